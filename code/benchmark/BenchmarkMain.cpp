@@ -0,0 +1,48 @@
+#include <iostream>
+#include "WindowImpl.h"
+
+#include "BenchmarkRunner.h"
+#include "FrameCapture.h"
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "Benchmark"
+
+#ifndef BENCHMARK_SCENE_NAME
+#define BENCHMARK_SCENE_NAME "unknown"
+#endif
+
+int main(int argc, char** argv) {
+    framework::BenchmarkConfig config{};
+    std::vector<std::string> compareReports = {};
+    if (!framework::BenchmarkRunner::ParseCommandLine(argc, argv, config, compareReports)) {
+        framework::BenchmarkRunner::PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    // 只比较两份报告或两次回放结果，不渲染
+    if (!compareReports.empty()) {
+        int regressionCount = config.compareReplays ?
+            framework::FrameCapture::Compare(compareReports[0], compareReports[1], config.regressionThresholdPercent) :
+            framework::BenchmarkRunner::CompareReports(compareReports[0], compareReports[1], config.regressionThresholdPercent);
+        return regressionCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int result = EXIT_FAILURE;
+    try {
+        window::WindowImpl a(false, config.visible);
+        if (!config.replayPath.empty()) {
+            a.EnableReplay(config);
+        }
+        else {
+            a.EnableBenchmark(config, BENCHMARK_SCENE_NAME);
+        }
+        a.Exec();
+        result = a.GetBenchmarkResult();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return result;
+}
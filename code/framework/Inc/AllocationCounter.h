@@ -0,0 +1,25 @@
+#ifndef __ALLOCATION_COUNTER_H__
+#define __ALLOCATION_COUNTER_H__
+
+#include <cstdint>
+
+// 编译期开关，打开时替换全局operator new，统计每个线程的堆分配次数；默认关闭，只有跑分exe打开
+#ifndef ENABLE_ALLOCATION_COUNTER
+#define ENABLE_ALLOCATION_COUNTER 0
+#endif
+
+namespace framework {
+/*
+ * @brief 检查渲染循环中的堆分配：读取前后两次计数的差值，就是这段代码在当前线程中调用operator new的次数。
+ *        统计operator new/new[]，包括对齐版本；malloc不计入。
+ */
+class AllocationCounter {
+public:
+    static bool IsEnabled() { return ENABLE_ALLOCATION_COUNTER != 0; }
+
+    // 当前线程累计的分配次数，关闭时始终为0
+    static uint64_t GetThreadCount();
+};
+}   // namespace framework
+
+#endif // !__ALLOCATION_COUNTER_H__
@@ -2,79 +2,147 @@
 #define __APP_DISPATCH_TABLE__
 
 #include <vulkan/vulkan.h>
-#include "Log.h"
-
-#define DEFINE_FUNCTION(returnType, funcName, ...) returnType funcName(##__VA_ARGS__)
-
-#define LOAD_AND_DISPATCH_INSTANCE_FUNCTION(funcName, returnErr, ...)         \
-{                                                                             \
-    static PFN_vk##funcName pfn##funcName = nullptr;                          \
-    if (pfn##funcName == nullptr && mInstance != VK_NULL_HANDLE) {            \
-        pfn##funcName = reinterpret_cast<PFN_vk##funcName>(                   \
-            vkGetInstanceProcAddr(mInstance, "vk" #funcName));                \
-    }                                                                         \
-    if (pfn##funcName == nullptr) {                                           \
-        LOGE("Get procces address vk" #funcName " failed!");                  \
-        return returnErr;                                                     \
-    }                                                                         \
-    return pfn##funcName(##__VA_ARGS__);                                      \
-}
-
-#define LOAD_AND_DISPATCH_DEVICE_FUNCTION(funcName, returnErr, ...)           \
-{                                                                             \
-    static PFN_vk##funcName pfn##funcName = nullptr;                          \
-    if (pfn##funcName == nullptr && mDevice != VK_NULL_HANDLE) {              \
-        pfn##funcName = reinterpret_cast<PFN_vk##funcName>(                   \
-        vkGetDeviceProcAddr(mDevice, "vk" #funcName));                        \
-    }                                                                         \
-    if (pfn##funcName == nullptr && mInstance != VK_NULL_HANDLE) {            \
-        pfn##funcName = reinterpret_cast<PFN_vk##funcName>(                   \
-            vkGetInstanceProcAddr(mInstance, "vk" #funcName));                \
-    }                                                                         \
-    if (pfn##funcName == nullptr) {                                           \
-        LOGE("Get procces address vk" #funcName " failed!");                  \
-        return returnErr;                                                     \
-    }                                                                         \
-    return pfn##funcName(##__VA_ARGS__);                                      \
-}
+
+// 用到的函数列表，新增调用时在对应的列表中添加
+#define APP_INSTANCE_FUNCTIONS_KHR_FRAGMENT_SHADING_RATE(X) \
+    X(GetPhysicalDeviceFragmentShadingRatesKHR)
+
+#define APP_DEVICE_FUNCTIONS_1_0(X) \
+    X(DestroyDevice) \
+    X(GetDeviceQueue) \
+    X(QueueSubmit) \
+    X(QueueWaitIdle) \
+    X(DeviceWaitIdle) \
+    X(AllocateMemory) \
+    X(FreeMemory) \
+    X(MapMemory) \
+    X(UnmapMemory) \
+    X(BindBufferMemory) \
+    X(BindImageMemory) \
+    X(GetBufferMemoryRequirements) \
+    X(GetImageMemoryRequirements) \
+    X(CreateFence) \
+    X(DestroyFence) \
+    X(ResetFences) \
+    X(WaitForFences) \
+    X(CreateSemaphore) \
+    X(DestroySemaphore) \
+    X(CreateQueryPool) \
+    X(DestroyQueryPool) \
+    X(GetQueryPoolResults) \
+    X(CreateBuffer) \
+    X(DestroyBuffer) \
+    X(CreateImage) \
+    X(DestroyImage) \
+    X(CreateImageView) \
+    X(DestroyImageView) \
+    X(CreateShaderModule) \
+    X(DestroyShaderModule) \
+    X(CreateGraphicsPipelines) \
+    X(CreateComputePipelines) \
+    X(DestroyPipeline) \
+    X(CreatePipelineLayout) \
+    X(DestroyPipelineLayout) \
+    X(CreateSampler) \
+    X(DestroySampler) \
+    X(CreateDescriptorSetLayout) \
+    X(DestroyDescriptorSetLayout) \
+    X(CreateDescriptorPool) \
+    X(DestroyDescriptorPool) \
+    X(AllocateDescriptorSets) \
+    X(UpdateDescriptorSets) \
+    X(CreateFramebuffer) \
+    X(DestroyFramebuffer) \
+    X(DestroyRenderPass) \
+    X(CreateCommandPool) \
+    X(DestroyCommandPool) \
+    X(ResetCommandPool) \
+    X(AllocateCommandBuffers) \
+    X(FreeCommandBuffers) \
+    X(BeginCommandBuffer) \
+    X(EndCommandBuffer) \
+    X(ResetCommandBuffer) \
+    X(CmdBindPipeline) \
+    X(CmdSetViewport) \
+    X(CmdSetScissor) \
+    X(CmdSetStencilReference) \
+    X(CmdBindDescriptorSets) \
+    X(CmdBindIndexBuffer) \
+    X(CmdBindVertexBuffers) \
+    X(CmdDraw) \
+    X(CmdDrawIndexed) \
+    X(CmdDispatch) \
+    X(CmdCopyBuffer) \
+    X(CmdCopyBufferToImage) \
+    X(CmdCopyImageToBuffer) \
+    X(CmdPipelineBarrier) \
+    X(CmdBeginQuery) \
+    X(CmdEndQuery) \
+    X(CmdResetQueryPool) \
+    X(CmdWriteTimestamp) \
+    X(CmdPushConstants) \
+    X(CmdBeginRenderPass) \
+    X(CmdNextSubpass) \
+    X(CmdEndRenderPass) \
+    X(CmdExecuteCommands)
+
+#define APP_DEVICE_FUNCTIONS_1_2(X) \
+    X(CreateRenderPass2) \
+    X(WaitSemaphores)
+
+#define APP_DEVICE_FUNCTIONS_KHR_SWAPCHAIN(X) \
+    X(CreateSwapchainKHR) \
+    X(DestroySwapchainKHR) \
+    X(GetSwapchainImagesKHR) \
+    X(AcquireNextImageKHR) \
+    X(QueuePresentKHR)
+
+#define APP_DEVICE_FUNCTIONS_KHR_FRAGMENT_SHADING_RATE(X) \
+    X(CmdSetFragmentShadingRateKHR)
+
+#define APP_DEVICE_FUNCTIONS_KHR_DYNAMIC_RENDERING(X) \
+    X(CmdBeginRenderingKHR) \
+    X(CmdEndRenderingKHR)
+
+#define APP_DECLARE_FUNCTION_POINTER(funcName) PFN_vk##funcName funcName = nullptr;
 
 namespace framework {
+/*
+ * @brief 实例级函数表，创建实例后加载一次
+ */
 class AppInstanceDispatchTable {
 public:
-    void InitInstance(VkInstance instance) {
-        mInstance = instance;
-    }
-
     static AppInstanceDispatchTable& GetInstance() {
         static AppInstanceDispatchTable inst;
         return inst;
     }
 
-    DEFINE_FUNCTION(VkResult, GetPhysicalDeviceFragmentShadingRatesKHR, VkPhysicalDevice physicalDevice, uint32_t* pFragmentShadingRateCount, VkPhysicalDeviceFragmentShadingRateKHR* pFragmentShadingRates)
-    LOAD_AND_DISPATCH_INSTANCE_FUNCTION(GetPhysicalDeviceFragmentShadingRatesKHR, VK_ERROR_INITIALIZATION_FAILED, physicalDevice, pFragmentShadingRateCount, pFragmentShadingRates)
+    void InitInstance(VkInstance instance);
 
-private:
-    VkInstance mInstance = VK_NULL_HANDLE;
+    APP_INSTANCE_FUNCTIONS_KHR_FRAGMENT_SHADING_RATE(APP_DECLARE_FUNCTION_POINTER)
 };
 
+/*
+ * @brief 设备级函数表，创建设备后用vkGetDeviceProcAddr加载一次，调用时直接进入驱动，不经过loader的分发。
+ *        扩展没有开启时对应的函数为空，调用前由使用者保证扩展已开启。
+ */
 class AppDeviceDispatchTable {
 public:
-    void InitDevice(VkInstance instance, VkDevice device) {
-        mInstance = instance;
-        mDevice = device;
-    }
-
     static AppDeviceDispatchTable& GetInstance() {
         static AppDeviceDispatchTable inst;
         return inst;
     }
 
-    DEFINE_FUNCTION(void, CmdSetFragmentShadingRateKHR, VkCommandBuffer commandBuffer, const VkExtent2D* pFragmentSize, const VkFragmentShadingRateCombinerOpKHR combinerOps[2])
-    LOAD_AND_DISPATCH_DEVICE_FUNCTION(CmdSetFragmentShadingRateKHR, void(), commandBuffer, pFragmentSize, combinerOps)
+    void InitDevice(VkDevice device);
 
-private:
-    VkDevice mDevice = VK_NULL_HANDLE;
-    VkInstance mInstance = VK_NULL_HANDLE;
+    APP_DEVICE_FUNCTIONS_1_0(APP_DECLARE_FUNCTION_POINTER)
+    APP_DEVICE_FUNCTIONS_1_2(APP_DECLARE_FUNCTION_POINTER)
+    APP_DEVICE_FUNCTIONS_KHR_SWAPCHAIN(APP_DECLARE_FUNCTION_POINTER)
+    APP_DEVICE_FUNCTIONS_KHR_FRAGMENT_SHADING_RATE(APP_DECLARE_FUNCTION_POINTER)
+    APP_DEVICE_FUNCTIONS_KHR_DYNAMIC_RENDERING(APP_DECLARE_FUNCTION_POINTER)
 };
 }   // namespace framework
+
+#undef APP_DECLARE_FUNCTION_POINTER
+
 #endif // !__APP_DISPATCH_TABLE__
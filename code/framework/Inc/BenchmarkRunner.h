@@ -0,0 +1,146 @@
+#ifndef __BENCHMARK_RUNNER_H__
+#define __BENCHMARK_RUNNER_H__
+
+#include <vector>
+#include <string>
+#include <map>
+#include <array>
+#include <cstdint>
+
+#include "Device.h"
+#include "Camera.h"
+#include "CameraPath.h"
+#include "FramePacer.h"
+#include "GpuProfiler.h"
+
+namespace framework {
+struct BenchmarkConfig {
+    uint32_t frameCount = 1000;             // 统计的帧数，不含预热
+    uint32_t warmupFrameCount = 60;
+    float timeStepSec = 1.0f / 60.0f;       // 相机路径按固定步长推进，每次运行画面一致
+    float orbitDurationSec = 10.0f;         // 没有路径文件时使用环绕路径
+    std::string cameraPathFile = "";
+    std::string reportPath = "benchmark_report.json";
+    std::string baselinePath = "";          // 非空时和基线比较
+    float regressionThresholdPercent = 5.0f;
+    bool visible = false;
+    std::string replayPath = "";            // 非空时回放录制的会话，代替跑分
+    std::string replayOutputPath = "replay_result.txt";
+    bool compareReplays = false;            // 比较的是两次回放的结果
+    uint32_t resizeIntervalFrames = 0;      // 大于0时每隔这么多帧按脚本修改窗口大小，统计重建交换链那一帧的耗时
+    bool checkAllocations = false;          // 统计的帧中渲染线程有堆分配时跑分失败
+    bool measureCpuUsage = false;           // 统计进程和主线程的CPU占用
+    bool pollEvents = false;                // 主线程轮询事件，和默认的阻塞等待对比CPU占用
+    bool measureDispatchOverhead = false;   // 初始化时比较经过loader和直接用设备函数表录制命令的开销
+};
+
+struct CpuUsageSample {
+    double wallSec = 0.0;
+    double processCpuSec = 0.0;
+    double mainThreadCpuSec = 0.0;
+    uint64_t eventLoopCount = 0;            // 主线程事件循环的次数
+};
+
+struct BenchmarkStatistics {
+    double avg = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+/*
+ * @brief 离线跑分：用相机路径代替用户输入，跑固定帧数后输出json报告，并可与基线报告比较
+ */
+class BenchmarkRunner {
+public:
+    BenchmarkRunner() {}
+    ~BenchmarkRunner() {}
+
+    /*
+     * @brief 解析命令行，支持 --frames --warmup --path --orbit --report --baseline --threshold --visible
+     *        --replay --replay-output --resize --check-allocations --cpu-usage --poll-events --dispatch-overhead，只比较两份报告的 --compare <baseline> <current>
+     *        和只比较两次回放结果的 --compare-replay <baseline> <current>
+     * @return 参数错误时返回false
+     */
+    static bool ParseCommandLine(int argc, char** argv, BenchmarkConfig& config, std::vector<std::string>& compareReports);
+    static void PrintUsage();
+
+    void Init(const BenchmarkConfig& config, const std::string& sceneName, Device* device);
+
+    bool IsFinished() { return mFrameIndex >= mConfig.warmupFrameCount + mConfig.frameCount; }
+
+    // 录制之前调用，按路径设置相机
+    void BeginFrame(Camera* camera);
+
+    /*
+     * @brief 帧节奏统计完成之后调用
+     * @param allocationCount 本帧渲染线程的堆分配次数
+     */
+    void EndFrame(const FrameTimingInfo& timing, VkExtent2D extent, uint64_t allocationCount);
+
+    // measureCpuUsage时在EndFrame之后调用，预热结束时的采样作为起点
+    void RecordCpuUsage(const CpuUsageSample& sample);
+
+    /*
+     * @brief EndFrame之后调用，按resizeIntervalFrames在几个固定比例的分辨率之间切换
+     * @return 这一帧需要修改窗口大小
+     */
+    bool GetScriptedResize(VkExtent2D& extent);
+
+    /*
+     * @brief 写报告，设置了基线时再比较
+     * @return 0表示成功且没有退化
+     */
+    int Finish();
+
+    /*
+     * @return 超过阈值的指标个数，读取失败时返回-1
+     */
+    static int CompareReports(const std::string& baselinePath, const std::string& currentPath, float thresholdPercent);
+
+private:
+    struct ScopeAccumulator {
+        uint32_t order = 0;
+        uint32_t sampleCount = 0;
+        double sumMs = 0.0;
+        uint32_t statisticsCount = 0;
+        std::array<double, GPU_STAT_COUNT> statisticsSum = {};
+    };
+
+    static BenchmarkStatistics CalculateStatistics(std::vector<float> samples);
+    // 录制大量状态命令，得到每条命令的平均耗时
+    void MeasureDispatchOverhead();
+    bool WriteReport();
+
+private:
+    BenchmarkConfig mConfig = {};
+    std::string mSceneName = {};
+    Device* mDevice = nullptr;
+
+    CameraPath mCameraPath = {};
+    bool mCameraPathReady = false;
+    uint32_t mFrameIndex = 0;
+    VkExtent2D mExtent = {};
+    VkExtent2D mBaseExtent = {};            // 脚本修改大小之前的分辨率
+    uint32_t mResizeStep = 0;
+
+    std::vector<float> mCpuFrameTimes = {};
+    std::vector<float> mGpuFrameTimes = {};
+    std::vector<float> mFrameIntervals = {};
+    std::vector<float> mResizeCpuFrameTimes = {};   // 分辨率变化的那一帧，包含重建交换链的耗时
+    std::vector<float> mResizeFrameIntervals = {};
+    // 不含分辨率变化的帧
+    uint32_t mAllocationFrameCount = 0;     // 有堆分配的帧数
+    uint64_t mAllocationCount = 0;
+    uint64_t mMaxFrameAllocationCount = 0;
+    CpuUsageSample mCpuUsageBegin = {};
+    CpuUsageSample mCpuUsageEnd = {};
+    double mLoaderNsPerCommand = 0.0;
+    double mTableNsPerCommand = 0.0;
+    uint64_t mLastGpuFrameCount = 0;
+    std::map<std::string, ScopeAccumulator> mGpuScopes = {};
+};
+}   // namespace framework
+
+#endif // !__BENCHMARK_RUNNER_H__
@@ -24,6 +24,13 @@ public:
     {
         return mProjection;
     }
+    // 叠加了子像素抖动的投影矩阵，时域超分时用于渲染
+    glm::mat4 GetJitteredProjection();
+    // 抖动量，单位为NDC
+    void SetJitter(glm::vec2 jitter)
+    {
+        mJitter = jitter;
+    }
     glm::vec3& GetUp()
     {
         return mUp;
@@ -58,6 +65,7 @@ public:
     glm::mat4 mView;
 
     glm::mat4 mProjection;
+    glm::vec2 mJitter = glm::vec2(0.0f);
 
 };
 }   // namespace framework
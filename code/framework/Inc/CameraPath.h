@@ -0,0 +1,53 @@
+#ifndef __CAMERA_PATH_H__
+#define __CAMERA_PATH_H__
+
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Camera.h"
+
+namespace framework {
+struct CameraKeyframe {
+    float timeSec = 0.0f;
+    glm::vec3 targetPoint = glm::vec3(0.0f);
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    float targetDistance = 1.0f;
+};
+
+/*
+ * @brief 相机关键帧路径，可以从文件读取、录制或者参数化生成，按时间插值后写回Camera
+ */
+class CameraPath {
+public:
+    CameraPath() {}
+    ~CameraPath() {}
+
+    // 文本格式，每行一个关键帧：time targetX targetY targetZ yaw pitch distance
+    bool LoadFromFile(const std::string& path);
+    bool SaveToFile(const std::string& path);
+
+    /*
+     * @brief 以相机当前的目标点为中心环绕一周，俯仰角按正弦摆动
+     */
+    void CreateOrbit(const Camera& camera, float durationSec, float pitchAmplitudeDeg, uint32_t keyframeCount = 64);
+
+    // 时间必须递增
+    void AddKeyframe(const CameraKeyframe& keyframe);
+    void Clear() { mKeyframes.clear(); }
+    bool Empty() { return mKeyframes.empty(); }
+    float GetDuration() { return mKeyframes.empty() ? 0.0f : mKeyframes.back().timeSec; }
+
+    // 超过路径时长后循环
+    void Apply(Camera& camera, float timeSec);
+
+    static CameraKeyframe Capture(const Camera& camera, float timeSec);
+
+private:
+    std::vector<CameraKeyframe> mKeyframes = {};
+};
+}   // namespace framework
+
+#endif // !__CAMERA_PATH_H__
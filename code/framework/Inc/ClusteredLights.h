@@ -0,0 +1,116 @@
+#ifndef __CLUSTERED_LIGHTS_H__
+#define __CLUSTERED_LIGHTS_H__
+
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include "Device.h"
+#include "PipelineFactory.h"
+
+namespace framework {
+// 和着色器中的PointLight一致，std430布局
+struct PointLight {
+    glm::vec3 position = glm::vec3(0.0f);
+    float radius = 0.0f;                    // 影响半径，分簇按这个半径裁剪，着色时在半径处衰减到0
+    glm::vec3 power = glm::vec3(0.0f);
+    float padding = 0.0f;
+};
+
+/*
+ * @brief 分簇前向渲染的光源剔除：光源由CPU写入SSBO，计算着色器按相机的投影把视锥切分成froxel，
+ *        为每个簇记录与之相交的光源下标，片元着色器只遍历所在簇的光源。
+ *        使用分簇结果的管线需要在描述符集中加入AppendLayoutBindings的绑定，并用WriteDescriptorSet写入。
+ */
+class ClusteredLights {
+public:
+    ClusteredLights() {}
+    ~ClusteredLights() {}
+
+    void Init(Device* device, uint32_t maxLightCount);
+    void CleanUp();
+
+    // 片元着色器中的绑定号，场景自己的绑定不能和它们冲突
+    static void AppendLayoutBindings(std::vector<VkDescriptorSetLayoutBinding>& bindings,
+        VkShaderStageFlags stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT);
+    void WriteDescriptorSet(VkDescriptorSet descriptorSet);
+
+    // 超过maxLightCount的部分被丢弃，录制CmdCullLights时上传
+    void SetLights(const PointLight* lights, uint32_t lightCount);
+    uint32_t GetLightCount() { return mLightCount; }
+    uint32_t GetMaxLightCount() { return mMaxLightCount; }
+
+    /*
+     * @brief 上传光源并分簇，在使用分簇结果的pass之前、pass外录制
+     * @param proj 渲染使用的投影矩阵(y已翻转，不带抖动)，nearPlane和farPlane需要和它一致
+     * @param renderExtent 渲染区域的大小，片元着色器按gl_FragCoord查找所在的簇
+     */
+    void CmdCullLights(VkCommandBuffer cmdBuf, const glm::mat4& view, const glm::mat4& proj,
+        float nearPlane, float farPlane, VkExtent2D renderExtent);
+
+    // 辐照度衰减到threshold时的距离，作为光源的影响半径
+    static float CalculateRadius(const glm::vec3& power, float threshold);
+
+public:
+    static constexpr uint32_t GRID_SIZE_X = 16;
+    static constexpr uint32_t GRID_SIZE_Y = 9;
+    static constexpr uint32_t GRID_SIZE_Z = 24;
+    static constexpr uint32_t CLUSTER_COUNT = GRID_SIZE_X * GRID_SIZE_Y * GRID_SIZE_Z;
+    // 每个簇固定的下标槽位，超出的光源被丢弃；和着色器中的MAX_LIGHTS_PER_CLUSTER一致
+    static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 256;
+
+    static constexpr uint32_t BINDING_CLUSTER_PARAMS = 20;
+    static constexpr uint32_t BINDING_LIGHTS = 21;
+    static constexpr uint32_t BINDING_CLUSTER_LIGHT_COUNTS = 22;
+    static constexpr uint32_t BINDING_CLUSTER_LIGHT_INDICES = 23;
+
+private:
+    void CreateBuffers();
+    void CleanUpBuffers();
+
+    void CreatePipeline();
+    void CleanUpPipeline();
+
+    void CreateDescriptorSet();
+
+private:
+    // 和着色器中的ClusterParams一致，std140布局
+    struct ClusterParams {
+        glm::mat4 view;
+        glm::mat4 invProj;
+        glm::uvec4 gridSize;        // xyz为簇的个数，w为光源个数
+        glm::vec4 screenParams;     // 渲染区域的宽高，近平面，远平面
+        glm::vec4 sliceParams;      // 深度分片：slice = log(depth) * x - y
+    };
+
+    Device* mDevice = nullptr;
+
+    PipelineObjecs mPipelineCull = {};
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptorSetCull = VK_NULL_HANDLE;
+
+    // 参数和光源的暂存区常驻映射，RenderThread录制前已经等到上一帧执行完，直接覆盖
+    VkBuffer mParamsBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mParamsMemory = VK_NULL_HANDLE;
+    void* mParamsAddr = nullptr;
+    VkBuffer mLightStagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mLightStagingMemory = VK_NULL_HANDLE;
+    void* mLightStagingAddr = nullptr;
+
+    // 片元着色器读取的数据放在显存中
+    VkBuffer mLightBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mLightMemory = VK_NULL_HANDLE;
+    VkBuffer mClusterLightCountBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mClusterLightCountMemory = VK_NULL_HANDLE;
+    VkBuffer mClusterLightIndexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mClusterLightIndexMemory = VK_NULL_HANDLE;
+
+    uint32_t mMaxLightCount = 0;
+    uint32_t mLightCount = 0;
+    bool mLightsDirty = false;
+
+    static constexpr uint32_t CULL_GROUP_SIZE = 64;     // 和cluster_light_cull.comp的local_size_x一致
+};
+}   // namespace framework
+
+#endif // !__CLUSTERED_LIGHTS_H__
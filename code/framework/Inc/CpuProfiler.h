@@ -0,0 +1,114 @@
+#ifndef __CPU_PROFILER_H__
+#define __CPU_PROFILER_H__
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "SpscRingBuffer.h"
+
+// 编译期开关，关闭后CPU_PROFILE_SCOPE展开为空，不产生任何开销
+#ifndef ENABLE_CPU_PROFILER
+#define ENABLE_CPU_PROFILER 1
+#endif
+
+namespace framework {
+struct CpuZoneRecord {
+    const char* name = nullptr;     // 必须是字符串常量
+    int64_t beginNs = 0;            // steady_clock
+    int64_t endNs = 0;
+};
+
+/*
+ * @brief CPU端的分段计时。每个线程第一次记录时注册一个自己的环形队列，
+ *        记录时只写本线程的队列，没有锁；Collect在渲染线程把所有队列取出来。
+ */
+class CpuProfiler {
+public:
+    CpuProfiler() {}
+    ~CpuProfiler() {}
+
+    static CpuProfiler& GetInstance();
+
+    static int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 给当前线程命名，显示在trace中
+    void SetThreadName(const char* name);
+
+    // 任意线程调用，队列满时丢弃
+    void RecordZone(const char* name, int64_t beginNs, int64_t endNs);
+
+    /*
+     * @brief 取出各线程队列中的记录，只保留最近HISTORY_DURATION_NS内的。只能在一个线程调用
+     */
+    void Collect();
+
+    /*
+     * @brief 输出chrome://tracing格式的文件，GPU的scope换算到CPU时间轴上一起输出
+     */
+    bool WriteChromeTrace(const std::string& path, bool includeGpu = true);
+
+private:
+    static constexpr uint32_t THREAD_QUEUE_SIZE = 8192;
+    static constexpr int64_t HISTORY_DURATION_NS = 5000000000;      // 5s
+    static constexpr uint32_t HISTORY_CAPACITY = 32768;             // 每个线程最多保留的记录数
+
+    struct ThreadZones {
+        uint32_t threadIndex = 0;
+        std::string threadName = {};
+        SpscRingBuffer<CpuZoneRecord, THREAD_QUEUE_SIZE> queue;
+        std::atomic<uint32_t> droppedCount = 0;
+        // 只在Collect的线程访问，注册时分配好的环形数组，Collect时不再分配
+        std::vector<CpuZoneRecord> history = {};
+        uint32_t historyBegin = 0;
+        uint32_t historyCount = 0;
+    };
+
+    ThreadZones* GetThreadZones();
+
+private:
+    std::mutex mThreadsMutex;
+    std::vector<std::unique_ptr<ThreadZones>> mThreads = {};
+};
+
+/*
+ * @brief RAII形式的zone，析构时记录
+ */
+class CpuProfileScope {
+public:
+    explicit CpuProfileScope(const char* name) : mName(name), mBeginNs(CpuProfiler::NowNs()) {}
+
+    ~CpuProfileScope()
+    {
+        CpuProfiler::GetInstance().RecordZone(mName, mBeginNs, CpuProfiler::NowNs());
+    }
+
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    const char* mName = nullptr;
+    int64_t mBeginNs = 0;
+};
+}   // namespace framework
+
+#define CPU_PROFILE_CONCAT_INNER(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_INNER(a, b)
+
+#if ENABLE_CPU_PROFILER
+#define CPU_PROFILE_SCOPE(name) framework::CpuProfileScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#define CPU_PROFILE_THREAD_NAME(name) framework::CpuProfiler::GetInstance().SetThreadName(name)
+#else
+#define CPU_PROFILE_SCOPE(name)
+#define CPU_PROFILE_THREAD_NAME(name)
+#endif
+
+#endif // !__CPU_PROFILER_H__
@@ -0,0 +1,70 @@
+#ifndef __DELETION_QUEUE_H__
+#define __DELETION_QUEUE_H__
+
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <functional>
+#include <cstdint>
+
+#include "Device.h"
+#include "PipelineFactory.h"
+#include "VmaUsage.h"
+
+namespace framework {
+/*
+ * @brief 延迟销毁：加入的资源在当前帧(包括异步计算)执行完之后才真正销毁。
+ *        重建分辨率、运行时替换资源时把旧资源交给这里，不需要vkDeviceWaitIdle。
+ *        只在渲染线程使用，句柄为VK_NULL_HANDLE时忽略。
+ */
+class DeletionQueue {
+public:
+    DeletionQueue() {}
+    ~DeletionQueue() {}
+
+    static DeletionQueue& GetInstance();
+
+    void Init(Device* device);
+
+    // 设备空闲之后调用，立即释放剩余的所有资源
+    void CleanUp();
+
+    // 渲染线程等到上一帧的fence和异步计算之后、录制本帧之前调用
+    void BeginFrame();
+    uint64_t GetFrameSerial() { return mFrameSerial; }
+
+    /*
+     * @brief 通用入口，release在资源不再被使用后调用
+     * @param extraFrames 当前帧之后再多保留的帧数，例如retired的交换链要等排队的显示完成
+     */
+    void Push(std::function<void()> release, uint32_t extraFrames = 0);
+
+    void DestroyBuffer(VkBuffer buffer);
+    void DestroyImage(VkImage image);
+    void DestroyImageView(VkImageView imageView);
+    void DestroyFramebuffer(VkFramebuffer framebuffer);
+    void DestroySampler(VkSampler sampler);
+    void DestroyPipeline(VkPipeline pipeline);
+    void DestroyPipelineObjecs(const PipelineObjecs& pipeline);
+    void DestroyDescriptorPool(VkDescriptorPool descriptorPool);
+    void FreeMemory(VkDeviceMemory memory);
+    void DestroyVmaBuffer(VkBuffer buffer, VmaAllocation allocation);
+    void DestroyVmaImage(VkImage image, VmaAllocation allocation);
+
+private:
+    void Release(bool releaseAll);
+
+private:
+    struct Entry {
+        uint64_t frameSerial = 0;
+        std::function<void()> release = nullptr;
+    };
+
+    Device* mDevice = nullptr;
+    bool mInited = false;
+
+    std::deque<Entry> mEntries = {};
+    uint64_t mFrameSerial = 0;      // 正在录制的帧
+};
+}   // namespace framework
+
+#endif // !__DELETION_QUEUE_H__
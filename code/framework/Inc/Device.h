@@ -40,10 +40,27 @@ public:
 
     VkQueue GetPresentQueue() { return mPresentQueue; }
 
+    // 异步计算队列，没有时为VK_NULL_HANDLE
+    VkQueue GetComputeQueue() { return mComputeQueue; }
+
+    /*
+     * @brief 有独立的计算队列族，并且支持timeline semaphore
+     */
+    bool HasAsyncCompute() { return mComputeQueue != VK_NULL_HANDLE; }
+
     VkCommandBuffer CreateCommandBuffer(VkCommandBufferLevel level);
 
     void FreeCommandBuffer(VkCommandBuffer commandBuffer);
 
+    VkCommandBuffer CreateComputeCommandBuffer(VkCommandBufferLevel level);
+
+    void FreeComputeCommandBuffer(VkCommandBuffer commandBuffer);
+
+    /*
+     * @brief 图形队列和计算队列都会访问的图像用CONCURRENT模式创建，省去队列族所有权的转移，没有异步计算时不修改
+     */
+    void SetAsyncComputeSharing(VkImageCreateInfo& imageInfo);
+
     VkCommandBuffer BeginSingleTimeCommands();
 
     void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
@@ -64,6 +81,9 @@ private:
     VkQueue mGraphicsQueue = VK_NULL_HANDLE;	 // 图形队列
     VkQueue mPresentQueue = VK_NULL_HANDLE;	     // 显示队列
     VkCommandPool mCommandPoolOfGraphics = VK_NULL_HANDLE; // 命令池
+    VkQueue mComputeQueue = VK_NULL_HANDLE;      // 异步计算队列
+    VkCommandPool mCommandPoolOfCompute = VK_NULL_HANDLE;
+    std::vector<uint32_t> mSharingQueueFamilies = {};
 
     // info
     PhysicalDevice::QueueFamilyIndices mQueueFamilyIndices = {};
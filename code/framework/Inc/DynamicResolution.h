@@ -0,0 +1,56 @@
+#ifndef __DYNAMIC_RESOLUTION_H__
+#define __DYNAMIC_RESOLUTION_H__
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include "SceneDemoConfig.h"
+
+namespace framework {
+/*
+ * @brief 动态分辨率：按GPU耗时调整主framebuffer的渲染区域。
+ *        图像按maxScale一次分配好，缩放时只改变viewport和scissor，不重新分配；
+ *        只有窗口大小变化时才需要重建。
+ */
+class DynamicResolution {
+public:
+    DynamicResolution() {}
+    ~DynamicResolution() {}
+
+    void Init(const DynamicResolutionConfig& config);
+
+    /*
+     * @brief 交换链大小变化时调用
+     * @return 主framebuffer需要分配的大小
+     */
+    VkExtent2D Resize(VkExtent2D swapchainExtent);
+
+    // 每帧录制之前调用，gpuFrameTimeMs为0时不调整
+    void Update(float gpuFrameTimeMs);
+
+    VkExtent2D GetMaxExtent() { return mMaxExtent; }
+    VkExtent2D GetRenderExtent() { return mRenderExtent; }
+    float GetScale() { return mScale; }
+
+    // 渲染区域在分配的图像中所占的比例，采样主framebuffer时用来缩放纹理坐标
+    glm::vec2 GetUvScale();
+
+    // 采样渲染区域时纹理坐标的上限，离边缘半个像素，避免双线性采样读到区域外的旧数据
+    glm::vec2 GetUvClamp();
+
+private:
+    void UpdateRenderExtent();
+
+private:
+    DynamicResolutionConfig mConfig = {};
+    VkExtent2D mSwapchainExtent = {};
+    VkExtent2D mMaxExtent = {};
+    VkExtent2D mRenderExtent = {};
+    float mScale = 1.0f;
+    float mAvgGpuTimeMs = 0.0f;
+
+    static constexpr float SMOOTH_FACTOR = 0.1f;
+};
+}   // namespace framework
+
+#endif // !__DYNAMIC_RESOLUTION_H__
@@ -0,0 +1,77 @@
+#ifndef __FRAME_ARENA_H__
+#define __FRAME_ARENA_H__
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace framework {
+/*
+ * @brief 帧内的线性分配器：每帧开始时整体重置，帧内分配只移动偏移，释放什么也不做。
+ *        只在渲染线程使用，分配的内存不能跨帧保存。容量不够时退回到operator new并输出警告。
+ */
+class FrameArena {
+public:
+    FrameArena() {}
+    ~FrameArena() {}
+
+    static FrameArena& GetInstance();
+
+    void Init(size_t capacity);
+    void CleanUp();
+
+    // 渲染线程每帧开始时调用，上一帧分配的内存全部失效
+    void Reset();
+
+    void* Allocate(size_t size, size_t alignment);
+    void Deallocate(void* ptr, size_t size, size_t alignment);
+
+    size_t GetUsedSize() { return mOffset; }
+    size_t GetPeakSize() { return mPeakSize; }
+
+private:
+    bool Contains(const void* ptr);
+
+private:
+    std::unique_ptr<uint8_t[]> mBuffer = nullptr;
+    size_t mCapacity = 0;
+    size_t mOffset = 0;
+    size_t mPeakSize = 0;
+    bool mOverflowReported = false;
+};
+
+/*
+ * @brief STL分配器适配，容器的元素从FrameArena分配
+ */
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(FrameArena::GetInstance().Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept
+    {
+        FrameArena::GetInstance().Deallocate(ptr, count * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+};
+
+// 帧内临时数组，生命周期不能超过当前帧
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+}   // namespace framework
+
+#endif // !__FRAME_ARENA_H__
@@ -0,0 +1,54 @@
+#ifndef __FRAME_CAPTURE_H__
+#define __FRAME_CAPTURE_H__
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+#include "SceneRenderBase.h"
+#include "FramePacer.h"
+
+namespace framework {
+struct CapturedFrame {
+    uint32_t frameIndex = 0;
+    float timeSec = 0.0f;               // 场景时间
+    VkExtent2D extent = {};             // 交换链分辨率
+    bool resized = false;               // 这一帧之前发生过重建
+    FrameTimingInfo timing = {};
+    InputEventInfo input = {};
+    bool hasChecksum = false;           // 只有回放时计算画面校验和
+    uint64_t imageChecksum = 0;
+};
+
+/*
+ * @brief 一次会话的逐帧记录：输入、分辨率变化和耗时。录制的文件可以回放，
+ *        回放的结果也用同样的格式保存，两次回放的结果可以逐帧比较耗时和画面。
+ */
+class FrameCapture {
+public:
+    FrameCapture() {}
+    ~FrameCapture() {}
+
+    bool Load(const std::string& path);
+    bool Save(const std::string& path);
+
+    void Clear() { mFrames.clear(); }
+    void AddFrame(const CapturedFrame& frame) { mFrames.emplace_back(frame); }
+    std::vector<CapturedFrame>& GetFrames() { return mFrames; }
+
+    // FNV-1a，逐行计算，跳过行尾的填充
+    static uint64_t CalculateChecksum(const uint8_t* data, uint32_t rowBytes, uint32_t rowPitch, uint32_t rowCount);
+
+    /*
+     * @brief 逐帧比较两次回放的结果
+     * @return 画面不一致的帧数加上超过阈值的平均耗时指标数，读取失败时返回-1
+     */
+    static int Compare(const std::string& baselinePath, const std::string& currentPath, float thresholdPercent);
+
+private:
+    std::vector<CapturedFrame> mFrames = {};
+};
+}   // namespace framework
+
+#endif // !__FRAME_CAPTURE_H__
@@ -0,0 +1,84 @@
+#ifndef __FRAME_PACER_H__
+#define __FRAME_PACER_H__
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <chrono>
+
+#include "SceneDemoConfig.h"
+
+namespace framework {
+struct FrameTimingInfo {
+    float cpuFrameTimeMs = 0.0f;        // 渲染线程在一帧内的实际工作时间，不含等待fence、acquire和节奏控制
+    float gpuFrameTimeMs = 0.0f;        // 上一帧命令在GPU上的执行时间
+    float frameIntervalMs = 0.0f;       // 相邻两帧开始的间隔
+    float estimatedLatencyMs = 0.0f;    // 输入采样到画面显示的估计延迟
+    float resizeTimeMs = 0.0f;          // 本帧重建交换链的耗时，发生在输入采样之前，不计入cpuFrameTimeMs
+};
+
+/*
+ * @brief 控制渲染线程的帧节奏，并统计每帧的CPU/GPU耗时和延迟。
+ *        调用顺序：BeginFrame -> (等待fence、重建交换链、acquire) -> WaitForInputSampling -> (处理输入、录制)
+ *        -> MarkSubmitted -> (present) -> EndFrame
+ */
+class FramePacer {
+public:
+    FramePacer() {}
+    ~FramePacer() {}
+
+    void Init(const FramePacingConfig& config);
+
+    void SetMode(FramePacingMode mode) { mConfig.mode = mode; }
+    FramePacingMode GetMode() { return mConfig.mode; }
+
+    // 各模式对应的交换链显示模式，按优先级排列
+    static std::vector<VkPresentModeKHR> GetPresentModeCandidates(FramePacingMode mode);
+
+    void BeginFrame();
+
+    /*
+     * @brief LOW_LATENCY模式下等待到预测的最晚开始时间，其他模式直接返回；返回时记为输入采样时间
+     */
+    void WaitForInputSampling();
+
+    void MarkSubmitted();
+
+    // 记录重建交换链的耗时，累加到下一次EndFrame的resizeTimeMs中
+    void AddResizeTime(float resizeTimeMs) { mPendingResizeTimeMs += resizeTimeMs; }
+
+    /*
+     * @brief TARGET_FPS模式下等待到下一帧的开始时间
+     * @param gpuFrameTimeMs GPU计时结果，没有时传0
+     * @param presentMode 当前交换链实际使用的显示模式，用于估计排队延迟
+     */
+    void EndFrame(float gpuFrameTimeMs, VkPresentModeKHR presentMode);
+
+    const FrameTimingInfo& GetTimingInfo() { return mTimingInfo; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void WaitUntil(Clock::time_point targetTime);
+    float ElapsedMs(Clock::time_point begin, Clock::time_point end);
+
+private:
+    FramePacingConfig mConfig = {};
+    FrameTimingInfo mTimingInfo = {};
+
+    Clock::time_point mFrameBeginTime = {};
+    Clock::time_point mLastFrameBeginTime = {};
+    Clock::time_point mAcquiredTime = {};
+    Clock::time_point mInputSampleTime = {};
+    Clock::time_point mSubmitTime = {};
+    bool mHasLastFrame = false;
+    float mPendingResizeTimeMs = 0.0f;
+
+    // 指数平均，用于LOW_LATENCY的预测
+    static constexpr float SMOOTH_FACTOR = 0.1f;
+    float mAvgCpuTimeMs = 0.0f;
+    float mAvgGpuTimeMs = 0.0f;
+    float mAvgIntervalMs = 0.0f;
+};
+}   // namespace framework
+
+#endif // !__FRAME_PACER_H__
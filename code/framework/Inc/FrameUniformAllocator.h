@@ -0,0 +1,68 @@
+#ifndef __FRAME_UNIFORM_ALLOCATOR_H__
+#define __FRAME_UNIFORM_ALLOCATOR_H__
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <cstring>
+
+#include "Device.h"
+
+namespace framework {
+struct UniformAllocation {
+    void* mapped = nullptr;
+    uint32_t offset = 0;        // 相对缓冲区开头的偏移，绑定时作为dynamic offset
+};
+
+/*
+ * @brief 每帧的uniform数据线性分配器。一个持久映射的缓冲区分成frameCount段，
+ *        每帧从一段的开头按minUniformBufferOffsetAlignment对齐依次分配，下一帧换到下一段，
+ *        GPU还在读的那一段不会被覆盖。描述符类型使用UNIFORM_BUFFER_DYNAMIC，
+ *        描述符只写一次(GetDescriptorInfo)，每次绘制通过dynamic offset选择数据，分配过程没有内存申请。
+ */
+class FrameUniformAllocator {
+public:
+    FrameUniformAllocator() {}
+    ~FrameUniformAllocator() {}
+
+    /*
+     * @param frameCapacity 每帧最多分配的字节数，超出时抛出异常
+     * @param frameCount 同时存在的帧数，至少为在飞行的帧数加1
+     */
+    void Init(Device* device, VkDeviceSize frameCapacity, uint32_t frameCount = DEFAULT_FRAME_COUNT);
+    void CleanUp();
+
+    // 上一帧的fence等到之后、本帧第一次分配之前调用，切换到下一段并从头分配
+    void BeginFrame();
+
+    UniformAllocation Allocate(VkDeviceSize size);
+
+    // 拷贝数据并返回dynamic offset
+    template <typename T>
+    uint32_t Push(const T& data)
+    {
+        UniformAllocation allocation = Allocate(sizeof(T));
+        memcpy(allocation.mapped, &data, sizeof(T));
+        return allocation.offset;
+    }
+
+    // range为绑定的单个结构体大小
+    VkDescriptorBufferInfo GetDescriptorInfo(VkDeviceSize range) { return { mBuffer, 0, range }; }
+    VkDeviceSize GetFrameUsedSize() { return mOffset - mFrameIndex * mFrameCapacity; }
+
+private:
+    static constexpr uint32_t DEFAULT_FRAME_COUNT = 2;
+
+    Device* mDevice = nullptr;
+    VkBuffer mBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mMemory = VK_NULL_HANDLE;
+    uint8_t* mMapped = nullptr;
+
+    VkDeviceSize mAlignment = 1;
+    VkDeviceSize mFrameCapacity = 0;
+    uint32_t mFrameCount = 0;
+    uint32_t mFrameIndex = 0;
+    VkDeviceSize mOffset = 0;
+};
+}   // namespace framework
+
+#endif // !__FRAME_UNIFORM_ALLOCATOR_H__
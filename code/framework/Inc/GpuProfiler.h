@@ -0,0 +1,176 @@
+#ifndef __GPU_PROFILER_H__
+#define __GPU_PROFILER_H__
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <array>
+#include <map>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <ostream>
+
+#include "Device.h"
+
+namespace framework {
+// 统计的管线数据，顺序与GpuProfiler::STATISTICS_FLAGS一致
+enum GpuStatisticsIndex : uint32_t {
+    GPU_STAT_IA_VERTICES = 0,
+    GPU_STAT_VS_INVOCATIONS,
+    GPU_STAT_CLIPPING_PRIMITIVES,
+    GPU_STAT_FS_INVOCATIONS,
+    GPU_STAT_CS_INVOCATIONS,
+    GPU_STAT_COUNT,
+};
+
+struct GpuScopeResult {
+    const char* name = nullptr;
+    double beginUs = 0.0;       // GPU时间戳换算成微秒，GPU自己的时间轴
+    double durationMs = 0.0;
+    bool hasStatistics = false;
+    std::array<uint64_t, GPU_STAT_COUNT> statistics = {};
+};
+
+/*
+ * @brief GPU耗时和管线统计，每个帧槽位有独立的一段query。
+ *        帧开始时只读取槽位中已经可用的结果，不会等待GPU。
+ */
+class GpuProfiler {
+public:
+    static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+    GpuProfiler() {}
+    ~GpuProfiler() {}
+
+    static GpuProfiler& GetInstance();
+
+    /*
+     * @param frameSlotCount 槽位数，至少比飞行帧多1，保证复用时上一轮的结果已经写完
+     * @param enablePipelineStatistics 需要开启pipelineStatisticsQuery特性
+     */
+    void Init(Device* device, uint32_t frameSlotCount, bool enablePipelineStatistics, uint32_t maxScopesPerFrame = 128);
+    void CleanUp();
+
+    bool IsEnabled() { return mTimestampQueryPool != VK_NULL_HANDLE; }
+
+    /*
+     * @brief CPU上每帧开始时调用：收集即将复用的槽位的结果，然后切换到该槽位
+     */
+    void BeginFrame();
+
+    /*
+     * @param submitted 本帧的命令是否已经提交，没有提交的槽位不会被读取
+     * @param submitCpuNs 第一次QueueSubmit调用之前的CPU时刻，用于估计GPU时钟偏移
+     */
+    void EndFrame(bool submitted, int64_t submitCpuNs);
+
+    /*
+     * @brief 重置当前槽位的query，必须在render pass外、本帧所有scope之前执行
+     */
+    void CmdResetQueries(VkCommandBuffer cmdBuf);
+
+    // 可以在多个线程同时录制
+    uint32_t CmdBeginScope(VkCommandBuffer cmdBuf, const char* name, bool pipelineStatistics = false);
+    void CmdEndScope(VkCommandBuffer cmdBuf, uint32_t scopeId);
+
+    // 最近一次收集到的结果中名为name的scope耗时，没有时返回0
+    float GetLastScopeTimeMs(const std::string& name);
+    const std::vector<GpuScopeResult>& GetLastFrameResults() { return mLastFrameResults; }
+    // 成功收集的帧数，变化时GetLastFrameResults才是新的一帧
+    uint64_t GetCollectedFrameCount() { return mCollectedFrameCount; }
+
+    void PrintAverageTable();
+    bool WriteChromeTrace(const std::string& path);
+
+    /*
+     * @brief 把最近的结果以trace事件的形式写入out，时间换算到CPU的steady_clock上
+     * @param first 是否为第一个事件，用于处理逗号
+     */
+    void WriteTraceEvents(std::ostream& out, bool& first);
+
+private:
+    struct ScopeRecord {
+        const char* name = nullptr;
+        uint32_t statisticsQuery = INVALID_SCOPE;
+    };
+
+    struct FrameSlot {
+        std::atomic<uint32_t> scopeCount = 0;
+        std::atomic<uint32_t> statisticsCount = 0;
+        std::vector<ScopeRecord> scopes = {};
+        bool submitted = false;
+        int64_t submitCpuNs = 0;
+    };
+
+    // 滑动窗口平均
+    static constexpr uint32_t AVERAGE_WINDOW = 128;
+    struct ScopeHistory {
+        uint32_t order = 0;
+        std::array<float, AVERAGE_WINDOW> samples = {};
+        uint32_t next = 0;
+        uint32_t count = 0;
+        double sum = 0.0;
+        bool hasStatistics = false;
+        std::array<uint64_t, GPU_STAT_COUNT> lastStatistics = {};
+    };
+
+    void CollectSlot(uint32_t slotIndex);
+    void AddToHistory(const GpuScopeResult& result);
+    uint32_t GetTimestampValidBits();
+
+private:
+    Device* mDevice = nullptr;
+    VkQueryPool mTimestampQueryPool = VK_NULL_HANDLE;
+    VkQueryPool mStatisticsQueryPool = VK_NULL_HANDLE;
+    double mTimestampPeriodNs = 1.0;
+    uint64_t mTimestampMask = UINT64_MAX;
+
+    uint32_t mMaxScopes = 0;
+    std::vector<std::unique_ptr<FrameSlot>> mFrameSlots = {};
+    uint32_t mCurrentSlot = 0;
+
+    // 收集到的结果
+    std::vector<GpuScopeResult> mLastFrameResults = {};
+    std::map<std::string, ScopeHistory, std::less<>> mHistories = {};     // 直接用const char*查找
+    // 最近的scope结果，环形覆盖，输出trace时使用
+    static constexpr uint32_t TRACE_RESULT_COUNT = 4096;
+    std::vector<GpuScopeResult> mTraceResults = {};
+    uint32_t mTraceNext = 0;
+    uint32_t mTraceCount = 0;
+    // 读取query结果的临时空间，Init时按最大scope数分配，每帧复用
+    std::vector<uint64_t> mTimestampResults = {};
+    std::vector<uint64_t> mStatisticsResults = {};
+    uint32_t mDroppedFrameCount = 0;
+    uint64_t mCollectedFrameCount = 0;
+
+    // GPU时间轴到CPU时间轴的偏移
+    double mGpuToCpuOffsetUs = 0.0;
+    bool mHasCpuOffset = false;
+};
+
+/*
+ * @brief RAII形式的scope，析构时写入结束时间戳
+ */
+class GpuProfileScope {
+public:
+    GpuProfileScope(VkCommandBuffer cmdBuf, const char* name, bool pipelineStatistics = false)
+        : mCommandBuffer(cmdBuf)
+    {
+        mScopeId = GpuProfiler::GetInstance().CmdBeginScope(cmdBuf, name, pipelineStatistics);
+    }
+
+    ~GpuProfileScope()
+    {
+        GpuProfiler::GetInstance().CmdEndScope(mCommandBuffer, mScopeId);
+    }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+    uint32_t mScopeId = GpuProfiler::INVALID_SCOPE;
+};
+}   // namespace framework
+
+#endif // !__GPU_PROFILER_H__
@@ -31,6 +31,10 @@ public:
         mSubpassIndex = subpassIndex;
     }
 
+    // 动态渲染时代替SetRenderPass，附件格式会被拷贝，调用后renderingInfo可以释放
+    bool SetRenderingInfo(const VkPipelineRenderingCreateInfoKHR& renderingInfo);
+    bool UseDynamicRendering() const { return mRenderPass == VK_NULL_HANDLE && mDynamicRendering; }
+
     void SetPipelineLayout(VkPipelineLayout pipelineLayout)
     {
         mPipelineLayout = pipelineLayout;
@@ -66,6 +70,10 @@ public:
     VkRenderPass mRenderPass = VK_NULL_HANDLE;
     uint32_t mSubpassIndex = 0;
 
+    VkPipelineRenderingCreateInfoKHR mRenderingInfo = {};
+    std::vector<VkFormat> mColorAttachmentFormats = {};
+    bool mDynamicRendering = false;
+
     VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
 };
 }   // namespace framework
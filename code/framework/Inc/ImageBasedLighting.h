@@ -0,0 +1,165 @@
+#ifndef __IMAGE_BASED_LIGHTING_H__
+#define __IMAGE_BASED_LIGHTING_H__
+
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include "Device.h"
+#include "PipelineFactory.h"
+#include "VmaUsage.h"
+
+namespace framework {
+// 等距柱状投影的HDR环境图，RGBA32F，第一行是天顶方向(+z)
+struct EquirectImage {
+    const float* pixels = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/*
+ * @brief 基于图像的环境光(split-sum)：环境图在GPU上预处理成漫反射的SH9辐照度系数、
+ *        按粗糙度预滤波的GGX高光立方体贴图和BRDF积分查找表，结果写入磁盘缓存，
+ *        同一张环境图只在第一次运行时计算，之后LoadCache直接上传。
+ *        使用预处理结果的管线需要在描述符集中加入AppendLayoutBindings的绑定，并用WriteDescriptorSet写入。
+ */
+class ImageBasedLighting {
+public:
+    ImageBasedLighting() {}
+    ~ImageBasedLighting() {}
+
+    void Init(Device* device);
+    void CleanUp();
+
+    /*
+     * @brief 缓存存在并且和sourceKey、预处理参数一致时直接上传到显存
+     * @return 返回false时需要调用Bake
+     */
+    bool LoadCache(const std::string& cachePath, uint64_t sourceKey);
+
+    // 在GPU上预处理环境图，结果留在显存中并写入缓存，缓存写入失败不影响使用
+    void Bake(const EquirectImage& source, const std::string& cachePath, uint64_t sourceKey);
+
+    bool IsReady() { return mParamsBuffer != VK_NULL_HANDLE; }
+
+    // 片元着色器中的绑定号，场景自己的绑定不能和它们冲突
+    static void AppendLayoutBindings(std::vector<VkDescriptorSetLayoutBinding>& bindings,
+        VkShaderStageFlags stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT);
+    void WriteDescriptorSet(VkDescriptorSet descriptorSet);
+
+    // 由文件路径、大小和修改时间得到的缓存键，文件不存在时返回0
+    static uint64_t GetFileKey(const std::string& filePath);
+
+    // 没有HDR环境图时使用的程序化天空，按PROCEDURAL_SKY_KEY缓存
+    static void GenerateProceduralSky(std::vector<float>& pixels, uint32_t width, uint32_t height);
+
+public:
+    static constexpr uint32_t BINDING_IBL_PARAMS = 24;
+    static constexpr uint32_t BINDING_PREFILTERED_ENV = 25;
+    static constexpr uint32_t BINDING_BRDF_LUT = 26;
+
+    static constexpr uint64_t PROCEDURAL_SKY_KEY = 1;
+    static constexpr uint32_t PROCEDURAL_SKY_WIDTH = 1024;
+    static constexpr uint32_t PROCEDURAL_SKY_HEIGHT = 512;
+
+    // 预处理参数，修改后旧的缓存自动失效
+    static constexpr uint32_t ENV_CUBE_SIZE = 512;
+    static constexpr uint32_t ENV_CUBE_MIP_COUNT = 10;
+    static constexpr uint32_t SH_PROJECT_MIP = 3;           // 在64x64的mip上投影SH，低频信息足够
+    static constexpr uint32_t PREFILTER_SIZE = 256;
+    static constexpr uint32_t PREFILTER_MIP_COUNT = 6;      // 第0级粗糙度为0，最后一级为1
+    static constexpr uint32_t BRDF_LUT_SIZE = 256;
+    static constexpr uint32_t CACHE_VERSION = 1;            // 修改预处理着色器后加1
+
+private:
+    // 和着色器中的IblParams一致，std140布局
+    struct IblParams {
+        glm::vec4 sh[9];                // 已卷积余弦核并除以PI的辐照度SH9系数，rgb有效
+        glm::vec4 prefilterParams;      // x为预滤波贴图的最大mip
+    };
+
+    // 预处理时的临时对象，Bake结束后全部释放
+    struct BakeResources {
+        VkImage equirectImage = VK_NULL_HANDLE;
+        VmaAllocation equirectAllocation = VK_NULL_HANDLE;
+        VkImageView equirectView = VK_NULL_HANDLE;
+
+        VkImage envImage = VK_NULL_HANDLE;
+        VmaAllocation envAllocation = VK_NULL_HANDLE;
+        VkImageView envStorageView = VK_NULL_HANDLE;
+        VkImageView envCubeView = VK_NULL_HANDLE;
+        std::vector<VkImageView> prefilterStorageViews = {};
+
+        // 每个面10项：9个SH系数和立体角之和，CPU上相加
+        VkBuffer shBuffer = VK_NULL_HANDLE;
+        VmaAllocation shAllocation = VK_NULL_HANDLE;
+        void* shAddr = nullptr;
+        // 预滤波贴图和查找表读回后写入缓存
+        VkBuffer readbackBuffer = VK_NULL_HANDLE;
+        VmaAllocation readbackAllocation = VK_NULL_HANDLE;
+        void* readbackAddr = nullptr;
+
+        VkSampler sampler = VK_NULL_HANDLE;
+        PipelineObjecs pipelineEquirectToCube = {};
+        PipelineObjecs pipelineShProject = {};
+        PipelineObjecs pipelinePrefilter = {};
+        PipelineObjecs pipelineBrdfLut = {};
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSetEquirectToCube = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSetShProject = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> descriptorSetsPrefilter = {};
+        VkDescriptorSet descriptorSetBrdfLut = VK_NULL_HANDLE;
+    };
+
+    void CreateResultImages();
+    void CleanUpResultImages();
+    void CreateParamsBuffer(const IblParams& params);
+
+    void CreateBakeResources(const EquirectImage& source, BakeResources& bake);
+    void CreateBakePipelines(BakeResources& bake);
+    void CreateBakeDescriptorSets(BakeResources& bake);
+    void RecordBake(VkCommandBuffer cmdBuf, BakeResources& bake);
+    IblParams ResolveShCoefficients(BakeResources& bake);
+    void CleanUpBakeResources(BakeResources& bake);
+
+    void SaveCache(const std::string& cachePath, uint64_t sourceKey, const IblParams& params, const void* data);
+
+    VkImageView CreateImageView(VkImage image, VkImageViewType viewType, VkFormat format,
+        uint32_t baseMip, uint32_t mipCount, uint32_t layerCount);
+    VkSampler CreateSampler(VkSamplerAddressMode addressModeU, uint32_t mipCount);
+    static void CmdImageBarrier(VkCommandBuffer cmdBuf, VkImage image, VkImageSubresourceRange range,
+        VkImageLayout oldLayout, VkImageLayout newLayout,
+        VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+    // 缓存中的数据：预滤波贴图按mip、面依次排列，后面接查找表
+    static std::vector<VkBufferImageCopy> GetPrefilterCopyRegions();
+    static VkBufferImageCopy GetBrdfLutCopyRegion();
+    static VkDeviceSize GetPrefilterDataSize();
+    static VkDeviceSize GetBrdfLutDataSize();
+
+private:
+    Device* mDevice = nullptr;
+
+    VkImage mPrefilteredImage = VK_NULL_HANDLE;
+    VmaAllocation mPrefilteredAllocation = VK_NULL_HANDLE;
+    VkImageView mPrefilteredView = VK_NULL_HANDLE;
+    VkImage mBrdfLutImage = VK_NULL_HANDLE;
+    VmaAllocation mBrdfLutAllocation = VK_NULL_HANDLE;
+    VkImageView mBrdfLutView = VK_NULL_HANDLE;
+    VkSampler mSampler = VK_NULL_HANDLE;
+
+    VkBuffer mParamsBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mParamsMemory = VK_NULL_HANDLE;
+
+    static constexpr VkFormat HDR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+    static constexpr VkFormat BRDF_LUT_FORMAT = VK_FORMAT_R16G16_SFLOAT;
+    static constexpr VkDeviceSize HDR_TEXEL_SIZE = 8;
+    static constexpr VkDeviceSize BRDF_LUT_TEXEL_SIZE = 4;
+    static constexpr uint32_t SH_COEFF_COUNT = 9;
+    static constexpr uint32_t SH_FACE_STRIDE = 10;          // 和ibl_sh_project.comp一致
+    static constexpr uint32_t BAKE_GROUP_SIZE = 8;          // 和预处理着色器的local_size一致
+};
+}   // namespace framework
+
+#endif // !__IMAGE_BASED_LIGHTING_H__
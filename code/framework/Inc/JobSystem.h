@@ -0,0 +1,168 @@
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <cstddef>
+
+namespace framework {
+struct Job;
+
+/*
+ * @brief 任务句柄，侵入式引用计数：最后一个句柄释放时Job回到JobSystem的空闲链表，
+ *        复用时不需要重新分配内存
+ */
+class JobHandle {
+public:
+    JobHandle() {}
+    JobHandle(std::nullptr_t) {}
+    explicit JobHandle(Job* job);
+    JobHandle(const JobHandle& other);
+    JobHandle(JobHandle&& other) noexcept : mJob(other.mJob) { other.mJob = nullptr; }
+    ~JobHandle();
+
+    JobHandle& operator=(const JobHandle& other);
+    JobHandle& operator=(JobHandle&& other) noexcept;
+
+    Job* operator->() const { return mJob; }
+    bool operator==(std::nullptr_t) const { return mJob == nullptr; }
+
+private:
+    void Release();
+
+private:
+    Job* mJob = nullptr;
+};
+
+struct Job {
+    // 预留几个后继任务的位置，Job复用时clear保留容量，登记后继任务不再分配
+    Job() { continuations.reserve(4); }
+
+    std::function<void()> func = nullptr;
+
+    // 未完成的前置任务个数，为0时才会被放入队列
+    std::atomic<uint32_t> pendingDependencies = 0;
+
+    // 本任务完成后需要检查的后继任务
+    std::mutex continuationMutex;
+    std::vector<JobHandle> continuations = {};
+    std::atomic<bool> finished = false;
+
+    // func抛出的异常，在finished之前写入，由Wait在等待的线程上重新抛出
+    std::exception_ptr exception = nullptr;
+
+    // 持有它的句柄个数，空闲链表中的下一个Job
+    std::atomic<uint32_t> refCount = 0;
+    Job* nextFree = nullptr;
+};
+
+/*
+ * @brief 工作窃取式的任务调度器，每个工作线程有自己的双端队列：
+ *        本线程从队尾取任务(LIFO)，空闲线程从其他队列的队头窃取(FIFO)。
+ *        非工作线程(渲染线程、主线程)提交的任务放入共享队列，同样可以被窃取。
+ */
+class JobSystem {
+public:
+    JobSystem() {}
+    ~JobSystem();
+
+    static JobSystem& GetInstance();
+
+    /*
+     * @param workerCount 工作线程个数，为0时按hardware_concurrency - 1创建(调用线程在Wait时也会执行任务)
+     */
+    void Init(uint32_t workerCount = 0);
+
+    void CleanUp();
+
+    bool IsInited() { return mInited; }
+
+    uint32_t GetWorkerCount() { return static_cast<uint32_t>(mWorkers.size()); }
+
+    /*
+     * @brief 提交任务，dependencies全部完成后才会执行
+     *        Job从空闲链表中复用，最后一个句柄释放后才会回到链表
+     */
+    JobHandle Schedule(std::function<void()> func, const std::vector<JobHandle>& dependencies = {});
+
+    /*
+     * @brief 在job完成后执行func
+     */
+    JobHandle Then(const JobHandle& job, std::function<void()> func);
+
+    /*
+     * @brief 等待任务完成，等待期间当前线程会帮忙执行队列中的任务
+     *        任务抛出异常时在这里重新抛出，任务本身仍视为已完成，后继任务照常执行
+     */
+    void Wait(const JobHandle& job);
+    // 全部完成后才抛出第一个异常
+    void WaitAll(const std::vector<JobHandle>& jobs);
+
+    /*
+     * @brief 将[0, count)按grainSize切分成多个任务并行执行，返回时全部执行完毕
+     *        某个区间抛出异常时，等所有区间结束后在调用线程上重新抛出
+     *        每帧调用时不分配内存：Job来自池中，各区间只引用调用者栈上的计数
+     * @param func 参数为[begin, end)
+     */
+    void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& func);
+
+private:
+    // 环形缓冲，满了才扩容，稳定之后入队出队都不再分配内存
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<JobHandle> jobs;
+        size_t head = 0;
+        size_t count = 0;
+
+        void PushBack(const JobHandle& job);
+        JobHandle PopBack();
+        JobHandle PopFront();
+    };
+
+    static constexpr size_t INITIAL_QUEUE_CAPACITY = 64;
+
+    void WorkerFunction(uint32_t workerIndex);
+
+    JobHandle AllocateJob();
+    void FreeJob(Job* job);
+    void DeleteFreeJobs();
+    JobHandle Schedule(std::function<void()> func, const JobHandle* dependencies, size_t dependencyCount);
+
+    void Enqueue(const JobHandle& job);
+    bool TryRunOneJob();
+    JobHandle PopLocal(uint32_t queueIndex);
+    JobHandle Steal(uint32_t thiefIndex);
+    void Execute(const JobHandle& job);
+
+private:
+    bool mInited = false;
+
+    std::vector<std::thread> mWorkers = {};
+
+    // [0, workerCount)为各工作线程的队列，最后一个为外部线程共享的队列
+    std::vector<std::unique_ptr<WorkQueue>> mQueues = {};
+
+    // 空闲的Job，Init时预先创建INITIAL_FREE_JOB_COUNT个，最多保留MAX_FREE_JOB_COUNT个，多出来的直接释放
+    static constexpr uint32_t INITIAL_FREE_JOB_COUNT = 256;
+    static constexpr uint32_t MAX_FREE_JOB_COUNT = 1024;
+    std::mutex mFreeJobMutex;
+    Job* mFreeJobs = nullptr;
+    uint32_t mFreeJobCount = 0;
+
+    friend class JobHandle;
+
+    // 空闲线程休眠
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition;
+    std::atomic<int32_t> mQueuedJobCount = 0;
+    std::atomic<bool> mIsDestroying = false;
+};
+}   // namespace framework
+
+#endif // !__JOB_SYSTEM_H__
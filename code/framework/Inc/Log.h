@@ -3,48 +3,58 @@
 
 #include <stdio.h>
 
+#include "Logger.h"
+
 #define LOG_TAG "DefaultTag"
 
+// 编译期过滤：低于LOG_COMPILE_LEVEL的日志不产生代码。
+// 单个文件可以在定义LOG_TAG的地方重新定义LOG_COMPILE_LEVEL，只裁掉自己的日志
+#ifndef LOG_COMPILE_LEVEL
 #ifdef NDEBUG
-#define LOGD(format, ...)
+#define LOG_COMPILE_LEVEL 1
 #else
-#define LOGD(format, ...) printf("[D] " LOG_TAG ": " format "\n", ##__VA_ARGS__)
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+// 每个调用点一个LogSite用于限频
+#define LOG_IMPL(level, format, ...)                                                            \
+do {                                                                                            \
+    if constexpr ((level) >= LOG_COMPILE_LEVEL) {                                               \
+        static framework::LogSite logSite;                                                      \
+        framework::Logger::GetInstance().Log(&logSite, level, LOG_TAG, format, ##__VA_ARGS__);  \
+    }                                                                                           \
+} while (0)
+
+// 列表输出不限频
+#define LOG_IMPL_UNLIMITED(level, format, ...)                                                  \
+do {                                                                                            \
+    if constexpr ((level) >= LOG_COMPILE_LEVEL) {                                               \
+        framework::Logger::GetInstance().Log(nullptr, level, LOG_TAG, format, ##__VA_ARGS__);   \
+    }                                                                                           \
+} while (0)
+
+#if LOG_COMPILE_LEVEL <= 0
+#define LOGD(format, ...) LOG_IMPL(framework::LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOGD(format, ...)
 #endif
 
-#define LOGI(format, ...) printf("[I] " LOG_TAG ": " format "\n", ##__VA_ARGS__)
-#define LOGW(format, ...) printf("[W] " LOG_TAG ": " format "\n", ##__VA_ARGS__)
-#define LOGE(format, ...) printf("[E] " LOG_TAG ": " format "\n", ##__VA_ARGS__)
-
-#define LOGI_LIST(head, list)							\
-printf("[D] " LOG_TAG ": " head "\n");					\
-for (int i = 0; i < list.size(); i++) {					\
-	std::string item(list[i]);							\
-	printf("[D] " LOG_TAG ":   - %s\n", item.c_str());	\
-}														\
-printf("[D] " LOG_TAG ":   - end\n");
-
-#define LOGI_LIST(head, list)							\
-printf("[I] " LOG_TAG ": " head "\n");					\
-for (int i = 0; i < list.size(); i++) {					\
-	std::string item(list[i]);							\
-	printf("[I] " LOG_TAG ":   - %s\n", item.c_str());	\
-}														\
-printf("[I] " LOG_TAG ":   - end\n");
-
-#define LOGW_LIST(head, list)							\
-printf("[W] " LOG_TAG ": " head "\n");					\
-for (int i = 0; i < list.size(); i++) {					\
-	std::string item(list[i]);							\
-	printf("[W] " LOG_TAG ":   - %s\n", item.c_str());	\
-}														\
-printf("[W] " LOG_TAG ":   - end\n");
-
-#define LOGE_LIST(head, list)							\
-printf("[E] " LOG_TAG ": " head "\n");					\
-for (int i = 0; i < list.size(); i++) {					\
-	std::string item(list[i]);							\
-	printf("[E] " LOG_TAG ":   - %s\n", item.c_str());	\
-}														\
-printf("[E] " LOG_TAG ":   - end\n");
+#define LOGI(format, ...) LOG_IMPL(framework::LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOGW(format, ...) LOG_IMPL(framework::LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOGE(format, ...) LOG_IMPL(framework::LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+#define LOG_LIST_IMPL(level, head, list)                        \
+LOG_IMPL_UNLIMITED(level, head);                                \
+for (int i = 0; i < list.size(); i++) {                         \
+    std::string item(list[i]);                                  \
+    LOG_IMPL_UNLIMITED(level, "  - %s", item.c_str());          \
+}                                                               \
+LOG_IMPL_UNLIMITED(level, "  - end");
+
+#define LOGD_LIST(head, list) LOG_LIST_IMPL(framework::LOG_LEVEL_DEBUG, head, list)
+#define LOGI_LIST(head, list) LOG_LIST_IMPL(framework::LOG_LEVEL_INFO, head, list)
+#define LOGW_LIST(head, list) LOG_LIST_IMPL(framework::LOG_LEVEL_WARN, head, list)
+#define LOGE_LIST(head, list) LOG_LIST_IMPL(framework::LOG_LEVEL_ERROR, head, list)
 
 #endif // __LOG_H__
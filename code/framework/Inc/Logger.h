@@ -0,0 +1,117 @@
+#ifndef __LOGGER_H__
+#define __LOGGER_H__
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+#include "SpscRingBuffer.h"
+
+namespace framework {
+enum LogLevel : int32_t {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF,
+};
+
+/*
+ * @brief 每个LOG调用点一个，用于限制同一处日志的频率
+ */
+struct LogSite {
+    std::atomic<int64_t> windowBeginMs = 0;
+    std::atomic<uint32_t> windowCount = 0;
+    std::atomic<uint32_t> suppressedCount = 0;
+};
+
+/*
+ * @brief Log.h的后端。调用线程只在自己的环形队列里格式化一条定长记录，不分配内存也不加锁，
+ *        后台线程按时间顺序合并各线程的记录后写到stdout。
+ */
+class Logger {
+public:
+    static constexpr uint32_t MAX_MESSAGE_LENGTH = 1024;    // 超出的部分截断
+    static constexpr uint32_t THREAD_QUEUE_SIZE = 256;
+    static constexpr uint32_t MAX_TAG_FILTERS = 32;
+    static constexpr uint32_t MAX_TAG_LENGTH = 32;
+    // 同一调用点每秒最多输出的条数
+    static constexpr uint32_t RATE_LIMIT_PER_SECOND = 20;
+
+    Logger() {}
+    ~Logger();
+
+    static Logger& GetInstance();
+
+    /*
+     * @param site 调用点，为空时不限频，队列满时等待而不是丢弃
+     */
+    void Log(LogSite* site, LogLevel level, const char* tag, const char* format, ...);
+
+    // 运行时过滤，可以在任意线程调用
+    void SetLevel(LogLevel level) { mLevel.store(level); }
+    LogLevel GetLevel() { return mLevel.load(); }
+    void SetTagLevel(const char* tag, LogLevel level);
+
+    // 等待当前已经提交的日志全部输出
+    void Flush();
+
+private:
+    struct LogRecord {
+        int64_t timestampUs = 0;
+        const char* tag = nullptr;      // 必须是字符串常量
+        LogLevel level = LOG_LEVEL_INFO;
+        uint32_t threadIndex = 0;
+        uint32_t suppressedCount = 0;
+        char message[MAX_MESSAGE_LENGTH] = {};
+    };
+
+    struct ThreadQueue {
+        uint32_t threadIndex = 0;
+        SpscRingBuffer<LogRecord, THREAD_QUEUE_SIZE> queue;
+        std::atomic<uint32_t> droppedCount = 0;
+    };
+
+    // 只增加不删除，读的时候不用加锁
+    struct TagFilter {
+        char tag[MAX_TAG_LENGTH] = {};
+        std::atomic<LogLevel> level = LOG_LEVEL_DEBUG;
+    };
+
+    bool IsEnabled(LogLevel level, const char* tag);
+    bool CheckRateLimit(LogSite& site, uint32_t& suppressedCount);
+    ThreadQueue* GetThreadQueue();
+
+    void StartWriter();
+    void WriterFunction();
+    uint32_t DrainQueues();
+    void WriteRecord(const LogRecord& record);
+
+private:
+    std::atomic<LogLevel> mLevel = LOG_LEVEL_DEBUG;
+    TagFilter mTagFilters[MAX_TAG_FILTERS] = {};
+    std::atomic<uint32_t> mTagFilterCount = 0;
+    std::mutex mTagFilterMutex;
+
+    std::mutex mThreadsMutex;
+    std::vector<std::unique_ptr<ThreadQueue>> mThreadQueues = {};
+
+    std::once_flag mWriterStartFlag;
+    std::unique_ptr<std::thread> mWriterThread = nullptr;
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterCondition;
+    std::condition_variable mFlushCondition;
+    std::atomic<bool> mIsDestroying = false;
+    std::atomic<bool> mUrgent = false;
+    uint64_t mFlushRequested = 0;
+    uint64_t mFlushFinished = 0;
+
+    std::vector<LogRecord> mWriteBatch = {};     // 只在写线程访问
+};
+}   // namespace framework
+
+#endif // !__LOGGER_H__
@@ -0,0 +1,89 @@
+#ifndef __PARALLEL_COMMAND_RECORDER_H__
+#define __PARALLEL_COMMAND_RECORDER_H__
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <functional>
+
+#include "Device.h"
+
+namespace framework {
+struct SecondaryRecordInfo {
+    uint32_t frameIndex = 0;                    // 当前帧在飞行帧中的编号，用于选择命令池
+    VkRenderPass renderPass = VK_NULL_HANDLE;   // 二级命令缓冲继承的render pass
+    uint32_t subpass = 0;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE; // 可以为空，填上之后驱动可以做更多优化
+    // 动态渲染时代替renderPass，此时renderPass和framebuffer为空
+    const VkCommandBufferInheritanceRenderingInfoKHR* renderingInfo = nullptr;
+    uint32_t drawCount = 0;                     // 需要切分的绘制个数
+};
+
+/*
+ * @brief 把一段绘制列表切分成多段，提交给JobSystem并行录制到二级命令缓冲中，
+ *        结果通过vkCmdExecuteCommands在主命令缓冲中执行。
+ *        每一段、每个飞行帧都有独立的命令池，录制时不需要加锁。
+ */
+class ParallelCommandRecorder {
+public:
+    // 录制[firstDraw, firstDraw + drawCount)范围内的绘制，cmdBuf已经begin，不需要end
+    using RecordFunc = std::function<void(VkCommandBuffer cmdBuf, uint32_t rangeIndex, uint32_t firstDraw, uint32_t drawCount)>;
+
+    ParallelCommandRecorder() {}
+    ~ParallelCommandRecorder() {}
+
+    /*
+     * @param workerCount 最多切分成几段并行录制，0表示JobSystem工作线程数 + 1(调用线程)
+     * @param framesInFlight 飞行帧个数，每一帧的命令池在该帧的fence触发前不会被重置
+     */
+    void Init(Device* device, uint32_t workerCount, uint32_t framesInFlight = 1);
+
+    void CleanUp();
+
+    /*
+     * @brief 阻塞直到所有段录制完成，返回的数组按绘制顺序排列
+     */
+    std::vector<VkCommandBuffer>& Record(const SecondaryRecordInfo& recordInfo, const RecordFunc& recordFunc);
+
+    uint32_t GetWorkerCount() { return mWorkerCount; }
+
+    // 限制实际切分的段数，用于测试并行度对录制耗时的影响
+    void SetActiveWorkerCount(uint32_t count);
+    uint32_t GetActiveWorkerCount() { return mActiveWorkerCount; }
+
+    // 上一次Record的耗时
+    float GetLastRecordTimeMs() { return mLastRecordTimeMs; }
+
+private:
+    void CreateCommandPools();
+    void CleanUpCommandPools();
+
+    void RecordRange(uint32_t rangeIndex);
+
+private:
+    struct WorkerFrameResources {
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    };
+
+    // external objects
+    Device* mDevice = nullptr;
+
+    uint32_t mWorkerCount = 1;
+    uint32_t mActiveWorkerCount = 1;
+    uint32_t mFramesInFlight = 1;
+
+    // [frameIndex][rangeIndex]
+    std::vector<std::vector<WorkerFrameResources>> mFrameResources = {};
+
+    // 当前录制任务
+    SecondaryRecordInfo mRecordInfo = {};
+    VkCommandBufferInheritanceInfo mInheritanceInfo = {};
+    const RecordFunc* mRecordFunc = nullptr;
+    std::vector<VkCommandBuffer> mWorkerCommandBuffers = {};
+    std::vector<VkCommandBuffer> mSecondaryCommandBuffers = {};
+
+    float mLastRecordTimeMs = 0.0f;
+};
+}   // namespace framework
+
+#endif // !__PARALLEL_COMMAND_RECORDER_H__
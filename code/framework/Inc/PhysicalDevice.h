@@ -16,6 +16,7 @@ public:
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        std::optional<uint32_t> computeFamily;     // 不支持图形的计算队列族，异步计算使用，可以没有
         bool IsComplete() {
             return graphicsFamily.has_value() && presentFamily.has_value();
         }
@@ -11,6 +11,7 @@ namespace framework {
 struct ShaderFileInfo {
     std::string filePath = "";
     VkShaderStageFlagBits stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
+    const VkSpecializationInfo* specializationInfo = nullptr;     // 创建管线期间需要保持有效
 };
 
 struct ShaderInfo {
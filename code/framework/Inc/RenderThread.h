@@ -5,8 +5,17 @@
 #include "RenderBase.h"
 #include "TestMesh.h"
 #include "SceneDemoDefs.h"
+#include "SpscRingBuffer.h"
+#include "FramePacer.h"
+#include "BenchmarkRunner.h"
+#include "CameraPath.h"
+#include "FrameCapture.h"
+#include "FrameArena.h"
 
 #include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
 #include <vulkan/vulkan.h>
 
 namespace window {
@@ -25,6 +34,25 @@ public:
 
     void SetFbResized();
 
+    // 可以在任意线程调用，下一帧开始时生效
+    void SetFramePacingMode(FramePacingMode mode);
+
+    // 在下一帧输出GPU profile表格和CPU/GPU合并的trace文件
+    void RequestProfileDump();
+
+    // 跑分模式，必须在Start之前调用；跑分时忽略用户输入，由相机路径驱动
+    void EnableBenchmark(const BenchmarkConfig& config, const std::string& sceneName);
+    int GetBenchmarkResult() { return mBenchmarkResult.load(); }
+
+    // 开始或结束录制相机路径，结束时保存到camera_path.txt
+    void ToggleCameraPathRecording();
+
+    // 回放录制的会话，必须在Start之前调用；逐帧按录制的输入和分辨率渲染，结果保存到config.replayOutputPath
+    void EnableReplay(const BenchmarkConfig& config);
+
+    // 开始或结束录制会话，结束时保存到capture.txt
+    void ToggleFrameCaptureRecording();
+
 private:
     // override from Thread
     void OnThreadInit() override;
@@ -37,8 +65,24 @@ private:
 private:
     // ----- rener functions -----
     void Resize();
+    void PushInputEvent(InputEvent& event);
+    void ConsumeInputEvents();
+    void ApplyFramePacingMode();
+    void UpdateCameraPathRecording();
+    void UpdateBenchmark();
+    float GetSceneTimeSec();
+
+    bool SubmitWithAsyncCompute(const FrameVector<VkCommandBuffer>& commandBuffers, const AsyncComputeInfo& asyncCompute,
+        int64_t& submitCpuNs);
+    void WaitAsyncCompute();
+
+    bool PrepareReplayFrame();
+    bool RecordReadbackCommand(uint32_t imageIndex);
+    void UpdateFrameCapture(float timeSec);
 
     // ----- create and clean up ----- 
+    void RequestDynamicRendering(PhysicalDevice* physicalDevice);
+
     void CreateAttachments();
     void CleanUpAttachments();
 
@@ -51,12 +95,23 @@ private:
     void CreatePresentRenderPass();
     void CleanUpPresentRenderPass();
 
+    void CreateProfileCommandBuffers();
+    void CleanUpProfileCommandBuffers();
+
+    void CreateReadbackBuffer(VkDeviceSize size);
+    void CleanUpReadbackBuffer();
+
 private:
     // sync objecs
     VkSemaphore mImageAvailableSemaphore = VK_NULL_HANDLE;
     VkSemaphore mRenderFinishedSemaphore = VK_NULL_HANDLE;
     VkFence mInFlightFence = VK_NULL_HANDLE;
 
+    // 异步计算的timeline semaphore，图形和计算交替signal递增的值，没有计算队列时不创建
+    VkSemaphore mAsyncComputeSemaphore = VK_NULL_HANDLE;
+    uint64_t mAsyncComputeValue = 0;        // 最近一次计算完成时的值
+    VkPipelineStageFlags mAsyncComputeWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
     // present fb depth attahcment
     VkFormat mDepthFormat = VK_FORMAT_UNDEFINED;
     VkImage mDepthImage = VK_NULL_HANDLE;
@@ -74,11 +129,69 @@ private:
 
     SceneRenderBase* mSceneRender = nullptr;
 
-    // 交互数据
-    std::mutex mInputEventMutex;
-    InputEventInfo mInputInfo = {};
+    // 交互数据，窗口线程写入、渲染线程读取
+    static constexpr uint32_t INPUT_EVENT_QUEUE_SIZE = 1024;
+    static constexpr uint32_t MAX_REPLAY_RESIZE_WAIT = 500;     // 等待窗口大小修改的最大次数，每次1ms
+    SpscRingBuffer<InputEvent, INPUT_EVENT_QUEUE_SIZE> mInputEventQueue;
+    std::atomic<uint32_t> mDroppedInputEventCount = 0;
+    InputEventInfo mInputInfo = {};    // 只在渲染线程访问
 
     std::atomic<bool> mFramebufferResized = false;
+    bool mSwapchainOutOfDate = false;       // 获取或显示失败、显示模式改变，下一帧开始时必须重建
+
+    // 帧节奏
+    FramePacer mFramePacer = {};
+    std::atomic<FramePacingMode> mRequestedPacingMode = FramePacingMode::VSYNC;
+
+    // 包住每帧提交的命令，重置profiler的query并统计整帧的GPU耗时
+    VkCommandBuffer mProfileBeginCmd = VK_NULL_HANDLE;
+    VkCommandBuffer mProfileEndCmd = VK_NULL_HANDLE;
+    std::atomic<bool> mProfileDumpRequested = false;
+
+    // 跑分
+    std::unique_ptr<BenchmarkRunner> mBenchmark = nullptr;
+    BenchmarkConfig mBenchmarkConfig = {};
+    std::string mBenchmarkSceneName = {};
+    bool mBenchmarkFinished = false;
+    std::atomic<int> mBenchmarkResult = 0;
+    uint64_t mFrameAllocationBase = 0;      // 本帧开始时渲染线程的堆分配计数
+
+    static constexpr size_t FRAME_ARENA_CAPACITY = 256 * 1024;
+
+    // 相机路径录制
+    std::atomic<bool> mCameraPathRecordRequested = false;
+    bool mCameraPathRecording = false;
+    CameraPath mRecordedCameraPath = {};
+    std::chrono::steady_clock::time_point mCameraPathRecordStartTime = {};
+
+    // 场景时间，mFixedTimeStepSec大于0时按帧数推进
+    std::chrono::steady_clock::time_point mSceneStartTime = {};
+    uint64_t mSceneFrameIndex = 0;
+    float mFixedTimeStepSec = 0.0f;
+
+    // 会话录制
+    std::atomic<bool> mFrameCaptureRecordRequested = false;
+    bool mFrameCaptureRecording = false;
+    FrameCapture mFrameCapture = {};
+    VkExtent2D mLastCapturedExtent = {};
+
+    // 会话回放
+    bool mReplaying = false;
+    std::string mReplayPath = {};
+    std::string mReplayOutputPath = {};
+    FrameCapture mReplayResult = {};
+    uint32_t mReplayFrameIndex = 0;
+    uint32_t mReplayResizeWaitCount = 0;
+    bool mReplayFinished = false;
+
+    // 回放时把交换链图像拷贝出来计算校验和
+    VkBuffer mReadbackBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mReadbackMemory = VK_NULL_HANDLE;
+    void* mReadbackMapped = nullptr;
+    VkDeviceSize mReadbackSize = 0;
+    VkCommandBuffer mReadbackCmd = VK_NULL_HANDLE;
+    VkExtent2D mReadbackExtent = {};
+    bool mReadbackRecorded = false;
 
 };
 }   // namespace framework
@@ -12,6 +12,8 @@ struct WindowConfig {
     uint32_t height = 960;
     uint32_t minWidth = 200;
     uint32_t minHeight = 200;
+    // 主线程阻塞等待事件，渲染线程需要主线程处理时发送空事件唤醒；关闭时每次循环都轮询，占满一个核
+    bool waitEvents = true;
 };
 
 struct InstanceConfig {
@@ -20,6 +22,7 @@ struct InstanceConfig {
 
 struct PhisicalDeviceConfig {
     VkPhysicalDeviceType defaultDeviceType = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+    bool enableAsyncCompute = false;    // 创建独立的计算队列，没有单独的计算队列族时不创建
 };
 
 struct LayerConfig {
@@ -39,7 +42,52 @@ struct ExtensionConfig {
 struct SwapchainConfig {
     VkSurfaceFormatKHR surfaceFormat = {};
     uint32_t imageCount = 2;
-    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    bool enableReadback = false;    // 图像可以拷贝到CPU，回放时计算画面校验和
+};
+
+enum class FramePacingMode : uint32_t {
+    UNCAPPED = 0,   // MAILBOX或IMMEDIATE，不限制帧率
+    VSYNC,          // FIFO，跟随垂直同步
+    TARGET_FPS,     // 不跟随垂直同步，CPU按固定帧率等待
+    LOW_LATENCY,    // FIFO，把输入采样和录制推迟到预测的GPU开始时间之前
+};
+
+struct FramePacingConfig {
+    FramePacingMode mode = FramePacingMode::VSYNC;  // 同时决定交换链的显示模式
+    float targetFps = 60.0f;                        // 只在TARGET_FPS下生效
+    float spinThresholdMs = 2.0f;                   // 剩余时间小于该值时改为自旋等待，sleep精度不够
+    float lowLatencyMarginMs = 1.0f;                // LOW_LATENCY预测误差的余量
+};
+
+struct DynamicResolutionConfig {
+    bool enable = false;                // 关闭时固定使用initialScale
+    float targetGpuTimeMs = 12.0f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;              // 主framebuffer按maxScale分配，缩放时不重新分配
+    float initialScale = 0.8f;
+    float adjustRate = 0.1f;            // 每帧向期望比例靠近的程度
+    float tolerancePercent = 5.0f;      // GPU耗时偏离目标不超过该比例时不调整
+    uint32_t alignment = 16;            // 渲染区域的对齐，VRS分析按16x16分块
+};
+
+struct VrsConfig {
+    bool reprojection = true;           // 按深度把上一帧的shading rate重投影到本帧
+    uint32_t analysisInterval = 1;      // 每隔几帧完整分析一次，其余帧只做重投影
+    bool asyncCompute = false;          // 内容分析放到计算队列上，和呈现pass并行，不支持时回退到图形队列
+    uint32_t tileSize = 16;             // shading rate附件的texel大小，可选8、16、32，按设备支持的范围调整
+
+    // 速率选择的参数，每帧作为push constant传给分析着色器
+    bool perceptual = true;             // 关闭时只按亮度梯度选择速率
+    float sensitivity = 5e-3f;          // 亮度梯度的阈值
+    float quarterCoef = 2.13f;          // 梯度乘以这个系数仍低于阈值时降到1/4
+    float motionScale = 0.1f;           // 每像素运动对梯度的衰减
+    float depthEdgeThreshold = 0.1f;    // 单元内距离的相对差超过它时保持全速率
+    float maskingStrength = 1.0f;       // 亮度掩蔽的强度
+    float adaptationLuma = 0.02f;       // 暗部的适应亮度
+
+    // 质量评估：每隔几帧额外渲染一帧全速率的参考画面，统计着色的像素和误差，0表示不评估
+    uint32_t evaluationInterval = 0;
+    std::string evaluationReportPath = "vrs_evaluation.txt";
 };
 
 struct PresentFbConfig {
@@ -49,6 +97,10 @@ struct PresentFbConfig {
 
     bool enableMsaa = false;
     VkSampleCountFlagBits msaaSampleCount = VK_SAMPLE_COUNT_1_BIT;
+
+    // 使用VK_KHR_dynamic_rendering直接在图像视图上渲染，不创建呈现RenderPass和交换链Framebuffer。
+    // 需要在deviceExtensions中加上VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME，不支持时退回RenderPass
+    bool dynamicRendering = false;
 };
 
 struct DirectoryConfig {
@@ -64,6 +116,9 @@ struct SceneDemoConfig {
     ExtensionConfig extension = {};
     VkPhysicalDeviceFeatures deviceFeatures = {};
     SwapchainConfig swapchain = {};
+    FramePacingConfig pacing = {};
+    DynamicResolutionConfig dynamicResolution = {};
+    VrsConfig vrs = {};
     PresentFbConfig presentFb = {};
     DirectoryConfig directory = {};
 };
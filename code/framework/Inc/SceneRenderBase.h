@@ -2,35 +2,86 @@
 #define __SCENE_RENDER_BASE__
 
 #include <stdexcept>
+#include <vector>
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
 
 #include "Device.h"
 #include "GraphicsPipelineConfigInfo.h"
 #include "TestMesh.h"
+#include "FramePacer.h"
+#include "Camera.h"
 
 namespace framework {
 struct RenderInitInfo {
-    VkRenderPass presentRenderPass = VK_NULL_HANDLE;
+    VkRenderPass presentRenderPass = VK_NULL_HANDLE;    // 动态渲染时为空
     Device* device = nullptr;
     VkExtent2D swapchainExtent = {};
+
+    // 呈现附件的格式，动态渲染时用来创建管线
+    bool dynamicRendering = false;
+    VkFormat presentColorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat presentDepthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits presentSampleCount = VK_SAMPLE_COUNT_1_BIT;
+};
+
+// 本帧呈现使用的图像，动态渲染时直接在这些视图上渲染
+struct PresentAttachments {
+    VkImage swapchainImage = VK_NULL_HANDLE;
+    VkImageView swapchainImageView = VK_NULL_HANDLE;
+    VkImage colorImage = VK_NULL_HANDLE;                // 开启MSAA时的多重采样颜色附件，否则为空
+    VkImageView colorImageView = VK_NULL_HANDLE;
+    VkImage depthImage = VK_NULL_HANDLE;
+    VkImageView depthImageView = VK_NULL_HANDLE;
 };
 
 struct RenderInputInfo {
     VkRenderPass presentRenderPass = VK_NULL_HANDLE;
-    VkFramebuffer swapchanFb = VK_NULL_HANDLE;
+    VkFramebuffer swapchanFb = VK_NULL_HANDLE;          // 动态渲染时为空
+    PresentAttachments presentAttachments = {};
     VkExtent2D swapchainExtent = {};
+    FrameTimingInfo frameTiming = {};   // 上一帧的耗时统计
+    float timeSec = 0.0f;               // 场景时间，动画应使用它而不是系统时钟，回放和跑分时按固定步长推进
+};
+
+// 场景放到计算队列上异步执行的命令
+struct AsyncComputeInfo {
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;         // 从Device::CreateComputeCommandBuffer申请
+    // RecordCommand返回的前dependencyCount个命令缓冲先单独提交，计算等待它们执行完，
+    // 其余的命令和计算并行。被依赖的命令不能访问交换链图像
+    uint32_t dependencyCount = 0;
+    // 下一帧的图形命令在这些阶段等待本帧的计算结束
+    VkPipelineStageFlags nextFrameWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
+enum class InputEventType : uint32_t {
+    MOUSE_BUTTON = 0,
+    CURSOR_POS,
+    KEY,
+};
+
+// 窗口线程产生的单个输入事件
+struct InputEvent {
+    InputEventType type = InputEventType::KEY;
+    int64_t timestampUs = 0;            // steady_clock时间戳，单位微秒
+    int code = GLFW_KEY_UNKNOWN;        // 鼠标按键或键盘按键
+    int scancode = GLFW_KEY_UNKNOWN;
+    int action = GLFW_KEY_UNKNOWN;
+    int mods = 0;
+    float cursorX = 0.0;
+    float cursorY = 0.0;
 };
 
 struct InputEventInfo {
+    // 所有事件处理完之后的状态
     bool leftPressFlag = false;
     bool rightPressFlag = false;
     bool middlePressFlag = false;
     float cursorX = 0.0;
     float cursorY = 0.0;
-    int key = GLFW_KEY_UNKNOWN;
-    int keyScancode = GLFW_KEY_UNKNOWN;
-    int keyAction = GLFW_KEY_UNKNOWN;
+
+    // 上一帧以来按时间顺序的全部事件
+    std::vector<InputEvent> events = {};
 };
 
 class SceneRenderBase {
@@ -41,31 +92,45 @@ public:
     virtual void Init(const RenderInitInfo& initInfo) = 0;
     virtual void CleanUp() = 0;
     virtual std::vector<VkCommandBuffer>& RecordCommand(const RenderInputInfo& input) = 0;
+    // RecordCommand之后调用，本帧没有异步计算时返回false
+    virtual bool GetAsyncCompute(AsyncComputeInfo& asyncCompute) { return false; }
     virtual void ProcessInputEvent(const InputEventInfo& inputEventInfo) {}
+    // 调用前在飞行的帧已经结束，但设备不是空闲的；旧资源交给DeletionQueue销毁
     virtual void OnResize(VkExtent2D newExtent) {}
     virtual void RequestPhysicalDeviceFeatures(PhysicalDevice* physicalDevice) {}
+    // 跑分和相机录制使用，没有相机的场景返回空
+    virtual Camera* GetCamera() { return nullptr; }
 
 protected:
-    bool InitCheck(const RenderInitInfo& initInfo)
-    {
-        if (initInfo.presentRenderPass == VK_NULL_HANDLE) {
-            throw std::runtime_error("presentRenderPass is null");
-            return false;
-        }
-        if (initInfo.device == nullptr) {
-            throw std::runtime_error("device is null");
-            return false;
-        }
-        mPresentRenderPass = initInfo.presentRenderPass;
-        mDevice = initInfo.device;
-        return true;
-    }
+    bool InitCheck(const RenderInitInfo& initInfo);
+
+    // 绘制到呈现pass的管线调用，代替SetRenderPass(mPresentRenderPass)
+    void SetPresentPassTarget(GraphicsPipelineConfigInfo& configInfo);
+
+    /*
+     * @brief 开始/结束绘制到交换链图像。RenderPass模式下对应vkCmdBeginRenderPass/vkCmdEndRenderPass；
+     *        动态渲染模式下在这里转换图像布局，结束时交换链图像处于PRESENT_SRC_KHR。
+     *        contents为SECONDARY_COMMAND_BUFFERS时，二级命令缓冲继承GetPresentInheritanceRenderingInfo()。
+     */
+    void CmdBeginPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input, VkClearValue clearColor,
+        VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+    void CmdEndPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input);
+
+    // RenderPass模式下返回空
+    const VkCommandBufferInheritanceRenderingInfoKHR* GetPresentInheritanceRenderingInfo();
 
 protected:
     // external objects
     Device* mDevice = nullptr;
     VkRenderPass mPresentRenderPass = VK_NULL_HANDLE;
 
+    // 动态渲染的呈现附件
+    bool mDynamicRendering = false;
+    VkFormat mPresentColorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat mPresentDepthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits mPresentSampleCount = VK_SAMPLE_COUNT_1_BIT;
+    VkPipelineRenderingCreateInfoKHR mPresentRenderingInfo = {};
+    VkCommandBufferInheritanceRenderingInfoKHR mPresentInheritanceRenderingInfo = {};
 };
 }   // namespace framework
 
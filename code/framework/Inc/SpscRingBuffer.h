@@ -0,0 +1,55 @@
+#ifndef __SPSC_RING_BUFFER_H__
+#define __SPSC_RING_BUFFER_H__
+
+#include <atomic>
+#include <cstdint>
+
+namespace framework {
+/*
+ * @brief 单生产者单消费者的无锁环形队列，容量固定为Capacity - 1。
+ *        生产者和消费者各自只写自己的下标，满了之后TryPush直接返回false，不会阻塞。
+ */
+template<typename T, uint32_t Capacity>
+class SpscRingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRingBuffer() {}
+    ~SpscRingBuffer() {}
+
+    // 只能在生产者线程调用
+    bool TryPush(const T& item)
+    {
+        uint32_t tail = mTail.load(std::memory_order_relaxed);
+        uint32_t nextTail = (tail + 1) & (Capacity - 1);
+        if (nextTail == mHead.load(std::memory_order_acquire)) {
+            return false;
+        }
+        mItems[tail] = item;
+        mTail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    // 只能在消费者线程调用
+    bool TryPop(T& item)
+    {
+        uint32_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = mItems[head];
+        mHead.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() { return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire); }
+
+private:
+    // 两个下标分属不同线程，分开放在不同的缓存行上
+    alignas(64) std::atomic<uint32_t> mHead = 0;
+    alignas(64) std::atomic<uint32_t> mTail = 0;
+    alignas(64) T mItems[Capacity] = {};
+};
+}   // namespace framework
+
+#endif // !__SPSC_RING_BUFFER_H__
@@ -19,6 +19,12 @@ struct SwapChainSupportdetails {
     std::vector<VkPresentModeKHR> presentModes = {};
 };
 
+// 重建后被替换的交换链和它的图像视图，排队的显示完成之前不能销毁
+struct RetiredSwapchain {
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    std::vector<VkImageView> imageViews = {};
+};
+
 class Swapchain {
 public:
     Swapchain();
@@ -26,14 +32,30 @@ public:
 
     bool Init(PhysicalDevice* physicalDevice, Device* device, VkExtent2D windowExtent, VkSurfaceKHR surface);
     bool CleanUp();
-    bool Recreate(VkExtent2D windowExtent);
+
+    /*
+     * @brief 以当前交换链作为oldSwapchain重建
+     * @param retired 非空时旧的交换链交给调用者，确认显示完成后用DestroyRetired销毁；为空时立即销毁
+     */
+    bool Recreate(VkExtent2D windowExtent, RetiredSwapchain* retired = nullptr);
+    void DestroyRetired(RetiredSwapchain& retired);
 
     VkFormat GetFormat() { return mSwapchainImageFormat; }
-    std::vector<VkImageView> GetImageViews() { return mSwapchainImageViews; }
+    std::vector<VkImageView>& GetImageViews() { return mSwapchainImageViews; }
     VkExtent2D GetExtent() { return mSwapchainExtent; }
+    VkPresentModeKHR GetPresentMode() { return mPresentMode; }
+    std::vector<VkImage>& GetImages() { return mSwapchainImages; }
+    uint32_t GetImageCount() { return static_cast<uint32_t>(mSwapchainImages.size()); }
+
+    // 按优先级排列的显示模式，下次创建交换链时生效，都不支持时使用FIFO
+    void SetPresentModeCandidates(const std::vector<VkPresentModeKHR>& candidates) { mPresentModeCandidates = candidates; }
+
+    // 下次创建交换链时生效，开启后图像可以作为拷贝源，并且被遮挡的像素也会写入
+    void SetReadbackEnabled(bool enable) { mReadbackRequested = enable; }
+    bool IsReadbackEnabled() { return mReadbackEnabled; }
 
     bool AcquireImage(VkSemaphore imageAvailiableSemaphore, uint32_t& imageIndex);
-    bool QueuePresent(uint32_t imageIndex, const std::vector<VkSemaphore>& waitSemaphores);
+    bool QueuePresent(uint32_t imageIndex, const VkSemaphore* waitSemaphores, uint32_t waitSemaphoreCount);
 
 private:
     void CreateSwapChain(VkExtent2D windowExtent, VkSwapchainKHR oldSwapchain);
@@ -57,8 +79,11 @@ private:
     // infos
     VkFormat mSwapchainImageFormat = {};
     VkPresentModeKHR mPresentMode = {};
+    std::vector<VkPresentModeKHR> mPresentModeCandidates = { VK_PRESENT_MODE_FIFO_KHR };
     VkExtent2D mSwapchainExtent = {};
     uint32_t mImageCount = 0;
+    bool mReadbackRequested = false;
+    bool mReadbackEnabled = false;
 
     // swapchain
     VkSwapchainKHR mSwapChain = VK_NULL_HANDLE;
@@ -64,6 +64,10 @@ std::vector<const char*> StringToCstr(const std::vector<std::string>& strings);
 std::vector<std::string> CstrToString(const std::vector<const char*>& cstrs);
 bool CheckSupported(const std::vector<const char*>& componentList, const std::vector<const char*>& availableList);
 std::vector<char> ReadFile(const std::string& filename);
+
+// 用户态加内核态的CPU时间，单位秒，用于统计CPU占用
+double GetProcessCpuTimeSec();
+double GetThreadCpuTimeSec();      // 调用线程自己的
 }
 
 
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 #include <vector>
+#include <array>
 
 namespace vulkanInitializers {
 inline VkPipelineVertexInputStateCreateInfo PipelineVertexInputStateCreateInfo(
@@ -456,6 +457,71 @@ inline VkRenderPassBeginInfo RenderPassBeginInfo(VkRenderPass pass, VkFramebuffe
     return info;
 }
 
+template <size_t N>
+inline VkRenderPassBeginInfo RenderPassBeginInfo(VkRenderPass pass, VkFramebuffer fb,
+    VkRect2D renderArea, std::array<VkClearValue, N>& clearValues)
+{
+    VkRenderPassBeginInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    info.pNext = nullptr;
+    info.renderPass = pass;
+    info.framebuffer = fb;
+    info.renderArea = renderArea;
+    info.clearValueCount = static_cast<uint32_t>(N);
+    info.pClearValues = N == 0 ? nullptr : clearValues.data();
+    return info;
+}
+
+inline VkRenderingAttachmentInfoKHR RenderingAttachmentInfo(VkImageView imageView, VkImageLayout imageLayout,
+    VkAttachmentLoadOp loadOp, VkAttachmentStoreOp storeOp, VkClearValue clearValue = {})
+{
+    VkRenderingAttachmentInfoKHR info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    info.pNext = nullptr;
+    info.imageView = imageView;
+    info.imageLayout = imageLayout;
+    info.resolveMode = VK_RESOLVE_MODE_NONE;
+    info.resolveImageView = VK_NULL_HANDLE;
+    info.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    info.loadOp = loadOp;
+    info.storeOp = storeOp;
+    info.clearValue = clearValue;
+    return info;
+}
+
+template <size_t N>
+inline VkRenderingInfoKHR RenderingInfo(VkRect2D renderArea,
+    std::array<VkRenderingAttachmentInfoKHR, N>& colorAttachments,
+    const VkRenderingAttachmentInfoKHR* pDepthAttachment, const VkRenderingAttachmentInfoKHR* pStencilAttachment)
+{
+    VkRenderingInfoKHR info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    info.pNext = nullptr;
+    info.flags = 0;
+    info.renderArea = renderArea;
+    info.layerCount = 1;
+    info.viewMask = 0;
+    info.colorAttachmentCount = static_cast<uint32_t>(N);
+    info.pColorAttachments = N == 0 ? nullptr : colorAttachments.data();
+    info.pDepthAttachment = pDepthAttachment;
+    info.pStencilAttachment = pStencilAttachment;
+    return info;
+}
+
+inline VkPipelineRenderingCreateInfoKHR PipelineRenderingCreateInfo(std::vector<VkFormat>& colorFormats,
+    VkFormat depthFormat, VkFormat stencilFormat)
+{
+    VkPipelineRenderingCreateInfoKHR info{};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    info.pNext = nullptr;
+    info.viewMask = 0;
+    info.colorAttachmentCount = colorFormats.size();
+    info.pColorAttachmentFormats = colorFormats.size() == 0 ? nullptr : colorFormats.data();
+    info.depthAttachmentFormat = depthFormat;
+    info.stencilAttachmentFormat = stencilFormat;
+    return info;
+}
+
 inline VkBufferCreateInfo BufferCreateInfo(VkDeviceSize size,
     VkBufferUsageFlags usage, VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE)
 {
@@ -478,6 +544,21 @@ inline VkCommandBufferBeginInfo CommandBufferBeginInfo(VkCommandBufferInheritanc
     return info;
 }
 
+inline VkCommandBufferInheritanceInfo CommandBufferInheritanceInfo(VkRenderPass renderPass,
+    uint32_t subpass, VkFramebuffer framebuffer = VK_NULL_HANDLE)
+{
+    VkCommandBufferInheritanceInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    info.pNext = nullptr;
+    info.renderPass = renderPass;
+    info.subpass = subpass;
+    info.framebuffer = framebuffer;
+    info.occlusionQueryEnable = VK_FALSE;
+    info.queryFlags = 0;
+    info.pipelineStatistics = 0;
+    return info;
+}
+
 inline VkRenderPassBeginInfo RenderPassBeginInfo(VkRenderPass renderPass, VkFramebuffer framebuffer)
 {
     const VkClearValue* pClearValues;
@@ -8,9 +8,16 @@ namespace window {
 class WindowImpl : public WindowTemplate
 {
 public:
-    WindowImpl(bool resizable);
+    WindowImpl(bool resizable, bool visible = true);
     ~WindowImpl();
 
+    // 在Exec之前调用，渲染线程跑完指定帧数后关闭窗口
+    void EnableBenchmark(const framework::BenchmarkConfig& config, const std::string& sceneName);
+    int GetBenchmarkResult();
+
+    // 在Exec之前调用，回放完录制的会话后关闭窗口，结果同样通过GetBenchmarkResult获取
+    void EnableReplay(const framework::BenchmarkConfig& config);
+
 private:
     virtual void Initialize() override;
     virtual void Update() override;
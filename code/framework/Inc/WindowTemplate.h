@@ -7,17 +7,27 @@
 #include <vector>
 #include <unordered_set>
 #include <string>
+#include <atomic>
 
 namespace window {
 class WindowTemplate {
 public:
-    explicit WindowTemplate(bool resizable);
+    explicit WindowTemplate(bool resizable, bool visible = true);
     virtual ~WindowTemplate();
 
     void Exec();
     VkSurfaceKHR CreateSurface(VkInstance instance);
     std::vector<const char*> QueryWindowRequiredExtensions();
     VkExtent2D GetWindowExtent();
+    // 可以在任意线程调用，主循环在下一次处理事件后退出
+    void RequestClose();
+    // 可以在任意线程调用，由主循环修改窗口大小
+    void RequestResize(VkExtent2D extent);
+    // 主循环的次数，和帧数比较可以看出主线程是否在空转
+    uint64_t GetEventLoopCount() { return mEventLoopCount.load(); }
+    // 开启后每次循环记录主线程的CPU时间
+    void SetCpuTimeTracking(bool enable) { mCpuTimeTracking.store(enable); }
+    double GetMainThreadCpuTimeSec() { return mMainThreadCpuTimeSec.load(); }
 
 protected:
     virtual void Initialize() = 0;
@@ -53,9 +63,20 @@ private:
         windowTemplate->OnKeyEvent(key, scancode, action, mods);
     }
 
+    void ApplyPendingResize();
+
 protected:
     GLFWwindow* mWindow = nullptr;
 
+private:
+    std::atomic<bool> mResizePending = false;
+    std::atomic<uint32_t> mPendingWidth = 0;
+    std::atomic<uint32_t> mPendingHeight = 0;
+
+    std::atomic<uint64_t> mEventLoopCount = 0;
+    std::atomic<bool> mCpuTimeTracking = false;
+    std::atomic<double> mMainThreadCpuTimeSec = 0.0;
+
 };
 }   // namespace window
 
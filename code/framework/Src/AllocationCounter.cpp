@@ -0,0 +1,72 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace framework {
+namespace {
+thread_local uint64_t gThreadAllocationCount = 0;
+}
+
+uint64_t AllocationCounter::GetThreadCount()
+{
+    return gThreadAllocationCount;
+}
+}   // namespace framework
+
+#if ENABLE_ALLOCATION_COUNTER
+// new[]和nothrow版本默认转发到这里，只需要替换基本的一组
+void* operator new(std::size_t size)
+{
+    framework::gThreadAllocationCount++;
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// 对齐版本单独分配，释放也要配对
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    framework::gThreadAllocationCount++;
+    size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void* ptr = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align);
+#endif
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(ptr, alignment);
+}
+#endif
@@ -0,0 +1,38 @@
+#include "AppDispatchTable.h"
+
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "DispatchTable"
+
+namespace framework {
+void AppInstanceDispatchTable::InitInstance(VkInstance instance)
+{
+    // 扩展函数，不支持时为空
+#define APP_LOAD_INSTANCE_FUNCTION(funcName) \
+    funcName = reinterpret_cast<PFN_vk##funcName>(vkGetInstanceProcAddr(instance, "vk" #funcName));
+
+    APP_INSTANCE_FUNCTIONS_KHR_FRAGMENT_SHADING_RATE(APP_LOAD_INSTANCE_FUNCTION)
+#undef APP_LOAD_INSTANCE_FUNCTION
+}
+
+void AppDeviceDispatchTable::InitDevice(VkDevice device)
+{
+#define APP_LOAD_DEVICE_FUNCTION(funcName) \
+    funcName = reinterpret_cast<PFN_vk##funcName>(vkGetDeviceProcAddr(device, "vk" #funcName));
+#define APP_LOAD_CORE_DEVICE_FUNCTION(funcName) \
+    APP_LOAD_DEVICE_FUNCTION(funcName) \
+    if (funcName == nullptr) { \
+        LOGE("get proc address vk" #funcName " failed!"); \
+    }
+
+    APP_DEVICE_FUNCTIONS_1_0(APP_LOAD_CORE_DEVICE_FUNCTION)
+    APP_DEVICE_FUNCTIONS_1_2(APP_LOAD_CORE_DEVICE_FUNCTION)
+    // 扩展没有开启时为空
+    APP_DEVICE_FUNCTIONS_KHR_SWAPCHAIN(APP_LOAD_DEVICE_FUNCTION)
+    APP_DEVICE_FUNCTIONS_KHR_FRAGMENT_SHADING_RATE(APP_LOAD_DEVICE_FUNCTION)
+    APP_DEVICE_FUNCTIONS_KHR_DYNAMIC_RENDERING(APP_LOAD_DEVICE_FUNCTION)
+#undef APP_LOAD_CORE_DEVICE_FUNCTION
+#undef APP_LOAD_DEVICE_FUNCTION
+}
+}   // namespace framework
@@ -0,0 +1,506 @@
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "BufferCreator.h"
+#include "AllocationCounter.h"
+#include "AppDispatchTable.h"
+#include "CpuProfiler.h"
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "Benchmark"
+
+namespace framework {
+namespace {
+// 报告里参与比较的指标，都是越小越好
+const char* COMPARE_SECTIONS[] = { "cpuFrameMs", "gpuFrameMs", "resizeCpuFrameMs" };
+const char* COMPARE_KEYS[] = { "p50", "p95", "p99" };
+
+// 脚本修改窗口大小时依次使用的比例
+const float RESIZE_SCALES[] = { 1.0f, 0.75f, 0.5f, 0.75f };
+
+// 录制开销测试：每轮录制的次数（每次3条命令），取最快的一轮
+constexpr uint32_t DISPATCH_ITERATION_COUNT = 20000;
+constexpr uint32_t DISPATCH_ROUND_COUNT = 5;
+
+bool ReadMetric(const std::string& text, const char* section, const char* key, double& value)
+{
+    size_t sectionPos = text.find(std::string("\"") + section + "\"");
+    if (sectionPos == std::string::npos) {
+        return false;
+    }
+    size_t sectionEnd = text.find('}', sectionPos);
+    size_t keyPos = text.find(std::string("\"") + key + "\":", sectionPos);
+    if (keyPos == std::string::npos || keyPos > sectionEnd) {
+        return false;
+    }
+    value = std::strtod(text.c_str() + keyPos + strlen(key) + 3, nullptr);
+    return true;
+}
+
+bool ReadFile(const std::string& path, std::string& text)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+void WriteStatistics(std::ofstream& file, const char* name, const BenchmarkStatistics& statistics)
+{
+    file << "  \"" << name << "\": {\"avg\":" << statistics.avg << ",\"p50\":" << statistics.p50
+        << ",\"p95\":" << statistics.p95 << ",\"p99\":" << statistics.p99 << ",\"max\":" << statistics.max << "},\n";
+}
+}
+
+bool BenchmarkRunner::ParseCommandLine(int argc, char** argv, BenchmarkConfig& config, std::vector<std::string>& compareReports)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue) {
+            config.frameCount = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        }
+        else if (arg == "--warmup" && hasValue) {
+            config.warmupFrameCount = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+        }
+        else if (arg == "--path" && hasValue) {
+            config.cameraPathFile = argv[++i];
+        }
+        else if (arg == "--orbit" && hasValue) {
+            config.orbitDurationSec = std::max(static_cast<float>(std::atof(argv[++i])), 0.1f);
+        }
+        else if (arg == "--report" && hasValue) {
+            config.reportPath = argv[++i];
+        }
+        else if (arg == "--baseline" && hasValue) {
+            config.baselinePath = argv[++i];
+        }
+        else if (arg == "--threshold" && hasValue) {
+            config.regressionThresholdPercent = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--visible") {
+            config.visible = true;
+        }
+        else if (arg == "--replay" && hasValue) {
+            config.replayPath = argv[++i];
+        }
+        else if (arg == "--replay-output" && hasValue) {
+            config.replayOutputPath = argv[++i];
+        }
+        else if (arg == "--resize" && hasValue) {
+            config.resizeIntervalFrames = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+        }
+        else if (arg == "--check-allocations") {
+            config.checkAllocations = true;
+        }
+        else if (arg == "--cpu-usage") {
+            config.measureCpuUsage = true;
+        }
+        else if (arg == "--poll-events") {
+            config.pollEvents = true;
+        }
+        else if (arg == "--dispatch-overhead") {
+            config.measureDispatchOverhead = true;
+        }
+        else if ((arg == "--compare" || arg == "--compare-replay") && i + 2 < argc) {
+            compareReports = { argv[i + 1], argv[i + 2] };
+            config.compareReplays = arg == "--compare-replay";
+            i += 2;
+        }
+        else {
+            LOGE("unknown or incomplete argument %s", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+void BenchmarkRunner::PrintUsage()
+{
+    LOGI("usage: <demo>_benchmark [options]");
+    LOGI("  --frames <n>          measured frames, default 1000");
+    LOGI("  --warmup <n>          warmup frames, default 60");
+    LOGI("  --path <file>         camera path recorded with F6, default orbit");
+    LOGI("  --orbit <seconds>     orbit duration, default 10");
+    LOGI("  --report <file>       report path, default benchmark_report.json");
+    LOGI("  --baseline <file>     compare with a baseline report after running");
+    LOGI("  --threshold <percent> regression threshold, default 5");
+    LOGI("  --visible             show the window");
+    LOGI("  --replay <file>       replay a session captured with F7 instead of benchmarking");
+    LOGI("  --replay-output <file> replay result path, default replay_result.txt");
+    LOGI("  --resize <n>          resize the window every n frames and report the resize frame times");
+    LOGI("  --check-allocations   fail if the render thread allocates from the heap in a measured frame");
+    LOGI("  --cpu-usage           report process and main thread cpu usage");
+    LOGI("  --poll-events         poll window events instead of waiting, to compare cpu usage");
+    LOGI("  --dispatch-overhead   compare command recording cost through the loader and the device dispatch table");
+    LOGI("  --compare <baseline> <current>  only compare two reports");
+    LOGI("  --compare-replay <baseline> <current>  only compare two replay results");
+}
+
+void BenchmarkRunner::Init(const BenchmarkConfig& config, const std::string& sceneName, Device* device)
+{
+    mConfig = config;
+    mSceneName = sceneName;
+    mDevice = device;
+    mFrameIndex = 0;
+    mCameraPathReady = false;
+    if (!mConfig.cameraPathFile.empty()) {
+        mCameraPathReady = mCameraPath.LoadFromFile(mConfig.cameraPathFile);
+        if (!mCameraPathReady) {
+            LOGW("fall back to orbit camera path");
+        }
+    }
+
+    mCpuFrameTimes.clear();
+    mGpuFrameTimes.clear();
+    mFrameIntervals.clear();
+    mResizeCpuFrameTimes.clear();
+    mResizeFrameIntervals.clear();
+    mAllocationFrameCount = 0;
+    mAllocationCount = 0;
+    mMaxFrameAllocationCount = 0;
+    mCpuUsageBegin = {};
+    mCpuUsageEnd = {};
+    mLoaderNsPerCommand = 0.0;
+    mTableNsPerCommand = 0.0;
+    mBaseExtent = {};
+    mResizeStep = 0;
+    mCpuFrameTimes.reserve(mConfig.frameCount);
+    mGpuFrameTimes.reserve(mConfig.frameCount);
+    mFrameIntervals.reserve(mConfig.frameCount);
+    mGpuScopes.clear();
+    mLastGpuFrameCount = GpuProfiler::GetInstance().GetCollectedFrameCount();
+    if (mConfig.checkAllocations && !AllocationCounter::IsEnabled()) {
+        LOGW("allocation counter disabled at build time, --check-allocations ignored");
+    }
+    if (mConfig.measureDispatchOverhead) {
+        MeasureDispatchOverhead();
+    }
+
+    LOGI("benchmark %s: %d warmup frames, %d measured frames", mSceneName.c_str(), mConfig.warmupFrameCount, mConfig.frameCount);
+}
+
+void BenchmarkRunner::BeginFrame(Camera* camera)
+{
+    if (camera == nullptr) {
+        return;
+    }
+    // 环绕路径以场景初始化后的相机为起点
+    if (!mCameraPathReady) {
+        mCameraPath.CreateOrbit(*camera, mConfig.orbitDurationSec, 20.0f);
+        mCameraPathReady = true;
+    }
+    mCameraPath.Apply(*camera, mFrameIndex * mConfig.timeStepSec);
+}
+
+void BenchmarkRunner::EndFrame(const FrameTimingInfo& timing, VkExtent2D extent, uint64_t allocationCount)
+{
+    bool measuring = mFrameIndex >= mConfig.warmupFrameCount;
+    bool resized = mExtent.width != 0 && (mExtent.width != extent.width || mExtent.height != extent.height);
+    mFrameIndex++;
+    mExtent = extent;
+
+    // GPU结果有几帧延迟，只在收集到新的一帧时记录
+    GpuProfiler& gpuProfiler = GpuProfiler::GetInstance();
+    uint64_t gpuFrameCount = gpuProfiler.GetCollectedFrameCount();
+    bool hasNewGpuFrame = gpuFrameCount != mLastGpuFrameCount;
+    mLastGpuFrameCount = gpuFrameCount;
+    if (!measuring) {
+        return;
+    }
+
+    mCpuFrameTimes.emplace_back(timing.cpuFrameTimeMs);
+    if (timing.frameIntervalMs > 0.0f) {
+        mFrameIntervals.emplace_back(timing.frameIntervalMs);
+    }
+    if (resized) {
+        // 重建交换链在输入采样之前，cpuFrameTimeMs不包含这部分，需要加上
+        mResizeCpuFrameTimes.emplace_back(timing.cpuFrameTimeMs + timing.resizeTimeMs);
+        if (timing.frameIntervalMs > 0.0f) {
+            mResizeFrameIntervals.emplace_back(timing.frameIntervalMs);
+        }
+    }
+    else if (allocationCount > 0) {
+        // 重建分辨率的帧会重新创建资源，只检查稳定的帧
+        mAllocationFrameCount++;
+        mAllocationCount += allocationCount;
+        mMaxFrameAllocationCount = std::max(mMaxFrameAllocationCount, allocationCount);
+    }
+    if (!hasNewGpuFrame) {
+        return;
+    }
+    for (const GpuScopeResult& result : gpuProfiler.GetLastFrameResults()) {
+        if (strcmp(result.name, "Frame") == 0) {
+            mGpuFrameTimes.emplace_back(static_cast<float>(result.durationMs));
+        }
+        auto it = mGpuScopes.find(result.name);
+        if (it == mGpuScopes.end()) {
+            it = mGpuScopes.emplace(result.name, ScopeAccumulator{}).first;
+            it->second.order = static_cast<uint32_t>(mGpuScopes.size());
+        }
+        ScopeAccumulator& scope = it->second;
+        scope.sampleCount++;
+        scope.sumMs += result.durationMs;
+        if (result.hasStatistics) {
+            scope.statisticsCount++;
+            for (uint32_t i = 0; i < GPU_STAT_COUNT; i++) {
+                scope.statisticsSum[i] += static_cast<double>(result.statistics[i]);
+            }
+        }
+    }
+}
+
+void BenchmarkRunner::RecordCpuUsage(const CpuUsageSample& sample)
+{
+    if (mFrameIndex == mConfig.warmupFrameCount) {
+        mCpuUsageBegin = sample;
+    }
+    else if (mFrameIndex > mConfig.warmupFrameCount) {
+        mCpuUsageEnd = sample;
+    }
+}
+
+void BenchmarkRunner::MeasureDispatchOverhead()
+{
+    // 只录制不提交，动态状态命令可以在pass外录制，测到的就是调用本身的开销
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    VkCommandBuffer cmdBuf = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkViewport viewport = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+    VkRect2D scissor = { {0, 0}, {1, 1} };
+
+    auto measure = [&](PFN_vkCmdSetViewport setViewport, PFN_vkCmdSetScissor setScissor,
+        PFN_vkCmdSetStencilReference setStencilReference) {
+        int64_t bestNs = INT64_MAX;
+        for (uint32_t round = 0; round < DISPATCH_ROUND_COUNT; round++) {
+            dispatch.BeginCommandBuffer(cmdBuf, &beginInfo);
+            int64_t beginNs = CpuProfiler::NowNs();
+            for (uint32_t i = 0; i < DISPATCH_ITERATION_COUNT; i++) {
+                setViewport(cmdBuf, 0, 1, &viewport);
+                setScissor(cmdBuf, 0, 1, &scissor);
+                setStencilReference(cmdBuf, VK_STENCIL_FACE_FRONT_AND_BACK, i & 0xff);
+            }
+            bestNs = std::min(bestNs, CpuProfiler::NowNs() - beginNs);
+            dispatch.EndCommandBuffer(cmdBuf);
+            dispatch.ResetCommandBuffer(cmdBuf, 0);
+        }
+        return static_cast<double>(bestNs) / (DISPATCH_ITERATION_COUNT * 3);
+    };
+    // 静态链接的vkCmd*经过loader的trampoline再进入驱动
+    mLoaderNsPerCommand = measure(vkCmdSetViewport, vkCmdSetScissor, vkCmdSetStencilReference);
+    mTableNsPerCommand = measure(dispatch.CmdSetViewport, dispatch.CmdSetScissor, dispatch.CmdSetStencilReference);
+    mDevice->FreeCommandBuffer(cmdBuf);
+
+    LOGI("dispatch overhead: loader %.2f ns/cmd, device table %.2f ns/cmd", mLoaderNsPerCommand, mTableNsPerCommand);
+}
+
+bool BenchmarkRunner::GetScriptedResize(VkExtent2D& extent)
+{
+    if (mConfig.resizeIntervalFrames == 0 || mFrameIndex % mConfig.resizeIntervalFrames != 0 || IsFinished()) {
+        return false;
+    }
+    if (mBaseExtent.width == 0) {
+        mBaseExtent = mExtent;
+    }
+    mResizeStep++;
+    float scale = RESIZE_SCALES[mResizeStep % (sizeof(RESIZE_SCALES) / sizeof(RESIZE_SCALES[0]))];
+    extent.width = std::max(static_cast<uint32_t>(mBaseExtent.width * scale), 1u);
+    extent.height = std::max(static_cast<uint32_t>(mBaseExtent.height * scale), 1u);
+    return true;
+}
+
+int BenchmarkRunner::Finish()
+{
+    if (!WriteReport()) {
+        return EXIT_FAILURE;
+    }
+    bool allocationFailed = mConfig.checkAllocations && AllocationCounter::IsEnabled() && mAllocationFrameCount > 0;
+    if (allocationFailed) {
+        LOGE("render thread allocated %llu times in %d measured frames, max %llu per frame",
+            mAllocationCount, mAllocationFrameCount, mMaxFrameAllocationCount);
+    }
+    if (mConfig.baselinePath.empty()) {
+        return allocationFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    int regressionCount = CompareReports(mConfig.baselinePath, mConfig.reportPath, mConfig.regressionThresholdPercent);
+    return regressionCount == 0 && !allocationFailed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int BenchmarkRunner::CompareReports(const std::string& baselinePath, const std::string& currentPath, float thresholdPercent)
+{
+    std::string baseline;
+    std::string current;
+    if (!ReadFile(baselinePath, baseline) || !ReadFile(currentPath, current)) {
+        LOGE("failed to read report %s or %s", baselinePath.c_str(), currentPath.c_str());
+        return -1;
+    }
+
+    int regressionCount = 0;
+    for (const char* section : COMPARE_SECTIONS) {
+        for (const char* key : COMPARE_KEYS) {
+            double baseValue = 0.0;
+            double currentValue = 0.0;
+            if (!ReadMetric(baseline, section, key, baseValue) || !ReadMetric(current, section, key, currentValue)) {
+                LOGW("%s.%s missing, skipped", section, key);
+                continue;
+            }
+            if (baseValue <= 0.0) {
+                continue;
+            }
+            double changePercent = (currentValue - baseValue) / baseValue * 100.0;
+            bool regressed = changePercent > thresholdPercent;
+            if (regressed) {
+                regressionCount++;
+                LOGE("REGRESSION %s.%s: %.3f -> %.3f ms (%+.1f%%)", section, key, baseValue, currentValue, changePercent);
+            }
+            else {
+                LOGI("%s.%s: %.3f -> %.3f ms (%+.1f%%)", section, key, baseValue, currentValue, changePercent);
+            }
+        }
+    }
+    LOGI("%d regressions beyond %.1f%%", regressionCount, thresholdPercent);
+    return regressionCount;
+}
+
+BenchmarkStatistics BenchmarkRunner::CalculateStatistics(std::vector<float> samples)
+{
+    BenchmarkStatistics statistics{};
+    if (samples.empty()) {
+        return statistics;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (float sample : samples) {
+        sum += sample;
+    }
+    // nearest-rank
+    auto percentile = [&samples](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+        return static_cast<double>(samples[std::clamp<size_t>(rank, 1, samples.size()) - 1]);
+    };
+    statistics.avg = sum / samples.size();
+    statistics.p50 = percentile(50.0);
+    statistics.p95 = percentile(95.0);
+    statistics.p99 = percentile(99.0);
+    statistics.max = samples.back();
+    return statistics;
+}
+
+bool BenchmarkRunner::WriteReport()
+{
+    std::ofstream file(mConfig.reportPath);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", mConfig.reportPath.c_str());
+        return false;
+    }
+
+    BenchmarkStatistics cpuStatistics = CalculateStatistics(mCpuFrameTimes);
+    BenchmarkStatistics gpuStatistics = CalculateStatistics(mGpuFrameTimes);
+    BenchmarkStatistics intervalStatistics = CalculateStatistics(mFrameIntervals);
+    BenchmarkStatistics resizeCpuStatistics = CalculateStatistics(mResizeCpuFrameTimes);
+    BenchmarkStatistics resizeIntervalStatistics = CalculateStatistics(mResizeFrameIntervals);
+
+    file << "{\n";
+    file << "  \"scene\": \"" << mSceneName << "\",\n";
+    file << "  \"device\": \"" << mDevice->GetPhysicalDevice()->GetProperties().deviceName << "\",\n";
+    file << "  \"resolution\": [" << mExtent.width << "," << mExtent.height << "],\n";
+    file << "  \"frames\": " << mCpuFrameTimes.size() << ",\n";
+    file << "  \"gpuFrames\": " << mGpuFrameTimes.size() << ",\n";
+    file << "  \"cameraPath\": \"" << (mConfig.cameraPathFile.empty() ? "orbit" : mConfig.cameraPathFile) << "\",\n";
+    WriteStatistics(file, "cpuFrameMs", cpuStatistics);
+    WriteStatistics(file, "gpuFrameMs", gpuStatistics);
+    WriteStatistics(file, "frameIntervalMs", intervalStatistics);
+    if (!mResizeCpuFrameTimes.empty()) {
+        file << "  \"resizeFrames\": " << mResizeCpuFrameTimes.size() << ",\n";
+        WriteStatistics(file, "resizeCpuFrameMs", resizeCpuStatistics);
+        WriteStatistics(file, "resizeFrameIntervalMs", resizeIntervalStatistics);
+    }
+    double cpuUsageWallSec = mCpuUsageEnd.wallSec - mCpuUsageBegin.wallSec;
+    if (mConfig.measureCpuUsage && cpuUsageWallSec > 0.0) {
+        // 单位是核数，1.0表示占满一个核
+        file << "  \"cpuUsage\": {\"waitEvents\":" << (mConfig.pollEvents ? "false" : "true")
+            << ",\"processCores\":" << (mCpuUsageEnd.processCpuSec - mCpuUsageBegin.processCpuSec) / cpuUsageWallSec
+            << ",\"mainThreadCores\":" << (mCpuUsageEnd.mainThreadCpuSec - mCpuUsageBegin.mainThreadCpuSec) / cpuUsageWallSec
+            << ",\"eventLoopsPerSec\":" << (mCpuUsageEnd.eventLoopCount - mCpuUsageBegin.eventLoopCount) / cpuUsageWallSec << "},\n";
+    }
+    if (mConfig.measureDispatchOverhead) {
+        file << "  \"dispatchOverhead\": {\"commands\":" << DISPATCH_ITERATION_COUNT * 3
+            << ",\"loaderNsPerCmd\":" << mLoaderNsPerCommand << ",\"tableNsPerCmd\":" << mTableNsPerCommand << "},\n";
+    }
+    if (AllocationCounter::IsEnabled()) {
+        file << "  \"heapAllocations\": {\"frames\":" << mAllocationFrameCount << ",\"total\":" << mAllocationCount
+            << ",\"maxPerFrame\":" << mMaxFrameAllocationCount << "},\n";
+    }
+
+    // 显存占用，没有开启VK_EXT_memory_budget时只包含VMA分配的内存
+    VmaAllocator allocator = BufferCreator::GetInstance().GetAllocator();
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(allocator, &memoryProperties);
+    std::vector<VmaBudget> budgets(memoryProperties->memoryHeapCount);
+    vmaGetHeapBudgets(allocator, budgets.data());
+    file << "  \"memoryHeaps\": [";
+    for (uint32_t i = 0; i < budgets.size(); i++) {
+        file << (i == 0 ? "" : ",") << "\n    {\"heap\":" << i
+            << ",\"deviceLocal\":" << ((memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false")
+            << ",\"usageBytes\":" << budgets[i].usage << ",\"budgetBytes\":" << budgets[i].budget
+            << ",\"allocationBytes\":" << budgets[i].statistics.allocationBytes << "}";
+    }
+    file << "\n  ],\n";
+
+    // 各GPU scope的平均耗时和管线统计
+    std::vector<std::pair<const std::string*, const ScopeAccumulator*>> scopes = {};
+    for (const auto& scope : mGpuScopes) {
+        scopes.emplace_back(&scope.first, &scope.second);
+    }
+    std::sort(scopes.begin(), scopes.end(), [](const auto& a, const auto& b) { return a.second->order < b.second->order; });
+    file << "  \"gpuScopes\": [";
+    for (uint32_t i = 0; i < scopes.size(); i++) {
+        const ScopeAccumulator& scope = *scopes[i].second;
+        file << (i == 0 ? "" : ",") << "\n    {\"name\":\"" << *scopes[i].first << "\",\"avgMs\":" << scope.sumMs / scope.sampleCount;
+        if (scope.statisticsCount > 0) {
+            const auto& sum = scope.statisticsSum;
+            double count = static_cast<double>(scope.statisticsCount);
+            file << ",\"iaVertices\":" << sum[GPU_STAT_IA_VERTICES] / count
+                << ",\"vsInvocations\":" << sum[GPU_STAT_VS_INVOCATIONS] / count
+                << ",\"clippingPrimitives\":" << sum[GPU_STAT_CLIPPING_PRIMITIVES] / count
+                << ",\"fsInvocations\":" << sum[GPU_STAT_FS_INVOCATIONS] / count
+                << ",\"csInvocations\":" << sum[GPU_STAT_CS_INVOCATIONS] / count;
+        }
+        file << "}";
+    }
+    file << "\n  ]\n";
+    file << "}\n";
+
+    LOGI("cpu frame ms: avg %.3f p50 %.3f p95 %.3f p99 %.3f",
+        cpuStatistics.avg, cpuStatistics.p50, cpuStatistics.p95, cpuStatistics.p99);
+    LOGI("gpu frame ms: avg %.3f p50 %.3f p95 %.3f p99 %.3f",
+        gpuStatistics.avg, gpuStatistics.p50, gpuStatistics.p95, gpuStatistics.p99);
+    if (!mResizeCpuFrameTimes.empty()) {
+        LOGI("resize frame ms (%d): avg %.3f p50 %.3f max %.3f, interval max %.3f",
+            static_cast<uint32_t>(mResizeCpuFrameTimes.size()), resizeCpuStatistics.avg, resizeCpuStatistics.p50,
+            resizeCpuStatistics.max, resizeIntervalStatistics.max);
+    }
+    if (mConfig.measureCpuUsage && cpuUsageWallSec > 0.0) {
+        LOGI("cpu usage (%s): process %.2f cores, main thread %.3f cores",
+            mConfig.pollEvents ? "poll events" : "wait events",
+            (mCpuUsageEnd.processCpuSec - mCpuUsageBegin.processCpuSec) / cpuUsageWallSec,
+            (mCpuUsageEnd.mainThreadCpuSec - mCpuUsageBegin.mainThreadCpuSec) / cpuUsageWallSec);
+    }
+    LOGI("report written to %s", mConfig.reportPath.c_str());
+    return true;
+}
+}   // namespace framework
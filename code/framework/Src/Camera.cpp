@@ -41,6 +41,11 @@ void Camera::SetPerspective(float aspect, float nearPlane, float mFarPlane, floa
     mProjection = glm::perspective(glm::radians(fovyDeg), aspect, nearPlane, mFarPlane);
 }
 
+glm::mat4 Camera::GetJitteredProjection() {
+    // 在NDC中平移，与投影类型无关
+    return glm::translate(glm::mat4(1.0f), glm::vec3(mJitter, 0.0f)) * mProjection;
+}
+
 void Camera::UpdateView() {
     mFront.x = std::cos(glm::radians(mPitch)) * std::cos(glm::radians(mYaw));
     mFront.y = std::cos(glm::radians(mPitch)) * std::sin(glm::radians(mYaw));
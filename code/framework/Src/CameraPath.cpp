@@ -0,0 +1,119 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "CameraPath"
+
+namespace framework {
+bool CameraPath::LoadFromFile(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return false;
+    }
+
+    mKeyframes.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream lineStream(line);
+        CameraKeyframe keyframe{};
+        lineStream >> keyframe.timeSec >> keyframe.targetPoint.x >> keyframe.targetPoint.y >> keyframe.targetPoint.z
+            >> keyframe.yaw >> keyframe.pitch >> keyframe.targetDistance;
+        if (lineStream.fail()) {
+            LOGE("invalid keyframe in %s: %s", path.c_str(), line.c_str());
+            mKeyframes.clear();
+            return false;
+        }
+        AddKeyframe(keyframe);
+    }
+    LOGI("load %d keyframes from %s, duration %.2fs", static_cast<uint32_t>(mKeyframes.size()), path.c_str(), GetDuration());
+    return !mKeyframes.empty();
+}
+
+bool CameraPath::SaveToFile(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return false;
+    }
+
+    file << "# time targetX targetY targetZ yaw pitch distance\n";
+    for (const CameraKeyframe& keyframe : mKeyframes) {
+        file << keyframe.timeSec << " " << keyframe.targetPoint.x << " " << keyframe.targetPoint.y << " " << keyframe.targetPoint.z
+            << " " << keyframe.yaw << " " << keyframe.pitch << " " << keyframe.targetDistance << "\n";
+    }
+    LOGI("save %d keyframes to %s", static_cast<uint32_t>(mKeyframes.size()), path.c_str());
+    return true;
+}
+
+void CameraPath::CreateOrbit(const Camera& camera, float durationSec, float pitchAmplitudeDeg, uint32_t keyframeCount)
+{
+    mKeyframes.clear();
+    keyframeCount = std::max(keyframeCount, 2u);
+    for (uint32_t i = 0; i <= keyframeCount; i++) {
+        float t = static_cast<float>(i) / keyframeCount;
+        CameraKeyframe keyframe = Capture(camera, t * durationSec);
+        keyframe.yaw = camera.mYaw + 360.0f * t;
+        keyframe.pitch = glm::clamp(camera.mPitch + pitchAmplitudeDeg * std::sin(glm::two_pi<float>() * t), -89.9f, 89.9f);
+        mKeyframes.emplace_back(keyframe);
+    }
+}
+
+void CameraPath::AddKeyframe(const CameraKeyframe& keyframe)
+{
+    if (!mKeyframes.empty() && keyframe.timeSec < mKeyframes.back().timeSec) {
+        LOGW("keyframe time %.3f earlier than last keyframe, ignored", keyframe.timeSec);
+        return;
+    }
+    mKeyframes.emplace_back(keyframe);
+}
+
+void CameraPath::Apply(Camera& camera, float timeSec)
+{
+    if (mKeyframes.empty()) {
+        return;
+    }
+
+    float duration = GetDuration();
+    if (duration > 0.0f) {
+        timeSec = std::fmod(timeSec, duration);
+    }
+
+    // 找到timeSec所在的区间，线性插值
+    auto next = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), timeSec,
+        [](float time, const CameraKeyframe& keyframe) { return time < keyframe.timeSec; });
+    const CameraKeyframe& k1 = next == mKeyframes.end() ? mKeyframes.back() : *next;
+    const CameraKeyframe& k0 = next == mKeyframes.begin() ? mKeyframes.front() : *(next - 1);
+    float span = k1.timeSec - k0.timeSec;
+    float alpha = span > 0.0f ? glm::clamp((timeSec - k0.timeSec) / span, 0.0f, 1.0f) : 0.0f;
+
+    camera.mTargetPoint = glm::mix(k0.targetPoint, k1.targetPoint, alpha);
+    // 偏航角走最短的方向，避免跨过±360时转一整圈
+    camera.mYaw = k0.yaw + std::remainder(k1.yaw - k0.yaw, 360.0f) * alpha;
+    camera.mPitch = glm::mix(k0.pitch, k1.pitch, alpha);
+    camera.mTargetDistance = glm::mix(k0.targetDistance, k1.targetDistance, alpha);
+    camera.UpdateView();
+}
+
+CameraKeyframe CameraPath::Capture(const Camera& camera, float timeSec)
+{
+    CameraKeyframe keyframe{};
+    keyframe.timeSec = timeSec;
+    keyframe.targetPoint = camera.mTargetPoint;
+    keyframe.yaw = camera.mYaw;
+    keyframe.pitch = camera.mPitch;
+    keyframe.targetDistance = camera.mTargetDistance;
+    return keyframe;
+}
+}   // namespace framework
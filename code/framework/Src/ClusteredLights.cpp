@@ -0,0 +1,231 @@
+#include "ClusteredLights.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <glm/gtc/constants.hpp>
+
+#include "VulkanInitializers.h"
+#include "BufferCreator.h"
+#include "GpuProfiler.h"
+#include "Log.h"
+#include "AppDispatchTable.h"
+#undef LOG_TAG
+#define LOG_TAG "ClusteredLights"
+
+namespace framework {
+void ClusteredLights::Init(Device* device, uint32_t maxLightCount)
+{
+    if (device == nullptr || maxLightCount == 0) {
+        throw std::runtime_error("invalid clustered lights params!");
+    }
+    mDevice = device;
+    mMaxLightCount = maxLightCount;
+    mLightCount = 0;
+    mLightsDirty = false;
+
+    CreateBuffers();
+    CreatePipeline();
+    CreateDescriptorSet();
+    LOGI("clustered lights: %d x %d x %d clusters, max %d lights",
+        GRID_SIZE_X, GRID_SIZE_Y, GRID_SIZE_Z, mMaxLightCount);
+}
+
+void ClusteredLights::CleanUp()
+{
+    if (mDevice == nullptr) {
+        return;
+    }
+    vkDestroyDescriptorPool(mDevice->Get(), mDescriptorPool, nullptr);
+    mDescriptorPool = VK_NULL_HANDLE;
+    CleanUpPipeline();
+    CleanUpBuffers();
+    mDevice = nullptr;
+}
+
+void ClusteredLights::AppendLayoutBindings(std::vector<VkDescriptorSetLayoutBinding>& bindings, VkShaderStageFlags stageFlags)
+{
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_CLUSTER_PARAMS, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, stageFlags));
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_LIGHTS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, stageFlags));
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_CLUSTER_LIGHT_COUNTS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, stageFlags));
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_CLUSTER_LIGHT_INDICES, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, stageFlags));
+}
+
+void ClusteredLights::WriteDescriptorSet(VkDescriptorSet descriptorSet)
+{
+    VkDescriptorBufferInfo paramsInfo = { mParamsBuffer, 0, sizeof(ClusterParams) };
+    VkDescriptorBufferInfo lightsInfo = { mLightBuffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo countsInfo = { mClusterLightCountBuffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo indicesInfo = { mClusterLightIndexBuffer, 0, VK_WHOLE_SIZE };
+
+    std::vector<VkWriteDescriptorSet> descriptorWrites = {
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_CLUSTER_PARAMS, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &paramsInfo),
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_LIGHTS, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &lightsInfo),
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_CLUSTER_LIGHT_COUNTS, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &countsInfo),
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_CLUSTER_LIGHT_INDICES, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &indicesInfo),
+    };
+    vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+void ClusteredLights::SetLights(const PointLight* lights, uint32_t lightCount)
+{
+    if (lightCount > mMaxLightCount) {
+        LOGW("%d lights exceed the limit %d, the rest are dropped", lightCount, mMaxLightCount);
+    }
+    mLightCount = std::min(lightCount, mMaxLightCount);
+    if (mLightCount > 0) {
+        memcpy(mLightStagingAddr, lights, sizeof(PointLight) * mLightCount);
+    }
+    mLightsDirty = true;
+}
+
+void ClusteredLights::CmdCullLights(VkCommandBuffer cmdBuf, const glm::mat4& view, const glm::mat4& proj,
+    float nearPlane, float farPlane, VkExtent2D renderExtent)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    GpuProfileScope cullScope(cmdBuf, "LightCull");
+
+    // 深度按指数切分，每片在视空间中的长宽比接近，远处的簇不会过长
+    float logDepthRatio = std::log(farPlane / nearPlane);
+    ClusterParams params{};
+    params.view = view;
+    params.invProj = glm::inverse(proj);
+    params.gridSize = glm::uvec4(GRID_SIZE_X, GRID_SIZE_Y, GRID_SIZE_Z, mLightCount);
+    params.screenParams = glm::vec4(renderExtent.width, renderExtent.height, nearPlane, farPlane);
+    params.sliceParams = glm::vec4(GRID_SIZE_Z / logDepthRatio, GRID_SIZE_Z * std::log(nearPlane) / logDepthRatio, 0.0f, 0.0f);
+    memcpy(mParamsAddr, &params, sizeof(params));
+
+    // 上一帧已经执行完，暂存区可以直接拷贝到显存
+    if (mLightsDirty && mLightCount > 0) {
+        VkBufferCopy copyRegion = { 0, 0, sizeof(PointLight) * mLightCount };
+        dispatch.CmdCopyBuffer(cmdBuf, mLightStagingBuffer, mLightBuffer, 1, &copyRegion);
+
+        VkMemoryBarrier copyBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+        copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        copyBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        dispatch.CmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+        mLightsDirty = false;
+    }
+
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineCull.pipeline);
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE,
+        mPipelineCull.layout,
+        0, 1, &mDescriptorSetCull,
+        0, nullptr);
+    dispatch.CmdDispatch(cmdBuf, (CLUSTER_COUNT + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // 分簇结果给后面的片元着色器读
+    VkMemoryBarrier cullBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dispatch.CmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+}
+
+float ClusteredLights::CalculateRadius(const glm::vec3& power, float threshold)
+{
+    // E = P / (4 * PI * d^2)
+    float maxPower = std::max(power.r, std::max(power.g, power.b));
+    return std::sqrt(maxPower / (4.0f * glm::pi<float>() * threshold));
+}
+
+void ClusteredLights::CreateBuffers()
+{
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+    VkDeviceSize lightBufferSize = sizeof(PointLight) * mMaxLightCount;
+
+    bufferCreator.CreateBuffer(sizeof(ClusterParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mParamsBuffer, mParamsMemory);
+    if (vkMapMemory(mDevice->Get(), mParamsMemory, 0, sizeof(ClusterParams), 0, &mParamsAddr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map cluster params buffer!");
+    }
+
+    bufferCreator.CreateBuffer(lightBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mLightStagingBuffer, mLightStagingMemory);
+    if (vkMapMemory(mDevice->Get(), mLightStagingMemory, 0, lightBufferSize, 0, &mLightStagingAddr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map light staging buffer!");
+    }
+
+    bufferCreator.CreateBuffer(lightBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mLightBuffer, mLightMemory);
+    bufferCreator.CreateBuffer(sizeof(uint32_t) * CLUSTER_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mClusterLightCountBuffer, mClusterLightCountMemory);
+    bufferCreator.CreateBuffer(sizeof(uint32_t) * CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mClusterLightIndexBuffer, mClusterLightIndexMemory);
+}
+
+void ClusteredLights::CleanUpBuffers()
+{
+    vkUnmapMemory(mDevice->Get(), mParamsMemory);
+    vkUnmapMemory(mDevice->Get(), mLightStagingMemory);
+    mParamsAddr = nullptr;
+    mLightStagingAddr = nullptr;
+
+    vkDestroyBuffer(mDevice->Get(), mClusterLightIndexBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mClusterLightIndexMemory, nullptr);
+    vkDestroyBuffer(mDevice->Get(), mClusterLightCountBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mClusterLightCountMemory, nullptr);
+    vkDestroyBuffer(mDevice->Get(), mLightBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mLightMemory, nullptr);
+    vkDestroyBuffer(mDevice->Get(), mLightStagingBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mLightStagingMemory, nullptr);
+    vkDestroyBuffer(mDevice->Get(), mParamsBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mParamsMemory, nullptr);
+}
+
+void ClusteredLights::CreatePipeline()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    ShaderFileInfo cullShaderFile{};
+    cullShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("cluster_light_cull.comp.spv");
+    cullShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> cullLayoutBindings = {};
+    AppendLayoutBindings(cullLayoutBindings, VK_SHADER_STAGE_COMPUTE_BIT);
+
+    std::vector<VkPushConstantRange> nullPushConstantRanges = {};
+
+    mPipelineCull = pipelineFactory.CreateComputePipeline(cullShaderFile, cullLayoutBindings, nullPushConstantRanges);
+}
+
+void ClusteredLights::CleanUpPipeline()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    pipelineFactory.DestroyPipelineObjecst(mPipelineCull);
+}
+
+void ClusteredLights::CreateDescriptorSet()
+{
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = mPipelineCull.descriptorSizes.size();
+    poolInfo.pPoolSizes = mPipelineCull.descriptorSizes.data();
+    poolInfo.maxSets = 1;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = mDescriptorPool;
+    allocInfo.descriptorSetCount = mPipelineCull.descriptorSetLayouts.size();
+    allocInfo.pSetLayouts = mPipelineCull.descriptorSetLayouts.data();
+    if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetCull) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mDescriptorSetCull!");
+    }
+
+    WriteDescriptorSet(mDescriptorSetCull);
+}
+}   // namespace framework
@@ -0,0 +1,119 @@
+#include "CpuProfiler.h"
+
+#include <fstream>
+
+#include "GpuProfiler.h"
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "CpuProfiler"
+
+namespace framework {
+namespace {
+// 每个线程的队列由CpuProfiler持有，线程退出后记录仍然保留
+thread_local void* tlsThreadZones = nullptr;
+}
+
+CpuProfiler& CpuProfiler::GetInstance()
+{
+    static CpuProfiler instance;
+    return instance;
+}
+
+CpuProfiler::ThreadZones* CpuProfiler::GetThreadZones()
+{
+    if (tlsThreadZones != nullptr) {
+        return static_cast<ThreadZones*>(tlsThreadZones);
+    }
+
+    // 每个线程只在第一次记录时上锁注册
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    mThreads.emplace_back(std::make_unique<ThreadZones>());
+    ThreadZones* zones = mThreads.back().get();
+    zones->threadIndex = static_cast<uint32_t>(mThreads.size());
+    zones->threadName = "Thread " + std::to_string(zones->threadIndex);
+    zones->history.resize(HISTORY_CAPACITY);
+    tlsThreadZones = zones;
+    return zones;
+}
+
+void CpuProfiler::SetThreadName(const char* name)
+{
+    ThreadZones* zones = GetThreadZones();
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    zones->threadName = name;
+}
+
+void CpuProfiler::RecordZone(const char* name, int64_t beginNs, int64_t endNs)
+{
+    ThreadZones* zones = GetThreadZones();
+    if (!zones->queue.TryPush({ name, beginNs, endNs })) {
+        zones->droppedCount++;
+    }
+}
+
+void CpuProfiler::Collect()
+{
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    int64_t minBeginNs = NowNs() - HISTORY_DURATION_NS;
+    for (auto& zones : mThreads) {
+        CpuZoneRecord record{};
+        while (zones->queue.TryPop(record)) {
+            // 满了覆盖最旧的
+            if (zones->historyCount == HISTORY_CAPACITY) {
+                zones->historyBegin = (zones->historyBegin + 1) % HISTORY_CAPACITY;
+                zones->historyCount--;
+            }
+            zones->history[(zones->historyBegin + zones->historyCount) % HISTORY_CAPACITY] = record;
+            zones->historyCount++;
+        }
+        while (zones->historyCount > 0 && zones->history[zones->historyBegin].beginNs < minBeginNs) {
+            zones->historyBegin = (zones->historyBegin + 1) % HISTORY_CAPACITY;
+            zones->historyCount--;
+        }
+
+        uint32_t droppedCount = zones->droppedCount.exchange(0);
+        if (droppedCount > 0) {
+            LOGW("%s zone queue full, %d zones dropped", zones->threadName.c_str(), droppedCount);
+        }
+    }
+}
+
+bool CpuProfiler::WriteChromeTrace(const std::string& path, bool includeGpu)
+{
+    Collect();
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return false;
+    }
+
+    // 时间单位为微秒，CPU线程的tid从1开始，0留给GPU
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        for (auto& zones : mThreads) {
+            file << (first ? "" : ",\n");
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << zones->threadIndex
+                << ",\"args\":{\"name\":\"" << zones->threadName << "\"}}";
+            first = false;
+
+            for (uint32_t i = 0; i < zones->historyCount; i++) {
+                const CpuZoneRecord& record = zones->history[(zones->historyBegin + i) % HISTORY_CAPACITY];
+                file << ",\n";
+                file << "{\"name\":\"" << record.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zones->threadIndex
+                    << ",\"ts\":" << std::fixed << static_cast<double>(record.beginNs) / 1000.0
+                    << ",\"dur\":" << static_cast<double>(record.endNs - record.beginNs) / 1000.0 << "}";
+            }
+        }
+    }
+    if (includeGpu && GpuProfiler::GetInstance().IsEnabled()) {
+        GpuProfiler::GetInstance().WriteTraceEvents(file, first);
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    LOGI("frame trace written to %s", path.c_str());
+    return true;
+}
+}   // namespace framework
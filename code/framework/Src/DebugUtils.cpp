@@ -2,7 +2,11 @@
 #include "Utils.h"
 
 #include <iostream>
-#include <sstream>
+
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "Validation"
 
 namespace framework {
 
@@ -61,33 +65,14 @@ VKAPI_ATTR VkBool32 VKAPI_CALL DebugUtils::DebugCallback(
     VkDebugUtilsMessageTypeFlagsEXT messageType,
     const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
     void* pUserData) {
-	// Select prefix depending on flags passed to the callback
-	std::string prefix("");
-
-	if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) {
-		prefix = "VERBOSE: ";
-	}
-	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) {
-		prefix = "INFO: ";
-	}
-	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
-		prefix = "WARNING: ";
-	}
-	else if (messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
-		prefix = "ERROR: ";
-	}
-
-	// Display message to default output (console/logcat)
-	std::stringstream debugMessage;
-	debugMessage << prefix << "[" << pCallbackData->messageIdNumber << "][" << pCallbackData->pMessageIdName << "] : " << pCallbackData->pMessage;
-
+	// 交给异步日志输出，不在调用Vulkan的线程上阻塞，刷屏时会被限频；错误以外的消息只在debug下输出
+	const char* messageIdName = pCallbackData->pMessageIdName != nullptr ? pCallbackData->pMessageIdName : "";
 	if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
-		std::cerr << debugMessage.str() << "\n";
+		LOGE("[%d][%s] : %s", pCallbackData->messageIdNumber, messageIdName, pCallbackData->pMessage);
 	}
 	else {
-		//std::cout << debugMessage.str() << "\n";
+		LOGD("[%d][%s] : %s", pCallbackData->messageIdNumber, messageIdName, pCallbackData->pMessage);
 	}
-	fflush(stdout);
 
 	// The return value of this callback controls whether the Vulkan call that caused the validation message will be aborted or not
 	// We return VK_FALSE as we DON'T want Vulkan calls that cause a validation message to abort
@@ -0,0 +1,166 @@
+#include "DeletionQueue.h"
+
+#include <utility>
+
+#include "BufferCreator.h"
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "DeletionQueue"
+
+namespace framework {
+DeletionQueue& DeletionQueue::GetInstance()
+{
+    static DeletionQueue instance;
+    return instance;
+}
+
+void DeletionQueue::Init(Device* device)
+{
+    if (mInited) {
+        LOGE("repeated init");
+        return;
+    }
+    if (device == nullptr) {
+        return;
+    }
+    mDevice = device;
+    mFrameSerial = 0;
+    mInited = true;
+}
+
+void DeletionQueue::CleanUp()
+{
+    if (!mInited) {
+        return;
+    }
+    Release(true);
+    mDevice = nullptr;
+    mInited = false;
+}
+
+void DeletionQueue::BeginFrame()
+{
+    // 调用时mFrameSerial及之前的帧都已经执行完
+    Release(false);
+    mFrameSerial++;
+}
+
+void DeletionQueue::Push(std::function<void()> release, uint32_t extraFrames)
+{
+    Entry entry{};
+    entry.frameSerial = mFrameSerial + extraFrames;
+    entry.release = std::move(release);
+    mEntries.emplace_back(std::move(entry));
+}
+
+void DeletionQueue::Release(bool releaseAll)
+{
+    // extraFrames使frameSerial不是单调的，需要遍历整个队列
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (releaseAll || it->frameSerial <= mFrameSerial) {
+            it->release();
+            it = mEntries.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+}
+
+void DeletionQueue::DestroyBuffer(VkBuffer buffer)
+{
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, buffer]() { vkDestroyBuffer(device, buffer, nullptr); });
+}
+
+void DeletionQueue::DestroyImage(VkImage image)
+{
+    if (image == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, image]() { vkDestroyImage(device, image, nullptr); });
+}
+
+void DeletionQueue::DestroyImageView(VkImageView imageView)
+{
+    if (imageView == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, imageView]() { vkDestroyImageView(device, imageView, nullptr); });
+}
+
+void DeletionQueue::DestroyFramebuffer(VkFramebuffer framebuffer)
+{
+    if (framebuffer == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+}
+
+void DeletionQueue::DestroySampler(VkSampler sampler)
+{
+    if (sampler == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, sampler]() { vkDestroySampler(device, sampler, nullptr); });
+}
+
+void DeletionQueue::DestroyPipeline(VkPipeline pipeline)
+{
+    if (pipeline == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, pipeline]() { vkDestroyPipeline(device, pipeline, nullptr); });
+}
+
+void DeletionQueue::DestroyPipelineObjecs(const PipelineObjecs& pipeline)
+{
+    if (pipeline.pipeline == VK_NULL_HANDLE) {
+        return;
+    }
+    Push([pipeline]() mutable { PipelineFactory::GetInstance().DestroyPipelineObjecst(pipeline); });
+}
+
+void DeletionQueue::DestroyDescriptorPool(VkDescriptorPool descriptorPool)
+{
+    if (descriptorPool == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, descriptorPool]() { vkDestroyDescriptorPool(device, descriptorPool, nullptr); });
+}
+
+void DeletionQueue::FreeMemory(VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE) {
+        return;
+    }
+    VkDevice device = mDevice->Get();
+    Push([device, memory]() { vkFreeMemory(device, memory, nullptr); });
+}
+
+void DeletionQueue::DestroyVmaBuffer(VkBuffer buffer, VmaAllocation allocation)
+{
+    if (buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    Push([buffer, allocation]() { vmaDestroyBuffer(BufferCreator::GetInstance().GetAllocator(), buffer, allocation); });
+}
+
+void DeletionQueue::DestroyVmaImage(VkImage image, VmaAllocation allocation)
+{
+    if (image == VK_NULL_HANDLE) {
+        return;
+    }
+    Push([image, allocation]() { vmaDestroyImage(BufferCreator::GetInstance().GetAllocator(), image, allocation); });
+}
+}   // namespace framework
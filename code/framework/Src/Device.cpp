@@ -25,6 +25,11 @@ void Device::Init(PhysicalDevice* physicalDevice) {
 }
 
 void Device::CleanUp() {
+    if (mCommandPoolOfCompute != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(mDevice, mCommandPoolOfCompute, nullptr);
+        mCommandPoolOfCompute = VK_NULL_HANDLE;
+    }
+    mComputeQueue = VK_NULL_HANDLE;
     vkDestroyCommandPool(mDevice, mCommandPoolOfGraphics, nullptr);
     vkDestroyDevice(mDevice, nullptr);
     mPhysicalDevice = nullptr;
@@ -55,6 +60,40 @@ void Device::FreeCommandBuffer(VkCommandBuffer commandBuffer) {
     vkFreeCommandBuffers(mDevice, mCommandPoolOfGraphics, 1, &commandBuffer);
 }
 
+VkCommandBuffer Device::CreateComputeCommandBuffer(VkCommandBufferLevel level) {
+    if (mCommandPoolOfCompute == VK_NULL_HANDLE) {
+        throw std::runtime_error("async compute is not enabled!");
+    }
+
+    VkCommandBufferAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.commandPool = mCommandPoolOfCompute;
+    allocateInfo.level = level;
+    allocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    if (vkAllocateCommandBuffers(mDevice, &allocateInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate compute command buffers!");
+    }
+    return commandBuffer;
+}
+
+void Device::FreeComputeCommandBuffer(VkCommandBuffer commandBuffer) {
+    if (mCommandPoolOfCompute == VK_NULL_HANDLE) {
+        throw std::runtime_error("async compute is not enabled!");
+    }
+    vkFreeCommandBuffers(mDevice, mCommandPoolOfCompute, 1, &commandBuffer);
+}
+
+void Device::SetAsyncComputeSharing(VkImageCreateInfo& imageInfo) {
+    if (mSharingQueueFamilies.size() < 2) {
+        return;
+    }
+    imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(mSharingQueueFamilies.size());
+    imageInfo.pQueueFamilyIndices = mSharingQueueFamilies.data();
+}
+
 VkCommandBuffer Device::BeginSingleTimeCommands() {
     if (mDevice == nullptr) {
         throw std::runtime_error("mDevice is null!");
@@ -136,11 +175,30 @@ void Device::CreateLogicalDevice() {
     // ------ fill queueCreateInfo -------
     mQueueFamilyIndices = mPhysicalDevice->GetQueueFamilyIndices();
 
+    // 异步计算用timeline semaphore和图形队列同步，两者缺一个就只用图形队列
+    if (!GetConfig().phisicalDevice.enableAsyncCompute) {
+        mQueueFamilyIndices.computeFamily.reset();
+    }
+    if (mQueueFamilyIndices.computeFamily.has_value()) {
+        auto& timelineFeatures = mPhysicalDevice->RequestExtensionsFeatures<VkPhysicalDeviceTimelineSemaphoreFeatures>(
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES);
+        if (!timelineFeatures.timelineSemaphore) {
+            LOGW("timeline semaphore not supported, async compute disabled");
+            mQueueFamilyIndices.computeFamily.reset();
+        }
+    }
+    else if (GetConfig().phisicalDevice.enableAsyncCompute) {
+        LOGW("no dedicated compute queue family, async compute disabled");
+    }
+
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {
         mQueueFamilyIndices.graphicsFamily.value(),
         mQueueFamilyIndices.presentFamily.value(),
     };    // 用set去重
+    if (mQueueFamilyIndices.computeFamily.has_value()) {
+        uniqueQueueFamilies.insert(mQueueFamilyIndices.computeFamily.value());
+    }
 
     float queuePriority = 1.0f;        // 优先级
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -180,6 +238,12 @@ void Device::CreateLogicalDevice() {
     // 从逻辑设备中取出图形队列（根据队列族编号）
     vkGetDeviceQueue(mDevice, mQueueFamilyIndices.graphicsFamily.value(), 0, &mGraphicsQueue);
     vkGetDeviceQueue(mDevice, mQueueFamilyIndices.presentFamily.value(), 0, &mPresentQueue);
+    mSharingQueueFamilies.clear();
+    if (mQueueFamilyIndices.computeFamily.has_value()) {
+        vkGetDeviceQueue(mDevice, mQueueFamilyIndices.computeFamily.value(), 0, &mComputeQueue);
+        mSharingQueueFamilies = { mQueueFamilyIndices.graphicsFamily.value(), mQueueFamilyIndices.computeFamily.value() };
+        LOGI("async compute queue family %d", mQueueFamilyIndices.computeFamily.value());
+    }
 }
 
 void Device::CreateCommandPool() {
@@ -198,6 +262,14 @@ void Device::CreateCommandPool() {
     if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, &mCommandPoolOfGraphics) != VK_SUCCESS) {
         throw std::runtime_error("failed to create command pool!");
     }
+
+    // 计算队列的命令缓冲只能从计算队列族的命令池申请
+    if (mComputeQueue != VK_NULL_HANDLE) {
+        poolInfo.queueFamilyIndex = mQueueFamilyIndices.computeFamily.value();
+        if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, &mCommandPoolOfCompute) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute command pool!");
+        }
+    }
 }
 }    // namespace framework
 
@@ -0,0 +1,76 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace framework {
+void DynamicResolution::Init(const DynamicResolutionConfig& config)
+{
+    mConfig = config;
+    mConfig.minScale = std::clamp(mConfig.minScale, 0.1f, 1.0f);
+    mConfig.maxScale = std::clamp(mConfig.maxScale, mConfig.minScale, 1.0f);
+    mConfig.alignment = std::max(mConfig.alignment, 1u);
+    mScale = std::clamp(mConfig.initialScale, mConfig.minScale, mConfig.maxScale);
+    mAvgGpuTimeMs = 0.0f;
+}
+
+VkExtent2D DynamicResolution::Resize(VkExtent2D swapchainExtent)
+{
+    mSwapchainExtent = swapchainExtent;
+    float maxScale = mConfig.enable ? mConfig.maxScale : mScale;
+    mMaxExtent.width = std::max(static_cast<uint32_t>(swapchainExtent.width * maxScale), 1u);
+    mMaxExtent.height = std::max(static_cast<uint32_t>(swapchainExtent.height * maxScale), 1u);
+    UpdateRenderExtent();
+    return mMaxExtent;
+}
+
+void DynamicResolution::Update(float gpuFrameTimeMs)
+{
+    if (!mConfig.enable || gpuFrameTimeMs <= 0.0f || mConfig.targetGpuTimeMs <= 0.0f) {
+        return;
+    }
+
+    // GPU耗时有几帧的延迟，先平滑再调整，避免分辨率来回跳
+    mAvgGpuTimeMs = mAvgGpuTimeMs <= 0.0f ? gpuFrameTimeMs : mAvgGpuTimeMs + (gpuFrameTimeMs - mAvgGpuTimeMs) * SMOOTH_FACTOR;
+    float errorPercent = (mAvgGpuTimeMs - mConfig.targetGpuTimeMs) / mConfig.targetGpuTimeMs * 100.0f;
+    if (std::abs(errorPercent) <= mConfig.tolerancePercent) {
+        return;
+    }
+
+    // 耗时近似与像素数成正比，边长按平方根缩放
+    float desiredScale = mScale * std::sqrt(mConfig.targetGpuTimeMs / mAvgGpuTimeMs);
+    mScale += (desiredScale - mScale) * mConfig.adjustRate;
+    mScale = std::clamp(mScale, mConfig.minScale, mConfig.maxScale);
+    UpdateRenderExtent();
+}
+
+glm::vec2 DynamicResolution::GetUvScale()
+{
+    if (mMaxExtent.width == 0 || mMaxExtent.height == 0) {
+        return glm::vec2(1.0f);
+    }
+    return glm::vec2(static_cast<float>(mRenderExtent.width) / mMaxExtent.width,
+        static_cast<float>(mRenderExtent.height) / mMaxExtent.height);
+}
+
+glm::vec2 DynamicResolution::GetUvClamp()
+{
+    if (mMaxExtent.width == 0 || mMaxExtent.height == 0) {
+        return glm::vec2(1.0f);
+    }
+    return glm::vec2((static_cast<float>(mRenderExtent.width) - 0.5f) / mMaxExtent.width,
+        (static_cast<float>(mRenderExtent.height) - 0.5f) / mMaxExtent.height);
+}
+
+void DynamicResolution::UpdateRenderExtent()
+{
+    // 向下对齐，且不超过分配的大小
+    uint32_t alignment = mConfig.alignment;
+    auto alignExtent = [alignment](float size, uint32_t maxSize) {
+        uint32_t aligned = static_cast<uint32_t>(size) / alignment * alignment;
+        return std::clamp(aligned, std::min(alignment, maxSize), maxSize);
+    };
+    mRenderExtent.width = alignExtent(mSwapchainExtent.width * mScale, mMaxExtent.width);
+    mRenderExtent.height = alignExtent(mSwapchainExtent.height * mScale, mMaxExtent.height);
+}
+}   // namespace framework
@@ -0,0 +1,76 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "FrameArena"
+
+namespace framework {
+FrameArena& FrameArena::GetInstance()
+{
+    static FrameArena instance;
+    return instance;
+}
+
+void FrameArena::Init(size_t capacity)
+{
+    mBuffer = std::make_unique<uint8_t[]>(capacity);
+    mCapacity = capacity;
+    mOffset = 0;
+    mPeakSize = 0;
+    mOverflowReported = false;
+}
+
+void FrameArena::CleanUp()
+{
+    mBuffer.reset();
+    mCapacity = 0;
+    mOffset = 0;
+}
+
+void FrameArena::Reset()
+{
+    mPeakSize = std::max(mPeakSize, mOffset);
+    mOffset = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    uintptr_t base = reinterpret_cast<uintptr_t>(mBuffer.get());
+    size_t alignedOffset = ((base + mOffset + alignment - 1) & ~(alignment - 1)) - base;
+    if (mBuffer == nullptr || alignedOffset + size > mCapacity) {
+        if (!mOverflowReported) {
+            LOGW("frame arena overflow: %zu + %zu > %zu, fall back to heap", mOffset, size, mCapacity);
+            mOverflowReported = true;
+        }
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+    mOffset = alignedOffset + size;
+    return mBuffer.get() + alignedOffset;
+}
+
+void FrameArena::Deallocate(void* ptr, size_t size, size_t alignment)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if (!Contains(ptr)) {
+        // 与Allocate中退回堆时的对齐版本配对
+        ::operator delete(ptr, std::align_val_t(alignment));
+        return;
+    }
+    // 最后一次分配可以直接退回，后分配先释放的临时数组不占用空间
+    if (static_cast<uint8_t*>(ptr) + size == mBuffer.get() + mOffset) {
+        mOffset -= size;
+    }
+}
+
+bool FrameArena::Contains(const void* ptr)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(ptr);
+    return mBuffer != nullptr && bytes >= mBuffer.get() && bytes < mBuffer.get() + mCapacity;
+}
+}   // namespace framework
@@ -0,0 +1,187 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "FrameCapture"
+
+namespace framework {
+namespace {
+constexpr const char* CAPTURE_HEADER = "# render capture v1";
+constexpr uint32_t MAX_REPORTED_MISMATCHES = 16;
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+}
+
+bool FrameCapture::Load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return false;
+    }
+
+    mFrames.clear();
+    std::string line;
+    std::getline(file, line);
+    if (line != CAPTURE_HEADER) {
+        LOGE("%s is not a capture file", path.c_str());
+        return false;
+    }
+
+    // frame行后面跟着eventCount个event行
+    while (std::getline(file, line)) {
+        std::istringstream lineStream(line);
+        std::string tag;
+        lineStream >> tag;
+        if (tag != "frame") {
+            continue;
+        }
+
+        CapturedFrame frame{};
+        uint32_t resized = 0;
+        uint32_t hasChecksum = 0;
+        uint32_t eventCount = 0;
+        lineStream >> frame.frameIndex >> frame.timeSec >> frame.extent.width >> frame.extent.height >> resized
+            >> frame.timing.cpuFrameTimeMs >> frame.timing.gpuFrameTimeMs >> frame.timing.frameIntervalMs
+            >> frame.timing.estimatedLatencyMs >> hasChecksum >> frame.imageChecksum
+            >> frame.input.leftPressFlag >> frame.input.rightPressFlag >> frame.input.middlePressFlag
+            >> frame.input.cursorX >> frame.input.cursorY >> eventCount;
+        if (lineStream.fail()) {
+            LOGE("invalid frame in %s: %s", path.c_str(), line.c_str());
+            mFrames.clear();
+            return false;
+        }
+        frame.resized = resized != 0;
+        frame.hasChecksum = hasChecksum != 0;
+
+        frame.input.events.resize(eventCount);
+        for (InputEvent& event : frame.input.events) {
+            std::getline(file, line);
+            std::istringstream eventStream(line);
+            uint32_t type = 0;
+            eventStream >> tag >> type >> event.timestampUs >> event.code >> event.scancode >> event.action
+                >> event.mods >> event.cursorX >> event.cursorY;
+            if (eventStream.fail() || tag != "event") {
+                LOGE("invalid event in %s: %s", path.c_str(), line.c_str());
+                mFrames.clear();
+                return false;
+            }
+            event.type = static_cast<InputEventType>(type);
+        }
+        mFrames.emplace_back(frame);
+    }
+    LOGI("load %d frames from %s", static_cast<uint32_t>(mFrames.size()), path.c_str());
+    return !mFrames.empty();
+}
+
+bool FrameCapture::Save(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return false;
+    }
+
+    file << CAPTURE_HEADER << "\n";
+    for (const CapturedFrame& frame : mFrames) {
+        file << "frame " << frame.frameIndex << " " << frame.timeSec << " " << frame.extent.width << " " << frame.extent.height
+            << " " << (frame.resized ? 1 : 0) << " " << frame.timing.cpuFrameTimeMs << " " << frame.timing.gpuFrameTimeMs
+            << " " << frame.timing.frameIntervalMs << " " << frame.timing.estimatedLatencyMs
+            << " " << (frame.hasChecksum ? 1 : 0) << " " << frame.imageChecksum
+            << " " << frame.input.leftPressFlag << " " << frame.input.rightPressFlag << " " << frame.input.middlePressFlag
+            << " " << frame.input.cursorX << " " << frame.input.cursorY << " " << frame.input.events.size() << "\n";
+        for (const InputEvent& event : frame.input.events) {
+            file << "event " << static_cast<uint32_t>(event.type) << " " << event.timestampUs << " " << event.code
+                << " " << event.scancode << " " << event.action << " " << event.mods
+                << " " << event.cursorX << " " << event.cursorY << "\n";
+        }
+    }
+    LOGI("save %d frames to %s", static_cast<uint32_t>(mFrames.size()), path.c_str());
+    return true;
+}
+
+uint64_t FrameCapture::CalculateChecksum(const uint8_t* data, uint32_t rowBytes, uint32_t rowPitch, uint32_t rowCount)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (uint32_t row = 0; row < rowCount; row++) {
+        const uint8_t* rowData = data + static_cast<size_t>(row) * rowPitch;
+        for (uint32_t i = 0; i < rowBytes; i++) {
+            hash ^= rowData[i];
+            hash *= FNV_PRIME;
+        }
+    }
+    return hash;
+}
+
+int FrameCapture::Compare(const std::string& baselinePath, const std::string& currentPath, float thresholdPercent)
+{
+    FrameCapture baseline;
+    FrameCapture current;
+    if (!baseline.Load(baselinePath) || !current.Load(currentPath)) {
+        return -1;
+    }
+
+    std::vector<CapturedFrame>& baseFrames = baseline.GetFrames();
+    std::vector<CapturedFrame>& currentFrames = current.GetFrames();
+    if (baseFrames.size() != currentFrames.size()) {
+        LOGW("frame count differs: %d vs %d, compare common frames only",
+            static_cast<uint32_t>(baseFrames.size()), static_cast<uint32_t>(currentFrames.size()));
+    }
+
+    uint32_t frameCount = static_cast<uint32_t>(std::min(baseFrames.size(), currentFrames.size()));
+    uint32_t mismatchCount = 0;
+    uint32_t slowerFrameCount = 0;
+    double baseCpuSum = 0.0;
+    double currentCpuSum = 0.0;
+    double baseGpuSum = 0.0;
+    double currentGpuSum = 0.0;
+    for (uint32_t i = 0; i < frameCount; i++) {
+        const CapturedFrame& baseFrame = baseFrames[i];
+        const CapturedFrame& currentFrame = currentFrames[i];
+        if (baseFrame.hasChecksum && currentFrame.hasChecksum && baseFrame.imageChecksum != currentFrame.imageChecksum) {
+            if (mismatchCount < MAX_REPORTED_MISMATCHES) {
+                LOGE("frame %d image differs: %llu vs %llu", i, baseFrame.imageChecksum, currentFrame.imageChecksum);
+            }
+            mismatchCount++;
+        }
+
+        float baseMs = baseFrame.timing.cpuFrameTimeMs + baseFrame.timing.gpuFrameTimeMs;
+        float currentMs = currentFrame.timing.cpuFrameTimeMs + currentFrame.timing.gpuFrameTimeMs;
+        if (baseMs > 0.0f && (currentMs - baseMs) / baseMs * 100.0f > thresholdPercent) {
+            slowerFrameCount++;
+        }
+        baseCpuSum += baseFrame.timing.cpuFrameTimeMs;
+        currentCpuSum += currentFrame.timing.cpuFrameTimeMs;
+        baseGpuSum += baseFrame.timing.gpuFrameTimeMs;
+        currentGpuSum += currentFrame.timing.gpuFrameTimeMs;
+    }
+
+    // 单帧耗时噪声很大，只用平均值判断退化，逐帧的结果作为参考
+    int regressionCount = 0;
+    auto compareAverage = [&](const char* name, double baseSum, double currentSum) {
+        if (frameCount == 0 || baseSum <= 0.0) {
+            return;
+        }
+        double changePercent = (currentSum - baseSum) / baseSum * 100.0;
+        if (changePercent > thresholdPercent) {
+            regressionCount++;
+            LOGE("REGRESSION avg %s: %.3f -> %.3f ms (%+.1f%%)", name, baseSum / frameCount, currentSum / frameCount, changePercent);
+        }
+        else {
+            LOGI("avg %s: %.3f -> %.3f ms (%+.1f%%)", name, baseSum / frameCount, currentSum / frameCount, changePercent);
+        }
+    };
+    compareAverage("cpu frame", baseCpuSum, currentCpuSum);
+    compareAverage("gpu frame", baseGpuSum, currentGpuSum);
+
+    LOGI("%d frames compared: %d images differ, %d frames slower than %.1f%%",
+        frameCount, mismatchCount, slowerFrameCount, thresholdPercent);
+    return static_cast<int>(mismatchCount) + regressionCount;
+}
+}   // namespace framework
@@ -0,0 +1,114 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace framework {
+void FramePacer::Init(const FramePacingConfig& config)
+{
+    mConfig = config;
+    mTimingInfo = {};
+    mHasLastFrame = false;
+    mAvgCpuTimeMs = 0.0f;
+    mAvgGpuTimeMs = 0.0f;
+    mAvgIntervalMs = 0.0f;
+    mPendingResizeTimeMs = 0.0f;
+}
+
+std::vector<VkPresentModeKHR> FramePacer::GetPresentModeCandidates(FramePacingMode mode)
+{
+    switch (mode) {
+    case FramePacingMode::UNCAPPED:
+    case FramePacingMode::TARGET_FPS:
+        // 由CPU控制帧率时不能被垂直同步卡住
+        return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    case FramePacingMode::VSYNC:
+    case FramePacingMode::LOW_LATENCY:
+    default:
+        return { VK_PRESENT_MODE_FIFO_KHR };
+    }
+}
+
+void FramePacer::BeginFrame()
+{
+    mFrameBeginTime = Clock::now();
+    if (mHasLastFrame) {
+        mTimingInfo.frameIntervalMs = ElapsedMs(mLastFrameBeginTime, mFrameBeginTime);
+        mAvgIntervalMs += (mTimingInfo.frameIntervalMs - mAvgIntervalMs) * SMOOTH_FACTOR;
+    }
+    mLastFrameBeginTime = mFrameBeginTime;
+    mHasLastFrame = true;
+}
+
+void FramePacer::WaitForInputSampling()
+{
+    mAcquiredTime = Clock::now();
+    mInputSampleTime = mAcquiredTime;
+    if (mConfig.mode != FramePacingMode::LOW_LATENCY || mAvgIntervalMs <= 0.0f) {
+        return;
+    }
+
+    // FIFO下acquire返回的时刻近似为垂直同步时刻，离下一次垂直同步还有一个帧间隔，
+    // 预留出CPU录制和GPU执行的时间，剩下的时间先睡掉，让输入尽可能晚地采样
+    float slackMs = mAvgIntervalMs - mAvgCpuTimeMs - mAvgGpuTimeMs - mConfig.lowLatencyMarginMs;
+    slackMs = std::clamp(slackMs, 0.0f, mAvgIntervalMs);
+    if (slackMs > 0.0f) {
+        WaitUntil(mAcquiredTime + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float, std::milli>(slackMs)));
+    }
+    mInputSampleTime = Clock::now();
+}
+
+void FramePacer::MarkSubmitted()
+{
+    mSubmitTime = Clock::now();
+}
+
+void FramePacer::EndFrame(float gpuFrameTimeMs, VkPresentModeKHR presentMode)
+{
+    Clock::time_point endTime = Clock::now();
+
+    mTimingInfo.cpuFrameTimeMs = ElapsedMs(mInputSampleTime, endTime);
+    mTimingInfo.gpuFrameTimeMs = gpuFrameTimeMs;
+    mTimingInfo.resizeTimeMs = mPendingResizeTimeMs;
+    mPendingResizeTimeMs = 0.0f;
+    mAvgCpuTimeMs += (mTimingInfo.cpuFrameTimeMs - mAvgCpuTimeMs) * SMOOTH_FACTOR;
+    mAvgGpuTimeMs += (gpuFrameTimeMs - mAvgGpuTimeMs) * SMOOTH_FACTOR;
+
+    // 估计延迟：输入采样 -> 提交 -> GPU执行完，FIFO下还要等到下一次垂直同步才显示
+    float renderDoneMs = ElapsedMs(mInputSampleTime, mSubmitTime) + gpuFrameTimeMs;
+    if (presentMode == VK_PRESENT_MODE_FIFO_KHR || presentMode == VK_PRESENT_MODE_FIFO_RELAXED_KHR) {
+        if (mAvgIntervalMs > 0.0f) {
+            float sampleOffsetMs = ElapsedMs(mAcquiredTime, mInputSampleTime);
+            float vsyncCount = std::max(std::ceil((sampleOffsetMs + renderDoneMs) / mAvgIntervalMs), 1.0f);
+            renderDoneMs = vsyncCount * mAvgIntervalMs - sampleOffsetMs;
+        }
+    }
+    mTimingInfo.estimatedLatencyMs = renderDoneMs;
+
+    if (mConfig.mode == FramePacingMode::TARGET_FPS && mConfig.targetFps > 0.0f) {
+        WaitUntil(mFrameBeginTime + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(1.0f / mConfig.targetFps)));
+    }
+}
+
+void FramePacer::WaitUntil(Clock::time_point targetTime)
+{
+    // 先sleep到目标时间之前，最后一段自旋，避免sleep的调度误差
+    auto spinThreshold = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float, std::milli>(mConfig.spinThresholdMs));
+    Clock::time_point now = Clock::now();
+    if (targetTime - now > spinThreshold) {
+        std::this_thread::sleep_for(targetTime - now - spinThreshold);
+    }
+    while (Clock::now() < targetTime) {
+        std::this_thread::yield();
+    }
+}
+
+float FramePacer::ElapsedMs(Clock::time_point begin, Clock::time_point end)
+{
+    return std::chrono::duration<float, std::milli>(end - begin).count();
+}
+}   // namespace framework
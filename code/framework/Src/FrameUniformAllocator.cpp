@@ -0,0 +1,72 @@
+#include "FrameUniformAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "BufferCreator.h"
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "FrameUniformAllocator"
+
+namespace framework {
+void FrameUniformAllocator::Init(Device* device, VkDeviceSize frameCapacity, uint32_t frameCount)
+{
+    if (device == nullptr || frameCapacity == 0 || frameCount == 0) {
+        throw std::runtime_error("invalid frame uniform allocator params!");
+    }
+    mDevice = device;
+
+    // 每段的起点也要满足对齐
+    mAlignment = std::max<VkDeviceSize>(device->GetPhysicalDevice()->GetProperties().limits.minUniformBufferOffsetAlignment, 1);
+    mFrameCapacity = (frameCapacity + mAlignment - 1) / mAlignment * mAlignment;
+    mFrameCount = frameCount;
+
+    VkDeviceSize bufferSize = mFrameCapacity * mFrameCount;
+    BufferCreator::GetInstance().CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mBuffer, mMemory);
+    if (vkMapMemory(mDevice->Get(), mMemory, 0, bufferSize, 0, reinterpret_cast<void**>(&mMapped)) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map frame uniform buffer!");
+    }
+
+    // 第一次BeginFrame切换到第0段
+    mFrameIndex = mFrameCount - 1;
+    mOffset = mFrameIndex * mFrameCapacity;
+    LOGI("frame uniform buffer %lld bytes x %d frames, alignment %lld", mFrameCapacity, mFrameCount, mAlignment);
+}
+
+void FrameUniformAllocator::CleanUp()
+{
+    if (mBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+    vkUnmapMemory(mDevice->Get(), mMemory);
+    vkDestroyBuffer(mDevice->Get(), mBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mMemory, nullptr);
+    mBuffer = VK_NULL_HANDLE;
+    mMemory = VK_NULL_HANDLE;
+    mMapped = nullptr;
+}
+
+void FrameUniformAllocator::BeginFrame()
+{
+    mFrameIndex = (mFrameIndex + 1) % mFrameCount;
+    mOffset = mFrameIndex * mFrameCapacity;
+}
+
+UniformAllocation FrameUniformAllocator::Allocate(VkDeviceSize size)
+{
+    VkDeviceSize offset = (mOffset + mAlignment - 1) / mAlignment * mAlignment;
+    if (offset + size > (mFrameIndex + 1) * mFrameCapacity) {
+        LOGE("frame uniform buffer overflow: %lld + %lld bytes, capacity %lld",
+            offset - mFrameIndex * mFrameCapacity, size, mFrameCapacity);
+        throw std::runtime_error("frame uniform buffer overflow!");
+    }
+    mOffset = offset + size;
+
+    UniformAllocation allocation{};
+    allocation.mapped = mMapped + offset;
+    allocation.offset = static_cast<uint32_t>(offset);
+    return allocation;
+}
+}   // namespace framework
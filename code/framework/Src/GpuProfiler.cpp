@@ -0,0 +1,366 @@
+#include "GpuProfiler.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+
+#include "CpuProfiler.h"
+#include "Log.h"
+#include "AppDispatchTable.h"
+
+#undef LOG_TAG
+#define LOG_TAG "GpuProfiler"
+
+namespace framework {
+namespace {
+constexpr VkQueryPipelineStatisticFlags STATISTICS_FLAGS =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+}
+
+GpuProfiler& GpuProfiler::GetInstance()
+{
+    static GpuProfiler instance;
+    return instance;
+}
+
+void GpuProfiler::Init(Device* device, uint32_t frameSlotCount, bool enablePipelineStatistics, uint32_t maxScopesPerFrame)
+{
+    if (device == nullptr || !device->IsValid()) {
+        throw std::runtime_error("can not init GpuProfiler with a null or invalid device!");
+    }
+    mDevice = device;
+
+    VkPhysicalDeviceLimits& limits = mDevice->GetPhysicalDevice()->GetProperties().limits;
+    if (!limits.timestampComputeAndGraphics) {
+        LOGW("timestamp queries not supported, profiler disabled");
+        return;
+    }
+    mTimestampPeriodNs = limits.timestampPeriod;
+
+    // 有效位数为0的队列族不能写时间戳，不足64位时计数会回绕，只取低位并按模求差
+    uint32_t validBits = GetTimestampValidBits();
+    if (validBits == 0) {
+        LOGW("queue family has no valid timestamp bits, profiler disabled");
+        return;
+    }
+    mTimestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+    mMaxScopes = maxScopesPerFrame;
+
+    frameSlotCount = std::max(frameSlotCount, 2u);
+    mFrameSlots.clear();
+    for (uint32_t i = 0; i < frameSlotCount; i++) {
+        mFrameSlots.emplace_back(std::make_unique<FrameSlot>());
+        mFrameSlots.back()->scopes.resize(mMaxScopes);
+    }
+    mCurrentSlot = 0;
+    mLastFrameResults.reserve(mMaxScopes);
+    mTimestampResults.resize(mMaxScopes * 2);
+    mStatisticsResults.resize(mMaxScopes * GPU_STAT_COUNT);
+    mTraceResults.resize(TRACE_RESULT_COUNT);
+    mTraceNext = 0;
+    mTraceCount = 0;
+
+    // 每个scope两个时间戳
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = frameSlotCount * mMaxScopes * 2;
+    if (vkCreateQueryPool(mDevice->Get(), &queryPoolInfo, nullptr, &mTimestampQueryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    if (enablePipelineStatistics) {
+        queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        queryPoolInfo.queryCount = frameSlotCount * mMaxScopes;
+        queryPoolInfo.pipelineStatistics = STATISTICS_FLAGS;
+        if (vkCreateQueryPool(mDevice->Get(), &queryPoolInfo, nullptr, &mStatisticsQueryPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline statistics query pool!");
+        }
+    }
+    LOGI("init with %d frame slots, %d scopes per frame, statistics %s",
+        frameSlotCount, mMaxScopes, enablePipelineStatistics ? "on" : "off");
+}
+
+void GpuProfiler::CleanUp()
+{
+    if (mDevice == nullptr) {
+        return;
+    }
+    vkDestroyQueryPool(mDevice->Get(), mStatisticsQueryPool, nullptr);
+    vkDestroyQueryPool(mDevice->Get(), mTimestampQueryPool, nullptr);
+    mStatisticsQueryPool = VK_NULL_HANDLE;
+    mTimestampQueryPool = VK_NULL_HANDLE;
+    mFrameSlots.clear();
+    mLastFrameResults.clear();
+    mHistories.clear();
+    mTraceResults.clear();
+    mTraceNext = 0;
+    mTraceCount = 0;
+    mHasCpuOffset = false;
+    mDevice = nullptr;
+}
+
+void GpuProfiler::BeginFrame()
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    mCurrentSlot = (mCurrentSlot + 1) % mFrameSlots.size();
+    CollectSlot(mCurrentSlot);
+
+    FrameSlot& slot = *mFrameSlots[mCurrentSlot];
+    slot.scopeCount.store(0);
+    slot.statisticsCount.store(0);
+    slot.submitted = false;
+}
+
+void GpuProfiler::EndFrame(bool submitted, int64_t submitCpuNs)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+    mFrameSlots[mCurrentSlot]->submitted = submitted;
+    mFrameSlots[mCurrentSlot]->submitCpuNs = submitCpuNs;
+}
+
+void GpuProfiler::CmdResetQueries(VkCommandBuffer cmdBuf)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    if (!IsEnabled()) {
+        return;
+    }
+    dispatch.CmdResetQueryPool(cmdBuf, mTimestampQueryPool, mCurrentSlot * mMaxScopes * 2, mMaxScopes * 2);
+    if (mStatisticsQueryPool != VK_NULL_HANDLE) {
+        dispatch.CmdResetQueryPool(cmdBuf, mStatisticsQueryPool, mCurrentSlot * mMaxScopes, mMaxScopes);
+    }
+}
+
+uint32_t GpuProfiler::CmdBeginScope(VkCommandBuffer cmdBuf, const char* name, bool pipelineStatistics)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    if (!IsEnabled()) {
+        return INVALID_SCOPE;
+    }
+
+    FrameSlot& slot = *mFrameSlots[mCurrentSlot];
+    uint32_t scopeId = slot.scopeCount.fetch_add(1);
+    if (scopeId >= mMaxScopes) {
+        return INVALID_SCOPE;
+    }
+
+    ScopeRecord& scope = slot.scopes[scopeId];
+    scope.name = name;
+    scope.statisticsQuery = INVALID_SCOPE;
+
+    uint32_t queryBase = mCurrentSlot * mMaxScopes * 2;
+    dispatch.CmdWriteTimestamp(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mTimestampQueryPool, queryBase + scopeId * 2);
+
+    // 同一个命令缓冲中管线统计的query不能嵌套
+    if (pipelineStatistics && mStatisticsQueryPool != VK_NULL_HANDLE) {
+        scope.statisticsQuery = slot.statisticsCount.fetch_add(1);
+        dispatch.CmdBeginQuery(cmdBuf, mStatisticsQueryPool, mCurrentSlot * mMaxScopes + scope.statisticsQuery, 0);
+    }
+    return scopeId;
+}
+
+void GpuProfiler::CmdEndScope(VkCommandBuffer cmdBuf, uint32_t scopeId)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    if (!IsEnabled() || scopeId == INVALID_SCOPE) {
+        return;
+    }
+
+    ScopeRecord& scope = mFrameSlots[mCurrentSlot]->scopes[scopeId];
+    if (scope.statisticsQuery != INVALID_SCOPE) {
+        dispatch.CmdEndQuery(cmdBuf, mStatisticsQueryPool, mCurrentSlot * mMaxScopes + scope.statisticsQuery);
+    }
+
+    uint32_t queryBase = mCurrentSlot * mMaxScopes * 2;
+    dispatch.CmdWriteTimestamp(cmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mTimestampQueryPool, queryBase + scopeId * 2 + 1);
+}
+
+float GpuProfiler::GetLastScopeTimeMs(const std::string& name)
+{
+    for (const GpuScopeResult& result : mLastFrameResults) {
+        if (name == result.name) {
+            return static_cast<float>(result.durationMs);
+        }
+    }
+    return 0.0f;
+}
+
+void GpuProfiler::CollectSlot(uint32_t slotIndex)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    FrameSlot& slot = *mFrameSlots[slotIndex];
+    uint32_t scopeCount = std::min(slot.scopeCount.load(), mMaxScopes);
+    if (!slot.submitted || scopeCount == 0) {
+        return;
+    }
+
+    // 不带WAIT标志，结果还没写完时直接丢弃这一帧
+    std::vector<uint64_t>& timestamps = mTimestampResults;
+    VkResult result = dispatch.GetQueryPoolResults(mDevice->Get(), mTimestampQueryPool,
+        slotIndex * mMaxScopes * 2, scopeCount * 2,
+        scopeCount * 2 * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        mDroppedFrameCount++;
+        return;
+    }
+
+    uint32_t statisticsCount = slot.statisticsCount.load();
+    std::vector<uint64_t>& statistics = mStatisticsResults;
+    bool statisticsValid = false;
+    if (statisticsCount > 0) {
+        result = dispatch.GetQueryPoolResults(mDevice->Get(), mStatisticsQueryPool,
+            slotIndex * mMaxScopes, statisticsCount,
+            statisticsCount * GPU_STAT_COUNT * sizeof(uint64_t), statistics.data(), GPU_STAT_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+        statisticsValid = result == VK_SUCCESS;
+    }
+
+    mLastFrameResults.clear();
+    for (uint32_t i = 0; i < scopeCount; i++) {
+        const ScopeRecord& scope = slot.scopes[i];
+        GpuScopeResult scopeResult{};
+        scopeResult.name = scope.name;
+        uint64_t beginTicks = timestamps[i * 2] & mTimestampMask;
+        uint64_t durationTicks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & mTimestampMask;
+        scopeResult.beginUs = static_cast<double>(beginTicks) * mTimestampPeriodNs / 1000.0;
+        scopeResult.durationMs = static_cast<double>(durationTicks) * mTimestampPeriodNs / 1000000.0;
+        if (statisticsValid && scope.statisticsQuery != INVALID_SCOPE) {
+            scopeResult.hasStatistics = true;
+            std::copy_n(statistics.begin() + scope.statisticsQuery * GPU_STAT_COUNT, GPU_STAT_COUNT, scopeResult.statistics.begin());
+        }
+        mLastFrameResults.emplace_back(scopeResult);
+        AddToHistory(scopeResult);
+
+        mTraceResults[mTraceNext] = scopeResult;
+        mTraceNext = (mTraceNext + 1) % TRACE_RESULT_COUNT;
+        mTraceCount = std::min(mTraceCount + 1, TRACE_RESULT_COUNT);
+    }
+
+    // 没有calibrated timestamps扩展时用提交时刻估计偏移：GPU一定在提交之后才开始执行，
+    // 提交时刻在第一次QueueSubmit之前记录，每帧都给出偏移的一个下界，取最大值最接近真实值
+    double firstBeginUs = mLastFrameResults.front().beginUs;
+    for (const GpuScopeResult& scopeResult : mLastFrameResults) {
+        firstBeginUs = std::min(firstBeginUs, scopeResult.beginUs);
+    }
+    double offsetUs = static_cast<double>(slot.submitCpuNs) / 1000.0 - firstBeginUs;
+    mGpuToCpuOffsetUs = mHasCpuOffset ? std::max(mGpuToCpuOffsetUs, offsetUs) : offsetUs;
+    mHasCpuOffset = true;
+
+    mCollectedFrameCount++;
+}
+
+uint32_t GpuProfiler::GetTimestampValidBits()
+{
+    PhysicalDevice* physicalDevice = mDevice->GetPhysicalDevice();
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->Get(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->Get(), &queueFamilyCount, queueFamilies.data());
+
+    // scope可能录在图形队列和异步计算队列上，取两者中较少的位数
+    PhysicalDevice::QueueFamilyIndices indices = physicalDevice->GetQueueFamilyIndices();
+    uint32_t validBits = queueFamilies[indices.graphicsFamily.value()].timestampValidBits;
+    if (indices.computeFamily.has_value()) {
+        validBits = std::min(validBits, queueFamilies[indices.computeFamily.value()].timestampValidBits);
+    }
+    return validBits;
+}
+
+void GpuProfiler::AddToHistory(const GpuScopeResult& result)
+{
+    auto it = mHistories.find(result.name);
+    if (it == mHistories.end()) {
+        it = mHistories.emplace(result.name, ScopeHistory{}).first;
+        it->second.order = static_cast<uint32_t>(mHistories.size());
+    }
+
+    ScopeHistory& history = it->second;
+    if (history.count == AVERAGE_WINDOW) {
+        history.sum -= history.samples[history.next];
+    }
+    else {
+        history.count++;
+    }
+    history.samples[history.next] = static_cast<float>(result.durationMs);
+    history.sum += result.durationMs;
+    history.next = (history.next + 1) % AVERAGE_WINDOW;
+
+    if (result.hasStatistics) {
+        history.hasStatistics = true;
+        history.lastStatistics = result.statistics;
+    }
+}
+
+void GpuProfiler::PrintAverageTable()
+{
+    // 按第一次出现的顺序输出
+    std::vector<std::pair<const std::string*, const ScopeHistory*>> rows = {};
+    for (const auto& history : mHistories) {
+        rows.emplace_back(&history.first, &history.second);
+    }
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.second->order < b.second->order; });
+
+    LOGI("---------------- gpu profile (avg of last %d frames, %d dropped) ----------------", AVERAGE_WINDOW, mDroppedFrameCount);
+    LOGI("%-20s %10s %12s %12s %12s %12s %12s", "scope", "avg(ms)", "ia verts", "vs inv", "clip prims", "fs inv", "cs inv");
+    for (const auto& row : rows) {
+        const ScopeHistory& history = *row.second;
+        double avgMs = history.count > 0 ? history.sum / history.count : 0.0;
+        if (history.hasStatistics) {
+            const auto& stats = history.lastStatistics;
+            LOGI("%-20s %10.3f %12llu %12llu %12llu %12llu %12llu", row.first->c_str(), avgMs,
+                stats[GPU_STAT_IA_VERTICES], stats[GPU_STAT_VS_INVOCATIONS], stats[GPU_STAT_CLIPPING_PRIMITIVES],
+                stats[GPU_STAT_FS_INVOCATIONS], stats[GPU_STAT_CS_INVOCATIONS]);
+        }
+        else {
+            LOGI("%-20s %10.3f", row.first->c_str(), avgMs);
+        }
+    }
+}
+
+bool GpuProfiler::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return false;
+    }
+
+    // chrome://tracing 的Trace Event格式
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    WriteTraceEvents(file, first);
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    LOGI("gpu trace written to %s", path.c_str());
+    return true;
+}
+
+void GpuProfiler::WriteTraceEvents(std::ostream& out, bool& first)
+{
+    // GPU单独占一行(tid = 0)，每个scope是一个完整事件(ph = X)
+    out << (first ? "" : ",\n");
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+    first = false;
+
+    uint32_t oldest = (mTraceNext + TRACE_RESULT_COUNT - mTraceCount) % TRACE_RESULT_COUNT;
+    for (uint32_t i = 0; i < mTraceCount; i++) {
+        const GpuScopeResult& result = mTraceResults[(oldest + i) % TRACE_RESULT_COUNT];
+        out << ",\n";
+        out << "{\"name\":\"" << result.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":0"
+            << ",\"ts\":" << std::fixed << result.beginUs + mGpuToCpuOffsetUs
+            << ",\"dur\":" << result.durationMs * 1000.0;
+        if (result.hasStatistics) {
+            out << ",\"args\":{\"fs invocations\":" << result.statistics[GPU_STAT_FS_INVOCATIONS]
+                << ",\"cs invocations\":" << result.statistics[GPU_STAT_CS_INVOCATIONS] << "}";
+        }
+        out << "}";
+    }
+}
+}   // namespace framework
@@ -45,11 +45,30 @@ VkGraphicsPipelineCreateInfo GraphicsPipelineConfigInfo::Populate() const
 	pipelineInfo.layout = mPipelineLayout;
 	pipelineInfo.renderPass = mRenderPass;
 	pipelineInfo.subpass = mSubpassIndex;
+	if (UseDynamicRendering()) {
+		pipelineInfo.pNext = &mRenderingInfo;	// 没有renderPass，附件格式从这里取
+	}
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineInfo.basePipelineIndex = -1;
 	return pipelineInfo;
 }
 
+bool GraphicsPipelineConfigInfo::SetRenderingInfo(const VkPipelineRenderingCreateInfoKHR& renderingInfo)
+{
+	if (renderingInfo.colorAttachmentCount > 0 && renderingInfo.pColorAttachmentFormats == nullptr) {
+		return false;
+	}
+	mColorAttachmentFormats.assign(renderingInfo.pColorAttachmentFormats,
+		renderingInfo.pColorAttachmentFormats + renderingInfo.colorAttachmentCount);
+	mRenderingInfo = renderingInfo;
+	mRenderingInfo.pNext = nullptr;
+	mRenderingInfo.pColorAttachmentFormats = mColorAttachmentFormats.empty() ? nullptr : mColorAttachmentFormats.data();
+	mRenderPass = VK_NULL_HANDLE;
+	mSubpassIndex = 0;
+	mDynamicRendering = true;
+	return true;
+}
+
 bool GraphicsPipelineConfigInfo::AddDynamicState(VkDynamicState state)
 {
 	mDynamicStates.emplace_back(state);
@@ -0,0 +1,781 @@
+#include "ImageBasedLighting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "VulkanInitializers.h"
+#include "BufferCreator.h"
+#include "Log.h"
+#undef LOG_TAG
+#define LOG_TAG "ImageBasedLighting"
+
+namespace framework {
+namespace {
+constexpr uint32_t CACHE_MAGIC = 0x43424C49;     // "IBLC"
+
+struct CacheHeader {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t sourceKey = 0;
+    uint32_t envCubeSize = 0;
+    uint32_t prefilterSize = 0;
+    uint32_t prefilterMipCount = 0;
+    uint32_t brdfLutSize = 0;
+};
+
+uint32_t GroupCount(uint32_t size, uint32_t groupSize)
+{
+    return (size + groupSize - 1) / groupSize;
+}
+}
+
+void ImageBasedLighting::Init(Device* device)
+{
+    if (device == nullptr) {
+        throw std::runtime_error("invalid image based lighting params!");
+    }
+    mDevice = device;
+    mSampler = CreateSampler(VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, PREFILTER_MIP_COUNT);
+}
+
+void ImageBasedLighting::CleanUp()
+{
+    if (mDevice == nullptr) {
+        return;
+    }
+    vkDestroyBuffer(mDevice->Get(), mParamsBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mParamsMemory, nullptr);
+    mParamsBuffer = VK_NULL_HANDLE;
+    mParamsMemory = VK_NULL_HANDLE;
+    CleanUpResultImages();
+    vkDestroySampler(mDevice->Get(), mSampler, nullptr);
+    mSampler = VK_NULL_HANDLE;
+    mDevice = nullptr;
+}
+
+bool ImageBasedLighting::LoadCache(const std::string& cachePath, uint64_t sourceKey)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file.is_open()) {
+        LOGI("no ibl cache at %s", cachePath.c_str());
+        return false;
+    }
+
+    CacheHeader header{};
+    IblParams params{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    file.read(reinterpret_cast<char*>(&params), sizeof(params));
+    if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.sourceKey != sourceKey ||
+        header.envCubeSize != ENV_CUBE_SIZE || header.prefilterSize != PREFILTER_SIZE ||
+        header.prefilterMipCount != PREFILTER_MIP_COUNT || header.brdfLutSize != BRDF_LUT_SIZE) {
+        LOGW("ibl cache %s is outdated", cachePath.c_str());
+        return false;
+    }
+
+    // 文件直接读到暂存区，省去一次内存拷贝
+    VmaAllocator allocator = BufferCreator::GetInstance().GetAllocator();
+    VkDeviceSize dataSize = GetPrefilterDataSize() + GetBrdfLutDataSize();
+    VkBufferCreateInfo stagingInfo = vulkanInitializers::BufferCreateInfo(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+    VmaAllocationCreateInfo stagingAllocInfo = {};
+    stagingAllocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+    stagingAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VmaAllocation stagingAllocation = VK_NULL_HANDLE;
+    VmaAllocationInfo stagingAllocResult = {};
+    if (vmaCreateBuffer(allocator, &stagingInfo, &stagingAllocInfo, &stagingBuffer, &stagingAllocation, &stagingAllocResult) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create ibl staging buffer!");
+    }
+    file.read(static_cast<char*>(stagingAllocResult.pMappedData), static_cast<std::streamsize>(dataSize));
+    if (!file) {
+        LOGW("ibl cache %s is truncated", cachePath.c_str());
+        vmaDestroyBuffer(allocator, stagingBuffer, stagingAllocation);
+        return false;
+    }
+    vmaFlushAllocation(allocator, stagingAllocation, 0, VK_WHOLE_SIZE);
+
+    CreateResultImages();
+
+    VkImageSubresourceRange prefilterRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, PREFILTER_MIP_COUNT, 0, 6 };
+    VkImageSubresourceRange brdfLutRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    std::vector<VkBufferImageCopy> prefilterRegions = GetPrefilterCopyRegions();
+    VkBufferImageCopy brdfLutRegion = GetBrdfLutCopyRegion();
+
+    VkCommandBuffer commandBuffer = mDevice->BeginSingleTimeCommands();
+    {
+        CmdImageBarrier(commandBuffer, mPrefilteredImage, prefilterRange,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+        CmdImageBarrier(commandBuffer, mBrdfLutImage, brdfLutRange,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, mPrefilteredImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            prefilterRegions.size(), prefilterRegions.data());
+        vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, mBrdfLutImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &brdfLutRegion);
+
+        CmdImageBarrier(commandBuffer, mPrefilteredImage, prefilterRange,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        CmdImageBarrier(commandBuffer, mBrdfLutImage, brdfLutRange,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    }
+    mDevice->EndSingleTimeCommands(commandBuffer);
+
+    vmaDestroyBuffer(allocator, stagingBuffer, stagingAllocation);
+    CreateParamsBuffer(params);
+
+    auto endTime = std::chrono::steady_clock::now();
+    LOGI("loaded ibl cache %s in %.2f ms", cachePath.c_str(),
+        std::chrono::duration<float, std::milli>(endTime - startTime).count());
+    return true;
+}
+
+void ImageBasedLighting::Bake(const EquirectImage& source, const std::string& cachePath, uint64_t sourceKey)
+{
+    if (source.pixels == nullptr || source.width == 0 || source.height == 0) {
+        throw std::runtime_error("invalid equirect image!");
+    }
+    auto startTime = std::chrono::steady_clock::now();
+
+    CreateResultImages();
+
+    BakeResources bake{};
+    CreateBakeResources(source, bake);
+    CreateBakePipelines(bake);
+    CreateBakeDescriptorSets(bake);
+
+    VkCommandBuffer commandBuffer = mDevice->BeginSingleTimeCommands();
+    RecordBake(commandBuffer, bake);
+    mDevice->EndSingleTimeCommands(commandBuffer);
+
+    IblParams params = ResolveShCoefficients(bake);
+    CreateParamsBuffer(params);
+
+    vmaInvalidateAllocation(BufferCreator::GetInstance().GetAllocator(), bake.readbackAllocation, 0, VK_WHOLE_SIZE);
+    SaveCache(cachePath, sourceKey, params, bake.readbackAddr);
+
+    CleanUpBakeResources(bake);
+
+    auto endTime = std::chrono::steady_clock::now();
+    LOGI("baked ibl from %dx%d equirect in %.2f ms", source.width, source.height,
+        std::chrono::duration<float, std::milli>(endTime - startTime).count());
+}
+
+void ImageBasedLighting::AppendLayoutBindings(std::vector<VkDescriptorSetLayoutBinding>& bindings, VkShaderStageFlags stageFlags)
+{
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_IBL_PARAMS, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, stageFlags));
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_PREFILTERED_ENV, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, stageFlags));
+    bindings.emplace_back(vulkanInitializers::DescriptorSetLayoutBinding(BINDING_BRDF_LUT, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, stageFlags));
+}
+
+void ImageBasedLighting::WriteDescriptorSet(VkDescriptorSet descriptorSet)
+{
+    if (!IsReady()) {
+        throw std::runtime_error("image based lighting is not loaded!");
+    }
+    VkDescriptorBufferInfo paramsInfo = { mParamsBuffer, 0, sizeof(IblParams) };
+    VkDescriptorImageInfo prefilteredInfo = { mSampler, mPrefilteredView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorImageInfo brdfLutInfo = { mSampler, mBrdfLutView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+    std::vector<VkWriteDescriptorSet> descriptorWrites = {
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_IBL_PARAMS, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &paramsInfo),
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_PREFILTERED_ENV, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &prefilteredInfo),
+        vulkanInitializers::WriteDescriptorSet(descriptorSet,
+            BINDING_BRDF_LUT, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &brdfLutInfo),
+    };
+    vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+uint64_t ImageBasedLighting::GetFileKey(const std::string& filePath)
+{
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(filePath, error);
+    if (error) {
+        return 0;
+    }
+    auto writeTime = std::filesystem::last_write_time(filePath, error);
+    if (error) {
+        return 0;
+    }
+
+    // FNV-1a，逐字节混合路径的哈希、文件大小和修改时间
+    uint64_t key = 14695981039346656037ull;
+    auto hashValue = [&key](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            key ^= (value >> (i * 8)) & 0xff;
+            key *= 1099511628211ull;
+        }
+    };
+    hashValue(std::hash<std::string>()(filePath));
+    hashValue(fileSize);
+    hashValue(static_cast<uint64_t>(writeTime.time_since_epoch().count()));
+    // 0表示文件不存在，PROCEDURAL_SKY_KEY留给程序化天空
+    return key <= PROCEDURAL_SKY_KEY ? key + PROCEDURAL_SKY_KEY + 1 : key;
+}
+
+void ImageBasedLighting::GenerateProceduralSky(std::vector<float>& pixels, uint32_t width, uint32_t height)
+{
+    const glm::vec3 zenithColor = glm::vec3(0.15f, 0.35f, 0.8f);
+    const glm::vec3 horizonColor = glm::vec3(0.7f, 0.8f, 0.95f);
+    const glm::vec3 groundColor = glm::vec3(0.15f, 0.13f, 0.1f);
+    const glm::vec3 sunColor = glm::vec3(1.0f, 0.9f, 0.75f);
+    const glm::vec3 sunDir = glm::normalize(glm::vec3(0.6f, 0.3f, 0.5f));
+
+    pixels.resize(static_cast<size_t>(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        float theta = (y + 0.5f) / height * glm::pi<float>();
+        for (uint32_t x = 0; x < width; x++) {
+            // 和ibl_equirect_to_cube.comp的映射一致：u = atan(y, x) / 2PI + 0.5, v = acos(z) / PI
+            float phi = ((x + 0.5f) / width - 0.5f) * glm::two_pi<float>();
+            glm::vec3 dir = glm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+
+            glm::vec3 color = glm::vec3(0.0f);
+            if (dir.z >= 0.0f) {
+                color = glm::mix(zenithColor, horizonColor, std::pow(1.0f - dir.z, 4.0f));
+            } else {
+                color = glm::mix(groundColor, horizonColor * 0.5f, std::pow(1.0f + dir.z, 8.0f));
+            }
+
+            // 太阳：明亮的圆盘加一圈光晕
+            float sunCos = std::max(glm::dot(dir, sunDir), 0.0f);
+            color += sunColor * (glm::smoothstep(0.9995f, 0.9998f, sunCos) * 60.0f + std::pow(sunCos, 32.0f) * 1.5f);
+
+            float* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+            pixel[0] = color.r;
+            pixel[1] = color.g;
+            pixel[2] = color.b;
+            pixel[3] = 1.0f;
+        }
+    }
+}
+
+void ImageBasedLighting::CreateResultImages()
+{
+    if (mPrefilteredImage != VK_NULL_HANDLE) {
+        CleanUpResultImages();
+    }
+    VmaAllocator allocator = BufferCreator::GetInstance().GetAllocator();
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    // 预处理时作为storage image写入并读回，加载缓存时作为拷贝目标
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    VkImageCreateInfo prefilterInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, HDR_FORMAT,
+        { PREFILTER_SIZE, PREFILTER_SIZE, 1 }, usage);
+    prefilterInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+    prefilterInfo.mipLevels = PREFILTER_MIP_COUNT;
+    prefilterInfo.arrayLayers = 6;
+    if (vmaCreateImage(allocator, &prefilterInfo, &imageAllocInfo, &mPrefilteredImage, &mPrefilteredAllocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create prefiltered environment image!");
+    }
+    mPrefilteredView = CreateImageView(mPrefilteredImage, VK_IMAGE_VIEW_TYPE_CUBE, HDR_FORMAT, 0, PREFILTER_MIP_COUNT, 6);
+
+    VkImageCreateInfo brdfLutInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, BRDF_LUT_FORMAT,
+        { BRDF_LUT_SIZE, BRDF_LUT_SIZE, 1 }, usage);
+    if (vmaCreateImage(allocator, &brdfLutInfo, &imageAllocInfo, &mBrdfLutImage, &mBrdfLutAllocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create brdf lut image!");
+    }
+    mBrdfLutView = CreateImageView(mBrdfLutImage, VK_IMAGE_VIEW_TYPE_2D, BRDF_LUT_FORMAT, 0, 1, 1);
+}
+
+void ImageBasedLighting::CleanUpResultImages()
+{
+    VmaAllocator allocator = BufferCreator::GetInstance().GetAllocator();
+    vkDestroyImageView(mDevice->Get(), mBrdfLutView, nullptr);
+    vkDestroyImageView(mDevice->Get(), mPrefilteredView, nullptr);
+    if (mBrdfLutImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(allocator, mBrdfLutImage, mBrdfLutAllocation);
+    }
+    if (mPrefilteredImage != VK_NULL_HANDLE) {
+        vmaDestroyImage(allocator, mPrefilteredImage, mPrefilteredAllocation);
+    }
+    mBrdfLutView = VK_NULL_HANDLE;
+    mPrefilteredView = VK_NULL_HANDLE;
+    mBrdfLutImage = VK_NULL_HANDLE;
+    mPrefilteredImage = VK_NULL_HANDLE;
+    mBrdfLutAllocation = VK_NULL_HANDLE;
+    mPrefilteredAllocation = VK_NULL_HANDLE;
+}
+
+void ImageBasedLighting::CreateParamsBuffer(const IblParams& params)
+{
+    if (mParamsBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(mDevice->Get(), mParamsBuffer, nullptr);
+        vkFreeMemory(mDevice->Get(), mParamsMemory, nullptr);
+    }
+    IblParams srcParams = params;
+    BufferCreator::GetInstance().CreateBufferFromSrcData(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        &srcParams, sizeof(IblParams), mParamsBuffer, mParamsMemory);
+}
+
+void ImageBasedLighting::CreateBakeResources(const EquirectImage& source, BakeResources& bake)
+{
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+    VmaAllocator allocator = bufferCreator.GetAllocator();
+
+    // 源图转成半精度上传，RGBA16F的线性过滤是必须支持的，RGBA32F不是
+    std::vector<uint64_t> halfPixels(static_cast<size_t>(source.width) * source.height);
+    for (size_t i = 0; i < halfPixels.size(); i++) {
+        const float* pixel = source.pixels + i * 4;
+        halfPixels[i] = glm::packHalf4x16(glm::vec4(pixel[0], pixel[1], pixel[2], pixel[3]));
+    }
+    VkImageCreateInfo equirectInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, HDR_FORMAT,
+        { source.width, source.height, 1 }, VK_IMAGE_USAGE_SAMPLED_BIT);
+    bufferCreator.CreateTextureFromSrcData(equirectInfo, halfPixels.data(), halfPixels.size() * sizeof(uint64_t),
+        bake.equirectImage, bake.equirectAllocation);
+    bake.equirectView = CreateImageView(bake.equirectImage, VK_IMAGE_VIEW_TYPE_2D, HDR_FORMAT, 0, 1, 1);
+
+    // 环境立方体贴图带完整的mip链，预滤波时按采样的概率密度选择mip，减少高亮处的噪点
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    VkImageCreateInfo envInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, HDR_FORMAT,
+        { ENV_CUBE_SIZE, ENV_CUBE_SIZE, 1 },
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    envInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+    envInfo.mipLevels = ENV_CUBE_MIP_COUNT;
+    envInfo.arrayLayers = 6;
+    if (vmaCreateImage(allocator, &envInfo, &imageAllocInfo, &bake.envImage, &bake.envAllocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create environment cube image!");
+    }
+    bake.envStorageView = CreateImageView(bake.envImage, VK_IMAGE_VIEW_TYPE_2D_ARRAY, HDR_FORMAT, 0, 1, 6);
+    bake.envCubeView = CreateImageView(bake.envImage, VK_IMAGE_VIEW_TYPE_CUBE, HDR_FORMAT, 0, ENV_CUBE_MIP_COUNT, 6);
+
+    // 预滤波贴图每一级mip单独作为storage image写入
+    bake.prefilterStorageViews.resize(PREFILTER_MIP_COUNT);
+    for (uint32_t mip = 0; mip < PREFILTER_MIP_COUNT; mip++) {
+        bake.prefilterStorageViews[mip] = CreateImageView(mPrefilteredImage, VK_IMAGE_VIEW_TYPE_2D_ARRAY, HDR_FORMAT, mip, 1, 6);
+    }
+
+    // GPU写、CPU读的两个缓冲
+    VmaAllocationCreateInfo readbackAllocInfo = {};
+    readbackAllocInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+    readbackAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo allocResult = {};
+
+    VkBufferCreateInfo shInfo = vulkanInitializers::BufferCreateInfo(sizeof(glm::vec4) * SH_FACE_STRIDE * 6,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    if (vmaCreateBuffer(allocator, &shInfo, &readbackAllocInfo, &bake.shBuffer, &bake.shAllocation, &allocResult) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create sh buffer!");
+    }
+    bake.shAddr = allocResult.pMappedData;
+
+    VkBufferCreateInfo readbackInfo = vulkanInitializers::BufferCreateInfo(GetPrefilterDataSize() + GetBrdfLutDataSize(),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    if (vmaCreateBuffer(allocator, &readbackInfo, &readbackAllocInfo, &bake.readbackBuffer, &bake.readbackAllocation, &allocResult) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create ibl readback buffer!");
+    }
+    bake.readbackAddr = allocResult.pMappedData;
+
+    // 等距柱状图在经度方向上首尾相接
+    bake.sampler = CreateSampler(VK_SAMPLER_ADDRESS_MODE_REPEAT, ENV_CUBE_MIP_COUNT);
+}
+
+void ImageBasedLighting::CreateBakePipelines(BakeResources& bake)
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+    std::vector<VkPushConstantRange> nullPushConstantRanges = {};
+
+    // 等距柱状图 -> 立方体贴图
+    ShaderFileInfo equirectShaderFile{};
+    equirectShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("ibl_equirect_to_cube.comp.spv");
+    equirectShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    std::vector<VkDescriptorSetLayoutBinding> equirectLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+    bake.pipelineEquirectToCube = pipelineFactory.CreateComputePipeline(equirectShaderFile, equirectLayoutBindings, nullPushConstantRanges);
+
+    // 漫反射辐照度投影到SH9
+    ShaderFileInfo shShaderFile{};
+    shShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("ibl_sh_project.comp.spv");
+    shShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    std::vector<VkDescriptorSetLayoutBinding> shLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+    std::vector<VkPushConstantRange> shPushConstantRanges = {
+        { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float) + sizeof(uint32_t) },     // lod, faceSize
+    };
+    bake.pipelineShProject = pipelineFactory.CreateComputePipeline(shShaderFile, shLayoutBindings, shPushConstantRanges);
+
+    // GGX预滤波
+    ShaderFileInfo prefilterShaderFile{};
+    prefilterShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("ibl_prefilter.comp.spv");
+    prefilterShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    std::vector<VkDescriptorSetLayoutBinding> prefilterLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+    std::vector<VkPushConstantRange> prefilterPushConstantRanges = {
+        { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float) * 2 },     // roughness, envSize
+    };
+    bake.pipelinePrefilter = pipelineFactory.CreateComputePipeline(prefilterShaderFile, prefilterLayoutBindings, prefilterPushConstantRanges);
+
+    // BRDF积分查找表
+    ShaderFileInfo brdfLutShaderFile{};
+    brdfLutShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("ibl_brdf_lut.comp.spv");
+    brdfLutShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    std::vector<VkDescriptorSetLayoutBinding> brdfLutLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+    bake.pipelineBrdfLut = pipelineFactory.CreateComputePipeline(brdfLutShaderFile, brdfLutLayoutBindings, nullPushConstantRanges);
+}
+
+void ImageBasedLighting::CreateBakeDescriptorSets(BakeResources& bake)
+{
+    std::vector<VkDescriptorPoolSize> poolSizes = {};
+    poolSizes.insert(poolSizes.end(), bake.pipelineEquirectToCube.descriptorSizes.begin(), bake.pipelineEquirectToCube.descriptorSizes.end());
+    poolSizes.insert(poolSizes.end(), bake.pipelineShProject.descriptorSizes.begin(), bake.pipelineShProject.descriptorSizes.end());
+    for (uint32_t mip = 0; mip < PREFILTER_MIP_COUNT; mip++) {
+        poolSizes.insert(poolSizes.end(), bake.pipelinePrefilter.descriptorSizes.begin(), bake.pipelinePrefilter.descriptorSizes.end());
+    }
+    poolSizes.insert(poolSizes.end(), bake.pipelineBrdfLut.descriptorSizes.begin(), bake.pipelineBrdfLut.descriptorSizes.end());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 3 + PREFILTER_MIP_COUNT;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &bake.descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    auto allocateSet = [this, &bake](PipelineObjecs& pipeline, VkDescriptorSet& descriptorSet) {
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+        allocInfo.descriptorPool = bake.descriptorPool;
+        allocInfo.descriptorSetCount = pipeline.descriptorSetLayouts.size();
+        allocInfo.pSetLayouts = pipeline.descriptorSetLayouts.data();
+        if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate ibl descriptor set!");
+        }
+    };
+
+    VkDescriptorImageInfo equirectInfo = { bake.sampler, bake.equirectView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorImageInfo envStorageInfo = { VK_NULL_HANDLE, bake.envStorageView, VK_IMAGE_LAYOUT_GENERAL };
+    VkDescriptorImageInfo envCubeInfo = { bake.sampler, bake.envCubeView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorBufferInfo shInfo = { bake.shBuffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorImageInfo brdfLutStorageInfo = { VK_NULL_HANDLE, mBrdfLutView, VK_IMAGE_LAYOUT_GENERAL };
+
+    allocateSet(bake.pipelineEquirectToCube, bake.descriptorSetEquirectToCube);
+    allocateSet(bake.pipelineShProject, bake.descriptorSetShProject);
+    allocateSet(bake.pipelineBrdfLut, bake.descriptorSetBrdfLut);
+    std::vector<VkWriteDescriptorSet> descriptorWrites = {
+        vulkanInitializers::WriteDescriptorSet(bake.descriptorSetEquirectToCube,
+            0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &equirectInfo),
+        vulkanInitializers::WriteDescriptorSet(bake.descriptorSetEquirectToCube,
+            1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &envStorageInfo),
+        vulkanInitializers::WriteDescriptorSet(bake.descriptorSetShProject,
+            0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &envCubeInfo),
+        vulkanInitializers::WriteDescriptorSet(bake.descriptorSetShProject,
+            1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &shInfo),
+        vulkanInitializers::WriteDescriptorSet(bake.descriptorSetBrdfLut,
+            0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &brdfLutStorageInfo),
+    };
+
+    bake.descriptorSetsPrefilter.resize(PREFILTER_MIP_COUNT);
+    std::vector<VkDescriptorImageInfo> prefilterStorageInfos(PREFILTER_MIP_COUNT);
+    for (uint32_t mip = 0; mip < PREFILTER_MIP_COUNT; mip++) {
+        allocateSet(bake.pipelinePrefilter, bake.descriptorSetsPrefilter[mip]);
+        prefilterStorageInfos[mip] = { VK_NULL_HANDLE, bake.prefilterStorageViews[mip], VK_IMAGE_LAYOUT_GENERAL };
+        descriptorWrites.emplace_back(vulkanInitializers::WriteDescriptorSet(bake.descriptorSetsPrefilter[mip],
+            0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &envCubeInfo));
+        descriptorWrites.emplace_back(vulkanInitializers::WriteDescriptorSet(bake.descriptorSetsPrefilter[mip],
+            1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &prefilterStorageInfos[mip]));
+    }
+    vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+void ImageBasedLighting::RecordBake(VkCommandBuffer cmdBuf, BakeResources& bake)
+{
+    VkImageSubresourceRange envMip0Range = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 };
+    VkImageSubresourceRange envMipChainRange = { VK_IMAGE_ASPECT_COLOR_BIT, 1, ENV_CUBE_MIP_COUNT - 1, 0, 6 };
+    VkImageSubresourceRange envRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, ENV_CUBE_MIP_COUNT, 0, 6 };
+    VkImageSubresourceRange prefilterRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, PREFILTER_MIP_COUNT, 0, 6 };
+    VkImageSubresourceRange brdfLutRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    // 1. 等距柱状图 -> 立方体贴图第0级
+    CmdImageBarrier(cmdBuf, bake.envImage, envMip0Range, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelineEquirectToCube.pipeline);
+    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelineEquirectToCube.layout,
+        0, 1, &bake.descriptorSetEquirectToCube, 0, nullptr);
+    vkCmdDispatch(cmdBuf, GroupCount(ENV_CUBE_SIZE, BAKE_GROUP_SIZE), GroupCount(ENV_CUBE_SIZE, BAKE_GROUP_SIZE), 6);
+
+    // 2. 逐级blit生成mip链
+    CmdImageBarrier(cmdBuf, bake.envImage, envMip0Range, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    CmdImageBarrier(cmdBuf, bake.envImage, envMipChainRange, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    for (uint32_t mip = 1; mip < ENV_CUBE_MIP_COUNT; mip++) {
+        int32_t srcSize = static_cast<int32_t>(std::max(ENV_CUBE_SIZE >> (mip - 1), 1u));
+        int32_t dstSize = static_cast<int32_t>(std::max(ENV_CUBE_SIZE >> mip, 1u));
+        VkImageBlit blit{};
+        blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 0, 6 };
+        blit.srcOffsets[1] = { srcSize, srcSize, 1 };
+        blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 6 };
+        blit.dstOffsets[1] = { dstSize, dstSize, 1 };
+        vkCmdBlitImage(cmdBuf, bake.envImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            bake.envImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        CmdImageBarrier(cmdBuf, bake.envImage, { VK_IMAGE_ASPECT_COLOR_BIT, mip, 1, 0, 6 },
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    }
+    CmdImageBarrier(cmdBuf, bake.envImage, envRange, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    // 3. SH9投影，每个工作组处理一个面
+    struct {
+        float lod;
+        uint32_t faceSize;
+    } shConsts = { static_cast<float>(SH_PROJECT_MIP), ENV_CUBE_SIZE >> SH_PROJECT_MIP };
+    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelineShProject.pipeline);
+    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelineShProject.layout,
+        0, 1, &bake.descriptorSetShProject, 0, nullptr);
+    vkCmdPushConstants(cmdBuf, bake.pipelineShProject.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(shConsts), &shConsts);
+    vkCmdDispatch(cmdBuf, 1, 1, 6);
+
+    // 4. 预滤波，第mip级的粗糙度为mip / (PREFILTER_MIP_COUNT - 1)
+    CmdImageBarrier(cmdBuf, mPrefilteredImage, prefilterRange, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelinePrefilter.pipeline);
+    for (uint32_t mip = 0; mip < PREFILTER_MIP_COUNT; mip++) {
+        uint32_t mipSize = PREFILTER_SIZE >> mip;
+        float prefilterConsts[2] = { static_cast<float>(mip) / (PREFILTER_MIP_COUNT - 1), static_cast<float>(ENV_CUBE_SIZE) };
+        vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelinePrefilter.layout,
+            0, 1, &bake.descriptorSetsPrefilter[mip], 0, nullptr);
+        vkCmdPushConstants(cmdBuf, bake.pipelinePrefilter.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(prefilterConsts), prefilterConsts);
+        vkCmdDispatch(cmdBuf, GroupCount(mipSize, BAKE_GROUP_SIZE), GroupCount(mipSize, BAKE_GROUP_SIZE), 6);
+    }
+
+    // 5. BRDF积分查找表，和环境图无关
+    CmdImageBarrier(cmdBuf, mBrdfLutImage, brdfLutRange, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelineBrdfLut.pipeline);
+    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, bake.pipelineBrdfLut.layout,
+        0, 1, &bake.descriptorSetBrdfLut, 0, nullptr);
+    vkCmdDispatch(cmdBuf, GroupCount(BRDF_LUT_SIZE, BAKE_GROUP_SIZE), GroupCount(BRDF_LUT_SIZE, BAKE_GROUP_SIZE), 1);
+
+    // 6. 读回结果写缓存，之后转为着色器只读
+    CmdImageBarrier(cmdBuf, mPrefilteredImage, prefilterRange, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    CmdImageBarrier(cmdBuf, mBrdfLutImage, brdfLutRange, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+    std::vector<VkBufferImageCopy> prefilterRegions = GetPrefilterCopyRegions();
+    VkBufferImageCopy brdfLutRegion = GetBrdfLutCopyRegion();
+    vkCmdCopyImageToBuffer(cmdBuf, mPrefilteredImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, bake.readbackBuffer,
+        prefilterRegions.size(), prefilterRegions.data());
+    vkCmdCopyImageToBuffer(cmdBuf, mBrdfLutImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, bake.readbackBuffer,
+        1, &brdfLutRegion);
+
+    CmdImageBarrier(cmdBuf, mPrefilteredImage, prefilterRange, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    CmdImageBarrier(cmdBuf, mBrdfLutImage, brdfLutRange, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    VkMemoryBarrier hostBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    hostBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+}
+
+ImageBasedLighting::IblParams ImageBasedLighting::ResolveShCoefficients(BakeResources& bake)
+{
+    vmaInvalidateAllocation(BufferCreator::GetInstance().GetAllocator(), bake.shAllocation, 0, VK_WHOLE_SIZE);
+    const glm::vec4* partialSums = static_cast<const glm::vec4*>(bake.shAddr);
+
+    glm::vec3 coeffs[SH_COEFF_COUNT] = {};
+    float weightSum = 0.0f;
+    for (uint32_t face = 0; face < 6; face++) {
+        for (uint32_t i = 0; i < SH_COEFF_COUNT; i++) {
+            coeffs[i] += glm::vec3(partialSums[face * SH_FACE_STRIDE + i]);
+        }
+        weightSum += partialSums[face * SH_FACE_STRIDE + SH_COEFF_COUNT].x;
+    }
+
+    // 离散的立体角之和归一化到4PI；再卷积余弦核，各阶分别乘PI、2PI/3、PI/4，最后除以PI，
+    // 着色器中求值的结果乘albedo就是漫反射的出射辐亮度
+    const float bandScale[3] = { 1.0f, 2.0f / 3.0f, 0.25f };
+    float normalizeScale = weightSum > 0.0f ? 4.0f * glm::pi<float>() / weightSum : 0.0f;
+    IblParams params{};
+    for (uint32_t i = 0; i < SH_COEFF_COUNT; i++) {
+        uint32_t band = i == 0 ? 0 : (i < 4 ? 1 : 2);
+        params.sh[i] = glm::vec4(coeffs[i] * normalizeScale * bandScale[band], 0.0f);
+    }
+    params.prefilterParams = glm::vec4(static_cast<float>(PREFILTER_MIP_COUNT - 1), 0.0f, 0.0f, 0.0f);
+    return params;
+}
+
+void ImageBasedLighting::CleanUpBakeResources(BakeResources& bake)
+{
+    VmaAllocator allocator = BufferCreator::GetInstance().GetAllocator();
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    vkDestroyDescriptorPool(mDevice->Get(), bake.descriptorPool, nullptr);
+    pipelineFactory.DestroyPipelineObjecst(bake.pipelineBrdfLut);
+    pipelineFactory.DestroyPipelineObjecst(bake.pipelinePrefilter);
+    pipelineFactory.DestroyPipelineObjecst(bake.pipelineShProject);
+    pipelineFactory.DestroyPipelineObjecst(bake.pipelineEquirectToCube);
+    vkDestroySampler(mDevice->Get(), bake.sampler, nullptr);
+
+    vmaDestroyBuffer(allocator, bake.readbackBuffer, bake.readbackAllocation);
+    vmaDestroyBuffer(allocator, bake.shBuffer, bake.shAllocation);
+
+    for (VkImageView view : bake.prefilterStorageViews) {
+        vkDestroyImageView(mDevice->Get(), view, nullptr);
+    }
+    vkDestroyImageView(mDevice->Get(), bake.envCubeView, nullptr);
+    vkDestroyImageView(mDevice->Get(), bake.envStorageView, nullptr);
+    vmaDestroyImage(allocator, bake.envImage, bake.envAllocation);
+    vkDestroyImageView(mDevice->Get(), bake.equirectView, nullptr);
+    vmaDestroyImage(allocator, bake.equirectImage, bake.equirectAllocation);
+    bake = {};
+}
+
+void ImageBasedLighting::SaveCache(const std::string& cachePath, uint64_t sourceKey, const IblParams& params, const void* data)
+{
+    std::error_code error;
+    std::filesystem::path parentPath = std::filesystem::path(cachePath).parent_path();
+    if (!parentPath.empty()) {
+        std::filesystem::create_directories(parentPath, error);
+    }
+
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOGW("failed to open ibl cache %s for writing", cachePath.c_str());
+        return;
+    }
+
+    CacheHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.sourceKey = sourceKey;
+    header.envCubeSize = ENV_CUBE_SIZE;
+    header.prefilterSize = PREFILTER_SIZE;
+    header.prefilterMipCount = PREFILTER_MIP_COUNT;
+    header.brdfLutSize = BRDF_LUT_SIZE;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&params), sizeof(params));
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(GetPrefilterDataSize() + GetBrdfLutDataSize()));
+    if (!file) {
+        LOGW("failed to write ibl cache %s", cachePath.c_str());
+        return;
+    }
+    LOGI("saved ibl cache %s", cachePath.c_str());
+}
+
+VkImageView ImageBasedLighting::CreateImageView(VkImage image, VkImageViewType viewType, VkFormat format,
+    uint32_t baseMip, uint32_t mipCount, uint32_t layerCount)
+{
+    VkImageViewCreateInfo viewInfo = vulkanInitializers::ImageViewCreateInfo(image, viewType, format,
+        { VK_IMAGE_ASPECT_COLOR_BIT, baseMip, mipCount, 0, layerCount });
+    VkImageView imageView = VK_NULL_HANDLE;
+    if (vkCreateImageView(mDevice->Get(), &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create ibl image view!");
+    }
+    return imageView;
+}
+
+VkSampler ImageBasedLighting::CreateSampler(VkSamplerAddressMode addressModeU, uint32_t mipCount)
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = addressModeU;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(mipCount);
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    if (vkCreateSampler(mDevice->Get(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create ibl sampler!");
+    }
+    return sampler;
+}
+
+void ImageBasedLighting::CmdImageBarrier(VkCommandBuffer cmdBuf, VkImage image, VkImageSubresourceRange range,
+    VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = range;
+    vkCmdPipelineBarrier(cmdBuf, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+std::vector<VkBufferImageCopy> ImageBasedLighting::GetPrefilterCopyRegions()
+{
+    std::vector<VkBufferImageCopy> regions(PREFILTER_MIP_COUNT);
+    VkDeviceSize offset = 0;
+    for (uint32_t mip = 0; mip < PREFILTER_MIP_COUNT; mip++) {
+        uint32_t mipSize = PREFILTER_SIZE >> mip;
+        regions[mip] = {};
+        regions[mip].bufferOffset = offset;
+        regions[mip].imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 6 };
+        regions[mip].imageExtent = { mipSize, mipSize, 1 };
+        offset += static_cast<VkDeviceSize>(mipSize) * mipSize * 6 * HDR_TEXEL_SIZE;
+    }
+    return regions;
+}
+
+VkBufferImageCopy ImageBasedLighting::GetBrdfLutCopyRegion()
+{
+    VkBufferImageCopy region{};
+    region.bufferOffset = GetPrefilterDataSize();
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { BRDF_LUT_SIZE, BRDF_LUT_SIZE, 1 };
+    return region;
+}
+
+VkDeviceSize ImageBasedLighting::GetPrefilterDataSize()
+{
+    VkDeviceSize size = 0;
+    for (uint32_t mip = 0; mip < PREFILTER_MIP_COUNT; mip++) {
+        uint32_t mipSize = PREFILTER_SIZE >> mip;
+        size += static_cast<VkDeviceSize>(mipSize) * mipSize * 6 * HDR_TEXEL_SIZE;
+    }
+    return size;
+}
+
+VkDeviceSize ImageBasedLighting::GetBrdfLutDataSize()
+{
+    return static_cast<VkDeviceSize>(BRDF_LUT_SIZE) * BRDF_LUT_SIZE * BRDF_LUT_TEXEL_SIZE;
+}
+}   // namespace framework
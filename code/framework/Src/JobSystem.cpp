@@ -0,0 +1,448 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <string>
+
+#include "CpuProfiler.h"
+#include "Log.h"
+
+#undef LOG_TAG
+#define LOG_TAG "JobSystem"
+
+namespace framework {
+namespace {
+// 当前线程对应的工作线程编号，非工作线程为-1
+thread_local int32_t tWorkerIndex = -1;
+}
+
+JobHandle::JobHandle(Job* job) : mJob(job)
+{
+    if (mJob != nullptr) {
+        mJob->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+JobHandle::JobHandle(const JobHandle& other) : JobHandle(other.mJob)
+{
+}
+
+JobHandle::~JobHandle()
+{
+    Release();
+}
+
+JobHandle& JobHandle::operator=(const JobHandle& other)
+{
+    if (mJob != other.mJob) {
+        JobHandle copy(other);
+        std::swap(mJob, copy.mJob);
+    }
+    return *this;
+}
+
+JobHandle& JobHandle::operator=(JobHandle&& other) noexcept
+{
+    if (this != &other) {
+        Release();
+        mJob = other.mJob;
+        other.mJob = nullptr;
+    }
+    return *this;
+}
+
+void JobHandle::Release()
+{
+    // 最后一个句柄释放时其他线程对Job的写入都已经可见
+    if (mJob != nullptr && mJob->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        JobSystem::GetInstance().FreeJob(mJob);
+    }
+    mJob = nullptr;
+}
+
+JobSystem& JobSystem::GetInstance()
+{
+    static JobSystem instance;
+    return instance;
+}
+
+JobSystem::~JobSystem()
+{
+    DeleteFreeJobs();
+}
+
+void JobSystem::Init(uint32_t workerCount)
+{
+    if (mInited) {
+        return;
+    }
+
+    if (workerCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    mQueues.clear();
+    for (uint32_t i = 0; i < workerCount + 1; i++) {
+        mQueues.emplace_back(std::make_unique<WorkQueue>());
+        mQueues.back()->jobs.resize(INITIAL_QUEUE_CAPACITY);
+    }
+    // 预先填充空闲链表，工作线程还持有上一批句柄时也不用新建
+    for (uint32_t i = 0; i < INITIAL_FREE_JOB_COUNT; i++) {
+        FreeJob(new Job());
+    }
+
+    mIsDestroying.store(false);
+    mQueuedJobCount.store(0);
+    mInited = true;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        mWorkers.emplace_back(&JobSystem::WorkerFunction, this, i);
+    }
+    LOGI("init with %d workers", workerCount);
+}
+
+void JobSystem::CleanUp()
+{
+    if (!mInited) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mIsDestroying.store(true);
+    }
+    mSleepCondition.notify_all();
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+
+    if (mQueuedJobCount.load() != 0) {
+        LOGW("%d jobs dropped on clean up", mQueuedJobCount.load());
+    }
+    mQueues.clear();
+    DeleteFreeJobs();
+    mInited = false;
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> func, const std::vector<JobHandle>& dependencies)
+{
+    return Schedule(std::move(func), dependencies.data(), dependencies.size());
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> func, const JobHandle* dependencies, size_t dependencyCount)
+{
+    JobHandle job = AllocateJob();
+    job->func = std::move(func);
+
+    // 先占一个计数，防止登记前置任务的过程中被提前放入队列
+    job->pendingDependencies.store(1);
+    for (size_t i = 0; i < dependencyCount; i++) {
+        const JobHandle& dependency = dependencies[i];
+        if (dependency == nullptr) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(dependency->continuationMutex);
+        if (!dependency->finished.load()) {
+            job->pendingDependencies++;
+            dependency->continuations.emplace_back(job);
+        }
+    }
+
+    if (job->pendingDependencies.fetch_sub(1) == 1) {
+        Enqueue(job);
+    }
+    return job;
+}
+
+JobHandle JobSystem::Then(const JobHandle& job, std::function<void()> func)
+{
+    // 单个前置任务不构造vector，避免每次调用都分配内存
+    return Schedule(std::move(func), &job, 1);
+}
+
+void JobSystem::Wait(const JobHandle& job)
+{
+    if (job == nullptr) {
+        return;
+    }
+    while (!job->finished.load()) {
+        if (!TryRunOneJob()) {
+            std::this_thread::yield();
+        }
+    }
+    if (job->exception != nullptr) {
+        std::rethrow_exception(job->exception);
+    }
+}
+
+void JobSystem::WaitAll(const std::vector<JobHandle>& jobs)
+{
+    // 先等全部完成，任务可能引用调用者栈上的数据，不能提前返回
+    std::exception_ptr firstException = nullptr;
+    for (const JobHandle& job : jobs) {
+        try {
+            Wait(job);
+        } catch (...) {
+            if (firstException == nullptr) {
+                firstException = std::current_exception();
+            }
+        }
+    }
+    if (firstException != nullptr) {
+        std::rethrow_exception(firstException);
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& func)
+{
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max(grainSize, 1u);
+
+    // 状态放在调用者栈上，区间任务只捕获它的地址，不需要保存每个任务的句柄
+    struct ParallelForState {
+        const std::function<void(uint32_t begin, uint32_t end)>* func = nullptr;
+        std::atomic<uint32_t> remainingCount = 0;
+        std::mutex exceptionMutex;
+        std::exception_ptr firstException = nullptr;
+    };
+    ParallelForState state{};
+    state.func = &func;
+    state.remainingCount.store((count + grainSize - 1) / grainSize);
+
+    for (uint32_t begin = 0; begin < count; begin += grainSize) {
+        uint32_t end = std::min(begin + grainSize, count);
+        Schedule([&state, begin, end]() {
+            try {
+                (*state.func)(begin, end);
+            } catch (...) {
+                std::unique_lock<std::mutex> lock(state.exceptionMutex);
+                if (state.firstException == nullptr) {
+                    state.firstException = std::current_exception();
+                }
+            }
+            // 这是最后一次访问state，之后调用者可能已经返回
+            state.remainingCount.fetch_sub(1);
+        });
+    }
+
+    // 先等全部完成，区间任务引用了栈上的state，不能提前返回
+    while (state.remainingCount.load() > 0) {
+        if (!TryRunOneJob()) {
+            std::this_thread::yield();
+        }
+    }
+    if (state.firstException != nullptr) {
+        std::rethrow_exception(state.firstException);
+    }
+}
+
+void JobSystem::WorkerFunction(uint32_t workerIndex)
+{
+    tWorkerIndex = static_cast<int32_t>(workerIndex);
+    CPU_PROFILE_THREAD_NAME(("Worker " + std::to_string(workerIndex)).c_str());
+
+    while (!mIsDestroying.load()) {
+        if (TryRunOneJob()) {
+            continue;
+        }
+
+        // 所有队列都空了，休眠等待新任务
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleepCondition.wait(lock, [this]() { return mIsDestroying.load() || mQueuedJobCount.load() > 0; });
+    }
+
+    tWorkerIndex = -1;
+}
+
+JobHandle JobSystem::AllocateJob()
+{
+    Job* job = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mFreeJobMutex);
+        if (mFreeJobs != nullptr) {
+            job = mFreeJobs;
+            mFreeJobs = job->nextFree;
+            mFreeJobCount--;
+        }
+    }
+    if (job == nullptr) {
+        // 空闲链表为空时新建，释放后进入链表
+        job = new Job();
+    }
+    job->nextFree = nullptr;
+    job->pendingDependencies.store(0);
+    job->finished.store(false);
+    return JobHandle(job);
+}
+
+void JobSystem::FreeJob(Job* job)
+{
+    // 先在锁外释放捕获的资源，析构中可能再释放别的句柄
+    job->func = nullptr;
+    job->continuations.clear();
+    job->exception = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mFreeJobMutex);
+        if (mFreeJobCount < MAX_FREE_JOB_COUNT) {
+            job->nextFree = mFreeJobs;
+            mFreeJobs = job;
+            mFreeJobCount++;
+            return;
+        }
+    }
+    delete job;
+}
+
+void JobSystem::DeleteFreeJobs()
+{
+    Job* job = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mFreeJobMutex);
+        job = mFreeJobs;
+        mFreeJobs = nullptr;
+        mFreeJobCount = 0;
+    }
+    while (job != nullptr) {
+        Job* next = job->nextFree;
+        delete job;
+        job = next;
+    }
+}
+
+void JobSystem::Enqueue(const JobHandle& job)
+{
+    if (!mInited) {
+        // 没有工作线程时直接在当前线程执行
+        Execute(job);
+        return;
+    }
+
+    uint32_t queueIndex = tWorkerIndex >= 0 ? static_cast<uint32_t>(tWorkerIndex) : static_cast<uint32_t>(mQueues.size() - 1);
+    {
+        std::unique_lock<std::mutex> lock(mQueues[queueIndex]->mutex);
+        mQueues[queueIndex]->PushBack(job);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mQueuedJobCount++;
+    }
+    mSleepCondition.notify_one();
+}
+
+bool JobSystem::TryRunOneJob()
+{
+    if (!mInited) {
+        return false;
+    }
+
+    JobHandle job = nullptr;
+    if (tWorkerIndex >= 0) {
+        job = PopLocal(static_cast<uint32_t>(tWorkerIndex));
+    }
+    if (job == nullptr) {
+        job = Steal(tWorkerIndex >= 0 ? static_cast<uint32_t>(tWorkerIndex) : static_cast<uint32_t>(mQueues.size() - 1));
+    }
+    if (job == nullptr) {
+        return false;
+    }
+
+    mQueuedJobCount--;
+    Execute(job);
+    return true;
+}
+
+JobHandle JobSystem::PopLocal(uint32_t queueIndex)
+{
+    // 本线程从队尾取，最近提交的任务数据还在缓存里
+    WorkQueue& queue = *mQueues[queueIndex];
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    return queue.PopBack();
+}
+
+JobHandle JobSystem::Steal(uint32_t thiefIndex)
+{
+    // 从其他队列的队头窃取，包括外部线程共享的队列
+    uint32_t queueCount = static_cast<uint32_t>(mQueues.size());
+    for (uint32_t i = 0; i < queueCount; i++) {
+        uint32_t victimIndex = (thiefIndex + i) % queueCount;
+        WorkQueue& queue = *mQueues[victimIndex];
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        JobHandle job = queue.PopFront();
+        if (job != nullptr) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Execute(const JobHandle& job)
+{
+    if (job->func) {
+        CPU_PROFILE_SCOPE("Job");
+        // 异常不能离开工作线程，否则整个进程terminate；也不能跳过下面的标记，否则等待者永远不会返回
+        try {
+            job->func();
+        } catch (const std::exception& e) {
+            LOGE("job failed: %s", e.what());
+            job->exception = std::current_exception();
+        } catch (...) {
+            LOGE("job failed with unknown exception");
+            job->exception = std::current_exception();
+        }
+        // 尽早释放捕获的资源，Job本身等句柄全部释放后回到空闲链表
+        job->func = nullptr;
+    }
+
+    // 标记完成，之后不会再有新的后继任务登记进来，可以不加锁遍历
+    {
+        std::unique_lock<std::mutex> lock(job->continuationMutex);
+        job->finished.store(true);
+    }
+    for (JobHandle& continuation : job->continuations) {
+        if (continuation->pendingDependencies.fetch_sub(1) == 1) {
+            Enqueue(continuation);
+        }
+    }
+    // clear保留容量，复用时登记后继任务不需要重新分配
+    job->continuations.clear();
+}
+
+void JobSystem::WorkQueue::PushBack(const JobHandle& job)
+{
+    if (count == jobs.size()) {
+        // 按顺序搬到新的缓冲里，队头从0开始
+        std::vector<JobHandle> grown(std::max(jobs.size() * 2, INITIAL_QUEUE_CAPACITY));
+        for (size_t i = 0; i < count; i++) {
+            grown[i] = std::move(jobs[(head + i) % jobs.size()]);
+        }
+        jobs.swap(grown);
+        head = 0;
+    }
+    jobs[(head + count) % jobs.size()] = job;
+    count++;
+}
+
+JobHandle JobSystem::WorkQueue::PopBack()
+{
+    if (count == 0) {
+        return nullptr;
+    }
+    count--;
+    // move后槽位为空，不会让Job一直被队列引用而无法复用
+    return std::move(jobs[(head + count) % jobs.size()]);
+}
+
+JobHandle JobSystem::WorkQueue::PopFront()
+{
+    if (count == 0) {
+        return nullptr;
+    }
+    JobHandle job = std::move(jobs[head]);
+    head = (head + 1) % jobs.size();
+    count--;
+    return job;
+}
+}   // namespace framework
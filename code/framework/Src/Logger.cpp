@@ -0,0 +1,243 @@
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace framework {
+namespace {
+// 每个线程的队列由Logger持有
+thread_local void* tlsLogThreadQueue = nullptr;
+
+constexpr auto WRITER_INTERVAL = std::chrono::milliseconds(10);
+
+int64_t NowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+char LevelChar(LogLevel level)
+{
+    switch (level) {
+    case LOG_LEVEL_DEBUG:
+        return 'D';
+    case LOG_LEVEL_INFO:
+        return 'I';
+    case LOG_LEVEL_WARN:
+        return 'W';
+    default:
+        return 'E';
+    }
+}
+}
+
+Logger& Logger::GetInstance()
+{
+    static Logger instance;
+    return instance;
+}
+
+Logger::~Logger()
+{
+    if (mWriterThread == nullptr) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mWriterMutex);
+        mIsDestroying.store(true);
+        mWriterCondition.notify_one();
+    }
+    mWriterThread->join();
+    mWriterThread = nullptr;
+}
+
+void Logger::Log(LogSite* site, LogLevel level, const char* tag, const char* format, ...)
+{
+    if (!IsEnabled(level, tag)) {
+        return;
+    }
+    uint32_t suppressedCount = 0;
+    if (site != nullptr && !CheckRateLimit(*site, suppressedCount)) {
+        return;
+    }
+    std::call_once(mWriterStartFlag, [this]() { StartWriter(); });
+
+    LogRecord record;
+    record.timestampUs = NowUs();
+    record.tag = tag;
+    record.level = level;
+    record.suppressedCount = suppressedCount;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(record.message, MAX_MESSAGE_LENGTH, format, args);
+    va_end(args);
+
+    ThreadQueue* threadQueue = GetThreadQueue();
+    record.threadIndex = threadQueue->threadIndex;
+    if (site == nullptr) {
+        // 不限频的日志(列表输出)只在初始化时出现，队列满了就等写线程腾出空间
+        while (!threadQueue->queue.TryPush(record)) {
+            mWriterCondition.notify_one();
+            std::this_thread::yield();
+        }
+    }
+    else if (!threadQueue->queue.TryPush(record)) {
+        threadQueue->droppedCount++;
+    }
+
+    // 错误尽快输出
+    if (level >= LOG_LEVEL_ERROR) {
+        mUrgent.store(true);
+        mWriterCondition.notify_one();
+    }
+}
+
+void Logger::SetTagLevel(const char* tag, LogLevel level)
+{
+    std::lock_guard<std::mutex> lock(mTagFilterMutex);
+    uint32_t count = mTagFilterCount.load();
+    for (uint32_t i = 0; i < count; i++) {
+        if (strcmp(mTagFilters[i].tag, tag) == 0) {
+            mTagFilters[i].level.store(level);
+            return;
+        }
+    }
+    if (count >= MAX_TAG_FILTERS) {
+        fprintf(stderr, "[W] Logger: too many tag filters, %s ignored\n", tag);
+        return;
+    }
+    snprintf(mTagFilters[count].tag, MAX_TAG_LENGTH, "%s", tag);
+    mTagFilters[count].level.store(level);
+    mTagFilterCount.store(count + 1, std::memory_order_release);
+}
+
+void Logger::Flush()
+{
+    if (mWriterThread == nullptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mWriterMutex);
+    uint64_t ticket = ++mFlushRequested;
+    mWriterCondition.notify_one();
+    mFlushCondition.wait(lock, [this, ticket]() { return mFlushFinished >= ticket || mIsDestroying.load(); });
+}
+
+bool Logger::IsEnabled(LogLevel level, const char* tag)
+{
+    // 设置过的tag优先于全局等级
+    uint32_t count = mTagFilterCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        if (strcmp(mTagFilters[i].tag, tag) == 0) {
+            return level >= mTagFilters[i].level.load(std::memory_order_relaxed);
+        }
+    }
+    return level >= mLevel.load(std::memory_order_relaxed);
+}
+
+bool Logger::CheckRateLimit(LogSite& site, uint32_t& suppressedCount)
+{
+    int64_t nowMs = NowUs() / 1000;
+    int64_t windowBeginMs = site.windowBeginMs.load(std::memory_order_relaxed);
+    if (nowMs - windowBeginMs >= 1000 && site.windowBeginMs.compare_exchange_strong(windowBeginMs, nowMs)) {
+        site.windowCount.store(0);
+    }
+    if (site.windowCount.fetch_add(1) >= RATE_LIMIT_PER_SECOND) {
+        site.suppressedCount++;
+        return false;
+    }
+    suppressedCount = site.suppressedCount.exchange(0);
+    return true;
+}
+
+Logger::ThreadQueue* Logger::GetThreadQueue()
+{
+    if (tlsLogThreadQueue != nullptr) {
+        return static_cast<ThreadQueue*>(tlsLogThreadQueue);
+    }
+
+    // 每个线程只在第一次输出时上锁注册
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    mThreadQueues.emplace_back(std::make_unique<ThreadQueue>());
+    ThreadQueue* threadQueue = mThreadQueues.back().get();
+    threadQueue->threadIndex = static_cast<uint32_t>(mThreadQueues.size() - 1);
+    tlsLogThreadQueue = threadQueue;
+    return threadQueue;
+}
+
+void Logger::StartWriter()
+{
+    mWriteBatch.reserve(THREAD_QUEUE_SIZE);
+    mWriterThread = std::make_unique<std::thread>(&Logger::WriterFunction, this);
+}
+
+void Logger::WriterFunction()
+{
+    while (true) {
+        uint64_t flushTicket = 0;
+        bool isDestroying = false;
+        {
+            std::unique_lock<std::mutex> lock(mWriterMutex);
+            mWriterCondition.wait_for(lock, WRITER_INTERVAL, [this]() {
+                return mIsDestroying.load() || mUrgent.load() || mFlushRequested != mFlushFinished;
+            });
+            flushTicket = mFlushRequested;
+            isDestroying = mIsDestroying.load();
+            mUrgent.store(false);
+        }
+
+        DrainQueues();
+        fflush(stdout);
+
+        {
+            std::unique_lock<std::mutex> lock(mWriterMutex);
+            mFlushFinished = flushTicket;
+            mFlushCondition.notify_all();
+        }
+        if (isDestroying) {
+            break;
+        }
+    }
+}
+
+uint32_t Logger::DrainQueues()
+{
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+
+    // 各线程的记录按时间排序后再输出
+    mWriteBatch.clear();
+    for (auto& threadQueue : mThreadQueues) {
+        LogRecord record;
+        while (threadQueue->queue.TryPop(record)) {
+            mWriteBatch.emplace_back(record);
+        }
+    }
+    std::stable_sort(mWriteBatch.begin(), mWriteBatch.end(),
+        [](const LogRecord& a, const LogRecord& b) { return a.timestampUs < b.timestampUs; });
+    for (const LogRecord& record : mWriteBatch) {
+        WriteRecord(record);
+    }
+
+    for (auto& threadQueue : mThreadQueues) {
+        uint32_t droppedCount = threadQueue->droppedCount.exchange(0);
+        if (droppedCount > 0) {
+            printf("[W] Logger: log queue of thread %d full, %d messages dropped\n", threadQueue->threadIndex, droppedCount);
+        }
+    }
+    return static_cast<uint32_t>(mWriteBatch.size());
+}
+
+void Logger::WriteRecord(const LogRecord& record)
+{
+    if (record.suppressedCount > 0) {
+        printf("[%c] %s: %s (%d similar messages suppressed)\n",
+            LevelChar(record.level), record.tag, record.message, record.suppressedCount);
+    }
+    else {
+        printf("[%c] %s: %s\n", LevelChar(record.level), record.tag, record.message);
+    }
+}
+}   // namespace framework
@@ -0,0 +1,148 @@
+#include "ParallelCommandRecorder.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+
+#include "VulkanInitializers.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "AppDispatchTable.h"
+
+#undef LOG_TAG
+#define LOG_TAG "ParallelCommandRecorder"
+
+namespace framework {
+void ParallelCommandRecorder::Init(Device* device, uint32_t workerCount, uint32_t framesInFlight)
+{
+    if (device == nullptr || !device->IsValid()) {
+        throw std::runtime_error("can not init ParallelCommandRecorder with a null or invalid device!");
+    }
+
+    mDevice = device;
+    if (workerCount == 0) {
+        workerCount = JobSystem::GetInstance().GetWorkerCount() + 1;
+    }
+    mWorkerCount = std::max(workerCount, 1u);
+    mActiveWorkerCount = mWorkerCount;
+    mFramesInFlight = std::max(framesInFlight, 1u);
+
+    CreateCommandPools();
+
+    mWorkerCommandBuffers.resize(mWorkerCount, VK_NULL_HANDLE);
+    mSecondaryCommandBuffers.reserve(mWorkerCount);
+    LOGI("init with %d ranges, %d frames in flight", mWorkerCount, mFramesInFlight);
+}
+
+void ParallelCommandRecorder::CleanUp()
+{
+    CleanUpCommandPools();
+    mDevice = nullptr;
+}
+
+void ParallelCommandRecorder::SetActiveWorkerCount(uint32_t count)
+{
+    mActiveWorkerCount = std::clamp(count, 1u, mWorkerCount);
+}
+
+std::vector<VkCommandBuffer>& ParallelCommandRecorder::Record(const SecondaryRecordInfo& recordInfo, const RecordFunc& recordFunc)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    mRecordInfo = recordInfo;
+    mRecordInfo.frameIndex = recordInfo.frameIndex % mFramesInFlight;
+    mInheritanceInfo = vulkanInitializers::CommandBufferInheritanceInfo(
+        recordInfo.renderPass, recordInfo.subpass, recordInfo.framebuffer);
+    mInheritanceInfo.pNext = recordInfo.renderingInfo;
+    mRecordFunc = &recordFunc;
+    std::fill(mWorkerCommandBuffers.begin(), mWorkerCommandBuffers.end(), VK_NULL_HANDLE);
+
+    // 每一段作为一个任务，调用线程在等待期间也会参与录制
+    JobSystem::GetInstance().ParallelFor(mActiveWorkerCount, 1, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t rangeIndex = begin; rangeIndex < end; rangeIndex++) {
+            RecordRange(rangeIndex);
+        }
+    });
+    mRecordFunc = nullptr;
+
+    // 按段编号收集，保证绘制顺序与切分前一致
+    mSecondaryCommandBuffers.clear();
+    for (VkCommandBuffer cmdBuf : mWorkerCommandBuffers) {
+        if (cmdBuf != VK_NULL_HANDLE) {
+            mSecondaryCommandBuffers.emplace_back(cmdBuf);
+        }
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+    mLastRecordTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    return mSecondaryCommandBuffers;
+}
+
+void ParallelCommandRecorder::CreateCommandPools()
+{
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;  // 每帧整体重置，不需要单独reset命令缓冲
+    poolInfo.queueFamilyIndex = mDevice->GetPhysicalDevice()->GetQueueFamilyIndices().graphicsFamily.value();
+
+    mFrameResources.resize(mFramesInFlight);
+    for (auto& workerResources : mFrameResources) {
+        workerResources.resize(mWorkerCount);
+        for (auto& resource : workerResources) {
+            if (vkCreateCommandPool(mDevice->Get(), &poolInfo, nullptr, &resource.commandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create worker command pool!");
+            }
+
+            VkCommandBufferAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandPool = resource.commandPool;
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocateInfo.commandBufferCount = 1;
+            if (vkAllocateCommandBuffers(mDevice->Get(), &allocateInfo, &resource.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate secondary command buffers!");
+            }
+        }
+    }
+}
+
+void ParallelCommandRecorder::CleanUpCommandPools()
+{
+    for (auto& workerResources : mFrameResources) {
+        for (auto& resource : workerResources) {
+            // 销毁命令池时会一并释放其中的命令缓冲
+            vkDestroyCommandPool(mDevice->Get(), resource.commandPool, nullptr);
+        }
+    }
+    mFrameResources.clear();
+}
+
+void ParallelCommandRecorder::RecordRange(uint32_t rangeIndex)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // 均分绘制列表，最后一段可能较短或为空
+    uint32_t drawsPerRange = (mRecordInfo.drawCount + mActiveWorkerCount - 1) / mActiveWorkerCount;
+    uint32_t firstDraw = std::min(rangeIndex * drawsPerRange, mRecordInfo.drawCount);
+    uint32_t drawCount = std::min(drawsPerRange, mRecordInfo.drawCount - firstDraw);
+    if (drawCount == 0) {
+        return;
+    }
+
+    WorkerFrameResources& resource = mFrameResources[mRecordInfo.frameIndex][rangeIndex];
+    dispatch.ResetCommandPool(mDevice->Get(), resource.commandPool, 0);
+
+    VkCommandBufferBeginInfo beginInfo = vulkanInitializers::CommandBufferBeginInfo(&mInheritanceInfo);
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    if (dispatch.BeginCommandBuffer(resource.commandBuffer, &beginInfo) != VK_SUCCESS) {
+        LOGE("range %d failed to begin secondary command buffer!", rangeIndex);
+        return;
+    }
+
+    (*mRecordFunc)(resource.commandBuffer, rangeIndex, firstDraw, drawCount);
+
+    if (dispatch.EndCommandBuffer(resource.commandBuffer) != VK_SUCCESS) {
+        LOGE("range %d failed to record secondary command buffer!", rangeIndex);
+        return;
+    }
+    mWorkerCommandBuffers[rangeIndex] = resource.commandBuffer;
+}
+}   // namespace framework
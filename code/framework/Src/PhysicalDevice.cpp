@@ -230,6 +230,15 @@ PhysicalDevice::QueueFamilyIndices PhysicalDevice::FindQueueFamilies(VkPhysicalD
 	// 寻找想要的queueFamily，记录索引
 	int i = 0;
 	for (const auto& queueFamily : queueFamilies) {
+		// 找支持计算但不支持图形的队列，这样的队列族才能和图形队列并行
+		if (!indices.computeFamily.has_value() &&
+			(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+			indices.computeFamily = i;
+		}
+		if (indices.IsComplete()) {
+			i++;
+			continue;
+		}
 		// 找支持图形的队列
 		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
 			indices.graphicsFamily = i;
@@ -240,7 +249,6 @@ PhysicalDevice::QueueFamilyIndices PhysicalDevice::FindQueueFamilies(VkPhysicalD
 		if (presentSupport) {
 			indices.presentFamily = i;
 		}
-		if (indices.IsComplete()) break;
 		i++;
 	}
 
@@ -103,7 +103,7 @@ PipelineObjecs PipelineFactory::CreateGraphicsPipelineCoreLogic(const GraphicsPi
         return {};
     }
 
-    if (configInfo.mRenderPass == VK_NULL_HANDLE) {
+    if (configInfo.mRenderPass == VK_NULL_HANDLE && !configInfo.UseDynamicRendering()) {
         LOGI("render pass is none on create graphics pipeline");
         return {};
     }
@@ -212,7 +212,7 @@ std::vector<VkPipelineShaderStageCreateInfo> PipelineFactory::CreateShaderStages
         shaderStage.stage = shaderInfo.stage;
         shaderStage.module = shaderModule;
         shaderStage.pName = "main";
-        shaderStage.pSpecializationInfo = nullptr;
+        shaderStage.pSpecializationInfo = shaderInfo.specializationInfo;
 
         result.emplace_back(shaderStage);
     }
@@ -243,7 +243,7 @@ VkPipelineShaderStageCreateInfo PipelineFactory::CreateShaderStage(const ShaderF
     shaderStage.stage = shaderFileInfo.stage;
     shaderStage.module = shaderModule;
     shaderStage.pName = "main";
-    shaderStage.pSpecializationInfo = nullptr;
+    shaderStage.pSpecializationInfo = shaderFileInfo.specializationInfo;
 
     return shaderStage;
 }
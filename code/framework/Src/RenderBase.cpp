@@ -8,6 +8,7 @@
 #include "DebugUtils.h"
 #include "WindowTemplate.h"
 #include "AppDispatchTable.h"
+#include "FramePacer.h"
 #include "SceneDemoDefs.h"
 #include "Log.h"
 
@@ -52,9 +53,11 @@ void RenderBase::Init() {
     }
     RequestPhysicalDeviceFeatures(mPhysicalDevice);
     mDevice->Init(mPhysicalDevice);
-    AppDeviceDispatchTable::GetInstance().InitDevice(mInstance, mDevice->Get());
+    AppDeviceDispatchTable::GetInstance().InitDevice(mDevice->Get());
 
-    // swapchain
+    // swapchain，显示模式由帧节奏模式决定
+    mSwapchain->SetPresentModeCandidates(FramePacer::GetPresentModeCandidates(GetConfig().pacing.mode));
+    mSwapchain->SetReadbackEnabled(GetConfig().swapchain.enableReadback);
     mSwapchain->Init(mPhysicalDevice, mDevice, mWindow.GetWindowExtent(), mSurface);
 }
 
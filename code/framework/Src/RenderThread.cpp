@@ -2,13 +2,23 @@
 #include <iostream>
 #include <stdexcept>
 #include <array>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
 
 #include "WindowTemplate.h"
 #include "Utils.h"
 #include "DebugUtils.h"
 #include "VulkanInitializers.h"
 #include "BufferCreator.h"
+#include "DeletionQueue.h"
+#include "JobSystem.h"
+#include "GpuProfiler.h"
+#include "CpuProfiler.h"
+#include "AllocationCounter.h"
 #include "Log.h"
+#include "AppDispatchTable.h"
 
 #undef LOG_TAG
 #define LOG_TAG "RenderThread"
@@ -26,85 +36,316 @@ RenderThread::~RenderThread()
 }
 
 void RenderThread::OnThreadInit() {
+    CPU_PROFILE_THREAD_NAME("RenderThread");
     RenderBase::Init();
     BufferCreator::GetInstance().Init(RenderBase::mDevice);
+    DeletionQueue::GetInstance().Init(RenderBase::mDevice);
+    FrameArena::GetInstance().Init(FRAME_ARENA_CAPACITY);
+    JobSystem::GetInstance().Init();
 
     mDepthFormat = RenderBase::FindSupportedFormat();
 
     // create render objects
     CreateSyncObjects();
-    CreatePresentRenderPass();
+    if (!GetConfig().presentFb.dynamicRendering) {
+        CreatePresentRenderPass();
+    }
     CreateAttachments();
     CreateFramebuffers();
+    GpuProfiler::GetInstance().Init(mDevice, 2, GetConfig().deviceFeatures.pipelineStatisticsQuery);
+    CreateProfileCommandBuffers();
+
+    mFramePacer.Init(GetConfig().pacing);
+    mRequestedPacingMode.store(GetConfig().pacing.mode);
+    mSceneStartTime = std::chrono::steady_clock::now();
+    mSceneFrameIndex = 0;
 
     RenderInitInfo initInfo{};
     initInfo.presentRenderPass = mPresentRenderPass;
     initInfo.device = mDevice;
     initInfo.swapchainExtent = mSwapchain->GetExtent();
+    initInfo.dynamicRendering = GetConfig().presentFb.dynamicRendering;
+    initInfo.presentColorFormat = mSwapchain->GetFormat();
+    initInfo.presentDepthFormat = mDepthFormat;
+    initInfo.presentSampleCount = GetConfig().presentFb.msaaSampleCount;
     mSceneRender->Init(initInfo);
+
+    if (mBenchmark != nullptr) {
+        mBenchmark->Init(mBenchmarkConfig, mBenchmarkSceneName, mDevice);
+    }
+    if (mReplaying) {
+        mReadbackCmd = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        if (!mFrameCapture.Load(mReplayPath)) {
+            LOGE("nothing to replay");
+            mBenchmarkResult.store(EXIT_FAILURE);
+            mReplayFinished = true;
+            mWindow.RequestClose();
+        }
+    }
 }
 
 void RenderThread::OnThreadLoop() {
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    CPU_PROFILE_SCOPE("Frame");
+    // 上一帧的临时内存全部失效，从这里开始统计本帧的堆分配
+    mFrameAllocationBase = AllocationCounter::GetThreadCount();
+    FrameArena::GetInstance().Reset();
+    ApplyFramePacingMode();
+    if (mReplaying && !PrepareReplayFrame()) {
+        return;
+    }
+    mFramePacer.BeginFrame();
+
     // 等待前一帧结束(等待队列中的命令执行完)，然后上锁，表示开始画了
-    vkWaitForFences(RenderBase::mDevice->Get(), 1, &mInFlightFence, VK_TRUE, UINT64_MAX);
+    {
+        CPU_PROFILE_SCOPE("WaitFence");
+        dispatch.WaitForFences(RenderBase::mDevice->Get(), 1, &mInFlightFence, VK_TRUE, UINT64_MAX);
+    }
+    // 窗口拖动时两帧之间的多次大小变化合并成一次重建
+    if (mFramebufferResized.exchange(false) || mSwapchainOutOfDate) {
+        std::chrono::steady_clock::time_point resizeBegin = std::chrono::steady_clock::now();
+        Resize();
+        mFramePacer.AddResizeTime(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - resizeBegin).count());
+    }
+
+    // 收集CPU和GPU计时，GPU结果来自之前的帧
+    GpuProfiler& gpuProfiler = GpuProfiler::GetInstance();
+    gpuProfiler.BeginFrame();
+    float gpuFrameTimeMs = gpuProfiler.GetLastScopeTimeMs("Frame");
+    CpuProfiler::GetInstance().Collect();
+    if (mProfileDumpRequested.exchange(false)) {
+        gpuProfiler.PrintAverageTable();
+        CpuProfiler::GetInstance().WriteChromeTrace("frame_trace.json");
+    }
 
     // 获取图像
     uint32_t imageIndex;
-    if (!mSwapchain->AcquireImage(mImageAvailableSemaphore, imageIndex)) {
-        Resize();
+    bool acquired = false;
+    {
+        CPU_PROFILE_SCOPE("Acquire");
+        acquired = mSwapchain->AcquireImage(mImageAvailableSemaphore, imageIndex);
+    }
+    if (!acquired) {
+        mSwapchainOutOfDate = true;
         return;
     }
 
-    vkResetFences(RenderBase::mDevice->Get(), 1, &mInFlightFence);
+    dispatch.ResetFences(RenderBase::mDevice->Get(), 1, &mInFlightFence);
 
-    // 处理输入事件
-    InputEventInfo inputEvent{};
+    // 处理输入事件，LOW_LATENCY模式下会先等待到预测的开始时间
     {
-        std::unique_lock<std::mutex> lock();
-        inputEvent = mInputInfo;
+        CPU_PROFILE_SCOPE("InputSamplingWait");
+        mFramePacer.WaitForInputSampling();
+    }
+    {
+        CPU_PROFILE_SCOPE("Input");
+        ConsumeInputEvents();
+        if (mReplaying) {
+            mInputInfo = mFrameCapture.GetFrames()[mReplayFrameIndex].input;
+            mSceneRender->ProcessInputEvent(mInputInfo);
+        }
+        else if (mBenchmark != nullptr) {
+            mBenchmark->BeginFrame(mSceneRender->GetCamera());
+        }
+        else {
+            mSceneRender->ProcessInputEvent(mInputInfo);
+            UpdateCameraPathRecording();
+        }
     }
-    mSceneRender->ProcessInputEvent(inputEvent);
 
     // 记录命令
     RenderInputInfo renderInput{};
     renderInput.presentRenderPass = mPresentRenderPass;
     renderInput.swapchainExtent = mSwapchain->GetExtent();
-    renderInput.swapchanFb = mSwapchainFramebuffers[imageIndex];
-    std::vector<VkCommandBuffer>& commandBuffers = mSceneRender->RecordCommand(renderInput);
+    renderInput.swapchanFb = mSwapchainFramebuffers.empty() ? VK_NULL_HANDLE : mSwapchainFramebuffers[imageIndex];
+    renderInput.presentAttachments.swapchainImage = mSwapchain->GetImages()[imageIndex];
+    renderInput.presentAttachments.swapchainImageView = mSwapchain->GetImageViews()[imageIndex];
+    renderInput.presentAttachments.colorImage = mColorImage;
+    renderInput.presentAttachments.colorImageView = mColorImageView;
+    renderInput.presentAttachments.depthImage = mDepthImage;
+    renderInput.presentAttachments.depthImageView = mDepthImageView;
+    renderInput.frameTiming = mFramePacer.GetTimingInfo();
+    renderInput.timeSec = GetSceneTimeSec();
+
+    // 先重置本帧的query再录制场景，场景中的scope都在"Frame"之内
+    VkCommandBufferBeginInfo profileBeginInfo = vulkanInitializers::CommandBufferBeginInfo(nullptr);
+    profileBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    dispatch.ResetCommandBuffer(mProfileBeginCmd, 0);
+    dispatch.BeginCommandBuffer(mProfileBeginCmd, &profileBeginInfo);
+    gpuProfiler.CmdResetQueries(mProfileBeginCmd);
+    uint32_t frameScope = gpuProfiler.CmdBeginScope(mProfileBeginCmd, "Frame");
+    dispatch.EndCommandBuffer(mProfileBeginCmd);
+
+    // 上一帧的计算结束之后才能重新录制计算命令
+    {
+        CPU_PROFILE_SCOPE("WaitAsyncCompute");
+        WaitAsyncCompute();
+    }
+    // 上一帧的图形和计算都已经结束，释放它之前交给延迟销毁的资源
+    DeletionQueue::GetInstance().BeginFrame();
+
+    std::vector<VkCommandBuffer>* sceneCommandBuffers = nullptr;
+    AsyncComputeInfo asyncCompute{};
+    bool hasAsyncCompute = false;
+    {
+        CPU_PROFILE_SCOPE("RecordCommand");
+        sceneCommandBuffers = &mSceneRender->RecordCommand(renderInput);
+        hasAsyncCompute = mAsyncComputeSemaphore != VK_NULL_HANDLE && mSceneRender->GetAsyncCompute(asyncCompute) &&
+            asyncCompute.commandBuffer != VK_NULL_HANDLE && asyncCompute.dependencyCount < sceneCommandBuffers->size();
+    }
+
+    dispatch.ResetCommandBuffer(mProfileEndCmd, 0);
+    dispatch.BeginCommandBuffer(mProfileEndCmd, &profileBeginInfo);
+    gpuProfiler.CmdEndScope(mProfileEndCmd, frameScope);
+    dispatch.EndCommandBuffer(mProfileEndCmd);
+
+    FrameVector<VkCommandBuffer> commandBuffers = {};
+    if (!sceneCommandBuffers->empty()) {
+        commandBuffers.reserve(sceneCommandBuffers->size() + 3);
+        commandBuffers.emplace_back(mProfileBeginCmd);
+        commandBuffers.insert(commandBuffers.end(), sceneCommandBuffers->begin(), sceneCommandBuffers->end());
+        if (mReplaying && RecordReadbackCommand(imageIndex)) {
+            commandBuffers.emplace_back(mReadbackCmd);
+        }
+        commandBuffers.emplace_back(mProfileEndCmd);
+    }
 
     // 提交命令
-    std::vector<VkSemaphore> imageAvailiableSemaphore = { mImageAvailableSemaphore };
-    std::vector<VkPipelineStageFlags> waitStages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    std::vector<VkSemaphore> renderFinishedSemaphore = { mRenderFinishedSemaphore };
-    if (!commandBuffers.empty()) {
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    if (!commandBuffers.empty() && hasAsyncCompute) {
+        CPU_PROFILE_SCOPE("Submit");
+        int64_t submitCpuNs = 0;
+        if (SubmitWithAsyncCompute(commandBuffers, asyncCompute, submitCpuNs)) {
+            gpuProfiler.EndFrame(true, submitCpuNs);
+        }
+    }
+    else if (!commandBuffers.empty()) {
+        CPU_PROFILE_SCOPE("Submit");
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.waitSemaphoreCount = imageAvailiableSemaphore.size();
-        submitInfo.pWaitSemaphores = imageAvailiableSemaphore.data();    // 指定要等待的信号量
-        submitInfo.pWaitDstStageMask = waitStages.data();      // 指定等待的阶段（颜色附件可写入）
-        submitInfo.commandBufferCount = commandBuffers.size();
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &mImageAvailableSemaphore;    // 指定要等待的信号量
+        submitInfo.pWaitDstStageMask = &waitStage;      // 指定等待的阶段（颜色附件可写入）
+        submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
         submitInfo.pCommandBuffers = commandBuffers.data();
-        submitInfo.signalSemaphoreCount = renderFinishedSemaphore.size();
-        submitInfo.pSignalSemaphores = renderFinishedSemaphore.data();    // 指定命令执行完触发mRenderFinishedSemaphore，意思是等我画完再返回交换链
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &mRenderFinishedSemaphore;    // 指定命令执行完触发mRenderFinishedSemaphore，意思是等我画完再返回交换链
         // 把命令提交到图形队列中，第三个参数指定命令执行完毕后触发mInFlightFence，告诉CPU当前帧画完可以画下一帧了（解锁）
-        if (vkQueueSubmit(RenderBase::mDevice->GetGraphicsQueue(), 1, &submitInfo, mInFlightFence) != VK_SUCCESS) {
+        int64_t submitCpuNs = CpuProfiler::NowNs();
+        if (dispatch.QueueSubmit(RenderBase::mDevice->GetGraphicsQueue(), 1, &submitInfo, mInFlightFence) != VK_SUCCESS) {
             LOGE("failed to submit draw command buffer!");
         }
+        else {
+            gpuProfiler.EndFrame(true, submitCpuNs);
+        }
     }
     else {
         LOGE("commandBuffers empty");
     }
 
     // 提交显示
-    if (!mSwapchain->QueuePresent(imageIndex, renderFinishedSemaphore)) {
-        Resize();
+    mFramePacer.MarkSubmitted();
+    bool presented = false;
+    {
+        CPU_PROFILE_SCOPE("Present");
+        presented = mSwapchain->QueuePresent(imageIndex, &mRenderFinishedSemaphore, 1);
     }
+    if (!presented) {
+        mSwapchainOutOfDate = true;
+    }
+    {
+        CPU_PROFILE_SCOPE("Pacing");
+        mFramePacer.EndFrame(gpuFrameTimeMs, mSwapchain->GetPresentMode());
+    }
+    UpdateBenchmark();
+    UpdateFrameCapture(renderInput.timeSec);
+    mSceneFrameIndex++;
+}
 
-    // 主动重建交换链
-    if (mFramebufferResized.load()) {
-        mFramebufferResized.store(false);
-        Resize();
+bool RenderThread::SubmitWithAsyncCompute(const FrameVector<VkCommandBuffer>& commandBuffers, const AsyncComputeInfo& asyncCompute,
+    int64_t& submitCpuNs)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // commandBuffers以mProfileBeginCmd开头，之后才是场景的命令
+    uint32_t splitIndex = asyncCompute.dependencyCount + 1;
+    uint64_t lastComputeValue = mAsyncComputeValue;
+    uint64_t graphicsValue = mAsyncComputeValue + 1;
+    uint64_t computeValue = mAsyncComputeValue + 2;
+
+    // 计算依赖的图形命令，等待上一帧的计算结束后开始，完成时signal graphicsValue
+    VkTimelineSemaphoreSubmitInfo graphicsTimelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+    graphicsTimelineInfo.waitSemaphoreValueCount = 1;
+    graphicsTimelineInfo.pWaitSemaphoreValues = &lastComputeValue;
+    graphicsTimelineInfo.signalSemaphoreValueCount = 1;
+    graphicsTimelineInfo.pSignalSemaphoreValues = &graphicsValue;
+    VkSubmitInfo graphicsSubmitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    graphicsSubmitInfo.pNext = &graphicsTimelineInfo;
+    graphicsSubmitInfo.waitSemaphoreCount = 1;
+    graphicsSubmitInfo.pWaitSemaphores = &mAsyncComputeSemaphore;
+    graphicsSubmitInfo.pWaitDstStageMask = &mAsyncComputeWaitStage;
+    graphicsSubmitInfo.commandBufferCount = splitIndex;
+    graphicsSubmitInfo.pCommandBuffers = commandBuffers.data();
+    graphicsSubmitInfo.signalSemaphoreCount = 1;
+    graphicsSubmitInfo.pSignalSemaphores = &mAsyncComputeSemaphore;
+    submitCpuNs = CpuProfiler::NowNs();
+    if (dispatch.QueueSubmit(RenderBase::mDevice->GetGraphicsQueue(), 1, &graphicsSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        LOGE("failed to submit graphics command buffer before async compute!");
+        return false;
+    }
+
+    // 计算队列
+    VkPipelineStageFlags computeWaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    VkTimelineSemaphoreSubmitInfo computeTimelineInfo{ VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+    computeTimelineInfo.waitSemaphoreValueCount = 1;
+    computeTimelineInfo.pWaitSemaphoreValues = &graphicsValue;
+    computeTimelineInfo.signalSemaphoreValueCount = 1;
+    computeTimelineInfo.pSignalSemaphoreValues = &computeValue;
+    VkSubmitInfo computeSubmitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    computeSubmitInfo.pNext = &computeTimelineInfo;
+    computeSubmitInfo.waitSemaphoreCount = 1;
+    computeSubmitInfo.pWaitSemaphores = &mAsyncComputeSemaphore;
+    computeSubmitInfo.pWaitDstStageMask = &computeWaitStage;
+    computeSubmitInfo.commandBufferCount = 1;
+    computeSubmitInfo.pCommandBuffers = &asyncCompute.commandBuffer;
+    computeSubmitInfo.signalSemaphoreCount = 1;
+    computeSubmitInfo.pSignalSemaphores = &mAsyncComputeSemaphore;
+    if (dispatch.QueueSubmit(RenderBase::mDevice->GetComputeQueue(), 1, &computeSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        LOGE("failed to submit async compute command buffer!");
+        mAsyncComputeValue = graphicsValue;
+    }
+    else {
+        mAsyncComputeValue = computeValue;
+        mAsyncComputeWaitStage = asyncCompute.nextFrameWaitStage;
     }
+
+    // 剩余的图形命令不等待计算，和计算并行
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &mImageAvailableSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size()) - splitIndex;
+    submitInfo.pCommandBuffers = commandBuffers.data() + splitIndex;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &mRenderFinishedSemaphore;
+    if (dispatch.QueueSubmit(RenderBase::mDevice->GetGraphicsQueue(), 1, &submitInfo, mInFlightFence) != VK_SUCCESS) {
+        LOGE("failed to submit draw command buffer!");
+        return false;
+    }
+    return true;
+}
+
+void RenderThread::WaitAsyncCompute()
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    if (mAsyncComputeValue == 0) {
+        return;
+    }
+    VkSemaphoreWaitInfo waitInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &mAsyncComputeSemaphore;
+    waitInfo.pValues = &mAsyncComputeValue;
+    dispatch.WaitSemaphores(mDevice->Get(), &waitInfo, UINT64_MAX);
 }
 
 void RenderThread::OnThreadDestroy() {
@@ -112,12 +353,21 @@ void RenderThread::OnThreadDestroy() {
 
     // destroy render objects
     mSceneRender->CleanUp();
+    CleanUpReadbackBuffer();
+    if (mReadbackCmd != VK_NULL_HANDLE) {
+        mDevice->FreeCommandBuffer(mReadbackCmd);
+    }
+    CleanUpProfileCommandBuffers();
+    GpuProfiler::GetInstance().CleanUp();
     CleanUpFramebuffers();
     CleanUpPresentRenderPass();
     CleanUpAttachments();
     CleanUpSyncObjects();
 
+    DeletionQueue::GetInstance().CleanUp();
+    FrameArena::GetInstance().CleanUp();
     BufferCreator::GetInstance().CleanUp();
+    JobSystem::GetInstance().CleanUp();
 
     // destroy basic objects
     RenderBase::CleanUp();
@@ -125,6 +375,7 @@ void RenderThread::OnThreadDestroy() {
 
 void RenderThread::RequestPhysicalDeviceFeatures(PhysicalDevice* physicalDevice) {
     mSceneRender->RequestPhysicalDeviceFeatures(physicalDevice);
+    RequestDynamicRendering(physicalDevice);
     //auto& shadingRateCreateInfo = physicalDevice->RequestExtensionsFeatures<VkPhysicalDeviceFragmentShadingRateFeaturesKHR>(
     //    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_FEATURES_KHR);
     //shadingRateCreateInfo.pipelineFragmentShadingRate = true;
@@ -134,55 +385,343 @@ void RenderThread::RequestPhysicalDeviceFeatures(PhysicalDevice* physicalDevice)
 
 void RenderThread::SetMouseButton(int button, int action, int mods)
 {
-    {
-        std::unique_lock<std::mutex> lock(mInputEventMutex);
-        if (action == GLFW_PRESS) {
-            if (button == GLFW_MOUSE_BUTTON_LEFT) {
-                mInputInfo.leftPressFlag = true;
-            }
-            else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-                mInputInfo.rightPressFlag = true;
-            }
-            else if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
-                mInputInfo.middlePressFlag = true;
+    InputEvent event{};
+    event.type = InputEventType::MOUSE_BUTTON;
+    event.code = button;
+    event.action = action;
+    event.mods = mods;
+    PushInputEvent(event);
+}
+
+void RenderThread::SetCursorPosChanged(double xpos, double ypos)
+{
+    InputEvent event{};
+    event.type = InputEventType::CURSOR_POS;
+    event.cursorX = xpos;
+    event.cursorY = ypos;
+    PushInputEvent(event);
+}
+
+void RenderThread::SetKeyEvent(int key, int scancode, int action, int mods)
+{
+    InputEvent event{};
+    event.type = InputEventType::KEY;
+    event.code = key;
+    event.scancode = scancode;
+    event.action = action;
+    event.mods = mods;
+    PushInputEvent(event);
+}
+
+void RenderThread::PushInputEvent(InputEvent& event)
+{
+    // 窗口线程调用，队列满时丢弃事件，不等待渲染线程
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    event.timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    if (!mInputEventQueue.TryPush(event)) {
+        mDroppedInputEventCount++;
+    }
+}
+
+void RenderThread::ConsumeInputEvents()
+{
+    mInputInfo.events.clear();
+
+    InputEvent event{};
+    while (mInputEventQueue.TryPop(event)) {
+        if (event.type == InputEventType::MOUSE_BUTTON) {
+            bool pressFlag = event.action == GLFW_PRESS;
+            if (event.action == GLFW_PRESS || event.action == GLFW_RELEASE) {
+                if (event.code == GLFW_MOUSE_BUTTON_LEFT) {
+                    mInputInfo.leftPressFlag = pressFlag;
+                }
+                else if (event.code == GLFW_MOUSE_BUTTON_RIGHT) {
+                    mInputInfo.rightPressFlag = pressFlag;
+                }
+                else if (event.code == GLFW_MOUSE_BUTTON_MIDDLE) {
+                    mInputInfo.middlePressFlag = pressFlag;
+                }
             }
         }
-        else if (action == GLFW_RELEASE) {
-            if (button == GLFW_MOUSE_BUTTON_LEFT) {
-                mInputInfo.leftPressFlag = false;
-            }
-            else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
-                mInputInfo.rightPressFlag = false;
-            }
-            else if (button == GLFW_MOUSE_BUTTON_MIDDLE) {
-                mInputInfo.middlePressFlag = false;
-            }
+        else if (event.type == InputEventType::CURSOR_POS) {
+            mInputInfo.cursorX = event.cursorX;
+            mInputInfo.cursorY = event.cursorY;
         }
+        mInputInfo.events.emplace_back(event);
+    }
+
+    uint32_t droppedCount = mDroppedInputEventCount.exchange(0);
+    if (droppedCount > 0) {
+        LOGW("input event queue full, %d events dropped", droppedCount);
     }
 }
 
-void RenderThread::SetCursorPosChanged(double xpos, double ypos)
+void RenderThread::SetFbResized()
 {
-    {
-        std::unique_lock<std::mutex> lock(mInputEventMutex);
-        mInputInfo.cursorX = xpos;
-        mInputInfo.cursorY = ypos;
+    mFramebufferResized.store(true);
+}
+
+void RenderThread::SetFramePacingMode(FramePacingMode mode)
+{
+    mRequestedPacingMode.store(mode);
+}
+
+void RenderThread::ApplyFramePacingMode()
+{
+    FramePacingMode mode = mRequestedPacingMode.load();
+    if (mode == mFramePacer.GetMode()) {
+        return;
+    }
+
+    LOGI("frame pacing mode %d -> %d", static_cast<uint32_t>(mFramePacer.GetMode()), static_cast<uint32_t>(mode));
+    mFramePacer.SetMode(mode);
+
+    // 显示模式只能在创建交换链时指定
+    std::vector<VkPresentModeKHR> candidates = FramePacer::GetPresentModeCandidates(mode);
+    mSwapchain->SetPresentModeCandidates(candidates);
+    if (candidates.front() != mSwapchain->GetPresentMode()) {
+        mSwapchainOutOfDate = true;
     }
 }
 
-void RenderThread::SetKeyEvent(int key, int scancode, int action, int mods)
+void RenderThread::RequestProfileDump()
 {
-    {
-        std::unique_lock<std::mutex> lock(mInputEventMutex);
-        mInputInfo.key = key;
-        mInputInfo.keyScancode = scancode;
-        mInputInfo.keyAction = action;
+    mProfileDumpRequested.store(true);
+}
+
+void RenderThread::EnableBenchmark(const BenchmarkConfig& config, const std::string& sceneName)
+{
+    mBenchmark = std::make_unique<BenchmarkRunner>();
+    mBenchmarkConfig = config;
+    mBenchmarkSceneName = sceneName;
+    mFixedTimeStepSec = config.timeStepSec;
+    // 跑分不受垂直同步限制
+    GetConfig().pacing.mode = FramePacingMode::UNCAPPED;
+    GetConfig().window.waitEvents = !config.pollEvents;
+    mWindow.SetCpuTimeTracking(config.measureCpuUsage);
+}
+
+void RenderThread::EnableReplay(const BenchmarkConfig& config)
+{
+    mReplaying = true;
+    mReplayPath = config.replayPath;
+    mReplayOutputPath = config.replayOutputPath;
+    mFixedTimeStepSec = config.timeStepSec;
+    GetConfig().pacing.mode = FramePacingMode::UNCAPPED;
+    GetConfig().swapchain.enableReadback = true;
+}
+
+float RenderThread::GetSceneTimeSec()
+{
+    if (mFixedTimeStepSec > 0.0f) {
+        return static_cast<float>(mSceneFrameIndex * mFixedTimeStepSec);
     }
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - mSceneStartTime).count();
 }
 
-void RenderThread::SetFbResized()
+void RenderThread::ToggleFrameCaptureRecording()
 {
-    mFramebufferResized.store(true);
+    mFrameCaptureRecordRequested.store(!mFrameCaptureRecordRequested.load());
+}
+
+bool RenderThread::PrepareReplayFrame()
+{
+    if (mReplayFinished) {
+        return false;
+    }
+    if (mFramebufferResized.exchange(false)) {
+        Resize();
+    }
+
+    // 分辨率和录制时不一致时先让主线程修改窗口大小，等交换链重建后再渲染这一帧
+    const CapturedFrame& frame = mFrameCapture.GetFrames()[mReplayFrameIndex];
+    VkExtent2D extent = mSwapchain->GetExtent();
+    bool extentMatched = extent.width == frame.extent.width && extent.height == frame.extent.height;
+    if (!extentMatched && mReplayResizeWaitCount < MAX_REPLAY_RESIZE_WAIT) {
+        if (mReplayResizeWaitCount == 0) {
+            mWindow.RequestResize(frame.extent);
+        }
+        mReplayResizeWaitCount++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return false;
+    }
+    if (!extentMatched) {
+        LOGW("replay frame %d: extent %dx%d differs from captured %dx%d", mReplayFrameIndex,
+            extent.width, extent.height, frame.extent.width, frame.extent.height);
+    }
+    mReplayResizeWaitCount = 0;
+    return true;
+}
+
+bool RenderThread::RecordReadbackCommand(uint32_t imageIndex)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    mReadbackRecorded = false;
+    if (!mSwapchain->IsReadbackEnabled()) {
+        return false;
+    }
+
+    // 交换链格式都是每像素4字节
+    VkExtent2D extent = mSwapchain->GetExtent();
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    if (size > mReadbackSize) {
+        CleanUpReadbackBuffer();
+        CreateReadbackBuffer(size);
+    }
+    VkImage image = mSwapchain->GetImages()[imageIndex];
+
+    VkCommandBufferBeginInfo beginInfo = vulkanInitializers::CommandBufferBeginInfo(nullptr);
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    dispatch.ResetCommandBuffer(mReadbackCmd, 0);
+    dispatch.BeginCommandBuffer(mReadbackCmd, &beginInfo);
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    dispatch.CmdPipelineBarrier(mReadbackCmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+    dispatch.CmdCopyImageToBuffer(mReadbackCmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, mReadbackBuffer, 1, &region);
+
+    // 还原成显示布局，拷贝结果对CPU可见
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = mReadbackBuffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+    dispatch.CmdPipelineBarrier(mReadbackCmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &bufferBarrier, 1, &barrier);
+
+    dispatch.EndCommandBuffer(mReadbackCmd);
+    mReadbackExtent = extent;
+    mReadbackRecorded = true;
+    return true;
+}
+
+void RenderThread::UpdateFrameCapture(float timeSec)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    CapturedFrame frame{};
+    frame.timeSec = timeSec;
+    frame.extent = mSwapchain->GetExtent();
+    frame.resized = frame.extent.width != mLastCapturedExtent.width || frame.extent.height != mLastCapturedExtent.height;
+    frame.timing = mFramePacer.GetTimingInfo();
+    mLastCapturedExtent = frame.extent;
+
+    if (mReplaying) {
+        // 等这一帧执行完再读取画面，回放不关心这里的停顿
+        dispatch.WaitForFences(mDevice->Get(), 1, &mInFlightFence, VK_TRUE, UINT64_MAX);
+        if (mReadbackRecorded) {
+            uint32_t rowBytes = mReadbackExtent.width * 4;
+            frame.hasChecksum = true;
+            frame.imageChecksum = FrameCapture::CalculateChecksum(
+                static_cast<const uint8_t*>(mReadbackMapped), rowBytes, rowBytes, mReadbackExtent.height);
+        }
+        frame.frameIndex = mReplayFrameIndex;
+        frame.input = mInputInfo;
+        mReplayResult.AddFrame(frame);
+
+        mReplayFrameIndex++;
+        if (mReplayFrameIndex >= mFrameCapture.GetFrames().size()) {
+            mReplayResult.Save(mReplayOutputPath);
+            mBenchmarkResult.store(EXIT_SUCCESS);
+            mReplayFinished = true;
+            mWindow.RequestClose();
+        }
+        return;
+    }
+
+    bool recordRequested = mFrameCaptureRecordRequested.load();
+    if (recordRequested && !mFrameCaptureRecording) {
+        LOGI("start recording frame capture");
+        mFrameCapture.Clear();
+        mFrameCaptureRecording = true;
+    }
+    else if (!recordRequested && mFrameCaptureRecording) {
+        mFrameCapture.Save("capture.txt");
+        mFrameCaptureRecording = false;
+    }
+
+    if (mFrameCaptureRecording) {
+        frame.frameIndex = static_cast<uint32_t>(mFrameCapture.GetFrames().size());
+        frame.input = mInputInfo;
+        mFrameCapture.AddFrame(frame);
+    }
+}
+
+void RenderThread::UpdateBenchmark()
+{
+    if (mBenchmark == nullptr || mBenchmarkFinished) {
+        return;
+    }
+    uint64_t allocationCount = AllocationCounter::GetThreadCount() - mFrameAllocationBase;
+    mBenchmark->EndFrame(mFramePacer.GetTimingInfo(), mSwapchain->GetExtent(), allocationCount);
+    if (mBenchmarkConfig.measureCpuUsage) {
+        CpuUsageSample sample{};
+        sample.wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        sample.processCpuSec = utils::GetProcessCpuTimeSec();
+        sample.mainThreadCpuSec = mWindow.GetMainThreadCpuTimeSec();
+        sample.eventLoopCount = mWindow.GetEventLoopCount();
+        mBenchmark->RecordCpuUsage(sample);
+    }
+    VkExtent2D resizeExtent = {};
+    if (mBenchmark->GetScriptedResize(resizeExtent)) {
+        mWindow.RequestResize(resizeExtent);
+    }
+    if (mBenchmark->IsFinished()) {
+        mBenchmarkResult.store(mBenchmark->Finish());
+        mBenchmarkFinished = true;
+        mWindow.RequestClose();
+    }
+}
+
+void RenderThread::ToggleCameraPathRecording()
+{
+    mCameraPathRecordRequested.store(!mCameraPathRecordRequested.load());
+}
+
+void RenderThread::UpdateCameraPathRecording()
+{
+    Camera* camera = mSceneRender->GetCamera();
+    if (camera == nullptr) {
+        return;
+    }
+
+    bool recordRequested = mCameraPathRecordRequested.load();
+    if (recordRequested && !mCameraPathRecording) {
+        LOGI("start recording camera path");
+        mRecordedCameraPath.Clear();
+        mCameraPathRecordStartTime = std::chrono::steady_clock::now();
+        mCameraPathRecording = true;
+    }
+    else if (!recordRequested && mCameraPathRecording) {
+        mRecordedCameraPath.SaveToFile("camera_path.txt");
+        mCameraPathRecording = false;
+    }
+
+    if (mCameraPathRecording) {
+        float timeSec = std::chrono::duration<float>(std::chrono::steady_clock::now() - mCameraPathRecordStartTime).count();
+        mRecordedCameraPath.AddKeyframe(CameraPath::Capture(*camera, timeSec));
+    }
 }
 
 void RenderThread::Resize() {
@@ -190,17 +729,63 @@ void RenderThread::Resize() {
     if (newExtent.width == 0 || newExtent.height == 0) {
         return;
     }
+    // 大小没有变化并且交换链仍然可用时不重建，拖动过程中来回变化的事件在这里被过滤掉
+    VkExtent2D extent = mSwapchain->GetExtent();
+    if (!mSwapchainOutOfDate && newExtent.width == extent.width && newExtent.height == extent.height) {
+        return;
+    }
+    CPU_PROFILE_SCOPE("Resize");
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+
+    // 资源都交给延迟销毁，这里只等待在飞行的一帧：场景在OnResize里会更新描述符集，
+    // 不能和执行中的命令冲突；下一帧开始时本来也要等这个fence，不再用vkDeviceWaitIdle等待显示队列
+    dispatch.WaitForFences(mDevice->Get(), 1, &mInFlightFence, VK_TRUE, UINT64_MAX);
+    WaitAsyncCompute();
 
-    vkDeviceWaitIdle(mDevice->Get());
     CleanUpFramebuffers();
     CleanUpAttachments();
-
     mSceneRender->OnResize(newExtent);
-    mSwapchain->Recreate(newExtent);
+
+    // 旧交换链上可能还有排队的显示，fence不能说明显示已经完成，多保留交换链图像个数的帧
+    RetiredSwapchain retiredSwapchain{};
+    mSwapchain->Recreate(newExtent, &retiredSwapchain);
+    DeletionQueue::GetInstance().Push([this, retiredSwapchain]() mutable {
+        mSwapchain->DestroyRetired(retiredSwapchain);
+    }, mSwapchain->GetImageCount());
+    mSwapchainOutOfDate = false;
+
     CreateAttachments();
     CreateFramebuffers();
 }
 
+
+void RenderThread::RequestDynamicRendering(PhysicalDevice* physicalDevice) {
+    if (!GetConfig().presentFb.dynamicRendering) {
+        return;
+    }
+
+    // 扩展在挑选物理设备时已经检查过，这里只确认场景确实开启了它
+    std::vector<const char*>& deviceExtensions = physicalDevice->GetDeviceExtensions();
+    bool extensionEnabled = std::any_of(deviceExtensions.begin(), deviceExtensions.end(), [](const char* name) {
+        return strcmp(name, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) == 0;
+    });
+    if (!extensionEnabled) {
+        LOGW("%s is not in device extensions, fall back to render pass", VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        GetConfig().presentFb.dynamicRendering = false;
+        return;
+    }
+
+    auto& dynamicRenderingFeatures = physicalDevice->RequestExtensionsFeatures<VkPhysicalDeviceDynamicRenderingFeaturesKHR>(
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR);
+    if (!dynamicRenderingFeatures.dynamicRendering) {
+        LOGW("dynamic rendering is not supported, fall back to render pass");
+        GetConfig().presentFb.dynamicRendering = false;
+        return;
+    }
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+    LOGI("present with dynamic rendering");
+}
+
 void RenderThread::CreateAttachments() {
     BufferCreator& bufferCreator = BufferCreator::GetInstance();
 
@@ -247,20 +832,33 @@ void RenderThread::CreateAttachments() {
 }
 
 void RenderThread::CleanUpAttachments() {
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+
     // destroy color attachemnt
-    vkDestroyImageView(mDevice->Get(), mColorImageView, nullptr);
-    vkDestroyImage(mDevice->Get(), mColorImage, nullptr);
-    vkFreeMemory(mDevice->Get(), mColorImageMemory, nullptr);
+    deletionQueue.DestroyImageView(mColorImageView);
+    deletionQueue.DestroyImage(mColorImage);
+    deletionQueue.FreeMemory(mColorImageMemory);
+    mColorImageView = VK_NULL_HANDLE;
+    mColorImage = VK_NULL_HANDLE;
+    mColorImageMemory = VK_NULL_HANDLE;
 
     // destroy depth attachemnt
-    vkDestroyImageView(mDevice->Get(), mDepthImageView, nullptr);
-    vkDestroyImage(mDevice->Get(), mDepthImage, nullptr);
-    vkFreeMemory(mDevice->Get(), mDepthImageMemory, nullptr);
+    deletionQueue.DestroyImageView(mDepthImageView);
+    deletionQueue.DestroyImage(mDepthImage);
+    deletionQueue.FreeMemory(mDepthImageMemory);
+    mDepthImageView = VK_NULL_HANDLE;
+    mDepthImage = VK_NULL_HANDLE;
+    mDepthImageMemory = VK_NULL_HANDLE;
 }
 
 void RenderThread::CreateFramebuffers() {
+    // 动态渲染直接使用交换链的imageView，不需要帧缓冲
+    if (GetConfig().presentFb.dynamicRendering) {
+        return;
+    }
+
     // 对每一个imageView创建帧缓冲
-    std::vector<VkImageView> swapChainImageViews = mSwapchain->GetImageViews();
+    std::vector<VkImageView>& swapChainImageViews = mSwapchain->GetImageViews();
     mSwapchainFramebuffers.resize(swapChainImageViews.size());
     for (size_t i = 0; i < swapChainImageViews.size(); i++) {
         std::vector<VkImageView> attachments = {};
@@ -289,8 +887,9 @@ void RenderThread::CreateFramebuffers() {
 void RenderThread::CleanUpFramebuffers() {
     // 销毁frame buffer
     for (auto framebuffer : mSwapchainFramebuffers) {
-        vkDestroyFramebuffer(mDevice->Get(), framebuffer, nullptr);
+        DeletionQueue::GetInstance().DestroyFramebuffer(framebuffer);
     }
+    mSwapchainFramebuffers.clear();
 }
 
 void RenderThread::CreateSyncObjects() {
@@ -304,9 +903,25 @@ void RenderThread::CreateSyncObjects() {
         vkCreateFence(RenderBase::GetDevice(), &fenceInfo, nullptr, &mInFlightFence) != VK_SUCCESS) {
         throw std::runtime_error("failed to create semaphores!");
     }
+
+    if (mDevice->HasAsyncCompute()) {
+        VkSemaphoreTypeCreateInfo timelineInfo{ VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+        timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        timelineInfo.initialValue = 0;
+        semaphoreInfo.pNext = &timelineInfo;
+        if (vkCreateSemaphore(RenderBase::GetDevice(), &semaphoreInfo, nullptr, &mAsyncComputeSemaphore) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timeline semaphore!");
+        }
+        mAsyncComputeValue = 0;
+        mAsyncComputeWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    }
 }
 
 void RenderThread::CleanUpSyncObjects() {
+    if (mAsyncComputeSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(mDevice->Get(), mAsyncComputeSemaphore, nullptr);
+        mAsyncComputeSemaphore = VK_NULL_HANDLE;
+    }
     vkDestroySemaphore(mDevice->Get(), mImageAvailableSemaphore, nullptr);
     vkDestroySemaphore(mDevice->Get(), mRenderFinishedSemaphore, nullptr);
     vkDestroyFence(mDevice->Get(), mInFlightFence, nullptr);
@@ -380,5 +995,43 @@ void RenderThread::CreatePresentRenderPass()
 void RenderThread::CleanUpPresentRenderPass()
 {
     vkDestroyRenderPass(mDevice->Get(), mPresentRenderPass, nullptr);
+    mPresentRenderPass = VK_NULL_HANDLE;
+}
+
+void RenderThread::CreateProfileCommandBuffers()
+{
+    mProfileBeginCmd = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    mProfileEndCmd = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+}
+
+void RenderThread::CleanUpProfileCommandBuffers()
+{
+    mDevice->FreeCommandBuffer(mProfileBeginCmd);
+    mDevice->FreeCommandBuffer(mProfileEndCmd);
+}
+
+void RenderThread::CreateReadbackBuffer(VkDeviceSize size)
+{
+    BufferCreator::GetInstance().CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mReadbackBuffer, mReadbackMemory);
+    if (vkMapMemory(mDevice->Get(), mReadbackMemory, 0, size, 0, &mReadbackMapped) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map readback buffer!");
+    }
+    mReadbackSize = size;
+}
+
+void RenderThread::CleanUpReadbackBuffer()
+{
+    if (mReadbackBuffer == VK_NULL_HANDLE) {
+        return;
+    }
+    // 回放时分辨率变大会在录制中替换缓冲区，旧的可能还在被上一帧的拷贝使用
+    vkUnmapMemory(mDevice->Get(), mReadbackMemory);
+    DeletionQueue::GetInstance().DestroyBuffer(mReadbackBuffer);
+    DeletionQueue::GetInstance().FreeMemory(mReadbackMemory);
+    mReadbackBuffer = VK_NULL_HANDLE;
+    mReadbackMemory = VK_NULL_HANDLE;
+    mReadbackMapped = nullptr;
+    mReadbackSize = 0;
 }
 }   // namespace framework
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "SceneRenderBase.h"
+
+#include <array>
+
+#include "VulkanInitializers.h"
+#include "Utils.h"
+#include "AppDispatchTable.h"
+
+namespace framework {
+namespace {
+bool HasStencilComponent(VkFormat format)
+{
+    return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT ||
+        format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_S8_UINT;
+}
+
+VkImageMemoryBarrier ImageBarrier(VkImage image, VkImageAspectFlags aspectMask, VkImageLayout oldLayout,
+    VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask)
+{
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { aspectMask, 0, 1, 0, 1 };
+    return barrier;
+}
+}
+
+bool SceneRenderBase::InitCheck(const RenderInitInfo& initInfo)
+{
+    if (!initInfo.dynamicRendering && initInfo.presentRenderPass == VK_NULL_HANDLE) {
+        throw std::runtime_error("presentRenderPass is null");
+        return false;
+    }
+    if (initInfo.device == nullptr) {
+        throw std::runtime_error("device is null");
+        return false;
+    }
+    mPresentRenderPass = initInfo.presentRenderPass;
+    mDevice = initInfo.device;
+
+    mDynamicRendering = initInfo.dynamicRendering;
+    mPresentColorFormat = initInfo.presentColorFormat;
+    mPresentDepthFormat = initInfo.presentDepthFormat;
+    mPresentSampleCount = initInfo.presentSampleCount;
+    VkFormat stencilFormat = HasStencilComponent(mPresentDepthFormat) ? mPresentDepthFormat : VK_FORMAT_UNDEFINED;
+
+    mPresentRenderingInfo = { VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR };
+    mPresentRenderingInfo.colorAttachmentCount = 1;
+    mPresentRenderingInfo.pColorAttachmentFormats = &mPresentColorFormat;
+    mPresentRenderingInfo.depthAttachmentFormat = mPresentDepthFormat;
+    mPresentRenderingInfo.stencilAttachmentFormat = stencilFormat;
+
+    mPresentInheritanceRenderingInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR };
+    mPresentInheritanceRenderingInfo.colorAttachmentCount = 1;
+    mPresentInheritanceRenderingInfo.pColorAttachmentFormats = &mPresentColorFormat;
+    mPresentInheritanceRenderingInfo.depthAttachmentFormat = mPresentDepthFormat;
+    mPresentInheritanceRenderingInfo.stencilAttachmentFormat = stencilFormat;
+    mPresentInheritanceRenderingInfo.rasterizationSamples = mPresentSampleCount;
+    return true;
+}
+
+void SceneRenderBase::SetPresentPassTarget(GraphicsPipelineConfigInfo& configInfo)
+{
+    if (mDynamicRendering) {
+        configInfo.SetRenderingInfo(mPresentRenderingInfo);
+    }
+    else {
+        configInfo.SetRenderPass(mPresentRenderPass);
+    }
+}
+
+void SceneRenderBase::CmdBeginPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input,
+    VkClearValue clearColor, VkSubpassContents contents)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    VkRect2D renderArea = { { 0, 0 }, input.swapchainExtent };
+    if (!mDynamicRendering) {
+        std::array<VkClearValue, 2> clearValues = { clearColor, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO };
+        VkRenderPassBeginInfo renderPassInfo = vulkanInitializers::RenderPassBeginInfo(
+            mPresentRenderPass, input.swapchanFb, renderArea, clearValues);
+        dispatch.CmdBeginRenderPass(cmdBuf, &renderPassInfo, contents);
+        return;
+    }
+
+    const PresentAttachments& attachments = input.presentAttachments;
+    bool msaa = attachments.colorImageView != VK_NULL_HANDLE;
+    bool hasStencil = HasStencilComponent(mPresentDepthFormat);
+
+    // 附件都会被清除，旧布局用UNDEFINED。交换链图像在COLOR_ATTACHMENT_OUTPUT阶段等待获取图像的信号量，
+    // 屏障也从这个阶段开始，保证布局转换发生在图像可用之后；深度和上一帧的写入之间也要同步
+    VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+    std::array<VkImageMemoryBarrier, 3> barriers = {};
+    uint32_t barrierCount = 0;
+    barriers[barrierCount++] = ImageBarrier(attachments.swapchainImage, VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    barriers[barrierCount++] = ImageBarrier(attachments.depthImage, depthAspect,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+    if (msaa) {
+        barriers[barrierCount++] = ImageBarrier(attachments.colorImage, VK_IMAGE_ASPECT_COLOR_BIT,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+    }
+    VkPipelineStageFlags attachmentStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dispatch.CmdPipelineBarrier(cmdBuf, attachmentStages, attachmentStages, 0,
+        0, nullptr, 0, nullptr, barrierCount, barriers.data());
+
+    std::array<VkRenderingAttachmentInfoKHR, 1> colorAttachments = {
+        vulkanInitializers::RenderingAttachmentInfo(attachments.swapchainImageView,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, clearColor)
+    };
+    if (msaa) {
+        // 多重采样图像只在pass内使用，结束时解析到交换链图像
+        colorAttachments[0].imageView = attachments.colorImageView;
+        colorAttachments[0].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachments[0].resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        colorAttachments[0].resolveImageView = attachments.swapchainImageView;
+        colorAttachments[0].resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+    VkRenderingAttachmentInfoKHR depthAttachment = vulkanInitializers::RenderingAttachmentInfo(
+        attachments.depthImageView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO);
+
+    VkRenderingInfoKHR renderingInfo = vulkanInitializers::RenderingInfo(renderArea, colorAttachments,
+        &depthAttachment, hasStencil ? &depthAttachment : nullptr);
+    if (contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+        renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
+    }
+    dispatch.CmdBeginRenderingKHR(cmdBuf, &renderingInfo);
+}
+
+void SceneRenderBase::CmdEndPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    if (!mDynamicRendering) {
+        dispatch.CmdEndRenderPass(cmdBuf);
+        return;
+    }
+
+    dispatch.CmdEndRenderingKHR(cmdBuf);
+    VkImageMemoryBarrier barrier = ImageBarrier(input.presentAttachments.swapchainImage, VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0);
+    dispatch.CmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+        0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+const VkCommandBufferInheritanceRenderingInfoKHR* SceneRenderBase::GetPresentInheritanceRenderingInfo()
+{
+    return mDynamicRendering ? &mPresentInheritanceRenderingInfo : nullptr;
+}
+}   // namespace framework
@@ -7,6 +7,11 @@
 #include "Utils.h"
 #include "WindowTemplate.h"
 #include "SceneDemoDefs.h"
+#include "Log.h"
+#include "AppDispatchTable.h"
+
+#undef LOG_TAG
+#define LOG_TAG "Swapchain"
 
 namespace framework {
 Swapchain::Swapchain() {
@@ -59,25 +64,42 @@ bool Swapchain::CleanUp() {
 	return true;
 }
 
-bool Swapchain::Recreate(VkExtent2D windowExtent) {
+bool Swapchain::Recreate(VkExtent2D windowExtent, RetiredSwapchain* retired) {
 	if (!mIsInitialized) {
 		return false;
 	}
 
-	DestroyImageViews();
-		
-	VkSwapchainKHR oldSwapchain = mSwapChain;
-	CreateSwapChain(windowExtent, oldSwapchain);
-	vkDestroySwapchainKHR(mDevice->Get(), oldSwapchain, nullptr);
-
+	// 旧交换链变为retired状态，已经提交的显示仍然有效
+	RetiredSwapchain oldSwapchain{};
+	oldSwapchain.swapchain = mSwapChain;
+	oldSwapchain.imageViews = mSwapchainImageViews;
+	CreateSwapChain(windowExtent, oldSwapchain.swapchain);
 	CreateImageViews();
 
+	if (retired != nullptr) {
+		*retired = std::move(oldSwapchain);
+	}
+	else {
+		DestroyRetired(oldSwapchain);
+	}
 	return true;
 }
 
+void Swapchain::DestroyRetired(RetiredSwapchain& retired) {
+	for (auto imageView : retired.imageViews) {
+		vkDestroyImageView(mDevice->Get(), imageView, nullptr);
+	}
+	retired.imageViews.clear();
+	if (retired.swapchain != VK_NULL_HANDLE) {
+		vkDestroySwapchainKHR(mDevice->Get(), retired.swapchain, nullptr);
+		retired.swapchain = VK_NULL_HANDLE;
+	}
+}
+
 bool Swapchain::AcquireImage(VkSemaphore imageAvailiableSemaphore, uint32_t& imageIndex) {
+	AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
 	// 从交换链中获取可用的图像，获取到之后触发imageAvailiableSemaphore，表示可以开始画了
-	VkResult result = vkAcquireNextImageKHR(mDevice->Get(), mSwapChain, UINT64_MAX, imageAvailiableSemaphore, VK_NULL_HANDLE, &imageIndex);
+	VkResult result = dispatch.AcquireNextImageKHR(mDevice->Get(), mSwapChain, UINT64_MAX, imageAvailiableSemaphore, VK_NULL_HANDLE, &imageIndex);
 	
 	if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR) {
 		return true;
@@ -92,19 +114,18 @@ bool Swapchain::AcquireImage(VkSemaphore imageAvailiableSemaphore, uint32_t& ima
 	}
 }
 
-bool Swapchain::QueuePresent(uint32_t imageIndex, const std::vector<VkSemaphore>& waitSemaphores) {
-	std::vector<VkSwapchainKHR> swapchains = { mSwapChain };
-
+bool Swapchain::QueuePresent(uint32_t imageIndex, const VkSemaphore* waitSemaphores, uint32_t waitSemaphoreCount) {
+	AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
 	// 将结果返回给交换链
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentInfo.waitSemaphoreCount = waitSemaphores.empty() ? 0 : waitSemaphores.size();    // 等待信号个数
-	presentInfo.pWaitSemaphores = waitSemaphores.empty() ? nullptr : waitSemaphores.data(); // 等待waitSemaphore，再返回交换链
-	presentInfo.swapchainCount = swapchains.size();				// 交换链个数
-	presentInfo.pSwapchains = swapchains.data();		// 返回给哪个交换链
+	presentInfo.waitSemaphoreCount = waitSemaphoreCount;    // 等待信号个数
+	presentInfo.pWaitSemaphores = waitSemaphoreCount == 0 ? nullptr : waitSemaphores; // 等待waitSemaphore，再返回交换链
+	presentInfo.swapchainCount = 1;				// 交换链个数
+	presentInfo.pSwapchains = &mSwapChain;		// 返回给哪个交换链
 	presentInfo.pImageIndices = &imageIndex;	// 返回的图片编号
 	presentInfo.pResults = nullptr;				// 各个交换链的返回值（成功与否），此处只用一个交换链，没必要用它
-	VkResult result = vkQueuePresentKHR(mDevice->GetPresentQueue(), &presentInfo);
+	VkResult result = dispatch.QueuePresentKHR(mDevice->GetPresentQueue(), &presentInfo);
 
 	if (result == VK_SUCCESS) {
 		return true;
@@ -148,13 +169,21 @@ void Swapchain::CreateSwapChain(VkExtent2D windowExtent, VkSwapchainKHR oldSwapc
 	createInfo.imageExtent = swapchainExtent;						// 图像大小(分辨率)
 	createInfo.imageArrayLayers = 1;						// 图像有几层（除非做VR程序，否则是1）
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;	// SwapChain中的图像用作颜色附件
+	mReadbackEnabled = mReadbackRequested &&
+		(swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+	if (mReadbackRequested && !mReadbackEnabled) {
+		LOGW("swapchain images can not be used as transfer source, readback disabled");
+	}
+	if (mReadbackEnabled) {
+		createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
 	createInfo.imageSharingMode = sharingMode;
 	createInfo.queueFamilyIndexCount = indicesList.size();
 	createInfo.pQueueFamilyIndices = indicesList.empty() ? nullptr : indicesList.data();
 	createInfo.preTransform = swapChainSupport.capabilities.currentTransform;	//  旋转/镜像 ：不操作
 	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;	// alpha通道是否与其他窗口混合：否
 	createInfo.presentMode = presentMode;
-	createInfo.clipped = VK_TRUE;		// 不关心被（其他窗口）遮挡像素的颜色
+	createInfo.clipped = mReadbackEnabled ? VK_FALSE : VK_TRUE;		// 不关心被（其他窗口）遮挡像素的颜色，回读时需要完整的画面
 	createInfo.oldSwapchain = oldSwapchain;
 	if (vkCreateSwapchainKHR(mDevice->Get(), &createInfo, nullptr, &mSwapChain) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create swap chain!");
@@ -213,12 +242,12 @@ VkSurfaceFormatKHR Swapchain::ChooseSwapSurfaceFormat(const std::vector<VkSurfac
 }
 
 VkPresentModeKHR Swapchain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availiablePresentModes) {
-	for (const auto& availiablePresentMode : availiablePresentModes) {
-		if (availiablePresentMode == GetConfig().swapchain.presentMode) {
-			return availiablePresentMode;
+	for (const auto& candidate : mPresentModeCandidates) {
+		if (std::find(availiablePresentModes.begin(), availiablePresentModes.end(), candidate) != availiablePresentModes.end()) {
+			return candidate;
 		}
 	}
-	return VK_PRESENT_MODE_FIFO_KHR;	// 默认
+	return VK_PRESENT_MODE_FIFO_KHR;	// 默认，所有设备都支持
 }
 
 VkExtent2D Swapchain::ChooseSwapExtent(VkExtent2D windowExtent, const VkSurfaceCapabilitiesKHR& capabilities) {
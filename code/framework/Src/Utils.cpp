@@ -3,6 +3,13 @@
 #include <iostream>
 #include <unordered_set>
 #include <fstream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 #include "Log.h"
 
@@ -63,4 +70,43 @@ std::vector<char> ReadFile(const std::string& filename) {
 	file.close();
 	return buffer;
 }
+
+#ifdef _WIN32
+namespace {
+double FileTimeToSec(const FILETIME& time) {
+	ULARGE_INTEGER value;
+	value.LowPart = time.dwLowDateTime;
+	value.HighPart = time.dwHighDateTime;
+	return static_cast<double>(value.QuadPart) * 1e-7;	// 100ns
+}
+}
+
+double GetProcessCpuTimeSec() {
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+		return 0.0;
+	}
+	return FileTimeToSec(kernelTime) + FileTimeToSec(userTime);
+}
+
+double GetThreadCpuTimeSec() {
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+		return 0.0;
+	}
+	return FileTimeToSec(kernelTime) + FileTimeToSec(userTime);
+}
+#else
+double GetProcessCpuTimeSec() {
+	timespec time{};
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+	return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+
+double GetThreadCpuTimeSec() {
+	timespec time{};
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+}
+#endif
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include "RenderThread.h"
 
 namespace window {
-WindowImpl::WindowImpl(bool resizable) : WindowTemplate(resizable)
+WindowImpl::WindowImpl(bool resizable, bool visible) : WindowTemplate(resizable, visible)
 {
     mRenderThread = new framework::RenderThread(*this);
 }
@@ -14,6 +14,21 @@ WindowImpl::~WindowImpl()
     delete mRenderThread;
 }
 
+void WindowImpl::EnableBenchmark(const framework::BenchmarkConfig& config, const std::string& sceneName)
+{
+    mRenderThread->EnableBenchmark(config, sceneName);
+}
+
+void WindowImpl::EnableReplay(const framework::BenchmarkConfig& config)
+{
+    mRenderThread->EnableReplay(config);
+}
+
+int WindowImpl::GetBenchmarkResult()
+{
+    return mRenderThread->GetBenchmarkResult();
+}
+
 void WindowImpl::Initialize()
 {
     mRenderThread->Start();
@@ -59,6 +74,26 @@ void WindowImpl::OnCursorPosChanged(double xpos, double ypos)
 
 void WindowImpl::OnKeyEvent(int key, int scancode, int action, int mods)
 {
+    // F1~F4切换帧节奏模式
+    if (action == GLFW_PRESS && key >= GLFW_KEY_F1 && key <= GLFW_KEY_F4) {
+        mRenderThread->SetFramePacingMode(static_cast<framework::FramePacingMode>(key - GLFW_KEY_F1));
+        return;
+    }
+    // F5输出CPU/GPU profile
+    if (action == GLFW_PRESS && key == GLFW_KEY_F5) {
+        mRenderThread->RequestProfileDump();
+        return;
+    }
+    // F6开始/结束录制相机路径
+    if (action == GLFW_PRESS && key == GLFW_KEY_F6) {
+        mRenderThread->ToggleCameraPathRecording();
+        return;
+    }
+    // F7开始/结束录制会话
+    if (action == GLFW_PRESS && key == GLFW_KEY_F7) {
+        mRenderThread->ToggleFrameCaptureRecording();
+        return;
+    }
     mRenderThread->SetKeyEvent(key, scancode, action, mods);
 }
 }   // namespace window
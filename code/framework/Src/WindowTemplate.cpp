@@ -5,12 +5,13 @@
 #include "SceneDemoDefs.h"
 
 namespace window {
-WindowTemplate::WindowTemplate(bool resizable) {
+WindowTemplate::WindowTemplate(bool resizable, bool visible) {
     framework::SceneDemoConfig& config = GetConfig();
     // 初始化GLFW窗口
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);	// 不要创建OpenGL上下文
     glfwWindowHint(GLFW_RESIZABLE, resizable);		// 禁止调整窗口大小
+    glfwWindowHint(GLFW_VISIBLE, visible);
     mWindow = glfwCreateWindow(config.window.width, config.window.height, "render widget", nullptr, nullptr);
 
     glfwSetWindowUserPointer(mWindow, this);
@@ -30,9 +31,22 @@ WindowTemplate::~WindowTemplate() {
 
 void WindowTemplate::Exec() {
     Initialize();
+    // 输入只是转发给渲染线程，没有事件时主线程不需要醒来
+    bool waitEvents = GetConfig().window.waitEvents;
     while (!glfwWindowShouldClose(mWindow)) {
-        glfwPollEvents();
+        if (waitEvents) {
+            glfwWaitEvents();
+        }
+        else {
+            glfwPollEvents();
+        }
+        ApplyPendingResize();
         Update();
+
+        mEventLoopCount++;
+        if (mCpuTimeTracking.load()) {
+            mMainThreadCpuTimeSec.store(utils::GetThreadCpuTimeSec());
+        }
     }
     CleanUp();
 }
@@ -53,6 +67,25 @@ std::vector<const char*> WindowTemplate::QueryWindowRequiredExtensions() {
     return extensions;
 }
 
+void WindowTemplate::RequestClose() {
+    glfwSetWindowShouldClose(mWindow, GLFW_TRUE);
+    glfwPostEmptyEvent();
+}
+
+void WindowTemplate::RequestResize(VkExtent2D extent) {
+    mPendingWidth.store(extent.width);
+    mPendingHeight.store(extent.height);
+    mResizePending.store(true);
+    glfwPostEmptyEvent();
+}
+
+void WindowTemplate::ApplyPendingResize() {
+    // glfw的窗口操作只能在主线程
+    if (mResizePending.exchange(false)) {
+        glfwSetWindowSize(mWindow, static_cast<int>(mPendingWidth.load()), static_cast<int>(mPendingHeight.load()));
+    }
+}
+
 VkExtent2D WindowTemplate::GetWindowExtent() {
     int width, height;
     glfwGetFramebufferSize(mWindow, &width, &height);
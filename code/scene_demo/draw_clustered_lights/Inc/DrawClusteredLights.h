@@ -0,0 +1,155 @@
+#ifndef __DRAW_CLUSTERED_LIGHTS_H__
+#define __DRAW_CLUSTERED_LIGHTS_H__
+
+#include <vulkan/vulkan.h>
+
+#include "SceneRenderBase.h"
+#include "FrameworkHeaders.h"
+#include "TestMesh.h"
+#include "Camera.h"
+#include "ClusteredLights.h"
+
+namespace framework {
+class DrawClusteredLights : public SceneRenderBase {
+public:
+    DrawClusteredLights();
+    ~DrawClusteredLights();
+
+    void Init(const RenderInitInfo& initInfo) override;
+    void CleanUp() override;
+    std::vector<VkCommandBuffer>& RecordCommand(const RenderInputInfo& input) override;
+    void ProcessInputEvent(const InputEventInfo& inputEventInfo) override;
+    Camera* GetCamera() override { return mCamera; }
+
+private:
+    void CreateDrawList();
+    void CreateLights();
+
+    void CreateVertexBuffer();
+    void CleanUpVertexBuffer();
+
+    void CreateIndexBuffer();
+    void CleanUpIndexBuffer();
+
+    void CreateUniformBuffer();
+    void CleanUpUniformBuffer();
+
+    void CreateDescriptorPool();
+    void CleanUpDescriptorPool();
+    void CreateDescriptorSets();
+
+    void CreatePipelines();
+    void CleanUpPipelines();
+
+    void UpdataUniformBuffer(float aspectRatio);
+    void UpdateLights(float timeSec);
+
+    // tool functions
+    void StartLightCountTest();
+    void UpdateLightCountTest();
+    void PrintLightCountChart();
+
+private:
+    std::vector<VkCommandBuffer> mPrimaryCommandBuffers = {};
+
+    // ---- render objects ----
+    PipelineObjecs mPipelineClustered = {};
+    PipelineObjecs mPipelineBruteForce = {};     // 同一个着色器关掉分簇，遍历全部光源
+
+    VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+
+    // vertex buffer
+    VkBuffer mVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mVertexBufferMemory = VK_NULL_HANDLE;
+
+    // index buffer
+    VkBuffer mIndexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mIndexBufferMemory = VK_NULL_HANDLE;
+
+    // uniform buffer
+    VkBuffer mUboGlobalMatrixVP = VK_NULL_HANDLE;
+    void* mUboGlobalMatrixVPAddr = nullptr;
+    VkDeviceMemory mUniformBuffersMemory = VK_NULL_HANDLE;
+
+    // 两个管线的布局相同，共用一个descriptor set
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptorSetDraw = VK_NULL_HANDLE;
+
+    // data
+    struct GlobalMatrixVP {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::vec3 cameraPos;
+    };
+
+    struct DrawPushConstants {
+        glm::vec4 offsetScale;
+        glm::vec4 material;     // xyz为albedo，w为roughness
+    };
+
+    // 地面上铺一层小球，光源在小球之间运动
+    static constexpr uint32_t GRID_SIZE = 48;
+    static constexpr uint32_t DRAW_COUNT = GRID_SIZE * GRID_SIZE;
+    static constexpr float GRID_SPACING = 1.0f;
+    std::vector<DrawPushConstants> mDrawList = {};
+
+    // 光源
+    struct LightMotion {
+        glm::vec3 center;
+        float orbitRadius;
+        float angularSpeed;
+        float phase;
+    };
+    static constexpr uint32_t MAX_LIGHT_COUNT = 16384;
+    static constexpr uint32_t DEFAULT_LIGHT_COUNT = 4096;
+    static constexpr float LIGHT_RADIUS = 2.0f;
+    static constexpr float LIGHT_THRESHOLD = 0.05f;
+    static constexpr float NEAR_PLANE = 0.1f;
+    static constexpr float FAR_PLANE = 200.0f;
+    ClusteredLights mClusteredLights = {};
+    std::vector<LightMotion> mLightMotions = {};
+    std::vector<PointLight> mLights = {};
+    uint32_t mActiveLightCount = DEFAULT_LIGHT_COUNT;
+    bool mBruteForce = false;
+
+    // 光源数-GPU耗时测试，遍历全部光源的对照只测到BRUTE_FORCE_MAX_LIGHT_COUNT，再多会让单帧过长
+    static constexpr uint32_t TEST_WARMUP_FRAMES = 30;
+    static constexpr uint32_t TEST_MEASURE_FRAMES = 200;
+    static constexpr uint32_t BRUTE_FORCE_MAX_LIGHT_COUNT = 1024;
+    struct LightCountStep {
+        uint32_t lightCount = 0;
+        bool bruteForce = false;
+    };
+    struct LightCountResult {
+        uint32_t lightCount = 0;
+        float cullTimeMs = 0.0f;
+        float shadingTimeMs = 0.0f;
+        float bruteForceTimeMs = -1.0f;     // 小于0表示没有测
+    };
+    std::vector<LightCountStep> mTestSteps = {};
+    std::vector<LightCountResult> mTestResults = {};
+    uint32_t mTestStep = 0;
+    uint32_t mTestFrame = 0;
+    bool mTestRunning = false;
+    double mTestCullTimeSum = 0.0;
+    double mTestShadingTimeSum = 0.0;
+
+    TestMesh* mMesh = nullptr;
+    Camera* mCamera = nullptr;
+
+    bool mLastLeftPress = false;
+    glm::vec2 mLastCursorPose = { 0.0, 0.0 };
+    std::unordered_map<int, uint16_t> mKeyPressStatus = {
+        { FRAMEWORK_KEY_W, false },
+        { FRAMEWORK_KEY_A, false },
+        { FRAMEWORK_KEY_S, false },
+        { FRAMEWORK_KEY_D, false },
+        { FRAMEWORK_KEY_Q, false },
+        { FRAMEWORK_KEY_E, false },
+    };
+    bool mTestKeyPress = false;
+
+};
+}
+
+#endif // __DRAW_CLUSTERED_LIGHTS_H__
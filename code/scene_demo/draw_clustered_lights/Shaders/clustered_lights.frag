@@ -0,0 +1,151 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+const float PI = 3.14159265359;
+const float EPS = 0.0001;
+const vec3 F0_BASE = vec3(0.04);
+const float GAMA = 2.2;
+
+// false时不查簇，遍历全部光源，作为分簇的对照
+layout(constant_id = 0) const bool USE_CLUSTERS = true;
+
+layout(binding = 0) uniform GlobalMatrixVP {
+    mat4 view;
+    mat4 proj;
+    vec3 cameraPos;
+} ubo;
+
+layout(push_constant) uniform PushConsts {
+    vec4 offsetScale;   // xyz: 偏移 w: 缩放
+    vec4 material;      // xyz: albedo w: roughness
+} uConsts;
+
+// light，分簇结果由cluster_light_cull.comp写入
+const uint MAX_LIGHTS_PER_CLUSTER = 256;    // 和ClusteredLights::MAX_LIGHTS_PER_CLUSTER一致
+
+struct PointLight {
+    vec3 position;
+    float radius;
+    vec3 power;
+    float padding;
+};
+
+layout(std140, binding = 20) uniform ClusterParams {
+    mat4 view;
+    mat4 invProj;
+    uvec4 gridSize;         // xyz为簇的个数，w为光源个数
+    vec4 screenParams;      // 渲染区域的宽高，近平面，远平面
+    vec4 sliceParams;       // slice = log(depth) * x - y
+} uCluster;
+
+layout(std430, binding = 21) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+
+layout(std430, binding = 22) readonly buffer ClusterLightCounts {
+    uint clusterLightCounts[];
+};
+
+layout(std430, binding = 23) readonly buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
+
+layout(location = 0) in vec3 normalDir;
+layout(location = 1) in vec3 pointOnWorld;
+
+layout(location = 0) out vec4 outColor;
+
+vec3 gAmbient = vec3(0.01);
+
+float DistributionGGX(float roughness, vec3 normal, vec3 halfVector)
+{
+    float alpha = roughness * roughness;
+    float alphaSquare = alpha * alpha;
+    float dotNToH = clamp(dot(normal, halfVector), 0.0, 1.0);
+    float denomTemp = dotNToH * dotNToH * (alphaSquare - 1.0) + 1.0;
+    return alphaSquare / (PI * denomTemp * denomTemp);
+}
+
+vec3 FresnelSchlick(vec3 f0, float dotHalfToView)
+{
+    return f0 + (1.0 - f0) * pow(clamp(1.0 - dotHalfToView, 0.0, 1.0), 5);
+}
+
+float GeometyGGX(float roughness, float dotNtoV)
+{
+    float k = (roughness + 1) * (roughness + 1) * 0.125;
+    return dotNtoV / (dotNtoV * (1.0 - k) + k);
+}
+
+uint GetClusterIndex(vec2 fragCoord, float viewDepth)
+{
+    uvec3 gridSize = uCluster.gridSize.xyz;
+    uvec2 tile = uvec2(fragCoord / uCluster.screenParams.xy * vec2(gridSize.xy));
+    tile = min(tile, gridSize.xy - 1);
+    uint slice = uint(max(log(viewDepth) * uCluster.sliceParams.x - uCluster.sliceParams.y, 0.0));
+    slice = min(slice, gridSize.z - 1);
+    return (slice * gridSize.y + tile.y) * gridSize.x + tile.x;
+}
+
+// 在影响半径处平滑衰减到0，和分簇的裁剪半径一致
+float RadiusFalloff(float lightDist, float radius)
+{
+    float ratio = lightDist / radius;
+    float falloff = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return falloff * falloff;
+}
+
+void main()
+{
+    vec3 normal = normalize(normalDir);
+    vec3 albedo = uConsts.material.xyz;
+    float roughness = uConsts.material.w;
+    float metallic = 0.0;
+
+    vec3 wo = normalize(ubo.cameraPos - pointOnWorld);
+    float dotNToWo = max(dot(normal, wo), 0.0);
+    vec3 F0 = mix(F0_BASE, albedo, metallic);
+    float G2 = GeometyGGX(roughness, dotNToWo);
+
+    uint clusterIndex = 0;
+    uint lightCount = uCluster.gridSize.w;
+    if (USE_CLUSTERS) {
+        float viewDepth = -(uCluster.view * vec4(pointOnWorld, 1.0)).z;
+        clusterIndex = GetClusterIndex(gl_FragCoord.xy, viewDepth);
+        lightCount = clusterLightCounts[clusterIndex];
+    }
+
+    vec3 outRadiance = vec3(0);
+    for (uint i = 0; i < lightCount; i++) {
+        uint lightIndex = USE_CLUSTERS ? clusterLightIndices[clusterIndex * MAX_LIGHTS_PER_CLUSTER + i] : i;
+        PointLight light = lights[lightIndex];
+
+        float lightDist = distance(light.position, pointOnWorld);
+        if (lightDist >= light.radius) {
+            continue;
+        }
+        vec3 lightIrradianceOnSp = light.power / (4.0 * PI * lightDist * lightDist) * RadiusFalloff(lightDist, light.radius);
+
+        vec3 wi = normalize(pointOnWorld - light.position);
+        float dotNToWi = max(dot(normal, -wi), 0.0);
+        vec3 halfVector = normalize((-wi) + wo);
+
+        vec3 FTerm = FresnelSchlick(F0, max(dot(halfVector, wo), 0.0));
+        float DTerm = DistributionGGX(roughness, normal, halfVector);
+        float G1 = GeometyGGX(roughness, dotNToWi);
+
+        vec3 kD = (vec3(1.0) - FTerm) * (1.0 - metallic);
+        vec3 fr = kD * albedo / PI + FTerm * DTerm * G1 * G2 / (4.0 * dotNToWi * dotNToWo + EPS);
+
+        outRadiance += fr * lightIrradianceOnSp * dotNToWi;
+    }
+
+    vec3 color = gAmbient * albedo + outRadiance;
+
+    // HDR tonemapping
+    color = color / (color + vec3(1.0));
+    // gamma correct
+    color = pow(color, vec3(1.0 / GAMA));
+
+    outColor = vec4(color, 1.0);
+}
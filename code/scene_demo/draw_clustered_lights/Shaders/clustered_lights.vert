@@ -0,0 +1,28 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform GlobalMatrixVP {
+    mat4 view;
+    mat4 proj;
+    vec3 cameraPos;
+} ubo;
+
+layout(push_constant) uniform PushConsts {
+    vec4 offsetScale;   // xyz: 偏移 w: 缩放
+    vec4 material;      // xyz: albedo w: roughness
+} uConsts;
+
+layout(location = 0) in vec3 loacalPosition;
+layout(location = 1) in vec2 texCoordInVert;
+layout(location = 2) in vec3 normalInVert;
+layout(location = 3) in vec3 vsInTangent;
+
+layout(location = 0) out vec3 normal;
+layout(location = 1) out vec3 pointOnWorld;
+
+void main() {
+    pointOnWorld = loacalPosition * uConsts.offsetScale.w + uConsts.offsetScale.xyz;
+    gl_Position = ubo.proj * ubo.view * vec4(pointOnWorld, 1.0);
+
+    normal = normalInVert;
+}
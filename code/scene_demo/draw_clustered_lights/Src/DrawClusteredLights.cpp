@@ -0,0 +1,505 @@
+#include "DrawClusteredLights.h"
+
+#include <stdexcept>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <algorithm>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "SceneDemoDefs.h"
+#include "BufferCreator.h"
+#include "GpuProfiler.h"
+#include "Log.h"
+#include "AppDispatchTable.h"
+#undef LOG_TAG
+#define LOG_TAG "DrawClusteredLights"
+
+namespace framework {
+DrawClusteredLights::DrawClusteredLights()
+{
+    mMesh = new TestMesh;
+    mCamera = new Camera;
+}
+
+DrawClusteredLights::~DrawClusteredLights()
+{
+    delete mCamera;
+    delete mMesh;
+}
+
+void DrawClusteredLights::Init(const RenderInitInfo& initInfo)
+{
+    if (!SceneRenderBase::InitCheck(initInfo)) {
+        return;
+    }
+
+    mCamera->mTargetDistance = 40.0f;
+    mCamera->mTargetPoint = glm::vec3(0.0, 0.0, 0.0);
+    mCamera->mPitch = 35.0f;   // 俯视地面
+    mCamera->mSensitiveX *= 20.0;
+    mCamera->mSensitiveY *= 20.0;
+    mCamera->mSensitiveFront *= 20.0;
+    mCamera->UpdateView();
+
+    mMesh->GenerateSphere(0.4f, glm::vec3(0.0), glm::uvec2(32, 32));
+    CreateDrawList();
+
+    CreatePipelines();
+    mCommandBuffer = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    CreateVertexBuffer();
+    CreateIndexBuffer();
+    CreateUniformBuffer();
+    CreateLights();
+    CreateDescriptorPool();
+    CreateDescriptorSets();
+
+    StartLightCountTest();
+}
+
+void DrawClusteredLights::CleanUp()
+{
+    CleanUpDescriptorPool();
+    mClusteredLights.CleanUp();
+    CleanUpUniformBuffer();
+    CleanUpIndexBuffer();
+    CleanUpVertexBuffer();
+    mDevice->FreeCommandBuffer(mCommandBuffer);
+    CleanUpPipelines();
+}
+
+std::vector<VkCommandBuffer>& DrawClusteredLights::RecordCommand(const RenderInputInfo& input)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+
+    // 测试中先统计上一帧的GPU耗时，可能切换光源数
+    if (mTestRunning) {
+        UpdateLightCountTest();
+    }
+
+    // 更新uniform buffer和光源
+    float aspectRatio = (float)input.swapchainExtent.width / (float)input.swapchainExtent.height;
+    UpdataUniformBuffer(aspectRatio);
+    UpdateLights(input.timeSec);
+
+    dispatch.ResetCommandBuffer(mCommandBuffer, 0);
+    // 开始写入
+    VkCommandBufferBeginInfo beginInfo = vulkanInitializers::CommandBufferBeginInfo(nullptr);
+    if (dispatch.BeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("fiaile to begin recording command buffer!");
+    }
+
+    // 光源分簇，遍历全部光源时也上传光源，只是片元着色器不读分簇结果
+    glm::mat4 proj = mCamera->GetProjection();
+    proj[1][1] *= -1;
+    mClusteredLights.CmdCullLights(mCommandBuffer, mCamera->GetView(), proj, NEAR_PLANE, FAR_PLANE, input.swapchainExtent);
+
+    // 启动Pass
+    CmdBeginPresentPass(mCommandBuffer, input, consts::CLEAR_COLOR_NAVY_FLT);
+    {
+        GpuProfileScope shadingScope(mCommandBuffer, "LightShading");
+
+        PipelineObjecs& pipeline = mBruteForce ? mPipelineBruteForce : mPipelineClustered;
+        dispatch.CmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
+        VkViewport viewport = { 0.0f, 0.0f, (float)input.swapchainExtent.width, (float)input.swapchainExtent.height, 0.0f, 1.0f };
+        dispatch.CmdSetViewport(mCommandBuffer, 0, 1, &viewport);
+        VkRect2D scissor = { { 0, 0 }, input.swapchainExtent };
+        dispatch.CmdSetScissor(mCommandBuffer, 0, 1, &scissor);
+
+        VkDeviceSize offset = 0;
+        dispatch.CmdBindVertexBuffers(mCommandBuffer, 0, 1, &mVertexBuffer, &offset);
+        dispatch.CmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+        dispatch.CmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipeline.layout,
+            0, 1, &mDescriptorSetDraw,
+            0, nullptr);
+
+        uint32_t indexCount = mMesh->GetIndexData().size();
+        for (const DrawPushConstants& draw : mDrawList) {
+            dispatch.CmdPushConstants(mCommandBuffer, pipeline.layout, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+                0, sizeof(DrawPushConstants), &draw);
+            dispatch.CmdDrawIndexed(mCommandBuffer, indexCount, 1, 0, 0, 0);
+        }
+    }
+    // 结束Pass
+    CmdEndPresentPass(mCommandBuffer, input);
+
+    // 写入完成
+    if (dispatch.EndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    mPrimaryCommandBuffers.clear();
+    mPrimaryCommandBuffers.emplace_back(mCommandBuffer);
+    return mPrimaryCommandBuffers;
+}
+
+void DrawClusteredLights::ProcessInputEvent(const InputEventInfo& inputEventInfo)
+{
+    // mouse inpute
+    glm::vec2 curCursorPose = glm::vec2(inputEventInfo.cursorX, inputEventInfo.cursorY);
+    if (inputEventInfo.leftPressFlag && mLastLeftPress) {
+        mCamera->ProcessRotate(curCursorPose - mLastCursorPose);
+    }
+    mLastLeftPress = inputEventInfo.leftPressFlag;
+    mLastCursorPose = curCursorPose;
+
+    // key input，依次处理本帧的所有按键事件
+    for (const InputEvent& event : inputEventInfo.events) {
+        if (event.type != InputEventType::KEY) {
+            continue;
+        }
+
+        // 按T重新测试光源数与GPU耗时的关系
+        if (event.action == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_T == event.code) {
+            if (!mTestKeyPress && !mTestRunning) {
+                StartLightCountTest();
+            }
+            mTestKeyPress = true;
+        }
+        if (event.action == FRAMEWORK_KEY_RELEASE && FRAMEWORK_KEY_T == event.code) {
+            mTestKeyPress = false;
+        }
+
+        if (event.action == FRAMEWORK_KEY_PRESS || event.action == FRAMEWORK_KEY_RELEASE) {
+            if (mKeyPressStatus.find(event.code) != mKeyPressStatus.end()) {
+                mKeyPressStatus[event.code] = static_cast<uint16_t>(event.action);
+            }
+        }
+    }
+    bool directionKeyPress = false;
+    for (auto it = mKeyPressStatus.begin(); it != mKeyPressStatus.end(); it++) {
+        if (it->second) {
+            directionKeyPress = true;
+            break;
+        }
+    }
+    if (directionKeyPress) {
+        float dxFront = mKeyPressStatus[FRAMEWORK_KEY_W] * 0.1f - mKeyPressStatus[FRAMEWORK_KEY_S] * 0.1f;
+        float dxRight = mKeyPressStatus[FRAMEWORK_KEY_D] * 5.0f - mKeyPressStatus[FRAMEWORK_KEY_A] * 5.0f;
+        float dxUp = mKeyPressStatus[FRAMEWORK_KEY_E] * 5.0f - mKeyPressStatus[FRAMEWORK_KEY_Q] * 5.0f;
+        mCamera->ProcessMove(glm::vec3(dxRight, dxUp, dxFront));
+    }
+
+    mCamera->UpdateView();
+}
+
+void DrawClusteredLights::CreateDrawList()
+{
+    mDrawList.resize(DRAW_COUNT);
+    float halfSize = GRID_SPACING * (GRID_SIZE - 1) * 0.5f;
+    for (uint32_t x = 0; x < GRID_SIZE; x++) {
+        for (uint32_t y = 0; y < GRID_SIZE; y++) {
+            uint32_t index = x * GRID_SIZE + y;
+            glm::vec3 offset = glm::vec3(x * GRID_SPACING - halfSize, y * GRID_SPACING - halfSize, 0.0f);
+            // 粗糙度沿x变化，便于看出高光
+            float roughness = 0.2f + 0.7f * x / static_cast<float>(GRID_SIZE - 1);
+            mDrawList[index].offsetScale = glm::vec4(offset, 1.0f);
+            mDrawList[index].material = glm::vec4(0.8f, 0.8f, 0.8f, roughness);
+        }
+    }
+}
+
+void DrawClusteredLights::CreateLights()
+{
+    mClusteredLights.Init(mDevice, MAX_LIGHT_COUNT);
+
+    // 固定种子，每次运行的光源分布相同，测试结果可以对比
+    std::mt19937 random(20240101);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float halfSize = GRID_SPACING * GRID_SIZE * 0.5f;
+    float power = LIGHT_THRESHOLD * 4.0f * glm::pi<float>() * LIGHT_RADIUS * LIGHT_RADIUS;
+
+    mLightMotions.resize(MAX_LIGHT_COUNT);
+    mLights.resize(MAX_LIGHT_COUNT);
+    for (uint32_t i = 0; i < MAX_LIGHT_COUNT; i++) {
+        LightMotion& motion = mLightMotions[i];
+        motion.center = glm::vec3((unit(random) * 2.0f - 1.0f) * halfSize, (unit(random) * 2.0f - 1.0f) * halfSize,
+            0.3f + unit(random) * 1.2f);
+        motion.orbitRadius = 0.5f + unit(random) * 2.5f;
+        motion.angularSpeed = (unit(random) * 2.0f - 1.0f) * 1.5f;
+        motion.phase = unit(random) * 2.0f * glm::pi<float>();
+
+        // 饱和的随机颜色，总功率相同
+        glm::vec3 color = glm::vec3(unit(random), unit(random), unit(random));
+        color /= std::max(color.r, std::max(color.g, color.b));
+        mLights[i].power = color * power;
+        mLights[i].radius = ClusteredLights::CalculateRadius(mLights[i].power, LIGHT_THRESHOLD);
+    }
+}
+
+void DrawClusteredLights::UpdateLights(float timeSec)
+{
+    for (uint32_t i = 0; i < mActiveLightCount; i++) {
+        const LightMotion& motion = mLightMotions[i];
+        float angle = motion.phase + motion.angularSpeed * timeSec;
+        mLights[i].position = motion.center + motion.orbitRadius * glm::vec3(std::cos(angle), std::sin(angle), 0.0f);
+    }
+    mClusteredLights.SetLights(mLights.data(), mActiveLightCount);
+}
+
+void DrawClusteredLights::CreateVertexBuffer() {
+    VkDeviceSize bufferSize = sizeof(Vertex3D) * mMesh->GetVertexData().size();
+
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+
+    bufferCreator.CreateBufferFromSrcData(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mMesh->GetVertexData().data(), bufferSize,
+            mVertexBuffer, mVertexBufferMemory);
+}
+
+void DrawClusteredLights::CleanUpVertexBuffer() {
+    // 销毁顶点缓冲区及显存
+    vkDestroyBuffer(mDevice->Get(), mVertexBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mVertexBufferMemory, nullptr);
+}
+
+void DrawClusteredLights::CreateIndexBuffer() {
+    VkDeviceSize bufferSize = sizeof(uint16_t) * mMesh->GetIndexData().size();
+
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+
+    bufferCreator.CreateBufferFromSrcData(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mMesh->GetIndexData().data(), bufferSize,
+        mIndexBuffer, mIndexBufferMemory);
+}
+
+void DrawClusteredLights::CleanUpIndexBuffer() {
+    vkDestroyBuffer(mDevice->Get(), mIndexBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mIndexBufferMemory, nullptr);
+}
+
+void DrawClusteredLights::CreateUniformBuffer()
+{
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+
+    std::vector<VkBufferCreateInfo> bufferInfos = {
+        vulkanInitializers::BufferCreateInfo(sizeof(GlobalMatrixVP), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+    };
+    std::vector<VkBuffer> buffers(bufferInfos.size(), VK_NULL_HANDLE);
+    std::vector<void*> mappedAddress(bufferInfos.size(), nullptr);
+    VkDeviceMemory bufferMemory = VK_NULL_HANDLE;
+    bufferCreator.CreateMappedBuffers(bufferInfos, buffers, mappedAddress, bufferMemory);
+
+    mUniformBuffersMemory = bufferMemory;
+    mUboGlobalMatrixVP = buffers[0];
+    mUboGlobalMatrixVPAddr = mappedAddress[0];
+}
+
+void DrawClusteredLights::CleanUpUniformBuffer() {
+    vkDestroyBuffer(mDevice->Get(), mUboGlobalMatrixVP, nullptr);
+    vkFreeMemory(mDevice->Get(), mUniformBuffersMemory, nullptr);
+}
+
+void DrawClusteredLights::CreateDescriptorPool() {
+    std::vector<VkDescriptorPoolSize> poolSizes = {};   // 池中各种类型的Descriptor个数
+    poolSizes.insert(poolSizes.end(), mPipelineClustered.descriptorSizes.begin(), mPipelineClustered.descriptorSizes.end());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;   // 池中最大能申请descriptorSet的个数
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+}
+
+void DrawClusteredLights::CleanUpDescriptorPool() {
+    vkDestroyDescriptorPool(mDevice->Get(), mDescriptorPool, nullptr);
+}
+
+void DrawClusteredLights::CreateDescriptorSets() {
+    // 从池中申请descriptor set
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = mDescriptorPool;
+    allocInfo.descriptorSetCount = mPipelineClustered.descriptorSetLayouts.size();
+    allocInfo.pSetLayouts = mPipelineClustered.descriptorSetLayouts.data();
+    if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetDraw) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mDescriptorSetDraw!");
+    }
+
+    // 向descriptor set写入信息
+    VkDescriptorBufferInfo uboVpInfo = { mUboGlobalMatrixVP, 0, sizeof(GlobalMatrixVP) };
+    std::vector<VkWriteDescriptorSet> descriptorWrites = {
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetDraw,
+            0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &uboVpInfo),
+    };
+    vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    mClusteredLights.WriteDescriptorSet(mDescriptorSetDraw);
+}
+
+void DrawClusteredLights::CreatePipelines()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    // 片元着色器按常量0选择是否使用分簇结果
+    VkBool32 useClusters = VK_TRUE;
+    VkSpecializationMapEntry useClustersEntry = { 0, 0, sizeof(VkBool32) };
+    VkSpecializationInfo useClustersSpecialization{};
+    useClustersSpecialization.mapEntryCount = 1;
+    useClustersSpecialization.pMapEntries = &useClustersEntry;
+    useClustersSpecialization.dataSize = sizeof(useClusters);
+    useClustersSpecialization.pData = &useClusters;
+
+    std::vector<ShaderFileInfo> shaderFilePaths = {
+        { GetConfig().directory.dirSpvFiles + std::string("clustered_lights.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT },
+        { GetConfig().directory.dirSpvFiles + std::string("clustered_lights.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT,
+            &useClustersSpecialization },
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    ClusteredLights::AppendLayoutBindings(layoutBindings);
+
+    std::vector<VkPushConstantRange> pushConstantRanges = {
+        { VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstants) },
+    };
+
+    GraphicsPipelineConfigInfo configInfo{};
+    SetPresentPassTarget(configInfo);
+    configInfo.SetVertexInputBindings({ Vertex3D::GetBindingDescription() });
+    configInfo.SetVertexInputAttributes(Vertex3D::getAttributeDescriptions());
+    configInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
+    configInfo.mDepthStencilState.depthWriteEnable = VK_TRUE;
+    configInfo.mDepthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+    configInfo.mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+
+    mPipelineClustered = pipelineFactory.CreateGraphicsPipeline(configInfo, shaderFilePaths, layoutBindings, pushConstantRanges);
+
+    // 布局和上面完全相同，descriptor set可以通用
+    useClusters = VK_FALSE;
+    mPipelineBruteForce = pipelineFactory.CreateGraphicsPipeline(configInfo, shaderFilePaths, layoutBindings, pushConstantRanges);
+}
+
+void DrawClusteredLights::CleanUpPipelines()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    pipelineFactory.DestroyPipelineObjecst(mPipelineBruteForce);
+    pipelineFactory.DestroyPipelineObjecst(mPipelineClustered);
+}
+
+void DrawClusteredLights::UpdataUniformBuffer(float aspectRatio)
+{
+    mCamera->SetPerspective(aspectRatio, NEAR_PLANE, FAR_PLANE, 45.0f);
+
+    GlobalMatrixVP uboVp{};
+    uboVp.view = mCamera->GetView();
+    uboVp.proj = mCamera->GetProjection();
+    uboVp.proj[1][1] *= -1;
+    uboVp.cameraPos = glm::inverse(uboVp.view) * glm::vec4(0.0, 0.0, 0.0, 1.0);
+    memcpy(mUboGlobalMatrixVPAddr, &uboVp, sizeof(uboVp));
+}
+
+void DrawClusteredLights::StartLightCountTest()
+{
+    if (!GpuProfiler::GetInstance().IsEnabled()) {
+        LOGW("gpu profiler is disabled, skip light count test");
+        return;
+    }
+
+    // 64, 256 ... 直到最大光源数，较少时额外测一组遍历全部光源的对照
+    mTestSteps.clear();
+    for (uint32_t count = 64; count <= MAX_LIGHT_COUNT; count *= 4) {
+        mTestSteps.push_back({ count, false });
+        if (count <= BRUTE_FORCE_MAX_LIGHT_COUNT) {
+            mTestSteps.push_back({ count, true });
+        }
+    }
+
+    mTestResults.clear();
+    mTestStep = 0;
+    mTestFrame = 0;
+    mTestCullTimeSum = 0.0;
+    mTestShadingTimeSum = 0.0;
+    mTestRunning = true;
+    mActiveLightCount = mTestSteps[0].lightCount;
+    mBruteForce = mTestSteps[0].bruteForce;
+    LOGI("start light count test: %d draws, max %d lights", DRAW_COUNT, MAX_LIGHT_COUNT);
+}
+
+void DrawClusteredLights::UpdateLightCountTest()
+{
+    // 结果晚几帧才能读到，预热阶段丢弃，同时把切换之前的帧排除在外
+    mTestFrame++;
+    if (mTestFrame <= TEST_WARMUP_FRAMES) {
+        return;
+    }
+    GpuProfiler& profiler = GpuProfiler::GetInstance();
+    mTestCullTimeSum += profiler.GetLastScopeTimeMs("LightCull");
+    mTestShadingTimeSum += profiler.GetLastScopeTimeMs("LightShading");
+
+    if (mTestFrame < TEST_WARMUP_FRAMES + TEST_MEASURE_FRAMES) {
+        return;
+    }
+
+    const LightCountStep& step = mTestSteps[mTestStep];
+    float avgCullTimeMs = static_cast<float>(mTestCullTimeSum / TEST_MEASURE_FRAMES);
+    float avgShadingTimeMs = static_cast<float>(mTestShadingTimeSum / TEST_MEASURE_FRAMES);
+    if (step.bruteForce) {
+        // 对照组紧跟在同样光源数的分簇组之后
+        if (!mTestResults.empty() && mTestResults.back().lightCount == step.lightCount) {
+            mTestResults.back().bruteForceTimeMs = avgShadingTimeMs;
+        }
+    } else {
+        LightCountResult result{};
+        result.lightCount = step.lightCount;
+        result.cullTimeMs = avgCullTimeMs;
+        result.shadingTimeMs = avgShadingTimeMs;
+        mTestResults.emplace_back(result);
+    }
+
+    // 下一组
+    mTestStep++;
+    mTestFrame = 0;
+    mTestCullTimeSum = 0.0;
+    mTestShadingTimeSum = 0.0;
+    if (mTestStep < mTestSteps.size()) {
+        mActiveLightCount = mTestSteps[mTestStep].lightCount;
+        mBruteForce = mTestSteps[mTestStep].bruteForce;
+        return;
+    }
+
+    mTestRunning = false;
+    mActiveLightCount = DEFAULT_LIGHT_COUNT;
+    mBruteForce = false;
+    PrintLightCountChart();
+}
+
+void DrawClusteredLights::PrintLightCountChart()
+{
+    if (mTestResults.empty()) {
+        return;
+    }
+
+    constexpr int MAX_BAR_LENGTH = 40;
+    float maxTime = 1e-4f;
+    for (auto& result : mTestResults) {
+        maxTime = std::max(maxTime, result.cullTimeMs + result.shadingTimeMs);
+    }
+
+    LOGI("------------- clustered lights gpu time (%d draws) -------------", DRAW_COUNT);
+    LOGI("  lights | cull(ms) | shading(ms) | total(ms) | brute force(ms)");
+    for (auto& result : mTestResults) {
+        float totalTime = result.cullTimeMs + result.shadingTimeMs;
+        std::string bar(static_cast<size_t>(MAX_BAR_LENGTH * totalTime / maxTime), '#');
+        char bruteForce[32] = "-";
+        if (result.bruteForceTimeMs >= 0.0f) {
+            snprintf(bruteForce, sizeof(bruteForce), "%.3f", result.bruteForceTimeMs);
+        }
+        LOGI(" %7d | %8.3f | %11.3f | %9.3f | %15s %s",
+            result.lightCount, result.cullTimeMs, result.shadingTimeMs, totalTime, bruteForce, bar.c_str());
+    }
+    LOGI("----------------------------------------------------------------");
+}
+}   // namespace framework
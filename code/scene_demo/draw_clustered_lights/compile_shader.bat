@@ -0,0 +1,12 @@
+@set glslc=C:\VulkanSDK\1.3.239.0\Bin
+
+:: 设置环境变量
+@set PATH=%glslc%;%PATH%
+
+@set SHADER_SRC_DIR=.\Shaders
+if not exist .\Spirv mkdir .\Spirv
+glslc %SHADER_SRC_DIR%\clustered_lights.vert -o .\Spirv\clustered_lights.vert.spv
+glslc %SHADER_SRC_DIR%\clustered_lights.frag -o .\Spirv\clustered_lights.frag.spv
+glslc %SHADER_SRC_DIR%\cluster_light_cull.comp -o .\Spirv\cluster_light_cull.comp.spv
+
+pause
@@ -0,0 +1,128 @@
+#ifndef __DRAW_PARALLEL_RECORD_H__
+#define __DRAW_PARALLEL_RECORD_H__
+
+#include <vulkan/vulkan.h>
+
+#include "SceneRenderBase.h"
+#include "FrameworkHeaders.h"
+#include "TestMesh.h"
+#include "Camera.h"
+#include "ParallelCommandRecorder.h"
+
+namespace framework {
+class DrawParallelRecord : public SceneRenderBase {
+public:
+    DrawParallelRecord();
+    ~DrawParallelRecord();
+
+    void Init(const RenderInitInfo& initInfo) override;
+    void CleanUp() override;
+    std::vector<VkCommandBuffer>& RecordCommand(const RenderInputInfo& input) override;
+    void ProcessInputEvent(const InputEventInfo& inputEventInfo) override;
+    Camera* GetCamera() override { return mCamera; }
+
+private:
+    void CreateDrawList();
+
+    void CreateVertexBuffer();
+    void CleanUpVertexBuffer();
+
+    void CreateIndexBuffer();
+    void CleanUpIndexBuffer();
+
+    void CreateUniformBuffer();
+    void CleanUpUniformBuffer();
+
+    void CreateDescriptorPool();
+    void CleanUpDescriptorPool();
+    void CreateDescriptorSets();
+
+    void CreatePipelines();
+    void CleanUpPipelines();
+
+    void UpdataUniformBuffer(float aspectRatio);
+
+    // tool functions
+    void RecordDrawRange(VkCommandBuffer cmdBuf, uint32_t firstDraw, uint32_t drawCount);
+    void StartScalingTest();
+    void UpdateScalingTest(float recordTimeMs);
+    void PrintScalingChart();
+
+private:
+    std::vector<VkCommandBuffer> mPrimaryCommandBuffers = {};
+
+    // ---- render objects ----
+    PipelineObjecs mPipelineDraw = {};
+
+    VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+    ParallelCommandRecorder* mRecorder = nullptr;
+
+    // vertex buffer
+    VkBuffer mVertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mVertexBufferMemory = VK_NULL_HANDLE;
+
+    // index buffer
+    VkBuffer mIndexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mIndexBufferMemory = VK_NULL_HANDLE;
+
+    // uniform buffer
+    VkBuffer mUboGlobalMatrixVP = VK_NULL_HANDLE;
+    void* mUboGlobalMatrixVPAddr = nullptr;
+    VkDeviceMemory mUniformBuffersMemory = VK_NULL_HANDLE;
+
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptorSetDraw = VK_NULL_HANDLE;
+
+    // data
+    struct GlobalMatrixVP {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::vec3 cameraPos;
+    };
+
+    struct DrawPushConstants {
+        glm::vec4 offsetScale;
+        glm::vec4 color;
+    };
+
+    // 32 x 32 x 32个小球，每个小球一次draw call
+    static constexpr uint32_t GRID_SIZE = 32;
+    static constexpr uint32_t DRAW_COUNT = GRID_SIZE * GRID_SIZE * GRID_SIZE;
+    std::vector<DrawPushConstants> mDrawList = {};
+    VkExtent2D mCurrentExtent = {};
+
+    // 线程数-录制耗时测试
+    static constexpr uint32_t SCALING_WARMUP_FRAMES = 30;
+    static constexpr uint32_t SCALING_MEASURE_FRAMES = 200;
+    struct ScalingResult {
+        uint32_t workerCount = 0;
+        float avgRecordTimeMs = 0.0f;
+        float avgFrameCpuTimeMs = 0.0f;
+    };
+    std::vector<uint32_t> mScalingWorkerCounts = {};
+    std::vector<ScalingResult> mScalingResults = {};
+    uint32_t mScalingStep = 0;
+    uint32_t mScalingFrame = 0;
+    bool mScalingTestRunning = false;
+    double mScalingRecordTimeSum = 0.0;
+    double mScalingFrameTimeSum = 0.0;
+
+    TestMesh* mMesh = nullptr;
+    Camera* mCamera = nullptr;
+
+    bool mLastLeftPress = false;
+    glm::vec2 mLastCursorPose = { 0.0, 0.0 };
+    std::unordered_map<int, uint16_t> mKeyPressStatus = {
+        { FRAMEWORK_KEY_W, false },
+        { FRAMEWORK_KEY_A, false },
+        { FRAMEWORK_KEY_S, false },
+        { FRAMEWORK_KEY_D, false },
+        { FRAMEWORK_KEY_Q, false },
+        { FRAMEWORK_KEY_E, false },
+    };
+    bool mTestKeyPress = false;
+
+};
+}
+
+#endif // __DRAW_PARALLEL_RECORD_H__
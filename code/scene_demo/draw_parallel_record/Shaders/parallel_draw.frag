@@ -0,0 +1,31 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform GlobalMatrixVP {
+    mat4 view;
+    mat4 proj;
+    vec3 cameraPos;
+} ubo;
+
+layout(push_constant) uniform PushConsts {
+    vec4 offsetScale;
+    vec4 color;
+} uConsts;
+
+layout(location = 0) in vec3 normal;
+layout(location = 1) in vec3 pointOnWorld;
+
+layout(location = 0) out vec4 outColor;
+
+const vec3 lightDir = normalize(vec3(1.0, 1.0, 2.0));
+const float gAmbient = 0.15;
+
+void main() {
+    vec3 N = normalize(normal);
+    vec3 V = normalize(ubo.cameraPos - pointOnWorld);
+    vec3 H = normalize(lightDir + V);
+
+    float diffuse = max(dot(N, lightDir), 0.0);
+    float specular = pow(max(dot(N, H), 0.0), 32.0) * 0.3;
+    outColor = vec4(uConsts.color.rgb * (gAmbient + diffuse) + vec3(specular), 1.0);
+}
@@ -0,0 +1,441 @@
+#include "DrawParallelRecord.h"
+
+#include <stdexcept>
+#include <array>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "SceneDemoDefs.h"
+#include "BufferCreator.h"
+#include "Log.h"
+#include "AppDispatchTable.h"
+#undef LOG_TAG
+#define LOG_TAG "DrawParallelRecord"
+
+namespace framework {
+DrawParallelRecord::DrawParallelRecord()
+{
+    mMesh = new TestMesh;
+    mCamera = new Camera;
+    mRecorder = new ParallelCommandRecorder;
+}
+
+DrawParallelRecord::~DrawParallelRecord()
+{
+    delete mRecorder;
+    delete mCamera;
+    delete mMesh;
+}
+
+void DrawParallelRecord::Init(const RenderInitInfo& initInfo)
+{
+    if (!SceneRenderBase::InitCheck(initInfo)) {
+        return;
+    }
+
+    mCamera->mTargetDistance = 60.0f;
+    mCamera->mTargetPoint = glm::vec3(0.0, 0.0, 0.0);
+    mCamera->mSensitiveX *= 20.0;
+    mCamera->mSensitiveY *= 20.0;
+    mCamera->mSensitiveFront *= 20.0;
+
+    // 低精度小球，压力集中在draw call数量上
+    mMesh->GenerateSphere(0.4f, glm::vec3(0.0), glm::uvec2(8, 8));
+    CreateDrawList();
+
+    mRecorder->Init(mDevice, 0);  // 段数跟随JobSystem的工作线程数
+
+    CreatePipelines();
+    mCommandBuffer = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    CreateVertexBuffer();
+    CreateIndexBuffer();
+    CreateUniformBuffer();
+    CreateDescriptorPool();
+    CreateDescriptorSets();
+
+    StartScalingTest();
+}
+
+void DrawParallelRecord::CleanUp()
+{
+    CleanUpDescriptorPool();
+    CleanUpUniformBuffer();
+    CleanUpIndexBuffer();
+    CleanUpVertexBuffer();
+    mDevice->FreeCommandBuffer(mCommandBuffer);
+    CleanUpPipelines();
+    mRecorder->CleanUp();
+}
+
+std::vector<VkCommandBuffer>& DrawParallelRecord::RecordCommand(const RenderInputInfo& input)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    auto frameStartTime = std::chrono::steady_clock::now();
+
+    // 更新uniform buffer
+    float aspectRatio = (float)input.swapchainExtent.width / (float)input.swapchainExtent.height;
+    UpdataUniformBuffer(aspectRatio);
+    mCurrentExtent = input.swapchainExtent;
+
+    dispatch.ResetCommandBuffer(mCommandBuffer, 0);
+    // 开始写入
+    VkCommandBufferBeginInfo beginInfo = vulkanInitializers::CommandBufferBeginInfo(nullptr);
+    if (dispatch.BeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("fiaile to begin recording command buffer!");
+    }
+
+    // 启动Pass，pass内容全部来自二级命令缓冲
+    CmdBeginPresentPass(mCommandBuffer, input, consts::CLEAR_COLOR_NAVY_FLT, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    // 多线程录制二级命令缓冲
+    SecondaryRecordInfo recordInfo{};
+    recordInfo.frameIndex = 0;  // RenderThread只有一个飞行帧
+    recordInfo.renderPass = input.presentRenderPass;
+    recordInfo.subpass = 0;
+    recordInfo.framebuffer = input.swapchanFb;
+    recordInfo.renderingInfo = GetPresentInheritanceRenderingInfo();
+    recordInfo.drawCount = DRAW_COUNT;
+    std::vector<VkCommandBuffer>& secondaryCommandBuffers = mRecorder->Record(recordInfo,
+        [this](VkCommandBuffer cmdBuf, uint32_t rangeIndex, uint32_t firstDraw, uint32_t drawCount) {
+            RecordDrawRange(cmdBuf, firstDraw, drawCount);
+        });
+    if (!secondaryCommandBuffers.empty()) {
+        dispatch.CmdExecuteCommands(mCommandBuffer, secondaryCommandBuffers.size(), secondaryCommandBuffers.data());
+    }
+
+    // 结束Pass
+    CmdEndPresentPass(mCommandBuffer, input);
+
+    // 写入完成
+    if (dispatch.EndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    auto frameEndTime = std::chrono::steady_clock::now();
+    if (mScalingTestRunning) {
+        mScalingFrameTimeSum += std::chrono::duration<double, std::milli>(frameEndTime - frameStartTime).count();
+        UpdateScalingTest(mRecorder->GetLastRecordTimeMs());
+    }
+
+    mPrimaryCommandBuffers.clear();
+    mPrimaryCommandBuffers.emplace_back(mCommandBuffer);
+    return mPrimaryCommandBuffers;
+}
+
+void DrawParallelRecord::ProcessInputEvent(const InputEventInfo& inputEventInfo)
+{
+    // mouse inpute
+    glm::vec2 curCursorPose = glm::vec2(inputEventInfo.cursorX, inputEventInfo.cursorY);
+    if (inputEventInfo.leftPressFlag && mLastLeftPress) {
+        mCamera->ProcessRotate(curCursorPose - mLastCursorPose);
+    }
+    mLastLeftPress = inputEventInfo.leftPressFlag;
+    mLastCursorPose = curCursorPose;
+
+    // key input，依次处理本帧的所有按键事件
+    for (const InputEvent& event : inputEventInfo.events) {
+        if (event.type != InputEventType::KEY) {
+            continue;
+        }
+
+        // 按T重新测试线程数与录制耗时的关系
+        if (event.action == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_T == event.code) {
+            if (!mTestKeyPress && !mScalingTestRunning) {
+                StartScalingTest();
+            }
+            mTestKeyPress = true;
+        }
+        if (event.action == FRAMEWORK_KEY_RELEASE && FRAMEWORK_KEY_T == event.code) {
+            mTestKeyPress = false;
+        }
+
+        if (event.action == FRAMEWORK_KEY_PRESS || event.action == FRAMEWORK_KEY_RELEASE) {
+            if (mKeyPressStatus.find(event.code) != mKeyPressStatus.end()) {
+                mKeyPressStatus[event.code] = static_cast<uint16_t>(event.action);
+            }
+        }
+    }
+    bool directionKeyPress = false;
+    for (auto it = mKeyPressStatus.begin(); it != mKeyPressStatus.end(); it++) {
+        if (it->second) {
+            directionKeyPress = true;
+            break;
+        }
+    }
+    if (directionKeyPress) {
+        float dxFront = mKeyPressStatus[FRAMEWORK_KEY_W] * 0.1f - mKeyPressStatus[FRAMEWORK_KEY_S] * 0.1f;
+        float dxRight = mKeyPressStatus[FRAMEWORK_KEY_D] * 5.0f - mKeyPressStatus[FRAMEWORK_KEY_A] * 5.0f;
+        float dxUp = mKeyPressStatus[FRAMEWORK_KEY_E] * 5.0f - mKeyPressStatus[FRAMEWORK_KEY_Q] * 5.0f;
+        mCamera->ProcessMove(glm::vec3(dxRight, dxUp, dxFront));
+    }
+
+    mCamera->UpdateView();
+}
+
+void DrawParallelRecord::CreateDrawList()
+{
+    mDrawList.resize(DRAW_COUNT);
+    float spacing = 1.2f;
+    float halfSize = spacing * (GRID_SIZE - 1) * 0.5f;
+    for (uint32_t x = 0; x < GRID_SIZE; x++) {
+        for (uint32_t y = 0; y < GRID_SIZE; y++) {
+            for (uint32_t z = 0; z < GRID_SIZE; z++) {
+                uint32_t index = (x * GRID_SIZE + y) * GRID_SIZE + z;
+                glm::vec3 offset = glm::vec3(x, y, z) * spacing - glm::vec3(halfSize);
+                glm::vec3 color = glm::vec3(x, y, z) / static_cast<float>(GRID_SIZE - 1);
+                mDrawList[index].offsetScale = glm::vec4(offset, 1.0f);
+                mDrawList[index].color = glm::vec4(color * 0.8f + 0.2f, 1.0f);
+            }
+        }
+    }
+}
+
+void DrawParallelRecord::CreateVertexBuffer() {
+    VkDeviceSize bufferSize = sizeof(Vertex3D) * mMesh->GetVertexData().size();
+
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+
+    bufferCreator.CreateBufferFromSrcData(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mMesh->GetVertexData().data(), bufferSize,
+            mVertexBuffer, mVertexBufferMemory);
+}
+
+void DrawParallelRecord::CleanUpVertexBuffer() {
+    // 销毁顶点缓冲区及显存
+    vkDestroyBuffer(mDevice->Get(), mVertexBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mVertexBufferMemory, nullptr);
+}
+
+void DrawParallelRecord::CreateIndexBuffer() {
+    VkDeviceSize bufferSize = sizeof(uint16_t) * mMesh->GetIndexData().size();
+
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+
+    bufferCreator.CreateBufferFromSrcData(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mMesh->GetIndexData().data(), bufferSize,
+        mIndexBuffer, mIndexBufferMemory);
+}
+
+void DrawParallelRecord::CleanUpIndexBuffer() {
+    vkDestroyBuffer(mDevice->Get(), mIndexBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mIndexBufferMemory, nullptr);
+}
+
+void DrawParallelRecord::CreateUniformBuffer()
+{
+    BufferCreator& bufferCreator = BufferCreator::GetInstance();
+
+    std::vector<VkBufferCreateInfo> bufferInfos = {
+        vulkanInitializers::BufferCreateInfo(sizeof(GlobalMatrixVP), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
+    };
+    std::vector<VkBuffer> buffers(bufferInfos.size(), VK_NULL_HANDLE);
+    std::vector<void*> mappedAddress(bufferInfos.size(), nullptr);
+    VkDeviceMemory bufferMemory = VK_NULL_HANDLE;
+    bufferCreator.CreateMappedBuffers(bufferInfos, buffers, mappedAddress, bufferMemory);
+
+    mUniformBuffersMemory = bufferMemory;
+    mUboGlobalMatrixVP = buffers[0];
+    mUboGlobalMatrixVPAddr = mappedAddress[0];
+}
+
+void DrawParallelRecord::CleanUpUniformBuffer() {
+    vkDestroyBuffer(mDevice->Get(), mUboGlobalMatrixVP, nullptr);
+    vkFreeMemory(mDevice->Get(), mUniformBuffersMemory, nullptr);
+}
+
+void DrawParallelRecord::CreateDescriptorPool() {
+    std::vector<VkDescriptorPoolSize> poolSizes = {};   // 池中各种类型的Descriptor个数
+    poolSizes.insert(poolSizes.end(), mPipelineDraw.descriptorSizes.begin(), mPipelineDraw.descriptorSizes.end());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;   // 池中最大能申请descriptorSet的个数
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+}
+
+void DrawParallelRecord::CleanUpDescriptorPool() {
+    vkDestroyDescriptorPool(mDevice->Get(), mDescriptorPool, nullptr);
+}
+
+void DrawParallelRecord::CreateDescriptorSets() {
+    // 从池中申请descriptor set
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = mDescriptorPool;
+    allocInfo.descriptorSetCount = mPipelineDraw.descriptorSetLayouts.size();
+    allocInfo.pSetLayouts = mPipelineDraw.descriptorSetLayouts.data();
+    if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetDraw) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mDescriptorSetDraw!");
+    }
+
+    // 向descriptor set写入信息
+    VkDescriptorBufferInfo uboVpInfo = { mUboGlobalMatrixVP, 0, sizeof(GlobalMatrixVP) };
+    std::vector<VkWriteDescriptorSet> descriptorWrites = {
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetDraw,
+            0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &uboVpInfo),
+    };
+    vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+}
+
+void DrawParallelRecord::CreatePipelines()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    std::vector<ShaderFileInfo> shaderFilePaths = {
+        { GetConfig().directory.dirSpvFiles + std::string("parallel_draw.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT },
+        { GetConfig().directory.dirSpvFiles + std::string("parallel_draw.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+
+    std::vector<VkPushConstantRange> pushConstantRanges = {
+        { VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawPushConstants) },
+    };
+
+    GraphicsPipelineConfigInfo configInfo{};
+    SetPresentPassTarget(configInfo);
+    configInfo.SetVertexInputBindings({ Vertex3D::GetBindingDescription() });
+    configInfo.SetVertexInputAttributes(Vertex3D::getAttributeDescriptions());
+    configInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
+    configInfo.mDepthStencilState.depthWriteEnable = VK_TRUE;
+    configInfo.mDepthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+    configInfo.mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+
+    mPipelineDraw = pipelineFactory.CreateGraphicsPipeline(configInfo, shaderFilePaths, layoutBindings, pushConstantRanges);
+}
+
+void DrawParallelRecord::CleanUpPipelines()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    pipelineFactory.DestroyPipelineObjecst(mPipelineDraw);
+}
+
+void DrawParallelRecord::UpdataUniformBuffer(float aspectRatio)
+{
+    mCamera->SetPerspective(aspectRatio, 0.1f, 200.0f, 45.0f);
+
+    GlobalMatrixVP uboVp{};
+    uboVp.view = mCamera->GetView();
+    uboVp.proj = mCamera->GetProjection();
+    uboVp.proj[1][1] *= -1;
+    uboVp.cameraPos = glm::inverse(uboVp.view) * glm::vec4(0.0, 0.0, 0.0, 1.0);
+    memcpy(mUboGlobalMatrixVPAddr, &uboVp, sizeof(uboVp));
+}
+
+void DrawParallelRecord::RecordDrawRange(VkCommandBuffer cmdBuf, uint32_t firstDraw, uint32_t drawCount)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // 二级命令缓冲不继承任何状态，需要各自绑定
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineDraw.pipeline);
+    VkViewport viewport = { 0.0f, 0.0f, (float)mCurrentExtent.width, (float)mCurrentExtent.height, 0.0f, 1.0f };
+    dispatch.CmdSetViewport(cmdBuf, 0, 1, &viewport);
+    VkRect2D scissor = { { 0, 0 }, mCurrentExtent };
+    dispatch.CmdSetScissor(cmdBuf, 0, 1, &scissor);
+
+    VkDeviceSize offset = 0;
+    dispatch.CmdBindVertexBuffers(cmdBuf, 0, 1, &mVertexBuffer, &offset);
+    dispatch.CmdBindIndexBuffer(cmdBuf, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        mPipelineDraw.layout,
+        0, 1, &mDescriptorSetDraw,
+        0, nullptr);
+
+    uint32_t indexCount = mMesh->GetIndexData().size();
+    for (uint32_t i = firstDraw; i < firstDraw + drawCount; i++) {
+        dispatch.CmdPushConstants(cmdBuf, mPipelineDraw.layout, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+            0, sizeof(DrawPushConstants), &mDrawList[i]);
+        dispatch.CmdDrawIndexed(cmdBuf, indexCount, 1, 0, 0, 0);
+    }
+}
+
+void DrawParallelRecord::StartScalingTest()
+{
+    // 1, 2, 4 ... 直到最大线程数
+    mScalingWorkerCounts.clear();
+    for (uint32_t count = 1; count < mRecorder->GetWorkerCount(); count *= 2) {
+        mScalingWorkerCounts.emplace_back(count);
+    }
+    mScalingWorkerCounts.emplace_back(mRecorder->GetWorkerCount());
+
+    mScalingResults.clear();
+    mScalingStep = 0;
+    mScalingFrame = 0;
+    mScalingRecordTimeSum = 0.0;
+    mScalingFrameTimeSum = 0.0;
+    mScalingTestRunning = true;
+    mRecorder->SetActiveWorkerCount(mScalingWorkerCounts[0]);
+    LOGI("start scaling test: %d draws, max %d workers", DRAW_COUNT, mRecorder->GetWorkerCount());
+}
+
+void DrawParallelRecord::UpdateScalingTest(float recordTimeMs)
+{
+    mScalingFrame++;
+    if (mScalingFrame <= SCALING_WARMUP_FRAMES) {
+        // 预热阶段不计入统计
+        mScalingRecordTimeSum = 0.0;
+        mScalingFrameTimeSum = 0.0;
+        return;
+    }
+    mScalingRecordTimeSum += recordTimeMs;
+
+    if (mScalingFrame < SCALING_WARMUP_FRAMES + SCALING_MEASURE_FRAMES) {
+        return;
+    }
+
+    ScalingResult result{};
+    result.workerCount = mRecorder->GetActiveWorkerCount();
+    result.avgRecordTimeMs = static_cast<float>(mScalingRecordTimeSum / SCALING_MEASURE_FRAMES);
+    result.avgFrameCpuTimeMs = static_cast<float>(mScalingFrameTimeSum / SCALING_MEASURE_FRAMES);
+    mScalingResults.emplace_back(result);
+
+    // 下一组
+    mScalingStep++;
+    mScalingFrame = 0;
+    mScalingRecordTimeSum = 0.0;
+    mScalingFrameTimeSum = 0.0;
+    if (mScalingStep < mScalingWorkerCounts.size()) {
+        mRecorder->SetActiveWorkerCount(mScalingWorkerCounts[mScalingStep]);
+        return;
+    }
+
+    mScalingTestRunning = false;
+    mRecorder->SetActiveWorkerCount(mRecorder->GetWorkerCount());
+    PrintScalingChart();
+}
+
+void DrawParallelRecord::PrintScalingChart()
+{
+    if (mScalingResults.empty()) {
+        return;
+    }
+
+    constexpr int MAX_BAR_LENGTH = 40;
+    float baseTime = mScalingResults[0].avgRecordTimeMs;
+    float maxSpeedup = 1.0f;
+    for (auto& result : mScalingResults) {
+        maxSpeedup = std::max(maxSpeedup, baseTime / std::max(result.avgRecordTimeMs, 1e-4f));
+    }
+
+    LOGI("------------- parallel record scaling (%d draws) -------------", DRAW_COUNT);
+    LOGI(" workers | record(ms) | RecordCommand(ms) | speedup");
+    for (auto& result : mScalingResults) {
+        float speedup = baseTime / std::max(result.avgRecordTimeMs, 1e-4f);
+        std::string bar(static_cast<size_t>(MAX_BAR_LENGTH * speedup / maxSpeedup), '#');
+        LOGI(" %7d | %10.3f | %17.3f | %5.2fx %s",
+            result.workerCount, result.avgRecordTimeMs, result.avgFrameCpuTimeMs, speedup, bar.c_str());
+    }
+    LOGI("---------------------------------------------------------------");
+}
+}   // namespace framework
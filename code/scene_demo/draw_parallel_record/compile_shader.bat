@@ -0,0 +1,11 @@
+@set glslc=C:\VulkanSDK\1.3.239.0\Bin
+
+:: 设置环境变量
+@set PATH=%glslc%;%PATH%
+
+@set SHADER_SRC_DIR=.\Shaders
+if not exist .\Spirv mkdir .\Spirv
+glslc %SHADER_SRC_DIR%\parallel_draw.vert -o .\Spirv\parallel_draw.vert.spv
+glslc %SHADER_SRC_DIR%\parallel_draw.frag -o .\Spirv\parallel_draw.frag.spv
+
+pause
@@ -37,7 +37,7 @@ private:
     void CreatePipelines();
     void CleanUpPipelines();
 
-    void UpdataUniformBuffer(float aspectRatio);
+    void UpdataUniformBuffer(float aspectRatio, float time);
 
 private:
     std::vector<VkCommandBuffer> mPrimaryCommandBuffers = {};
@@ -2,7 +2,6 @@
 
 #include <stdexcept>
 #include <array>
-#include <chrono>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -10,6 +9,7 @@
 
 #include "SceneDemoDefs.h"
 #include "BufferCreator.h"
+#include "AppDispatchTable.h"
 
 namespace framework {
 DrawRotateQuad::DrawRotateQuad() {}
@@ -45,37 +45,26 @@ void DrawRotateQuad::CleanUp()
 
 std::vector<VkCommandBuffer>& DrawRotateQuad::RecordCommand(const RenderInputInfo& input)
 {
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
     // 更新uniform buffer
     float aspectRatio = (float)input.swapchainExtent.width / (float)input.swapchainExtent.height;
-    UpdataUniformBuffer(aspectRatio);
+    UpdataUniformBuffer(aspectRatio, input.timeSec);
 
-    vkResetCommandBuffer(mCommandBuffer, 0);
+    dispatch.ResetCommandBuffer(mCommandBuffer, 0);
     // 开始写入
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0;
     beginInfo.pInheritanceInfo = nullptr;
-    if (vkBeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (dispatch.BeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("fiaile to begin recording command buffer!");
     }
 
     // 启动Pass
-    std::array<VkClearValue, 2> clearValues = {
-        consts::CLEAR_COLOR_NAVY_FLT,
-        consts::CLEAR_DEPTH_ONE_STENCIL_ZERO
-    };
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = input.presentRenderPass;
-    renderPassInfo.framebuffer = input.swapchanFb;
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = input.swapchainExtent;
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-    vkCmdBeginRenderPass(mCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    CmdBeginPresentPass(mCommandBuffer, input, consts::CLEAR_COLOR_NAVY_FLT);
 
     // 绑定Pipeline
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.pipeline);
+    dispatch.CmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.pipeline);
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -83,34 +72,34 @@ std::vector<VkCommandBuffer>& DrawRotateQuad::RecordCommand(const RenderInputInf
     viewport.height = input.swapchainExtent.height;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(mCommandBuffer, 0, 1, &viewport);
+    dispatch.CmdSetViewport(mCommandBuffer, 0, 1, &viewport);
     VkRect2D scissor{};
     scissor.offset = { 0, 0 };
     scissor.extent = input.swapchainExtent;
-    vkCmdSetScissor(mCommandBuffer, 0, 1, &scissor);
+    dispatch.CmdSetScissor(mCommandBuffer, 0, 1, &scissor);
 
     // 绑定顶点缓冲
-    std::vector<VkBuffer> vertexBuffers = { mVertexBuffer };
-    std::vector<VkDeviceSize> offsets = { 0 };
-    vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffers.data(), offsets.data());
+    std::array<VkBuffer, 1> vertexBuffers = { mVertexBuffer };
+    std::array<VkDeviceSize, 1> offsets = { 0 };
+    dispatch.CmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffers.data(), offsets.data());
 
     // 绑定索引缓冲
-    vkCmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    dispatch.CmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
     // 绑定DescriptorSet
-    vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    dispatch.CmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
         mPipeline.layout,
         0, 1, &mDescriptorSet,
         0, nullptr);
 
     //画图
-    vkCmdDrawIndexed(mCommandBuffer, mTriangleIndices.size(), 1, 0, 0, 0);
+    dispatch.CmdDrawIndexed(mCommandBuffer, mTriangleIndices.size(), 1, 0, 0, 0);
 
     // 结束Pass
-    vkCmdEndRenderPass(mCommandBuffer);
+    CmdEndPresentPass(mCommandBuffer, input);
 
     // 写入完成
-    if (vkEndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
+    if (dispatch.EndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
 
@@ -246,7 +235,7 @@ void DrawRotateQuad::CreatePipelines()
 
     // pipeline
     GraphicsPipelineConfigInfo configInfo;
-    configInfo.SetRenderPass(mPresentRenderPass);
+    SetPresentPassTarget(configInfo);
     configInfo.SetVertexInputBindings({ Vertex2DColor::GetBindingDescription() });
     configInfo.SetVertexInputAttributes(Vertex2DColor::getAttributeDescriptions());
     mPipeline = pipelineFactory.CreateGraphicsPipeline(configInfo, shaderFilePaths, layoutBindings, nullPushConstantRanges);
@@ -262,13 +251,8 @@ void DrawRotateQuad::CleanUpPipelines()
     }
 }
 
-void DrawRotateQuad::UpdataUniformBuffer(float aspectRatio)
+void DrawRotateQuad::UpdataUniformBuffer(float aspectRatio, float time)
 {
-    static auto startTime = std::chrono::high_resolution_clock::now();
-
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-
     UboMvpMatrix uboMvpMatrixs{};
     uboMvpMatrixs.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 
@@ -8,6 +8,11 @@
 #include "TestMesh.h"
 #include "Camera.h"
 #include "VmaUsage.h"
+#include "DynamicResolution.h"
+#include "TemporalUpscaler.h"
+#include "FrameUniformAllocator.h"
+#include "ClusteredLights.h"
+#include "ImageBasedLighting.h"
 
 namespace framework {
 class DrawScenePbr : public SceneRenderBase {
@@ -20,6 +25,7 @@ public:
     std::vector<VkCommandBuffer>& RecordCommand(const RenderInputInfo& input) override;
     void OnResize(VkExtent2D newExtent) override;
     void ProcessInputEvent(const InputEventInfo& inputEventInfo) override;
+    Camera* GetCamera() override { return mCamera; }
 
 private:
     void CreateRenderPasses();
@@ -28,6 +34,16 @@ private:
     void CreateMainFramebuffer();
     void CleanUpMainFramebuffer();
 
+    // 延迟渲染的G-buffer和framebuffer，依赖主framebuffer的颜色、深度和运动矢量
+    void CreateGBuffer();
+    void CleanUpGBuffer();
+
+    // 第一次切换到延迟渲染时才创建pass、管线、描述符和G-buffer，前向模式不占这部分资源
+    void CreateDeferredShading();
+    void CreateDeferredPipelines();
+    void CreateDeferredDescriptorSet();
+    void UpdateDeferredDescriptorSet();
+
     void CreateVertexBuffer();
     void CleanUpVertexBuffer();
 
@@ -50,12 +66,24 @@ private:
     void CreateTextureSampler();
     void CleanUpTextureSampler();
 
+    void CreateLights();
+    void CreateEnvironmentLighting();
+
     void UpdataUniformBuffer(float aspectRatio);
 
     void UpdateDescriptorSets();
 
     // tool functions
     void RecordPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input);
+    // 主pass在动态渲染时不创建RenderPass和Framebuffer，直接在附件视图上渲染
+    void SetMainPassTarget(GraphicsPipelineConfigInfo& configInfo);
+    void CmdBeginMainPass(VkRect2D renderArea);
+    void CmdEndMainPass();
+    // 前向和延迟两条路径画同样的物体，只是管线不同，两个管线的布局分别和mPipelineDrawPbr、mPipelinePbrTexture一致
+    void CmdDrawScene(const PipelineObjecs& pipelineConstMaterial, const PipelineObjecs& pipelineTexture);
+    void CmdDrawDeferredLighting();
+    void CreateDeferredPass();
+    void CreateGBufferImage(VkFormat format, VkImage& image, VmaAllocation& allocation, VkImageView& imageView);
 
 private:
     std::vector<VkCommandBuffer> mPrimaryCommandBuffers = {};
@@ -64,6 +92,9 @@ private:
     PipelineObjecs mPipelinePresent = {};
     PipelineObjecs mPipelineDrawPbr = {};
     PipelineObjecs mPipelinePbrTexture = {};
+    PipelineObjecs mPipelineGBuffer = {};
+    PipelineObjecs mPipelineGBufferTexture = {};
+    PipelineObjecs mPipelineDeferredLighting = {};
 
     VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
 
@@ -75,21 +106,16 @@ private:
     VkBuffer mIndexBuffer = VK_NULL_HANDLE;
     VkDeviceMemory mIndexBufferMemory = VK_NULL_HANDLE;
 
-    // uniform buffer
-    VkBuffer mUboMvp = VK_NULL_HANDLE;
-    void* mUboMvpMapped = nullptr;
-    VkBuffer mUboMaterial = VK_NULL_HANDLE;
-    void* mUboMaterialMapped = nullptr;
-    VkBuffer mUboGlobalMatrixVP = VK_NULL_HANDLE;
-    void* mUboGlobalMatrixVPAddr = nullptr;
-    VkBuffer mUboInstanceMatrixM = VK_NULL_HANDLE;
-    void* mUboInstanceMatrixMAddr = nullptr;
-    VkDeviceMemory mUniformBuffersMemory = VK_NULL_HANDLE;
+    // uniform buffer，所有uniform都是dynamic的，每帧从分配器里取新的区域
+    static constexpr VkDeviceSize UNIFORM_FRAME_CAPACITY = 64 * 1024;
+    FrameUniformAllocator mUniformAllocator = {};
 
     VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
     VkDescriptorSet mDescriptorSetPbr = VK_NULL_HANDLE;
     VkDescriptorSet mDescriptorSetPbrTexture = VK_NULL_HANDLE;
     VkDescriptorSet mDescriptorSetPresent = VK_NULL_HANDLE;
+    VkDescriptorPool mDeferredDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptorSetDeferredLighting = VK_NULL_HANDLE;
 
     // test texture
     VmaAllocation RoughnessImageAllocation = VK_NULL_HANDLE;
@@ -113,13 +139,52 @@ private:
     VkImage mMainFbDepthImage = VK_NULL_HANDLE;
     VkImageView mMainFbDepthImageView = VK_NULL_HANDLE;
     VkDeviceMemory mMainFbMemory = VK_NULL_HANDLE;
+    VmaAllocation mMainFbVelocityAllocation = VK_NULL_HANDLE;
+    VkImage mMainFbVelocityImage = VK_NULL_HANDLE;
+    VkImageView mMainFbVelocityImageView = VK_NULL_HANDLE;
     VkFramebuffer mMainFrameBuffer = VK_NULL_HANDLE;
     VkRenderPass mMainPass = VK_NULL_HANDLE;
 
-    const float mResolutionFactor = 0.8;
-    VkExtent2D mMainFbExtent = {};
+    DynamicResolution mDynamicResolution = {};
+    VkExtent2D mMainFbExtent = {};      // 分配的大小，实际渲染区域由mDynamicResolution决定
     const VkFormat mMainFbColorFormat = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
     const VkFormat mMainFbDepthFormat = VK_FORMAT_D24_UNORM_S8_UINT;
+    const VkFormat mMainFbVelocityFormat = VK_FORMAT_R16G16_SFLOAT;
+
+    // 延迟渲染，按G在前向和延迟之间切换，用GPU耗时对比
+    // G-buffer只在mDeferredPass内部使用，不写回显存，能懒分配时不占实际内存
+    bool mDeferredShading = false;
+    VkRenderPass mDeferredPass = VK_NULL_HANDLE;       // 动态渲染时也使用，input attachment需要subpass
+    VkFramebuffer mDeferredFrameBuffer = VK_NULL_HANDLE;
+    VkImageView mMainFbDepthInputView = VK_NULL_HANDLE;    // 只含深度aspect，作为input attachment读取
+    VmaAllocation mGBufferNormalAllocation = VK_NULL_HANDLE;
+    VkImage mGBufferNormalImage = VK_NULL_HANDLE;
+    VkImageView mGBufferNormalImageView = VK_NULL_HANDLE;
+    VmaAllocation mGBufferMaterialAllocation = VK_NULL_HANDLE;
+    VkImage mGBufferMaterialImage = VK_NULL_HANDLE;
+    VkImageView mGBufferMaterialImageView = VK_NULL_HANDLE;
+    VmaAllocation mGBufferAlbedoAllocation = VK_NULL_HANDLE;
+    VkImage mGBufferAlbedoImage = VK_NULL_HANDLE;
+    VkImageView mGBufferAlbedoImageView = VK_NULL_HANDLE;
+    const VkFormat mGBufferNormalFormat = VK_FORMAT_R16G16_SFLOAT;     // 八面体编码的法线，16位snorm/unorm不一定能作为颜色附件
+    const VkFormat mGBufferMaterialFormat = VK_FORMAT_R8G8_UNORM;      // roughness, metallic
+    const VkFormat mGBufferAlbedoFormat = VK_FORMAT_R8G8B8A8_SRGB;     // 线性值按sRGB编码，暗部精度更高
+
+    // 时域超分，按T开关，关闭时退回双线性拉伸
+    TemporalUpscaler mTemporalUpscaler = {};
+    bool mTemporalUpscaleEnabled = true;
+    glm::mat4 mPrevViewProj = glm::mat4(1.0f);
+    bool mPrevViewProjValid = false;
+
+    // 点光源放在SSBO中，主pass之前按簇剔除
+    ClusteredLights mClusteredLights = {};
+    static constexpr uint32_t MAX_LIGHT_COUNT = 64;
+    static constexpr float LIGHT_THRESHOLD = 0.05f;     // 辐照度低于该值时不再计算，决定光源的影响半径
+    static constexpr float NEAR_PLANE = 0.1f;
+    static constexpr float FAR_PLANE = 100.0f;
+
+    // 环境光，预处理结果缓存在磁盘上，resource/hdr/environment.hdr不存在时使用程序化天空
+    ImageBasedLighting mImageBasedLighting = {};
 
     // data
     struct UboMvpMatrix {
@@ -127,6 +192,8 @@ private:
         glm::mat4 view;
         glm::mat4 proj;
         glm::vec3 cameraPos;
+        alignas(16) glm::mat4 currViewProj;
+        glm::mat4 prevViewProj;
     };
 
     struct UniformMaterial {
@@ -140,14 +207,31 @@ private:
         glm::mat4 view;
         glm::mat4 proj;
         glm::vec3 cameraPos;
+        alignas(16) glm::mat4 currViewProj;
+        glm::mat4 prevViewProj;
     };
 
     struct InstanceMatrixM {
         glm::mat4 model;
     };
-    size_t mInstanceMatrixMAlignment = 0;
+
+    struct PresentPushConstants {
+        glm::vec2 uvScale;
+        glm::vec2 uvClamp;
+    };
+
+    struct DeferredLightingUniform {
+        glm::mat4 invViewProj;
+        glm::vec4 cameraPos;
+        glm::vec4 renderSize;
+    };
     static constexpr uint32_t INSTANCE_NUM = 5;
+
+    // 本帧的dynamic offset，按binding顺序排列
+    uint32_t mPbrDynamicOffsets[2] = {};                    // mvp, material
+    uint32_t mGlobalMatrixVPOffset = 0;
     uint32_t mInstanceMatrixMOffsets[INSTANCE_NUM] = {};
+    uint32_t mDeferredLightingOffset = 0;
 
     TestMesh* mMesh = nullptr;
     Camera* mCamera = nullptr;
@@ -36,6 +36,7 @@ static void FillConfig()
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
         VK_KHR_FRAGMENT_SHADING_RATE_EXTENSION_NAME,
         VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+        VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
     };
 
     // swapchain
@@ -44,12 +45,22 @@ static void FillConfig()
         VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT
     };
     g_SceneDemoConfig.swapchain.imageCount = 2;
-    g_SceneDemoConfig.swapchain.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+    // frame pacing
+    g_SceneDemoConfig.pacing.mode = framework::FramePacingMode::VSYNC;
+
+    // dynamic resolution
+    g_SceneDemoConfig.dynamicResolution.enable = true;
+    g_SceneDemoConfig.dynamicResolution.targetGpuTimeMs = 12.0f;
+    g_SceneDemoConfig.dynamicResolution.minScale = 0.5f;
+    g_SceneDemoConfig.dynamicResolution.maxScale = 0.67f;     // 时域超分补足到输出分辨率
+    g_SceneDemoConfig.dynamicResolution.initialScale = 0.67f;
     
     // present fb
     g_SceneDemoConfig.presentFb.depthFormatCandidates = { VK_FORMAT_D24_UNORM_S8_UINT };
     g_SceneDemoConfig.presentFb.tiling = VK_IMAGE_TILING_OPTIMAL;
     g_SceneDemoConfig.presentFb.features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    g_SceneDemoConfig.presentFb.dynamicRendering = true;
 
     // dirs
     g_SceneDemoConfig.directory.dirSpvFiles = "../code/scene_demo/draw_scene_pbr/Spirv/";
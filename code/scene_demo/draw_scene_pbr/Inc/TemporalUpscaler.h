@@ -0,0 +1,104 @@
+#ifndef __TEMPORAL_UPSCALER_H__
+#define __TEMPORAL_UPSCALER_H__
+
+#include <array>
+#include <glm/glm.hpp>
+
+#include "FrameworkHeaders.h"
+#include "VmaUsage.h"
+
+namespace framework {
+/*
+ * @brief 时域超分：主pass按抖动的投影在低分辨率下渲染并输出运动矢量，
+ *        本pass把当前帧和重投影的history混合到输出分辨率，最后在present pass中锐化。
+ */
+class TemporalUpscaler {
+public:
+    TemporalUpscaler() {}
+    ~TemporalUpscaler() {}
+
+    // 动态渲染时presentRenderPass为空，锐化管线使用presentRenderingInfo中的附件格式
+    void Init(Device* device, VkRenderPass presentRenderPass,
+        const VkPipelineRenderingCreateInfoKHR* presentRenderingInfo = nullptr);
+    void CleanUp();
+
+    // 输出分辨率变化时重建history
+    void CreateHistoryImages(VkExtent2D outputExtent);
+    void CleanUpHistoryImages();
+
+    // 主framebuffer重建后重新绑定输入
+    void SetInputs(VkImageView colorImageView, VkImageView velocityImageView);
+
+    // 丢弃history，下一帧只使用当前帧
+    void ResetHistory() { mHistoryValid = false; }
+
+    /*
+     * @brief 每帧渲染之前调用，返回本帧的抖动
+     * @return 单位为NDC，直接传给Camera::SetJitter
+     */
+    glm::vec2 BeginFrame(VkExtent2D renderExtent);
+
+    // 主pass之后调用，输入需要已经处于SHADER_READ_ONLY_OPTIMAL
+    void CmdResolve(VkCommandBuffer cmdBuf);
+
+    // 在present pass中调用，把输出锐化后画到swapchain
+    void CmdDrawSharpen(VkCommandBuffer cmdBuf);
+
+private:
+    void CreatePipelines(VkRenderPass presentRenderPass, const VkPipelineRenderingCreateInfoKHR* presentRenderingInfo);
+    void CleanUpPipelines();
+
+    void CreateSampler();
+    void CleanUpSampler();
+
+    void CreateDescriptorSets();
+    void UpdateDescriptorSets();
+
+    static float Halton(uint32_t index, uint32_t base);
+
+private:
+    struct ResolveParams {
+        glm::vec2 renderSize;
+        glm::vec2 outputSize;
+        glm::vec2 jitter;
+        float historyValid;
+        float blendFactor;
+    };
+
+    struct SharpenParams {
+        glm::vec2 uvScale;
+        float sharpness;
+    };
+
+    Device* mDevice = nullptr;
+
+    PipelineObjecs mPipelineResolve = {};
+    PipelineObjecs mPipelineSharpen = {};
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    // 两张history交替读写，descriptor set按写入的下标区分
+    std::array<VkDescriptorSet, 2> mDescriptorSetsResolve = {};
+    std::array<VkDescriptorSet, 2> mDescriptorSetsSharpen = {};
+    VkSampler mLinearSampler = VK_NULL_HANDLE;
+
+    std::array<VkImage, 2> mHistoryImages = {};
+    std::array<VkImageView, 2> mHistoryImageViews = {};
+    std::array<VmaAllocation, 2> mHistoryAllocations = {};
+    VkExtent2D mOutputExtent = {};
+    uint32_t mHistoryIndex = 0;             // 最新输出所在的history
+    bool mHistoryValid = false;
+
+    VkImageView mColorImageView = VK_NULL_HANDLE;
+    VkImageView mVelocityImageView = VK_NULL_HANDLE;
+
+    VkExtent2D mRenderExtent = {};
+    glm::vec2 mJitterPixels = glm::vec2(0.0f);
+    uint32_t mFrameIndex = 0;
+
+    static constexpr VkFormat HISTORY_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+    static constexpr uint32_t JITTER_PHASE_COUNT = 16;
+    static constexpr float BLEND_FACTOR = 0.1f;
+    static constexpr float SHARPNESS = 0.5f;
+};
+}   // namespace framework
+
+#endif // !__TEMPORAL_UPSCALER_H__
@@ -6,6 +6,8 @@ layout(binding = 0) uniform UniformMvpMatrix {
     mat4 view;
     mat4 proj;
     vec3 cameraPos;
+    mat4 currViewProj;      // 不带抖动，用于计算运动矢量
+    mat4 prevViewProj;
 } ubo;
 
 layout(push_constant) uniform PushConsts {
@@ -23,10 +25,14 @@ layout(location = 3) in vec3 vsInTangent;
 layout(location = 0) out vec2 texCoord;
 layout(location = 1) out vec3 normal;
 layout(location = 2) out vec4 pointOnWorld;
+layout(location = 3) out vec4 currClipPos;
+layout(location = 4) out vec4 prevClipPos;
 
 void main() {
     pointOnWorld = ubo.model * vec4(loacalPosition + uConsts.modelOffset, 1.0);
     gl_Position = ubo.proj * ubo.view * pointOnWorld;
+    currClipPos = ubo.currViewProj * pointOnWorld;
+    prevClipPos = ubo.prevViewProj * pointOnWorld;
 
     texCoord = texCoordInVert;
     normal = (ubo.model * vec4(normalInVert, 1.0)).xyz;
@@ -0,0 +1,47 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConsts {
+    float roughness;
+    float metallic;
+    vec3 albedo;
+    vec3 modelOffset;
+} uConsts;
+
+layout(location = 0) in vec2 texCoord;
+layout(location = 1) in vec3 normalDir;
+layout(location = 2) in vec4 pointOnWorld;
+layout(location = 3) in vec4 currClipPos;
+layout(location = 4) in vec4 prevClipPos;
+
+// G-buffer，顺序和DrawScenePbr::CreateRenderPasses中第0个subpass的颜色附件一致
+layout(location = 0) out vec4 outVelocity;
+layout(location = 1) out vec2 outNormal;        // 八面体编码的世界空间法线
+layout(location = 2) out vec2 outMaterial;      // x: roughness y: metallic
+layout(location = 3) out vec4 outAlbedo;        // sRGB格式，写入时自动编码
+
+vec2 OctWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// 单位向量投影到八面体再展开到[-1, 1]的正方形上，和deferred_lighting.frag中的解码一致
+vec2 EncodeOctahedral(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : OctWrap(n.xy);
+}
+
+void main()
+{
+    vec3 normal = normalize(normalDir);
+
+    outNormal = EncodeOctahedral(normal);
+    outMaterial = vec2(uConsts.roughness, uConsts.metallic);
+    outAlbedo = vec4(uConsts.albedo, 1.0);
+
+    // 运动矢量：屏幕uv空间下本帧位置减上一帧位置
+    vec2 currUv = currClipPos.xy / currClipPos.w * 0.5;
+    vec2 prevUv = prevClipPos.xy / prevClipPos.w * 0.5;
+    outVelocity = vec4(currUv - prevUv, 0.0, 0.0);
+}
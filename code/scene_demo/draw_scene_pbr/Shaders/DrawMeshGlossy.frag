@@ -11,6 +11,8 @@ layout(binding = 0) uniform UniformMvpMatrix {
     mat4 view;
     mat4 proj;
     vec3 cameraPos;
+    mat4 currViewProj;      // 不带抖动，用于计算运动矢量
+    mat4 prevViewProj;
 } uMvp;
 
 layout(binding = 1) uniform UniformMaterial {
@@ -29,8 +31,11 @@ layout(push_constant) uniform PushConsts {
 layout(location = 0) in vec2 texCoord;
 layout(location = 1) in vec3 normalDir;
 layout(location = 2) in vec4 pointOnWorld;
+layout(location = 3) in vec4 currClipPos;
+layout(location = 4) in vec4 prevClipPos;
 
 layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec4 outVelocity;
 
 // light
 vec3 lightPosList[4] = {
@@ -116,4 +121,9 @@ void main()
     color = pow(color, vec3(1.0 / GAMA)); 
 
     outColor = vec4(color, 1.0);
+
+    // 运动矢量：屏幕uv空间下本帧位置减上一帧位置
+    vec2 currUv = currClipPos.xy / currClipPos.w * 0.5;
+    vec2 prevUv = prevClipPos.xy / prevClipPos.w * 0.5;
+    outVelocity = vec4(currUv - prevUv, 0.0, 0.0);
 }
\ No newline at end of file
@@ -4,10 +4,16 @@
 // texture
 layout(binding = 0) uniform sampler2D texSampler;
 
+// 纹理坐标上限，离渲染区域边缘半个像素
+layout(push_constant) uniform PushConstants {
+    layout(offset = 8) vec2 uvClamp;
+} pushConstants;
+
 layout(location = 0) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(texture(texSampler, fragTexCoord).rgb, 1.0);
+    vec2 uv = min(fragTexCoord, pushConstants.uvClamp);
+    outColor = vec4(texture(texSampler, uv).rgb, 1.0);
 }
\ No newline at end of file
@@ -15,10 +15,15 @@ vec2 texCoord[4] = vec2[](
     vec2(1.0, 0.0)
 );
 
+// 采样区域占整张图的比例
+layout(push_constant) uniform PushConstants {
+    vec2 uvScale;
+} pushConstants;
+
 // out
 layout(location = 0) out vec2 fragTexCoord;
 
 void main() {
     gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragTexCoord = texCoord[gl_VertexIndex];
+    fragTexCoord = texCoord[gl_VertexIndex] * pushConstants.uvScale;
 }
@@ -0,0 +1,208 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+const float PI = 3.14159265359;
+const float EPS = 0.0001;
+const vec3 F0_BASE = vec3(0.04);
+const float GAMA = 2.2;
+
+layout(binding = 0) uniform DeferredLightingUniform {
+    mat4 invViewProj;       // 带抖动的投影，和G-buffer pass一致，用于从深度重建世界坐标
+    vec4 cameraPos;
+    vec4 renderSize;        // 渲染区域的宽高
+} uDeferred;
+
+// G-buffer，第0个subpass写入，tile-based GPU上不离开片上内存
+layout(input_attachment_index = 0, binding = 1) uniform subpassInput inNormal;
+layout(input_attachment_index = 1, binding = 2) uniform subpassInput inMaterial;
+layout(input_attachment_index = 2, binding = 3) uniform subpassInput inAlbedo;
+layout(input_attachment_index = 3, binding = 4) uniform subpassInput inDepth;
+
+layout(location = 0) out vec4 outColor;
+
+// light，分簇结果由cluster_light_cull.comp写入
+const uint MAX_LIGHTS_PER_CLUSTER = 256;    // 和ClusteredLights::MAX_LIGHTS_PER_CLUSTER一致
+
+struct PointLight {
+    vec3 position;
+    float radius;
+    vec3 power;
+    float padding;
+};
+
+layout(std140, binding = 20) uniform ClusterParams {
+    mat4 view;
+    mat4 invProj;
+    uvec4 gridSize;         // xyz为簇的个数，w为光源个数
+    vec4 screenParams;      // 渲染区域的宽高，近平面，远平面
+    vec4 sliceParams;       // slice = log(depth) * x - y
+} uCluster;
+
+layout(std430, binding = 21) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+
+layout(std430, binding = 22) readonly buffer ClusterLightCounts {
+    uint clusterLightCounts[];
+};
+
+layout(std430, binding = 23) readonly buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
+
+// 环境光，预处理结果由ImageBasedLighting生成
+layout(std140, binding = 24) uniform IblParams {
+    vec4 sh[9];                 // 已卷积余弦核并除以PI的辐照度SH9系数
+    vec4 prefilterParams;       // x为预滤波贴图的最大mip
+} uIbl;
+
+layout(binding = 25) uniform samplerCube texPrefilteredEnv;
+layout(binding = 26) uniform sampler2D texBrdfLut;
+
+// 漫反射辐照度除以PI，基函数和ibl_sh_project.comp一致
+vec3 EvaluateIrradianceSH(vec3 n)
+{
+    vec3 result = uIbl.sh[0].rgb * 0.282095
+        + uIbl.sh[1].rgb * 0.488603 * n.y
+        + uIbl.sh[2].rgb * 0.488603 * n.z
+        + uIbl.sh[3].rgb * 0.488603 * n.x
+        + uIbl.sh[4].rgb * 1.092548 * n.x * n.y
+        + uIbl.sh[5].rgb * 1.092548 * n.y * n.z
+        + uIbl.sh[6].rgb * 0.315392 * (3.0 * n.z * n.z - 1.0)
+        + uIbl.sh[7].rgb * 1.092548 * n.x * n.z
+        + uIbl.sh[8].rgb * 0.546274 * (n.x * n.x - n.y * n.y);
+    return max(result, vec3(0.0));
+}
+
+vec3 FresnelSchlickRoughness(vec3 f0, float dotNToWo, float roughness)
+{
+    return f0 + (max(vec3(1.0 - roughness), f0) - f0) * pow(clamp(1.0 - dotNToWo, 0.0, 1.0), 5);
+}
+
+// 环境光：漫反射用SH9辐照度，高光用预滤波环境图和BRDF查找表(split-sum)
+vec3 AmbientIBL(vec3 normal, vec3 wo, vec3 f0, vec3 albedo, float roughness, float metallic)
+{
+    float dotNToWo = max(dot(normal, wo), 0.0);
+    vec3 F = FresnelSchlickRoughness(f0, dotNToWo, roughness);
+    vec3 kD = (vec3(1.0) - F) * (1.0 - metallic);
+    vec3 diffuse = kD * albedo * EvaluateIrradianceSH(normal);
+
+    vec3 reflectDir = reflect(-wo, normal);
+    vec3 prefiltered = textureLod(texPrefilteredEnv, reflectDir, roughness * uIbl.prefilterParams.x).rgb;
+    vec2 envBrdf = texture(texBrdfLut, vec2(dotNToWo, roughness)).rg;
+    vec3 specular = prefiltered * (f0 * envBrdf.x + envBrdf.y);
+    return diffuse + specular;
+}
+
+float DistributionGGX(float roughness, vec3 normal, vec3 halfVector)
+{
+    float alpha = roughness * roughness;
+    float alphaSquare = alpha * alpha;
+    float dotNToH = clamp(dot(normal, halfVector), 0.0, 1.0);
+    float denomTemp = dotNToH * dotNToH * (alphaSquare - 1.0) + 1.0;
+    return alphaSquare / (PI * denomTemp * denomTemp);
+}
+
+vec3 FresnelSchlick(vec3 f0, float dotHalfToView)
+{
+    return f0 + (1.0 - f0) * pow(clamp(1.0 - dotHalfToView, 0.0, 1.0), 5);
+}
+
+float GeometyGGX(float roughness, float dotNtoV)
+{
+    float k = (roughness + 1) * (roughness + 1) * 0.125;
+    return dotNtoV / (dotNtoV * (1.0 - k) + k);
+}
+
+uint GetClusterIndex(vec2 fragCoord, float viewDepth)
+{
+    uvec3 gridSize = uCluster.gridSize.xyz;
+    uvec2 tile = uvec2(fragCoord / uCluster.screenParams.xy * vec2(gridSize.xy));
+    tile = min(tile, gridSize.xy - 1);
+    uint slice = uint(max(log(viewDepth) * uCluster.sliceParams.x - uCluster.sliceParams.y, 0.0));
+    slice = min(slice, gridSize.z - 1);
+    return (slice * gridSize.y + tile.y) * gridSize.x + tile.x;
+}
+
+// 在影响半径处平滑衰减到0，和分簇的裁剪半径一致
+float RadiusFalloff(float lightDist, float radius)
+{
+    float ratio = lightDist / radius;
+    float falloff = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return falloff * falloff;
+}
+
+// 和G-buffer着色器中的EncodeOctahedral对应
+vec3 DecodeOctahedral(vec2 f)
+{
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    // 读G-buffer，albedo是sRGB格式，读出来已经是线性值
+    vec3 normal = DecodeOctahedral(subpassLoad(inNormal).xy);
+    vec2 material = subpassLoad(inMaterial).xy;
+    float roughness = material.x;
+    float metallic = material.y;
+    vec3 albedo = subpassLoad(inAlbedo).rgb;
+    float depth = subpassLoad(inDepth).r;
+
+    vec2 ndc = gl_FragCoord.xy / uDeferred.renderSize.xy * 2.0 - 1.0;
+    vec4 pointOnWorld = uDeferred.invViewProj * vec4(ndc, depth, 1.0);
+    pointOnWorld /= pointOnWorld.w;
+
+    vec3 outRadiance = vec3(0);
+
+    vec3 wo = normalize(uDeferred.cameraPos.xyz - pointOnWorld.xyz);
+    float dotNToWo = max(dot(normal, wo), 0.0);
+
+    vec3 F0 = mix(F0_BASE, albedo, metallic);
+
+    float G2 = GeometyGGX(roughness, dotNToWo);
+
+    // 只遍历所在簇的光源
+    float viewDepth = -(uCluster.view * vec4(pointOnWorld.xyz, 1.0)).z;
+    uint clusterIndex = GetClusterIndex(gl_FragCoord.xy, viewDepth);
+    uint clusterLightCount = clusterLightCounts[clusterIndex];
+    for (uint i = 0; i < clusterLightCount; i++) {
+        PointLight light = lights[clusterLightIndices[clusterIndex * MAX_LIGHTS_PER_CLUSTER + i]];
+        vec3 lightPose = light.position;
+        vec3 lightPower = light.power;
+
+        vec3 wi = normalize(pointOnWorld.xyz - lightPose);
+        float dotNToWi = max(dot(normal, -wi), 0.0);
+
+        vec3 halfVector = normalize((-wi) + wo);
+
+        float lightDist = distance(lightPose, pointOnWorld.xyz);
+        vec3 lightIrradianceOnSp = lightPower / (4.0 * PI * lightDist * lightDist) * RadiusFalloff(lightDist, light.radius);
+
+        vec3 FTerm = FresnelSchlick(F0, max(dot(halfVector, wo), 0.0));
+        float DTerm = DistributionGGX(roughness, normal, halfVector);
+        float G1 = GeometyGGX(roughness, dotNToWi);
+
+        vec3 kS = FTerm;
+        vec3 kD = vec3(1.0) - kS;
+        kD *= 1.0 - metallic;
+
+        vec3 fr = kD * albedo / PI + FTerm * DTerm * G1 * G2 / (4.0 * dotNToWi * dotNToWo + EPS);
+
+        outRadiance += fr * lightIrradianceOnSp * dotNToWi;
+    }
+
+    // ambient
+    vec3 ambient = AmbientIBL(normal, wo, F0, albedo, roughness, metallic);
+    vec3 color = ambient + outRadiance;
+
+    // HDR tonemapping
+    color = color / (color + vec3(1.0));
+    // gamma correct
+    color = pow(color, vec3(1.0 / GAMA));
+
+    outColor = vec4(color, 1.0);
+}
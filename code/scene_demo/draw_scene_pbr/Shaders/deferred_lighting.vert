@@ -0,0 +1,13 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// 覆盖全屏的三角形，深度放在远平面上，配合GREATER深度测试跳过没有几何体的像素
+vec2 positions[3] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2(3.0, -1.0),
+    vec2(-1.0, 3.0)
+);
+
+void main() {
+    gl_Position = vec4(positions[gl_VertexIndex], 1.0, 1.0);
+}
@@ -10,6 +10,8 @@ layout(binding = 0) uniform GlobalMatrixVP {
     mat4 view;
     mat4 proj;
     vec3 cameraPos;
+    mat4 currViewProj;      // 不带抖动，用于计算运动矢量
+    mat4 prevViewProj;
 } globalMatrixVP;
 
 layout(binding = 10) uniform sampler2D texRoughness;
@@ -22,10 +24,13 @@ layout(location = 0) in VERT_OUT {
     vec2 texCoord;
     vec4 pointOnWorld;
     mat3 matTBN;
+    vec4 currClipPos;
+    vec4 prevClipPos;
 } fragIn;
 
 // out
 layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec4 outVelocity;
 
 // light
 vec3 lightPosList[4] = {
@@ -118,4 +123,9 @@ void main()
     color = pow(color, vec3(1.0 / GAMA)); 
 
     outColor = vec4(color, 1.0);
+
+    // 运动矢量：屏幕uv空间下本帧位置减上一帧位置
+    vec2 currUv = fragIn.currClipPos.xy / fragIn.currClipPos.w * 0.5;
+    vec2 prevUv = fragIn.prevClipPos.xy / fragIn.prevClipPos.w * 0.5;
+    outVelocity = vec4(currUv - prevUv, 0.0, 0.0);
 }
\ No newline at end of file
@@ -5,6 +5,8 @@ layout(binding = 0) uniform GlobalMatrixVP {
     mat4 view;
     mat4 proj;
     vec3 cameraPos;
+    mat4 currViewProj;      // 不带抖动，用于计算运动矢量
+    mat4 prevViewProj;
 } globalMatrixVP;
 
 layout(binding = 1) uniform InstanceMatrixM {
@@ -20,11 +22,15 @@ layout(location = 0) out VERT_OUT {
     vec2 texCoord;
     vec4 pointOnWorld;
     mat3 matTBN;
+    vec4 currClipPos;
+    vec4 prevClipPos;
 } vertOut;
 
 void main() {
     vertOut.pointOnWorld = instanceMatrixM.model * vec4(vsInLoacalPosition, 1.0);
     gl_Position = globalMatrixVP.proj * globalMatrixVP.view * vertOut.pointOnWorld;
+    vertOut.currClipPos = globalMatrixVP.currViewProj * vertOut.pointOnWorld;
+    vertOut.prevClipPos = globalMatrixVP.prevViewProj * vertOut.pointOnWorld;
 
     vertOut.texCoord = vsInTexCoord;
     vec3 normal = (instanceMatrixM.model * vec4(vsInNormal, 1.0) - 
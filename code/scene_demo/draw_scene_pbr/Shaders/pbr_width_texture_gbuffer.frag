@@ -0,0 +1,54 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 10) uniform sampler2D texRoughness;
+layout(binding = 11) uniform sampler2D texMatallic;
+layout(binding = 12) uniform sampler2D texAlbedo;
+layout(binding = 13) uniform sampler2D texNormal;
+
+// in
+layout(location = 0) in VERT_OUT {
+    vec2 texCoord;
+    vec4 pointOnWorld;
+    mat3 matTBN;
+    vec4 currClipPos;
+    vec4 prevClipPos;
+} fragIn;
+
+// G-buffer，顺序和DrawScenePbr::CreateRenderPasses中第0个subpass的颜色附件一致
+layout(location = 0) out vec4 outVelocity;
+layout(location = 1) out vec2 outNormal;        // 八面体编码的世界空间法线
+layout(location = 2) out vec2 outMaterial;      // x: roughness y: metallic
+layout(location = 3) out vec4 outAlbedo;        // sRGB格式，写入时自动编码
+
+vec2 OctWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// 单位向量投影到八面体再展开到[-1, 1]的正方形上，和deferred_lighting.frag中的解码一致
+vec2 EncodeOctahedral(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : OctWrap(n.xy);
+}
+
+void main()
+{
+    // sample texture
+    float sampleRoughness = texture(texRoughness, fragIn.texCoord).x;
+    float sampleMetallic = texture(texMatallic, fragIn.texCoord).x;
+    vec3 sampleAlbedo = pow(texture(texAlbedo, fragIn.texCoord).rgb, vec3(2.2));
+    vec3 sampleNormal = texture(texNormal, fragIn.texCoord).xyz;
+    sampleNormal = normalize(sampleNormal * 2.0 - 1.0);
+    sampleNormal = normalize(fragIn.matTBN * sampleNormal);
+
+    outNormal = EncodeOctahedral(sampleNormal);
+    outMaterial = vec2(sampleRoughness, sampleMetallic);
+    outAlbedo = vec4(sampleAlbedo, 1.0);
+
+    // 运动矢量：屏幕uv空间下本帧位置减上一帧位置
+    vec2 currUv = fragIn.currClipPos.xy / fragIn.currClipPos.w * 0.5;
+    vec2 prevUv = fragIn.prevClipPos.xy / fragIn.prevClipPos.w * 0.5;
+    outVelocity = vec4(currUv - prevUv, 0.0, 0.0);
+}
@@ -0,0 +1,37 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// texture
+layout(binding = 0) uniform sampler2D inputTex;
+
+layout(push_constant) uniform PushConstants {
+    vec2 uvScale;
+    float sharpness;
+} pushConstants;
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+vec3 Fetch(ivec2 coord, ivec2 maxCoord)
+{
+    return texelFetch(inputTex, clamp(coord, ivec2(0), maxCoord), 0).rgb;
+}
+
+void main() {
+    // 输出和swapchain同样大小，直接按像素读取
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    ivec2 maxCoord = textureSize(inputTex, 0) - 1;
+    vec3 center = Fetch(coord, maxCoord);
+    vec3 up = Fetch(coord + ivec2(0, -1), maxCoord);
+    vec3 down = Fetch(coord + ivec2(0, 1), maxCoord);
+    vec3 left = Fetch(coord + ivec2(-1, 0), maxCoord);
+    vec3 right = Fetch(coord + ivec2(1, 0), maxCoord);
+
+    // 反锐化掩模，结果限制在十字邻域的范围内，避免过冲产生白边
+    vec3 neighborMin = min(center, min(min(up, down), min(left, right)));
+    vec3 neighborMax = max(center, max(max(up, down), max(left, right)));
+    vec3 sharpened = center + pushConstants.sharpness * (4.0 * center - up - down - left - right) * 0.25;
+
+    outColor = vec4(clamp(sharpened, neighborMin, neighborMax), 1.0);
+}
@@ -14,7 +14,11 @@
 
 #include "SceneDemoDefs.h"
 #include "BufferCreator.h"
+#include "DeletionQueue.h"
+#include "JobSystem.h"
+#include "GpuProfiler.h"
 #include "Log.h"
+#include "AppDispatchTable.h"
 #undef LOG_TAG
 #define LOG_TAG "DrawScenePbr"
 
@@ -37,9 +41,8 @@ void DrawScenePbr::Init(const RenderInitInfo& initInfo)
         return;
     }
 
-    mMainFbExtent = initInfo.swapchainExtent;
-    mMainFbExtent.width *= mResolutionFactor;
-    mMainFbExtent.height *= mResolutionFactor;
+    mDynamicResolution.Init(GetConfig().dynamicResolution);
+    mMainFbExtent = mDynamicResolution.Resize(initInfo.swapchainExtent);
 
     mCamera->mTargetDistance = 20.0f;
     mCamera->mTargetPoint = glm::vec3(0.0, 0.0, 0.0);
@@ -58,13 +61,25 @@ void DrawScenePbr::Init(const RenderInitInfo& initInfo)
     CreateUniformBuffer();
     CreateTextures();
     CreateTextureSampler();
+    CreateLights();
+    CreateEnvironmentLighting();
     CreateDescriptorPool();
     CreateDescriptorSets();
+
+    mTemporalUpscaler.Init(mDevice, mPresentRenderPass, mDynamicRendering ? &mPresentRenderingInfo : nullptr);
+    mTemporalUpscaler.CreateHistoryImages(initInfo.swapchainExtent);
+    mTemporalUpscaler.SetInputs(mMainFbColorImageView, mMainFbVelocityImageView);
 }
 
 void DrawScenePbr::CleanUp()
 {
+    mTemporalUpscaler.CleanUpHistoryImages();
+    mTemporalUpscaler.CleanUp();
+    vkDestroyDescriptorPool(mDevice->Get(), mDeferredDescriptorPool, nullptr);
+    mDeferredDescriptorPool = VK_NULL_HANDLE;
     CleanUpDescriptorPool();
+    mImageBasedLighting.CleanUp();
+    mClusteredLights.CleanUp();
     CleanUpTextureSampler();
     CleanUpTextures();
     CleanUpUniformBuffer();
@@ -72,81 +87,74 @@ void DrawScenePbr::CleanUp()
     CleanUpVertexBuffer();
     mDevice->FreeCommandBuffer(mCommandBuffer);
     CleanUpPipelines();
+    CleanUpGBuffer();
     CleanUpMainFramebuffer();
     CleanUpRenderPasses();
 }
 
 std::vector<VkCommandBuffer>& DrawScenePbr::RecordCommand(const RenderInputInfo& input)
 {
-    // 更新uniform buffer
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // 按上一帧的GPU耗时调整渲染区域，只改viewport和scissor
+    mDynamicResolution.Update(input.frameTiming.gpuFrameTimeMs);
+    VkExtent2D renderExtent = mDynamicResolution.GetRenderExtent();
+
+    // 抖动按本帧的渲染分辨率计算，必须在更新uniform buffer之前
+    mCamera->SetJitter(mTemporalUpscaleEnabled ? mTemporalUpscaler.BeginFrame(renderExtent) : glm::vec2(0.0f));
+
+    // 更新uniform buffer，上一帧已经执行完，从头分配
+    mUniformAllocator.BeginFrame();
     float aspectRatio = (float)input.swapchainExtent.width / (float)input.swapchainExtent.height;
     UpdataUniformBuffer(aspectRatio);
 
-    vkResetCommandBuffer(mCommandBuffer, 0);
+    dispatch.ResetCommandBuffer(mCommandBuffer, 0);
     // 开始写入
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0;
     beginInfo.pInheritanceInfo = nullptr;
-    if (vkBeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (dispatch.BeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("fiaile to begin recording command buffer!");
     }
 
-    std::vector<VkClearValue> clearValuesMain = { { 0.1f, 0.1f, 0.1f, 1.0f }, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO };
-    VkRect2D renderArea = { {0, 0}, {mMainFbExtent.width, mMainFbExtent.height} };
-    VkRenderPassBeginInfo renderPassInfoMain = vulkanInitializers::RenderPassBeginInfo(
-        mMainPass, mMainFrameBuffer, renderArea, clearValuesMain);
-    vkCmdBeginRenderPass(mCommandBuffer, &renderPassInfoMain, VK_SUBPASS_CONTENTS_INLINE);
-
-    // 绑定Pipeline
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineDrawPbr.pipeline);
-    VkViewport viewportMain = { 0.0f, 0.0f, mMainFbExtent.width, mMainFbExtent.height, 0.0f, 1.0f };
-    vkCmdSetViewport(mCommandBuffer, 0, 1, &viewportMain);
-    vkCmdSetScissor(mCommandBuffer, 0, 1, &renderArea);
-
-    // 绑定顶点缓冲
-    std::vector<VkBuffer> vertexBuffersMain = { mVertexBuffer };
-    std::vector<VkDeviceSize> offsetsMain = { 0 };
-    vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffersMain.data(), offsetsMain.data());
-
-    // 绑定索引缓冲
-    vkCmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-    // 绑定DescriptorSet
-    vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-        mPipelineDrawPbr.layout,
-        0, 1, &mDescriptorSetPbr,
-        0, nullptr);
-
-    UniformMaterial uboMaterial{};
-    uboMaterial.albedo = glm::vec3(1.0f, 0.765557f, 0.336057f);
-
-    int ySegMent = 5;
-    int zSegMent = 5;
-    float SphereDistance = 2.5f;
-    for (int y = 0; y < ySegMent; y++) {
-        for (int z = 0; z < zSegMent; z++) {
-            uboMaterial.roughness = 0.2f + static_cast<float>(z) / zSegMent;
-            uboMaterial.metallic = 0.2f + static_cast<float>(y) / ySegMent;
-            uboMaterial.modelOffset = glm::vec3(0.0, SphereDistance * y - 5.0f, SphereDistance * z - 5.0f);
-            vkCmdPushConstants(mCommandBuffer, mPipelineDrawPbr.layout, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformMaterial), &uboMaterial);
-            vkCmdDrawIndexed(mCommandBuffer, mMesh->GetIndexData().size(), 1, 0, 0, 0);
-        }
+    // 光源分簇，按本帧的渲染区域划分屏幕
+    glm::mat4 cullProj = mCamera->GetProjection();
+    cullProj[1][1] *= -1;
+    mClusteredLights.CmdCullLights(mCommandBuffer, mCamera->GetView(), cullProj, NEAR_PLANE, FAR_PLANE, renderExtent);
+
+    VkRect2D renderArea = { {0, 0}, renderExtent };
+    VkViewport viewportMain = { 0.0f, 0.0f, (float)renderExtent.width, (float)renderExtent.height, 0.0f, 1.0f };
+    if (mDeferredShading) {
+        // subpass 0写G-buffer，subpass 1逐像素算一次光照，重叠的球不再重复计算BRDF
+        GpuProfileScope deferredScope(mCommandBuffer, "DeferredPass", true);
+        VkClearValue clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+        VkClearValue clearZero = { 0.0f, 0.0f, 0.0f, 0.0f };
+        std::array<VkClearValue, 6> clearValuesDeferred = {
+            clearColor, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO, clearZero, clearZero, clearZero, clearZero
+        };
+        VkRenderPassBeginInfo renderPassInfoDeferred = vulkanInitializers::RenderPassBeginInfo(
+            mDeferredPass, mDeferredFrameBuffer, renderArea, clearValuesDeferred);
+        dispatch.CmdBeginRenderPass(mCommandBuffer, &renderPassInfoDeferred, VK_SUBPASS_CONTENTS_INLINE);
+        dispatch.CmdSetViewport(mCommandBuffer, 0, 1, &viewportMain);
+        dispatch.CmdSetScissor(mCommandBuffer, 0, 1, &renderArea);
+
+        CmdDrawScene(mPipelineGBuffer, mPipelineGBufferTexture);
+        dispatch.CmdNextSubpass(mCommandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+        CmdDrawDeferredLighting();
+
+        dispatch.CmdEndRenderPass(mCommandBuffer);
     }
+    else {
+        GpuProfileScope forwardScope(mCommandBuffer, "ForwardPass", true);
+        CmdBeginMainPass(renderArea);
+        dispatch.CmdSetViewport(mCommandBuffer, 0, 1, &viewportMain);
+        dispatch.CmdSetScissor(mCommandBuffer, 0, 1, &renderArea);
 
-    // pbr with texture
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePbrTexture.pipeline);
+        CmdDrawScene(mPipelineDrawPbr, mPipelinePbrTexture);
 
-    for (int i = 0; i < INSTANCE_NUM; i++) {
-        vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-            mPipelinePbrTexture.layout,
-            0, 1, &mDescriptorSetPbrTexture,
-            1, &mInstanceMatrixMOffsets[i]);
-        vkCmdDrawIndexed(mCommandBuffer, mMesh->GetIndexData().size(), 1, 0, 0, 0);
+        CmdEndMainPass();
     }
 
-    vkCmdEndRenderPass(mCommandBuffer);
-
     // =============================================================================
 
     ImageMemoryBarrierInfo imageBarrierInfo{};
@@ -154,16 +162,21 @@ std::vector<VkCommandBuffer>& DrawScenePbr::RecordCommand(const RenderInputInfo&
     imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     imageBarrierInfo.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
     imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
     mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbColorImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbVelocityImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+
+    if (mTemporalUpscaleEnabled) {
+        mTemporalUpscaler.CmdResolve(mCommandBuffer);
+    }
 
     // =============================================================================
 
     RecordPresentPass(mCommandBuffer, input);
 
     // 写入完成
-    if (vkEndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
+    if (dispatch.EndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
 
@@ -177,14 +190,22 @@ void DrawScenePbr::OnResize(VkExtent2D newExtent)
     if (newExtent.width == 0 || newExtent.height == 0) {
         return;
     }
-    mMainFbExtent = newExtent;
-    mMainFbExtent.width *= mResolutionFactor;
-    mMainFbExtent.height *= mResolutionFactor;
+    mMainFbExtent = mDynamicResolution.Resize(newExtent);
 
+    // 前向模式下只释放G-buffer，下次切到延迟渲染时再按新尺寸创建
+    CleanUpGBuffer();
     CleanUpMainFramebuffer();
     CreateMainFramebuffer();
+    if (mDeferredShading) {
+        CreateGBuffer();
+        UpdateDeferredDescriptorSet();
+    }
 
     UpdateDescriptorSets();
+
+    mTemporalUpscaler.CleanUpHistoryImages();
+    mTemporalUpscaler.CreateHistoryImages(newExtent);
+    mTemporalUpscaler.SetInputs(mMainFbColorImageView, mMainFbVelocityImageView);
 }
 
 void DrawScenePbr::ProcessInputEvent(const InputEventInfo& inputEventInfo)
@@ -197,10 +218,30 @@ void DrawScenePbr::ProcessInputEvent(const InputEventInfo& inputEventInfo)
     mLastLeftPress = inputEventInfo.leftPressFlag;
     mLastCursorPose = curCursorPose;
 
-    // key input
-    if (inputEventInfo.keyAction == FRAMEWORK_KEY_PRESS || inputEventInfo.keyAction == FRAMEWORK_KEY_RELEASE) {
-        if (mKeyPressStatus.find(inputEventInfo.key) != mKeyPressStatus.end()) {
-            mKeyPressStatus[inputEventInfo.key] = static_cast<uint16_t>(inputEventInfo.keyAction);
+    // key input，依次处理本帧的所有按键事件
+    for (const InputEvent& event : inputEventInfo.events) {
+        if (event.type != InputEventType::KEY) {
+            continue;
+        }
+        if (event.code == FRAMEWORK_KEY_T && event.action == FRAMEWORK_KEY_PRESS) {
+            mTemporalUpscaleEnabled = !mTemporalUpscaleEnabled;
+            mTemporalUpscaler.ResetHistory();
+            LOGI("temporal upscale %s", mTemporalUpscaleEnabled ? "on" : "off");
+        }
+        if (event.code == FRAMEWORK_KEY_G && event.action == FRAMEWORK_KEY_PRESS) {
+            // 切换前打印当前路径的耗时，和切换后的结果对比
+            const char* lastScope = mDeferredShading ? "DeferredPass" : "ForwardPass";
+            LOGI("%s gpu time %.3f ms", lastScope, GpuProfiler::GetInstance().GetLastScopeTimeMs(lastScope));
+            mDeferredShading = !mDeferredShading;
+            if (mDeferredShading) {
+                CreateDeferredShading();
+            }
+            LOGI("shading mode %s", mDeferredShading ? "deferred" : "forward");
+        }
+        if (event.action == FRAMEWORK_KEY_PRESS || event.action == FRAMEWORK_KEY_RELEASE) {
+            if (mKeyPressStatus.find(event.code) != mKeyPressStatus.end()) {
+                mKeyPressStatus[event.code] = static_cast<uint16_t>(event.action);
+            }
         }
     }
     bool directionKeyPress = false;
@@ -222,14 +263,20 @@ void DrawScenePbr::ProcessInputEvent(const InputEventInfo& inputEventInfo)
 
 void DrawScenePbr::CreateRenderPasses()
 {
+    if (mDynamicRendering) {
+        return;
+    }
+
     // subpass
-    VkAttachmentReference2 colorAttachmentRef =
-        vulkanInitializers::AttachmentReference2(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    std::vector<VkAttachmentReference2> colorAttachmentRefs = {
+        vulkanInitializers::AttachmentReference2(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+        vulkanInitializers::AttachmentReference2(2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+    };
     VkAttachmentReference2 depthAttachmentRef =
         vulkanInitializers::AttachmentReference2(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
     std::vector<VkSubpassDescription2> subpasses = {
-        vulkanInitializers::SubpassDescription2(VK_PIPELINE_BIND_POINT_GRAPHICS, &colorAttachmentRef, &depthAttachmentRef),
+        vulkanInitializers::SubpassDescription2(VK_PIPELINE_BIND_POINT_GRAPHICS, colorAttachmentRefs, &depthAttachmentRef),
     };
 
     std::vector<VkSubpassDependency2> dependencys = { vulkanInitializers::SubpassDependency2(VK_SUBPASS_EXTERNAL, 0) };
@@ -238,7 +285,7 @@ void DrawScenePbr::CreateRenderPasses()
     dependencys[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     dependencys[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-    std::vector<VkAttachmentDescription2> mAttachments2(2);
+    std::vector<VkAttachmentDescription2> mAttachments2(3);
     // 颜色附件
     mAttachments2[0] = vulkanInitializers::AttachmentDescription2(mMainFbColorFormat);
     vulkanInitializers::AttachmentDescription2SetOp(mAttachments2[0],
@@ -251,6 +298,12 @@ void DrawScenePbr::CreateRenderPasses()
         VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE);
     vulkanInitializers::AttachmentDescription2SetLayout(mAttachments2[1],
         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    // 运动矢量
+    mAttachments2[2] = vulkanInitializers::AttachmentDescription2(mMainFbVelocityFormat);
+    vulkanInitializers::AttachmentDescription2SetOp(mAttachments2[2],
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
+    vulkanInitializers::AttachmentDescription2SetLayout(mAttachments2[2],
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
     VkRenderPassCreateInfo2 renderPassInfo = vulkanInitializers::RenderPassCreateInfo2(mAttachments2, subpasses);
     vulkanInitializers::RenderPassCreateInfo2SetArray(renderPassInfo, dependencys);
@@ -261,7 +314,93 @@ void DrawScenePbr::CreateRenderPasses()
 
 void DrawScenePbr::CleanUpRenderPasses()
 {
+    vkDestroyRenderPass(mDevice->Get(), mDeferredPass, nullptr);
+    mDeferredPass = VK_NULL_HANDLE;
     vkDestroyRenderPass(mDevice->Get(), mMainPass, nullptr);
+    mMainPass = VK_NULL_HANDLE;
+}
+
+void DrawScenePbr::CreateDeferredPass()
+{
+    // 附件：0颜色 1深度 2运动矢量 3法线 4材质 5albedo，前三个和主pass共用同一组图像
+    std::vector<VkAttachmentDescription2> attachments(6);
+    attachments[0] = vulkanInitializers::AttachmentDescription2(mMainFbColorFormat);
+    vulkanInitializers::AttachmentDescription2SetOp(attachments[0],
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
+    vulkanInitializers::AttachmentDescription2SetLayout(attachments[0],
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    attachments[1] = vulkanInitializers::AttachmentDescription2(mMainFbDepthFormat);
+    vulkanInitializers::AttachmentDescription2SetOp(attachments[1],
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    vulkanInitializers::AttachmentDescription2SetLayout(attachments[1],
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+    attachments[2] = vulkanInitializers::AttachmentDescription2(mMainFbVelocityFormat);
+    vulkanInitializers::AttachmentDescription2SetOp(attachments[2],
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
+    vulkanInitializers::AttachmentDescription2SetLayout(attachments[2],
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    // G-buffer在pass结束后丢弃，tile-based GPU上不会写回显存
+    const std::array<VkFormat, 3> gBufferFormats = { mGBufferNormalFormat, mGBufferMaterialFormat, mGBufferAlbedoFormat };
+    for (uint32_t i = 0; i < gBufferFormats.size(); i++) {
+        attachments[3 + i] = vulkanInitializers::AttachmentDescription2(gBufferFormats[i]);
+        vulkanInitializers::AttachmentDescription2SetOp(attachments[3 + i],
+            VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+        vulkanInitializers::AttachmentDescription2SetLayout(attachments[3 + i],
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+
+    // subpass 0：写G-buffer和运动矢量，顺序和G-buffer着色器的输出一致
+    std::vector<VkAttachmentReference2> gBufferColorRefs = {
+        vulkanInitializers::AttachmentReference2(2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+        vulkanInitializers::AttachmentReference2(3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+        vulkanInitializers::AttachmentReference2(4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+        vulkanInitializers::AttachmentReference2(5, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+    };
+    VkAttachmentReference2 gBufferDepthRef =
+        vulkanInitializers::AttachmentReference2(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+    // subpass 1：G-buffer和深度作为input attachment，深度同时以只读方式绑定，用深度测试跳过背景
+    std::vector<VkAttachmentReference2> lightingColorRefs = {
+        vulkanInitializers::AttachmentReference2(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+    };
+    std::vector<VkAttachmentReference2> lightingInputRefs = {
+        vulkanInitializers::AttachmentReference2(3, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT),
+        vulkanInitializers::AttachmentReference2(4, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT),
+        vulkanInitializers::AttachmentReference2(5, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT),
+        vulkanInitializers::AttachmentReference2(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT),
+    };
+    VkAttachmentReference2 lightingDepthRef =
+        vulkanInitializers::AttachmentReference2(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+
+    std::vector<VkSubpassDescription2> subpasses = {
+        vulkanInitializers::SubpassDescription2(VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferColorRefs, &gBufferDepthRef),
+        vulkanInitializers::SubpassDescription2(VK_PIPELINE_BIND_POINT_GRAPHICS, lightingColorRefs, &lightingDepthRef),
+    };
+    subpasses[1].inputAttachmentCount = lightingInputRefs.size();
+    subpasses[1].pInputAttachments = lightingInputRefs.data();
+
+    std::vector<VkSubpassDependency2> dependencys = {
+        vulkanInitializers::SubpassDependency2(VK_SUBPASS_EXTERNAL, 0),
+        vulkanInitializers::SubpassDependency2(0, 1),
+    };
+    // 上一帧的后处理还在读颜色和运动矢量
+    dependencys[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencys[0].srcAccessMask = 0;
+    dependencys[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencys[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    // 光照只读同一像素的G-buffer，BY_REGION让tile-based GPU在片上完成两个subpass
+    dependencys[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencys[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencys[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencys[1].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    dependencys[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    VkRenderPassCreateInfo2 renderPassInfo = vulkanInitializers::RenderPassCreateInfo2(attachments, subpasses);
+    vulkanInitializers::RenderPassCreateInfo2SetArray(renderPassInfo, dependencys);
+    if (vkCreateRenderPass2(mDevice->Get(), &renderPassInfo, nullptr, &mDeferredPass) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create deferred render pass!");
+    }
 }
 
 void DrawScenePbr::CreateMainFramebuffer()
@@ -278,7 +417,7 @@ void DrawScenePbr::CreateMainFramebuffer()
     VkImageCreateInfo depthImageInfo = vulkanInitializers::ImageCreateInfo(
         VK_IMAGE_TYPE_2D, mMainFbDepthFormat,
         { mMainFbExtent.width, mMainFbExtent.height, 1 },
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
     if (vkCreateImage(mDevice->Get(), &depthImageInfo, nullptr, &mMainFbDepthImage) != VK_SUCCESS) {    // 创建VkImage
         throw std::runtime_error("failed to mMainFbDepthImage!");
     }
@@ -318,7 +457,28 @@ void DrawScenePbr::CreateMainFramebuffer()
         throw std::runtime_error("failed to create mMainFbDepthImageView!");
     }
 
-    std::vector<VkImageView> attachments = { mMainFbColorImageView, mMainFbDepthImageView };
+    // 运动矢量单独用vma分配
+    VkImageCreateInfo velocityImageInfo = vulkanInitializers::ImageCreateInfo(
+        VK_IMAGE_TYPE_2D, mMainFbVelocityFormat,
+        { mMainFbExtent.width, mMainFbExtent.height, 1 },
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    VmaAllocationCreateInfo velocityAllocInfo = {};
+    velocityAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    if (vmaCreateImage(BufferCreator::GetInstance().GetAllocator(), &velocityImageInfo, &velocityAllocInfo,
+        &mMainFbVelocityImage, &mMainFbVelocityAllocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mMainFbVelocityImage!");
+    }
+    VkImageViewCreateInfo velocityImageViewInfo = vulkanInitializers::ImageViewCreateInfo(mMainFbVelocityImage,
+        VK_IMAGE_VIEW_TYPE_2D, mMainFbVelocityFormat, { VK_IMAGE_ASPECT_COLOR_BIT , 0, 1, 0, 1 });
+    if (vkCreateImageView(mDevice->Get(), &velocityImageViewInfo, nullptr, &mMainFbVelocityImageView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mMainFbVelocityImageView!");
+    }
+
+    if (mDynamicRendering) {
+        return;
+    }
+
+    std::vector<VkImageView> attachments = { mMainFbColorImageView, mMainFbDepthImageView, mMainFbVelocityImageView };
     VkFramebufferCreateInfo framebufferInfo = vulkanInitializers::FramebufferCreateInfo(
         mMainPass, attachments, mMainFbExtent.width, mMainFbExtent.height);
     if (vkCreateFramebuffer(mDevice->Get(), &framebufferInfo, nullptr, &mMainFrameBuffer) != VK_SUCCESS) {
@@ -331,12 +491,101 @@ void DrawScenePbr::CreateMainFramebuffer()
 void DrawScenePbr::CleanUpMainFramebuffer()
 {
     LOGI("clean up main fb %d", mMainFrameBuffer);
-    vkDestroyFramebuffer(mDevice->Get(), mMainFrameBuffer, nullptr);
-    vkDestroyImageView(mDevice->Get(), mMainFbDepthImageView, nullptr);
-    vkDestroyImageView(mDevice->Get(), mMainFbColorImageView, nullptr);
-    vkDestroyImage(mDevice->Get(), mMainFbDepthImage, nullptr);
-    vkDestroyImage(mDevice->Get(), mMainFbColorImage, nullptr);
-    vkFreeMemory(mDevice->Get(), mMainFbMemory, nullptr);
+    // 重建时上一帧可能还在使用，交给延迟销毁
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    deletionQueue.DestroyFramebuffer(mMainFrameBuffer);
+    mMainFrameBuffer = VK_NULL_HANDLE;
+    deletionQueue.DestroyImageView(mMainFbVelocityImageView);
+    deletionQueue.DestroyVmaImage(mMainFbVelocityImage, mMainFbVelocityAllocation);
+    deletionQueue.DestroyImageView(mMainFbDepthImageView);
+    deletionQueue.DestroyImageView(mMainFbColorImageView);
+    deletionQueue.DestroyImage(mMainFbDepthImage);
+    deletionQueue.DestroyImage(mMainFbColorImage);
+    deletionQueue.FreeMemory(mMainFbMemory);
+}
+
+void DrawScenePbr::CreateGBuffer()
+{
+    CreateGBufferImage(mGBufferNormalFormat, mGBufferNormalImage, mGBufferNormalAllocation, mGBufferNormalImageView);
+    CreateGBufferImage(mGBufferMaterialFormat, mGBufferMaterialImage, mGBufferMaterialAllocation, mGBufferMaterialImageView);
+    CreateGBufferImage(mGBufferAlbedoFormat, mGBufferAlbedoImage, mGBufferAlbedoAllocation, mGBufferAlbedoImageView);
+
+    // input attachment的描述符只能有一个aspect
+    VkImageViewCreateInfo depthInputViewInfo = vulkanInitializers::ImageViewCreateInfo(mMainFbDepthImage,
+        VK_IMAGE_VIEW_TYPE_2D, mMainFbDepthFormat, { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 });
+    if (vkCreateImageView(mDevice->Get(), &depthInputViewInfo, nullptr, &mMainFbDepthInputView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mMainFbDepthInputView!");
+    }
+
+    // 顺序和CreateDeferredPass中的附件一致
+    std::vector<VkImageView> attachments = {
+        mMainFbColorImageView, mMainFbDepthImageView, mMainFbVelocityImageView,
+        mGBufferNormalImageView, mGBufferMaterialImageView, mGBufferAlbedoImageView,
+    };
+    VkFramebufferCreateInfo framebufferInfo = vulkanInitializers::FramebufferCreateInfo(
+        mDeferredPass, attachments, mMainFbExtent.width, mMainFbExtent.height);
+    if (vkCreateFramebuffer(mDevice->Get(), &framebufferInfo, nullptr, &mDeferredFrameBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mDeferredFrameBuffer!");
+    }
+}
+
+void DrawScenePbr::CleanUpGBuffer()
+{
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    deletionQueue.DestroyFramebuffer(mDeferredFrameBuffer);
+    mDeferredFrameBuffer = VK_NULL_HANDLE;
+    deletionQueue.DestroyImageView(mMainFbDepthInputView);
+    mMainFbDepthInputView = VK_NULL_HANDLE;
+    deletionQueue.DestroyImageView(mGBufferAlbedoImageView);
+    deletionQueue.DestroyVmaImage(mGBufferAlbedoImage, mGBufferAlbedoAllocation);
+    mGBufferAlbedoImageView = VK_NULL_HANDLE;
+    mGBufferAlbedoImage = VK_NULL_HANDLE;
+    deletionQueue.DestroyImageView(mGBufferMaterialImageView);
+    deletionQueue.DestroyVmaImage(mGBufferMaterialImage, mGBufferMaterialAllocation);
+    mGBufferMaterialImageView = VK_NULL_HANDLE;
+    mGBufferMaterialImage = VK_NULL_HANDLE;
+    deletionQueue.DestroyImageView(mGBufferNormalImageView);
+    deletionQueue.DestroyVmaImage(mGBufferNormalImage, mGBufferNormalAllocation);
+    mGBufferNormalImageView = VK_NULL_HANDLE;
+    mGBufferNormalImage = VK_NULL_HANDLE;
+}
+
+void DrawScenePbr::CreateDeferredShading()
+{
+    // 切换按键在等待栅栏之后处理，这里可以直接创建
+    if (mDeferredPass == VK_NULL_HANDLE) {
+        CreateDeferredPass();
+        CreateDeferredPipelines();
+        CreateDeferredDescriptorSet();
+    }
+    if (mDeferredFrameBuffer == VK_NULL_HANDLE) {
+        CreateGBuffer();
+        UpdateDeferredDescriptorSet();
+    }
+}
+
+void DrawScenePbr::CreateGBufferImage(VkFormat format, VkImage& image, VmaAllocation& allocation, VkImageView& imageView)
+{
+    VkImageCreateInfo imageInfo = vulkanInitializers::ImageCreateInfo(
+        VK_IMAGE_TYPE_2D, format,
+        { mMainFbExtent.width, mMainFbExtent.height, 1 },
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT);
+    // 桌面GPU一般没有懒分配的内存类型，退回普通显存
+    VmaAllocationCreateInfo allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+    VmaAllocator allocator = BufferCreator::GetInstance().GetAllocator();
+    if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        if (vmaCreateImage(allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create g-buffer image!");
+        }
+    }
+
+    VkImageViewCreateInfo imageViewInfo = vulkanInitializers::ImageViewCreateInfo(image,
+        VK_IMAGE_VIEW_TYPE_2D, format, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+    if (vkCreateImageView(mDevice->Get(), &imageViewInfo, nullptr, &imageView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create g-buffer image view!");
+    }
 }
 
 void DrawScenePbr::CreateVertexBuffer() {
@@ -370,50 +619,11 @@ void DrawScenePbr::CleanUpIndexBuffer() {
 
 void DrawScenePbr::CreateUniformBuffer()
 {
-    BufferCreator& bufferCreator = BufferCreator::GetInstance();
-
-    size_t minUboAlignment = mDevice->GetPhysicalDevice()->GetProperties().limits.minUniformBufferOffsetAlignment;
-    LOGI("minUboAlignment=%lld", minUboAlignment);
-
-    mInstanceMatrixMAlignment = sizeof(InstanceMatrixM);
-    if (minUboAlignment > 0) {
-        mInstanceMatrixMAlignment = (mInstanceMatrixMAlignment + minUboAlignment - 1) & ~(minUboAlignment - 1);
-    }
-    for (int i = 0; i < INSTANCE_NUM; i++) {
-        mInstanceMatrixMOffsets[i] = mInstanceMatrixMAlignment * i;
-    }
-    size_t instanceMatrixMBufferSize = mInstanceMatrixMAlignment * INSTANCE_NUM;
-
-    std::vector<VkBufferCreateInfo> bufferInfos = {
-        vulkanInitializers::BufferCreateInfo(sizeof(UboMvpMatrix), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
-        vulkanInitializers::BufferCreateInfo(sizeof(UniformMaterial), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
-        vulkanInitializers::BufferCreateInfo(sizeof(GlobalMatrixVP), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
-        vulkanInitializers::BufferCreateInfo(instanceMatrixMBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT),
-    };
-    std::vector<VkBuffer> buffers(bufferInfos.size(), VK_NULL_HANDLE);
-    std::vector<void*> mappedAddress(bufferInfos.size(), nullptr);
-    VkDeviceMemory bufferMemory = VK_NULL_HANDLE;
-    bufferCreator.CreateMappedBuffers(bufferInfos, buffers, mappedAddress, bufferMemory);
-
-    mUniformBuffersMemory = bufferMemory;
-
-    mUboMvp = buffers[0];
-    mUboMaterial = buffers[1];
-    mUboGlobalMatrixVP = buffers[2];
-    mUboInstanceMatrixM = buffers[3];
-
-    mUboMvpMapped = mappedAddress[0];
-    mUboMaterialMapped = mappedAddress[1];
-    mUboGlobalMatrixVPAddr = mappedAddress[2];
-    mUboInstanceMatrixMAddr = mappedAddress[3];
+    mUniformAllocator.Init(mDevice, UNIFORM_FRAME_CAPACITY);
 }
 
 void DrawScenePbr::CleanUpUniformBuffer() {
-    vkDestroyBuffer(mDevice->Get(), mUboMvp, nullptr);
-    vkDestroyBuffer(mDevice->Get(), mUboMaterial, nullptr);
-    vkDestroyBuffer(mDevice->Get(), mUboGlobalMatrixVP, nullptr);
-    vkDestroyBuffer(mDevice->Get(), mUboInstanceMatrixM, nullptr);
-    vkFreeMemory(mDevice->Get(), mUniformBuffersMemory, nullptr);
+    mUniformAllocator.CleanUp();
 }
 
 void DrawScenePbr::CreateDescriptorPool() {
@@ -466,15 +676,17 @@ void DrawScenePbr::CreateDescriptorSets() {
     }
 
     // 向descriptor set写入信息
-    VkDescriptorBufferInfo uboMvpInfo = { mUboMvp, 0, sizeof(UboMvpMatrix) };
-    VkDescriptorBufferInfo uboMaterialInfo = { mUboMaterial, 0, sizeof(UniformMaterial) };
+    VkDescriptorBufferInfo uboMvpInfo = mUniformAllocator.GetDescriptorInfo(sizeof(UboMvpMatrix));
+    VkDescriptorBufferInfo uboMaterialInfo = mUniformAllocator.GetDescriptorInfo(sizeof(UniformMaterial));
 
     std::vector<VkWriteDescriptorSet> descriptorWrites(2);
     descriptorWrites[0] = vulkanInitializers::WriteDescriptorSet(mDescriptorSetPbr,
-        0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &uboMvpInfo);
+        0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &uboMvpInfo);
     descriptorWrites[1] = vulkanInitializers::WriteDescriptorSet(mDescriptorSetPbr,
-        1, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &uboMaterialInfo);
+        1, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &uboMaterialInfo);
     vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    mClusteredLights.WriteDescriptorSet(mDescriptorSetPbr);
+    mImageBasedLighting.WriteDescriptorSet(mDescriptorSetPbr);
 
     // mDescriptorSetPbrTexture
     // 从池中申请descriptor set
@@ -485,8 +697,8 @@ void DrawScenePbr::CreateDescriptorSets() {
     }
 
     // 向descriptor set写入信息
-    VkDescriptorBufferInfo uboVpInfo = { mUboGlobalMatrixVP, 0, sizeof(GlobalMatrixVP) };
-    VkDescriptorBufferInfo uboMInfo = { mUboInstanceMatrixM, 0, sizeof(InstanceMatrixM) };
+    VkDescriptorBufferInfo uboVpInfo = mUniformAllocator.GetDescriptorInfo(sizeof(GlobalMatrixVP));
+    VkDescriptorBufferInfo uboMInfo = mUniformAllocator.GetDescriptorInfo(sizeof(InstanceMatrixM));
     VkDescriptorImageInfo texRoughnessInfo = { mTexureSampler, mRoughnessImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
     VkDescriptorImageInfo texMatallicInfo = { mTexureSampler, mMatallicImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
     VkDescriptorImageInfo texAlbedoInfo = { mTexureSampler, mAlbedoImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
@@ -494,7 +706,7 @@ void DrawScenePbr::CreateDescriptorSets() {
 
     std::vector<VkWriteDescriptorSet> pbrTextureWrites = {
         vulkanInitializers::WriteDescriptorSet(mDescriptorSetPbrTexture,
-            0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &uboVpInfo),
+            0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &uboVpInfo),
         vulkanInitializers::WriteDescriptorSet(mDescriptorSetPbrTexture,
             1, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &uboMInfo),
 
@@ -509,6 +721,37 @@ void DrawScenePbr::CreateDescriptorSets() {
     };
 
     vkUpdateDescriptorSets(mDevice->Get(), pbrTextureWrites.size(), pbrTextureWrites.data(), 0, nullptr);
+    mClusteredLights.WriteDescriptorSet(mDescriptorSetPbrTexture);
+    mImageBasedLighting.WriteDescriptorSet(mDescriptorSetPbrTexture);
+}
+
+void DrawScenePbr::CreateDeferredDescriptorSet()
+{
+    // 延迟光照的描述符单独一个池，只在第一次切到延迟渲染时创建
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = mPipelineDeferredLighting.descriptorSizes.size();
+    poolInfo.pPoolSizes = mPipelineDeferredLighting.descriptorSizes.data();
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDeferredDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mDeferredDescriptorPool!");
+    }
+
+    // input attachment在UpdateDeferredDescriptorSet中写入
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = mDeferredDescriptorPool;
+    allocInfo.descriptorSetCount = mPipelineDeferredLighting.descriptorSetLayouts.size();
+    allocInfo.pSetLayouts = mPipelineDeferredLighting.descriptorSetLayouts.data();
+    if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetDeferredLighting) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mDescriptorSetDeferredLighting!");
+    }
+
+    VkDescriptorBufferInfo uboDeferredInfo = mUniformAllocator.GetDescriptorInfo(sizeof(DeferredLightingUniform));
+    VkWriteDescriptorSet deferredLightingWrite = vulkanInitializers::WriteDescriptorSet(mDescriptorSetDeferredLighting,
+        0, 0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, &uboDeferredInfo);
+    vkUpdateDescriptorSets(mDevice->Get(), 1, &deferredLightingWrite, 0, nullptr);
+    mClusteredLights.WriteDescriptorSet(mDescriptorSetDeferredLighting);
+    mImageBasedLighting.WriteDescriptorSet(mDescriptorSetDeferredLighting);
 }
 
 void DrawScenePbr::CreatePipelines()
@@ -528,29 +771,43 @@ void DrawScenePbr::CreatePipelines()
 
     std::vector<VkPushConstantRange> nullPushConstantRanges = {};
 
+    // 渲染区域只占主framebuffer的一部分，纹理坐标需要缩放，并在片元着色器中限制在区域内
+    std::vector<VkPushConstantRange> presentPushConstantRanges = {
+        { VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PresentPushConstants) },
+    };
+
     GraphicsPipelineConfigInfo presentConfigInfo{};
-    presentConfigInfo.SetRenderPass(mPresentRenderPass);
+    SetPresentPassTarget(presentConfigInfo);
     presentConfigInfo.SetInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
 
-    mPipelinePresent = pipelineFactory.CreateGraphicsPipeline(presentConfigInfo, presentShaderFilePaths, presentLayoutBindings, nullPushConstantRanges);
+    mPipelinePresent = pipelineFactory.CreateGraphicsPipeline(presentConfigInfo, presentShaderFilePaths, presentLayoutBindings, presentPushConstantRanges);
 
     // draw glosy material
     std::vector<ShaderFileInfo> pbrShaderFilePaths = {
         { GetConfig().directory.dirSpvFiles + std::string("DrawMesh.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT},
-        { GetConfig().directory.dirSpvFiles + std::string("DrawMeshGlossy.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+        { GetConfig().directory.dirSpvFiles + std::string("DrawMeshGlossyClustered.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
     };
 
     std::vector<VkDescriptorSetLayoutBinding> pbrLayoutBindings = {
-        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
-        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
     };
+    ClusteredLights::AppendLayoutBindings(pbrLayoutBindings);
+    ImageBasedLighting::AppendLayoutBindings(pbrLayoutBindings);
 
     std::vector<VkPushConstantRange> pbrPushConstantRanges = {
         { VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformMaterial) },
     };
 
+    // 颜色和运动矢量两个附件，都不混合
+    std::vector<VkPipelineColorBlendAttachmentState> mainPassBlendAttachmentStates = {
+        vulkanInitializers::PipelineColorBlendAttachmentState(),
+        vulkanInitializers::PipelineColorBlendAttachmentState(),
+    };
+
     GraphicsPipelineConfigInfo pipelinePbrConfigInfo{};
-    pipelinePbrConfigInfo.SetRenderPass(mMainPass);
+    SetMainPassTarget(pipelinePbrConfigInfo);
+    pipelinePbrConfigInfo.SetBlendStates(mainPassBlendAttachmentStates);
     pipelinePbrConfigInfo.SetVertexInputBindings({ Vertex3D::GetBindingDescription() });
     pipelinePbrConfigInfo.SetVertexInputAttributes(Vertex3D::getAttributeDescriptions());
     pipelinePbrConfigInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
@@ -563,20 +820,23 @@ void DrawScenePbr::CreatePipelines()
     // draw glosy material with texture
     std::vector<ShaderFileInfo> pbrTextureShaderFilePaths = {
         { GetConfig().directory.dirSpvFiles + std::string("pbr_width_texture.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT},
-        { GetConfig().directory.dirSpvFiles + std::string("pbr_width_texture.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+        { GetConfig().directory.dirSpvFiles + std::string("pbr_width_texture_clustered.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
     };
 
     std::vector<VkDescriptorSetLayoutBinding> pbrTextureLayoutBindings = {
-        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
         vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT),
         vulkanInitializers::DescriptorSetLayoutBinding(10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
         vulkanInitializers::DescriptorSetLayoutBinding(11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
         vulkanInitializers::DescriptorSetLayoutBinding(12, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
         vulkanInitializers::DescriptorSetLayoutBinding(13, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
     };
+    ClusteredLights::AppendLayoutBindings(pbrTextureLayoutBindings);
+    ImageBasedLighting::AppendLayoutBindings(pbrTextureLayoutBindings);
 
     GraphicsPipelineConfigInfo pbrTextureConfigInfo{};
-    pbrTextureConfigInfo.SetRenderPass(mMainPass);
+    SetMainPassTarget(pbrTextureConfigInfo);
+    pbrTextureConfigInfo.SetBlendStates(mainPassBlendAttachmentStates);
     pbrTextureConfigInfo.SetVertexInputBindings({ Vertex3D::GetBindingDescription() });
     pbrTextureConfigInfo.SetVertexInputAttributes(Vertex3D::getAttributeDescriptions());
     pbrTextureConfigInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
@@ -585,7 +845,101 @@ void DrawScenePbr::CreatePipelines()
     pbrTextureConfigInfo.mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
 
     mPipelinePbrTexture = pipelineFactory.CreateGraphicsPipeline(pbrTextureConfigInfo, pbrTextureShaderFilePaths, pbrTextureLayoutBindings, nullPushConstantRanges);
-    
+}
+
+void DrawScenePbr::CreateDeferredPipelines()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    std::vector<VkPushConstantRange> nullPushConstantRanges = {};
+
+    // 写G-buffer的管线和前向管线的布局相同，共用mDescriptorSetPbr和mDescriptorSetPbrTexture
+    std::vector<VkDescriptorSetLayoutBinding> pbrLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    ClusteredLights::AppendLayoutBindings(pbrLayoutBindings);
+    ImageBasedLighting::AppendLayoutBindings(pbrLayoutBindings);
+
+    std::vector<VkPushConstantRange> pbrPushConstantRanges = {
+        { VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformMaterial) },
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> pbrTextureLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(12, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(13, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    ClusteredLights::AppendLayoutBindings(pbrTextureLayoutBindings);
+    ImageBasedLighting::AppendLayoutBindings(pbrTextureLayoutBindings);
+
+    std::vector<VkPipelineColorBlendAttachmentState> gBufferBlendAttachmentStates(4,
+        vulkanInitializers::PipelineColorBlendAttachmentState());
+
+    std::vector<ShaderFileInfo> gBufferShaderFilePaths = {
+        { GetConfig().directory.dirSpvFiles + std::string("DrawMesh.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT},
+        { GetConfig().directory.dirSpvFiles + std::string("DrawMeshGBuffer.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+    GraphicsPipelineConfigInfo gBufferConfigInfo{};
+    gBufferConfigInfo.SetRenderPass(mDeferredPass, 0);
+    gBufferConfigInfo.SetBlendStates(gBufferBlendAttachmentStates);
+    gBufferConfigInfo.SetVertexInputBindings({ Vertex3D::GetBindingDescription() });
+    gBufferConfigInfo.SetVertexInputAttributes(Vertex3D::getAttributeDescriptions());
+    gBufferConfigInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
+    gBufferConfigInfo.mDepthStencilState.depthWriteEnable = VK_TRUE;
+    gBufferConfigInfo.mDepthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+    gBufferConfigInfo.mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+    mPipelineGBuffer = pipelineFactory.CreateGraphicsPipeline(gBufferConfigInfo, gBufferShaderFilePaths, pbrLayoutBindings, pbrPushConstantRanges);
+
+    std::vector<ShaderFileInfo> gBufferTextureShaderFilePaths = {
+        { GetConfig().directory.dirSpvFiles + std::string("pbr_width_texture.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT},
+        { GetConfig().directory.dirSpvFiles + std::string("pbr_width_texture_gbuffer.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+    GraphicsPipelineConfigInfo gBufferTextureConfigInfo{};
+    gBufferTextureConfigInfo.SetRenderPass(mDeferredPass, 0);
+    gBufferTextureConfigInfo.SetBlendStates(gBufferBlendAttachmentStates);
+    gBufferTextureConfigInfo.SetVertexInputBindings({ Vertex3D::GetBindingDescription() });
+    gBufferTextureConfigInfo.SetVertexInputAttributes(Vertex3D::getAttributeDescriptions());
+    gBufferTextureConfigInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
+    gBufferTextureConfigInfo.mDepthStencilState.depthWriteEnable = VK_TRUE;
+    gBufferTextureConfigInfo.mDepthStencilState.depthCompareOp = VK_COMPARE_OP_LESS;
+    gBufferTextureConfigInfo.mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+    mPipelineGBufferTexture = pipelineFactory.CreateGraphicsPipeline(gBufferTextureConfigInfo, gBufferTextureShaderFilePaths, pbrTextureLayoutBindings, nullPushConstantRanges);
+
+    // deferred: 全屏光照，G-buffer通过input attachment读取
+    std::vector<ShaderFileInfo> deferredLightingShaderFilePaths = {
+        { GetConfig().directory.dirSpvFiles + std::string("deferred_lighting.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT},
+        { GetConfig().directory.dirSpvFiles + std::string("deferred_lighting.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> deferredLightingLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(4, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    ClusteredLights::AppendLayoutBindings(deferredLightingLayoutBindings);
+    ImageBasedLighting::AppendLayoutBindings(deferredLightingLayoutBindings);
+
+    std::vector<VkPipelineColorBlendAttachmentState> lightingBlendAttachmentStates = {
+        vulkanInitializers::PipelineColorBlendAttachmentState(),
+    };
+
+    // 三角形在远平面上，只有画了物体的像素能通过GREATER测试
+    GraphicsPipelineConfigInfo deferredLightingConfigInfo{};
+    deferredLightingConfigInfo.SetRenderPass(mDeferredPass, 1);
+    deferredLightingConfigInfo.SetBlendStates(lightingBlendAttachmentStates);
+    deferredLightingConfigInfo.mDepthStencilState.depthTestEnable = VK_TRUE;
+    deferredLightingConfigInfo.mDepthStencilState.depthWriteEnable = VK_FALSE;
+    deferredLightingConfigInfo.mDepthStencilState.depthCompareOp = VK_COMPARE_OP_GREATER;
+    deferredLightingConfigInfo.mDepthStencilState.depthBoundsTestEnable = VK_FALSE;
+
+    mPipelineDeferredLighting = pipelineFactory.CreateGraphicsPipeline(deferredLightingConfigInfo, deferredLightingShaderFilePaths, deferredLightingLayoutBindings, nullPushConstantRanges);
 }
 
 void DrawScenePbr::CleanUpPipelines()
@@ -593,6 +947,9 @@ void DrawScenePbr::CleanUpPipelines()
     PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
     pipelineFactory.SetDevice(mDevice->Get());
 
+    pipelineFactory.DestroyPipelineObjecst(mPipelineDeferredLighting);
+    pipelineFactory.DestroyPipelineObjecst(mPipelineGBufferTexture);
+    pipelineFactory.DestroyPipelineObjecst(mPipelineGBuffer);
     pipelineFactory.DestroyPipelineObjecst(mPipelinePbrTexture);
     pipelineFactory.DestroyPipelineObjecst(mPipelineDrawPbr);
     pipelineFactory.DestroyPipelineObjecst(mPipelinePresent);
@@ -611,22 +968,28 @@ void DrawScenePbr::CreateTextures()
 
     std::vector<StbImageBuffer> imageBuffers(texturePaths.size());
 
-    // read pictures
-    for (int i = 0; i < texturePaths.size(); i++) {
-        int texWidth, texHeight, texChannels;
-        stbi_set_flip_vertically_on_load(true);
-        stbi_uc* pixels = stbi_load(texturePaths[i].c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        if (pixels) {
-            imageBuffers[i].pixels = pixels;
-            imageBuffers[i].width = texWidth;
-            imageBuffers[i].height = texHeight;
-            imageBuffers[i].channels = texChannels;
-            imageBuffers[i].size = texWidth * texHeight * 4 * sizeof(unsigned char);
-            LOGI("chanels=%d", imageBuffers[i].channels);
+    // read pictures，每张图片的解码作为一个任务并行执行
+    stbi_set_flip_vertically_on_load(true);
+    JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(texturePaths.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            int texWidth, texHeight, texChannels;
+            stbi_uc* pixels = stbi_load(texturePaths[i].c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (pixels) {
+                imageBuffers[i].pixels = pixels;
+                imageBuffers[i].width = texWidth;
+                imageBuffers[i].height = texHeight;
+                imageBuffers[i].channels = texChannels;
+                imageBuffers[i].size = texWidth * texHeight * 4 * sizeof(unsigned char);
+            }
         }
-        else {
-            throw std::runtime_error("failed to load test_texure.jpg!");
+    });
+
+    // 任务中不能抛异常，全部加载完再检查
+    for (int i = 0; i < imageBuffers.size(); i++) {
+        if (imageBuffers[i].pixels == nullptr) {
+            throw std::runtime_error("failed to load " + texturePaths[i] + "!");
         }
+        LOGI("chanels=%d", imageBuffers[i].channels);
     }
 
     // init createInfo
@@ -723,6 +1086,65 @@ void DrawScenePbr::CleanUpTextureSampler() {
     vkDestroySampler(mDevice->Get(), mTexureSampler, nullptr);
 }
 
+void DrawScenePbr::CreateLights()
+{
+    mClusteredLights.Init(mDevice, MAX_LIGHT_COUNT);
+
+    // 原来写在着色器中的四个点光源
+    std::vector<glm::vec3> lightPositions = {
+        glm::vec3(10.0f, 10.0f, 10.0f),
+        glm::vec3(10.0f, 10.0f, -10.0f),
+        glm::vec3(10.0f, -10.0f, 10.0f),
+        glm::vec3(10.0f, -10.0f, -10.0f),
+    };
+    std::vector<PointLight> lights(lightPositions.size());
+    for (uint32_t i = 0; i < lights.size(); i++) {
+        lights[i].position = lightPositions[i];
+        lights[i].power = glm::vec3(5000.0f);
+        lights[i].radius = ClusteredLights::CalculateRadius(lights[i].power, LIGHT_THRESHOLD);
+    }
+    mClusteredLights.SetLights(lights.data(), lights.size());
+}
+
+void DrawScenePbr::CreateEnvironmentLighting()
+{
+    mImageBasedLighting.Init(mDevice);
+
+    std::string hdrPath = GetConfig().directory.dirResource + "hdr/environment.hdr";
+    std::string cachePath = GetConfig().directory.dirResource + "cache/environment.ibl";
+    uint64_t sourceKey = ImageBasedLighting::GetFileKey(hdrPath);
+    if (sourceKey == 0) {
+        cachePath = GetConfig().directory.dirResource + "cache/procedural_sky.ibl";
+        sourceKey = ImageBasedLighting::PROCEDURAL_SKY_KEY;
+    }
+    if (mImageBasedLighting.LoadCache(cachePath, sourceKey)) {
+        return;
+    }
+
+    // 缓存不存在或已失效，重新预处理
+    EquirectImage source{};
+    std::vector<float> skyPixels = {};
+    float* hdrPixels = nullptr;
+    if (sourceKey != ImageBasedLighting::PROCEDURAL_SKY_KEY) {
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(false);        // 第一行是天顶
+        hdrPixels = stbi_loadf(hdrPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (hdrPixels == nullptr) {
+            throw std::runtime_error("failed to load " + hdrPath + "!");
+        }
+        source = { hdrPixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+    } else {
+        ImageBasedLighting::GenerateProceduralSky(skyPixels,
+            ImageBasedLighting::PROCEDURAL_SKY_WIDTH, ImageBasedLighting::PROCEDURAL_SKY_HEIGHT);
+        source = { skyPixels.data(), ImageBasedLighting::PROCEDURAL_SKY_WIDTH, ImageBasedLighting::PROCEDURAL_SKY_HEIGHT };
+    }
+    mImageBasedLighting.Bake(source, cachePath, sourceKey);
+
+    if (hdrPixels != nullptr) {
+        stbi_image_free(hdrPixels);
+    }
+}
+
 void DrawScenePbr::UpdataUniformBuffer(float aspectRatio)
 {
     UboMvpMatrix uboMvpMatrixs{};
@@ -731,10 +1153,21 @@ void DrawScenePbr::UpdataUniformBuffer(float aspectRatio)
     uboMvpMatrixs.view = mCamera->GetView();
     uboMvpMatrixs.cameraPos = glm::inverse(uboMvpMatrixs.view) * glm::vec4(0.0, 0.0, 0.0, 1.0);
 
-    mCamera->SetPerspective(aspectRatio, 0.1f, 100.0f, 45.0f);
-    uboMvpMatrixs.proj = mCamera->GetProjection();
+    mCamera->SetPerspective(aspectRatio, NEAR_PLANE, FAR_PLANE, 45.0f);
+    uboMvpMatrixs.proj = mCamera->GetJitteredProjection();
     uboMvpMatrixs.proj[1][1] *= -1;
 
+    // 运动矢量用不带抖动的矩阵计算，否则静止的画面也有位移
+    glm::mat4 proj = mCamera->GetProjection();
+    proj[1][1] *= -1;
+    glm::mat4 currViewProj = proj * uboMvpMatrixs.view;
+    if (!mPrevViewProjValid) {
+        mPrevViewProj = currViewProj;
+        mPrevViewProjValid = true;
+    }
+    uboMvpMatrixs.currViewProj = currViewProj;
+    uboMvpMatrixs.prevViewProj = mPrevViewProj;
+
     glm::mat vpMat = uboMvpMatrixs.proj * uboMvpMatrixs.view;
 
     mLastFront = mFront;
@@ -742,30 +1175,42 @@ void DrawScenePbr::UpdataUniformBuffer(float aspectRatio)
     
     float cos = glm::dot(mFront, mLastFront);
 
-    memcpy(mUboMvpMapped, &uboMvpMatrixs, sizeof(uboMvpMatrixs));
+    mPbrDynamicOffsets[0] = mUniformAllocator.Push(uboMvpMatrixs);
 
     UniformMaterial uboMaterial{};
     uboMaterial.albedo = glm::vec3(1.0, 0.5, 0.0);
     uboMaterial.roughness = 0.7f;
     uboMaterial.metallic = 1.0f;
-    memcpy(mUboMaterialMapped, &uboMaterial, sizeof(uboMaterial));
+    mPbrDynamicOffsets[1] = mUniformAllocator.Push(uboMaterial);
 
     // -------------
     GlobalMatrixVP uboVp{};
     uboVp.view = mCamera->GetView();
-    uboVp.proj = mCamera->GetProjection();
+    uboVp.proj = mCamera->GetJitteredProjection();
     uboVp.proj[1][1] *= -1;
     uboVp.cameraPos = glm::inverse(uboVp.view) * glm::vec4(0.0, 0.0, 0.0, 1.0);
-    memcpy(mUboGlobalMatrixVPAddr, &uboVp, sizeof(uboVp));
-
-    InstanceMatrixM uboM[INSTANCE_NUM] = {};
+    uboVp.currViewProj = currViewProj;
+    uboVp.prevViewProj = mPrevViewProj;
+    mGlobalMatrixVPOffset = mUniformAllocator.Push(uboVp);
+
+    // 延迟光照用带抖动的矩阵重建世界坐标，和写G-buffer时的光栅化位置一致
+    DeferredLightingUniform uboDeferred{};
+    VkExtent2D renderExtent = mDynamicResolution.GetRenderExtent();
+    uboDeferred.invViewProj = glm::inverse(uboVp.proj * uboVp.view);
+    uboDeferred.cameraPos = glm::vec4(uboVp.cameraPos, 1.0f);
+    uboDeferred.renderSize = glm::vec4(renderExtent.width, renderExtent.height, 0.0f, 0.0f);
+    mDeferredLightingOffset = mUniformAllocator.Push(uboDeferred);
+    mPrevViewProj = currViewProj;
+
+    // 每个实例单独分配，偏移按minUniformBufferOffsetAlignment对齐
+    InstanceMatrixM uboM{};
     float SphereDistance = 2.5f;
     float yOffset = SphereDistance * 3;
     float zOffset = -SphereDistance * 2;
     for (int i = 0; i < INSTANCE_NUM; i++) {
-        uboM[i].model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, yOffset, zOffset + SphereDistance * i));
+        uboM.model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, yOffset, zOffset + SphereDistance * i));
+        mInstanceMatrixMOffsets[i] = mUniformAllocator.Push(uboM);
     }
-    memcpy(mUboInstanceMatrixMAddr, &uboM, sizeof(uboM));
 }
 
 void DrawScenePbr::UpdateDescriptorSets()
@@ -779,40 +1224,190 @@ void DrawScenePbr::UpdateDescriptorSets()
     vkUpdateDescriptorSets(mDevice->Get(), presentDescriptorWrites.size(), presentDescriptorWrites.data(), 0, nullptr);
 }
 
+void DrawScenePbr::UpdateDeferredDescriptorSet()
+{
+    // G-buffer随framebuffer重建
+    VkDescriptorImageInfo inputNormalInfo = { VK_NULL_HANDLE, mGBufferNormalImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorImageInfo inputMaterialInfo = { VK_NULL_HANDLE, mGBufferMaterialImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorImageInfo inputAlbedoInfo = { VK_NULL_HANDLE, mGBufferAlbedoImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorImageInfo inputDepthInfo = { VK_NULL_HANDLE, mMainFbDepthInputView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+    std::vector<VkWriteDescriptorSet> deferredLightingWrites = {
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetDeferredLighting,
+            1, 0, 1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, &inputNormalInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetDeferredLighting,
+            2, 0, 1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, &inputMaterialInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetDeferredLighting,
+            3, 0, 1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, &inputAlbedoInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetDeferredLighting,
+            4, 0, 1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, &inputDepthInfo),
+    };
+    vkUpdateDescriptorSets(mDevice->Get(), deferredLightingWrites.size(), deferredLightingWrites.data(), 0, nullptr);
+}
+
 void DrawScenePbr::RecordPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input)
 {
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
     // 启动Pass
-    std::array<VkClearValue, 2> clearValues = {
-        consts::CLEAR_COLOR_NAVY_FLT,
-        consts::CLEAR_DEPTH_ONE_STENCIL_ZERO
-    };
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = input.presentRenderPass;
-    renderPassInfo.framebuffer = input.swapchanFb;
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = input.swapchainExtent;
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-    vkCmdBeginRenderPass(cmdBuf, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    CmdBeginPresentPass(cmdBuf, input, consts::CLEAR_COLOR_NAVY_FLT);
 
-    // 绑定Pipeline
-    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePresent.pipeline);
     VkViewport viewport = { 0.0f, 0.0f, input.swapchainExtent.width, input.swapchainExtent.height, 0.0f, 1.0f };
-    vkCmdSetViewport(cmdBuf, 0, 1, &viewport);
+    dispatch.CmdSetViewport(cmdBuf, 0, 1, &viewport);
     VkRect2D scissor = { { 0, 0 }, input.swapchainExtent };
-    vkCmdSetScissor(cmdBuf, 0, 1, &scissor);
+    dispatch.CmdSetScissor(cmdBuf, 0, 1, &scissor);
+
+    if (mTemporalUpscaleEnabled) {
+        mTemporalUpscaler.CmdDrawSharpen(cmdBuf);
+        CmdEndPresentPass(cmdBuf, input);
+        return;
+    }
+
+    // 绑定Pipeline
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePresent.pipeline);
 
     // 绑定DescriptorSet
-    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
         mPipelinePresent.layout,
         0, 1, &mDescriptorSetPresent,
         0, nullptr);
+    PresentPushConstants presentPushConstants = { mDynamicResolution.GetUvScale(), mDynamicResolution.GetUvClamp() };
+    dispatch.CmdPushConstants(cmdBuf, mPipelinePresent.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0, sizeof(presentPushConstants), &presentPushConstants);
 
     //画图
-    vkCmdDraw(cmdBuf, 4, 1, 0, 0);
+    dispatch.CmdDraw(cmdBuf, 4, 1, 0, 0);
 
     // 结束Pass
-    vkCmdEndRenderPass(cmdBuf);
+    CmdEndPresentPass(cmdBuf, input);
+}
+
+void DrawScenePbr::SetMainPassTarget(GraphicsPipelineConfigInfo& configInfo)
+{
+    if (!mDynamicRendering) {
+        configInfo.SetRenderPass(mMainPass);
+        return;
+    }
+    // 颜色和运动矢量的顺序与CmdBeginMainPass中一致
+    std::vector<VkFormat> colorFormats = { mMainFbColorFormat, mMainFbVelocityFormat };
+    configInfo.SetRenderingInfo(vulkanInitializers::PipelineRenderingCreateInfo(
+        colorFormats, mMainFbDepthFormat, mMainFbDepthFormat));
+}
+
+void DrawScenePbr::CmdBeginMainPass(VkRect2D renderArea)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    VkClearValue clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+    VkClearValue clearVelocity = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (!mDynamicRendering) {
+        std::array<VkClearValue, 3> clearValuesMain = { clearColor, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO, clearVelocity };
+        VkRenderPassBeginInfo renderPassInfoMain = vulkanInitializers::RenderPassBeginInfo(
+            mMainPass, mMainFrameBuffer, renderArea, clearValuesMain);
+        dispatch.CmdBeginRenderPass(mCommandBuffer, &renderPassInfoMain, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    // 上一帧的后处理还在读颜色和运动矢量，等它们读完再覆盖
+    ImageMemoryBarrierInfo colorBarrierInfo{};
+    colorBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    colorBarrierInfo.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorBarrierInfo.srcStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    colorBarrierInfo.srcAccessMask = 0;
+    colorBarrierInfo.dstStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    colorBarrierInfo.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbColorImage, VK_IMAGE_ASPECT_COLOR_BIT, colorBarrierInfo);
+    mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbVelocityImage, VK_IMAGE_ASPECT_COLOR_BIT, colorBarrierInfo);
+
+    ImageMemoryBarrierInfo depthBarrierInfo{};
+    depthBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthBarrierInfo.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthBarrierInfo.srcStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    depthBarrierInfo.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    depthBarrierInfo.dstStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    depthBarrierInfo.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbDepthImage,
+        VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, depthBarrierInfo);
+
+    std::array<VkRenderingAttachmentInfoKHR, 2> colorAttachments = {
+        vulkanInitializers::RenderingAttachmentInfo(mMainFbColorImageView, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, clearColor),
+        vulkanInitializers::RenderingAttachmentInfo(mMainFbVelocityImageView, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, clearVelocity),
+    };
+    VkRenderingAttachmentInfoKHR depthAttachment = vulkanInitializers::RenderingAttachmentInfo(
+        mMainFbDepthImageView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO);
+    VkRenderingInfoKHR renderingInfo = vulkanInitializers::RenderingInfo(
+        renderArea, colorAttachments, &depthAttachment, &depthAttachment);
+    dispatch.CmdBeginRenderingKHR(mCommandBuffer, &renderingInfo);
+}
+
+void DrawScenePbr::CmdEndMainPass()
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    if (mDynamicRendering) {
+        dispatch.CmdEndRenderingKHR(mCommandBuffer);
+    }
+    else {
+        dispatch.CmdEndRenderPass(mCommandBuffer);
+    }
+}
+
+void DrawScenePbr::CmdDrawScene(const PipelineObjecs& pipelineConstMaterial, const PipelineObjecs& pipelineTexture)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // 绑定Pipeline
+    dispatch.CmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineConstMaterial.pipeline);
+
+    // 绑定顶点缓冲
+    std::array<VkBuffer, 1> vertexBuffersMain = { mVertexBuffer };
+    std::array<VkDeviceSize, 1> offsetsMain = { 0 };
+    dispatch.CmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffersMain.data(), offsetsMain.data());
+
+    // 绑定索引缓冲
+    dispatch.CmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+
+    // 绑定DescriptorSet
+    dispatch.CmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineConstMaterial.layout,
+        0, 1, &mDescriptorSetPbr,
+        2, mPbrDynamicOffsets);
+
+    UniformMaterial uboMaterial{};
+    uboMaterial.albedo = glm::vec3(1.0f, 0.765557f, 0.336057f);
+
+    int ySegMent = 5;
+    int zSegMent = 5;
+    float SphereDistance = 2.5f;
+    for (int y = 0; y < ySegMent; y++) {
+        for (int z = 0; z < zSegMent; z++) {
+            uboMaterial.roughness = 0.2f + static_cast<float>(z) / zSegMent;
+            uboMaterial.metallic = 0.2f + static_cast<float>(y) / ySegMent;
+            uboMaterial.modelOffset = glm::vec3(0.0, SphereDistance * y - 5.0f, SphereDistance * z - 5.0f);
+            dispatch.CmdPushConstants(mCommandBuffer, pipelineConstMaterial.layout, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformMaterial), &uboMaterial);
+            dispatch.CmdDrawIndexed(mCommandBuffer, mMesh->GetIndexData().size(), 1, 0, 0, 0);
+        }
+    }
+
+    // pbr with texture
+    dispatch.CmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineTexture.pipeline);
+
+    for (int i = 0; i < INSTANCE_NUM; i++) {
+        uint32_t dynamicOffsets[] = { mGlobalMatrixVPOffset, mInstanceMatrixMOffsets[i] };
+        dispatch.CmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipelineTexture.layout,
+            0, 1, &mDescriptorSetPbrTexture,
+            2, dynamicOffsets);
+        dispatch.CmdDrawIndexed(mCommandBuffer, mMesh->GetIndexData().size(), 1, 0, 0, 0);
+    }
+}
+
+void DrawScenePbr::CmdDrawDeferredLighting()
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    dispatch.CmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineDeferredLighting.pipeline);
+    dispatch.CmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        mPipelineDeferredLighting.layout,
+        0, 1, &mDescriptorSetDeferredLighting,
+        1, &mDeferredLightingOffset);
+    dispatch.CmdDraw(mCommandBuffer, 3, 1, 0, 0);
 }
 }   // namespace render
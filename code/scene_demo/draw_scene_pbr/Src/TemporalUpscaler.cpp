@@ -0,0 +1,318 @@
+#include "TemporalUpscaler.h"
+
+#include <stdexcept>
+
+#include "SceneDemoDefs.h"
+#include "BufferCreator.h"
+#include "DeletionQueue.h"
+#include "GpuProfiler.h"
+
+#include "Log.h"
+#include "AppDispatchTable.h"
+#undef LOG_TAG
+#define LOG_TAG "TemporalUpscaler"
+
+namespace framework {
+void TemporalUpscaler::Init(Device* device, VkRenderPass presentRenderPass,
+    const VkPipelineRenderingCreateInfoKHR* presentRenderingInfo)
+{
+    mDevice = device;
+    CreatePipelines(presentRenderPass, presentRenderingInfo);
+    CreateSampler();
+    CreateDescriptorSets();
+}
+
+void TemporalUpscaler::CleanUp()
+{
+    vkDestroyDescriptorPool(mDevice->Get(), mDescriptorPool, nullptr);
+    CleanUpSampler();
+    CleanUpPipelines();
+}
+
+void TemporalUpscaler::CreateHistoryImages(VkExtent2D outputExtent)
+{
+    VkImageCreateInfo imageInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, HISTORY_FORMAT);
+    imageInfo.extent = { outputExtent.width, outputExtent.height, 1 };
+    imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    // 布局转换放到下一帧的CmdResolve中，resize时不用单独提交并等待队列
+    for (uint32_t i = 0; i < mHistoryImages.size(); i++) {
+        if (vmaCreateImage(BufferCreator::GetInstance().GetAllocator(),
+            &imageInfo, &imageAllocInfo, &mHistoryImages[i], &mHistoryAllocations[i], nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create history image!");
+        }
+        VkImageViewCreateInfo viewInfo = vulkanInitializers::ImageViewCreateInfo(mHistoryImages[i],
+            VK_IMAGE_VIEW_TYPE_2D, HISTORY_FORMAT, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+        if (vkCreateImageView(mDevice->Get(), &viewInfo, nullptr, &mHistoryImageViews[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create history image view!");
+        }
+    }
+
+    mOutputExtent = outputExtent;
+    mHistoryIndex = 0;
+    mHistoryValid = false;
+}
+
+void TemporalUpscaler::CleanUpHistoryImages()
+{
+    for (uint32_t i = 0; i < mHistoryImages.size(); i++) {
+        DeletionQueue::GetInstance().DestroyImageView(mHistoryImageViews[i]);
+        DeletionQueue::GetInstance().DestroyVmaImage(mHistoryImages[i], mHistoryAllocations[i]);
+        mHistoryImageViews[i] = VK_NULL_HANDLE;
+        mHistoryImages[i] = VK_NULL_HANDLE;
+        mHistoryAllocations[i] = VK_NULL_HANDLE;
+    }
+}
+
+void TemporalUpscaler::SetInputs(VkImageView colorImageView, VkImageView velocityImageView)
+{
+    mColorImageView = colorImageView;
+    mVelocityImageView = velocityImageView;
+    UpdateDescriptorSets();
+}
+
+glm::vec2 TemporalUpscaler::BeginFrame(VkExtent2D renderExtent)
+{
+    // Halton(2,3)序列，像素内均匀分布
+    uint32_t phase = mFrameIndex % JITTER_PHASE_COUNT + 1;
+    mJitterPixels = glm::vec2(Halton(phase, 2) - 0.5f, Halton(phase, 3) - 0.5f);
+    mRenderExtent = renderExtent;
+    mFrameIndex++;
+    return glm::vec2(2.0f * mJitterPixels.x / renderExtent.width, 2.0f * mJitterPixels.y / renderExtent.height);
+}
+
+void TemporalUpscaler::CmdResolve(VkCommandBuffer cmdBuf)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    GpuProfileScope resolveScope(cmdBuf, "TemporalUpscale", true);
+
+    uint32_t writeIndex = 1 - mHistoryIndex;
+
+    // 上一帧present读完、resolve写完之后才能读写
+    // history一直处于GENERAL，计算着色器写，采样器读
+    // history无效时内容可以丢弃，从UNDEFINED转换，新建的图像也在这里进入GENERAL
+    ImageMemoryBarrierInfo imageBarrierInfo{};
+    imageBarrierInfo.oldLayout = mHistoryValid ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    mDevice->AddCmdPipelineBarrier(cmdBuf, mHistoryImages[mHistoryIndex], VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    mDevice->AddCmdPipelineBarrier(cmdBuf, mHistoryImages[writeIndex], VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+
+    ResolveParams params{};
+    params.renderSize = glm::vec2(mRenderExtent.width, mRenderExtent.height);
+    params.outputSize = glm::vec2(mOutputExtent.width, mOutputExtent.height);
+    params.jitter = mJitterPixels;
+    params.historyValid = mHistoryValid ? 1.0f : 0.0f;
+    params.blendFactor = BLEND_FACTOR;
+
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineResolve.pipeline);
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE,
+        mPipelineResolve.layout,
+        0, 1, &mDescriptorSetsResolve[writeIndex],
+        0, nullptr);
+    dispatch.CmdPushConstants(cmdBuf, mPipelineResolve.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    dispatch.CmdDispatch(cmdBuf, (mOutputExtent.width + 7) / 8, (mOutputExtent.height + 7) / 8, 1);
+
+    imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    mDevice->AddCmdPipelineBarrier(cmdBuf, mHistoryImages[writeIndex], VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+
+    mHistoryIndex = writeIndex;
+    mHistoryValid = true;
+}
+
+void TemporalUpscaler::CmdDrawSharpen(VkCommandBuffer cmdBuf)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    GpuProfileScope sharpenScope(cmdBuf, "TemporalSharpen");
+
+    SharpenParams params{};
+    params.uvScale = glm::vec2(1.0f);
+    params.sharpness = SHARPNESS;
+
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineSharpen.pipeline);
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        mPipelineSharpen.layout,
+        0, 1, &mDescriptorSetsSharpen[mHistoryIndex],
+        0, nullptr);
+    dispatch.CmdPushConstants(cmdBuf, mPipelineSharpen.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0, sizeof(params), &params);
+    dispatch.CmdDraw(cmdBuf, 4, 1, 0, 0);
+}
+
+void TemporalUpscaler::CreatePipelines(VkRenderPass presentRenderPass,
+    const VkPipelineRenderingCreateInfoKHR* presentRenderingInfo)
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    // resolve
+    ShaderFileInfo resolveShaderFile{};
+    resolveShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("temporal_upscale.comp.spv");
+    resolveShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> resolveLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+
+    std::vector<VkPushConstantRange> resolvePushConstantRanges = {
+        { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ResolveParams) },
+    };
+
+    mPipelineResolve = pipelineFactory.CreateComputePipeline(resolveShaderFile, resolveLayoutBindings, resolvePushConstantRanges);
+
+    // sharpen
+    std::vector<ShaderFileInfo> sharpenShaderFilePaths = {
+        { GetConfig().directory.dirSpvFiles + std::string("ScreenQuad.vert.spv"), VK_SHADER_STAGE_VERTEX_BIT },
+        { GetConfig().directory.dirSpvFiles + std::string("temporal_sharpen.frag.spv"), VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> sharpenLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+
+    std::vector<VkPushConstantRange> sharpenPushConstantRanges = {
+        { VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SharpenParams) },
+    };
+
+    GraphicsPipelineConfigInfo sharpenConfigInfo{};
+    if (presentRenderingInfo != nullptr) {
+        sharpenConfigInfo.SetRenderingInfo(*presentRenderingInfo);
+    }
+    else {
+        sharpenConfigInfo.SetRenderPass(presentRenderPass);
+    }
+    sharpenConfigInfo.SetInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+
+    mPipelineSharpen = pipelineFactory.CreateGraphicsPipeline(sharpenConfigInfo, sharpenShaderFilePaths, sharpenLayoutBindings, sharpenPushConstantRanges);
+}
+
+void TemporalUpscaler::CleanUpPipelines()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    pipelineFactory.DestroyPipelineObjecst(mPipelineSharpen);
+    pipelineFactory.DestroyPipelineObjecst(mPipelineResolve);
+}
+
+void TemporalUpscaler::CreateSampler()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    // 重投影到屏幕边缘时不能绕回另一侧
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(mDevice->Get(), &samplerInfo, nullptr, &mLinearSampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texure sampler!");
+    }
+}
+
+void TemporalUpscaler::CleanUpSampler()
+{
+    vkDestroySampler(mDevice->Get(), mLinearSampler, nullptr);
+}
+
+void TemporalUpscaler::CreateDescriptorSets()
+{
+    std::vector<VkDescriptorPoolSize> poolSizes = {};   // 池中各种类型的Descriptor个数
+    for (uint32_t i = 0; i < mHistoryImages.size(); i++) {
+        poolSizes.insert(poolSizes.end(), mPipelineResolve.descriptorSizes.begin(), mPipelineResolve.descriptorSizes.end());
+        poolSizes.insert(poolSizes.end(), mPipelineSharpen.descriptorSizes.begin(), mPipelineSharpen.descriptorSizes.end());
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = mDescriptorSetsResolve.size() + mDescriptorSetsSharpen.size();
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = mDescriptorPool;
+    for (uint32_t i = 0; i < mHistoryImages.size(); i++) {
+        allocInfo.descriptorSetCount = mPipelineResolve.descriptorSetLayouts.size();
+        allocInfo.pSetLayouts = mPipelineResolve.descriptorSetLayouts.data();
+        if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetsResolve[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor sets!");
+        }
+
+        allocInfo.descriptorSetCount = mPipelineSharpen.descriptorSetLayouts.size();
+        allocInfo.pSetLayouts = mPipelineSharpen.descriptorSetLayouts.data();
+        if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetsSharpen[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor sets!");
+        }
+    }
+}
+
+void TemporalUpscaler::UpdateDescriptorSets()
+{
+    if (mColorImageView == VK_NULL_HANDLE || mHistoryImageViews[0] == VK_NULL_HANDLE) {
+        return;
+    }
+
+    VkDescriptorImageInfo colorInfo = { mLinearSampler, mColorImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkDescriptorImageInfo velocityInfo = { mLinearSampler, mVelocityImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    for (uint32_t i = 0; i < mHistoryImages.size(); i++) {
+        // 写入第i张，读取另一张
+        VkDescriptorImageInfo historyInfo = { mLinearSampler, mHistoryImageViews[1 - i], VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorImageInfo outputInfo = { VK_NULL_HANDLE, mHistoryImageViews[i], VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorImageInfo sharpenInputInfo = { mLinearSampler, mHistoryImageViews[i], VK_IMAGE_LAYOUT_GENERAL };
+
+        std::vector<VkWriteDescriptorSet> descriptorWrites = {
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsResolve[i],
+                0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &colorInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsResolve[i],
+                1, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &velocityInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsResolve[i],
+                2, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &historyInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsResolve[i],
+                3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &outputInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsSharpen[i],
+                0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &sharpenInputInfo),
+        };
+        vkUpdateDescriptorSets(mDevice->Get(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    }
+}
+
+float TemporalUpscaler::Halton(uint32_t index, uint32_t base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f / base;
+    while (index > 0) {
+        result += fraction * (index % base);
+        index /= base;
+        fraction /= base;
+    }
+    return result;
+}
+}   // namespace framework
@@ -13,4 +13,21 @@ glslc %SHADER_SRC_DIR%\ScreenQuad.vert -o .\Spirv\ScreenQuad.vert.spv
 glslc %SHADER_SRC_DIR%\pbr_width_texture.frag -o .\Spirv\pbr_width_texture.frag.spv
 glslc %SHADER_SRC_DIR%\pbr_width_texture.vert -o .\Spirv\pbr_width_texture.vert.spv
 
+glslc %SHADER_SRC_DIR%\temporal_upscale.comp -o .\Spirv\temporal_upscale.comp.spv
+glslc %SHADER_SRC_DIR%\temporal_sharpen.frag -o .\Spirv\temporal_sharpen.frag.spv
+
+glslc %SHADER_SRC_DIR%\cluster_light_cull.comp -o .\Spirv\cluster_light_cull.comp.spv
+glslc %SHADER_SRC_DIR%\DrawMeshGlossyClustered.frag -o .\Spirv\DrawMeshGlossyClustered.frag.spv
+glslc %SHADER_SRC_DIR%\pbr_width_texture_clustered.frag -o .\Spirv\pbr_width_texture_clustered.frag.spv
+
+glslc %SHADER_SRC_DIR%\ibl_equirect_to_cube.comp -o .\Spirv\ibl_equirect_to_cube.comp.spv
+glslc %SHADER_SRC_DIR%\ibl_sh_project.comp -o .\Spirv\ibl_sh_project.comp.spv
+glslc %SHADER_SRC_DIR%\ibl_prefilter.comp -o .\Spirv\ibl_prefilter.comp.spv
+glslc %SHADER_SRC_DIR%\ibl_brdf_lut.comp -o .\Spirv\ibl_brdf_lut.comp.spv
+
+glslc %SHADER_SRC_DIR%\DrawMeshGBuffer.frag -o .\Spirv\DrawMeshGBuffer.frag.spv
+glslc %SHADER_SRC_DIR%\pbr_width_texture_gbuffer.frag -o .\Spirv\pbr_width_texture_gbuffer.frag.spv
+glslc %SHADER_SRC_DIR%\deferred_lighting.vert -o .\Spirv\deferred_lighting.vert.spv
+glslc %SHADER_SRC_DIR%\deferred_lighting.frag -o .\Spirv\deferred_lighting.frag.spv
+
 pause
\ No newline at end of file
@@ -18,6 +18,7 @@ public:
     void CleanUp() override;
     std::vector<VkCommandBuffer>& RecordCommand(const RenderInputInfo& input) override;
     void ProcessInputEvent(const InputEventInfo& inputEventInfo) override;
+    Camera* GetCamera() override { return mCamera; }
 
 private:
     void CreateRenderPasses();
@@ -44,7 +44,9 @@ static void FillConfig()
         VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT
     };
     g_SceneDemoConfig.swapchain.imageCount = 2;
-    g_SceneDemoConfig.swapchain.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+    // frame pacing
+    g_SceneDemoConfig.pacing.mode = framework::FramePacingMode::VSYNC;
 
     // present fb
     g_SceneDemoConfig.presentFb.depthFormatCandidates = { VK_FORMAT_D24_UNORM_S8_UINT };
@@ -6,6 +6,7 @@
 #include "Utils.h"
 #include "SceneDemoDefs.h"
 #include "BufferCreator.h"
+#include "AppDispatchTable.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_STATIC
@@ -42,26 +43,18 @@ void DrawTextureMsaa::CleanUp()
 
 std::vector<VkCommandBuffer>& DrawTextureMsaa::RecordCommand(const RenderInputInfo& input)
 {
-    vkResetCommandBuffer(mCommandBuffer, 0);
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    dispatch.ResetCommandBuffer(mCommandBuffer, 0);
 
     VkCommandBufferBeginInfo beginInfo = vulkanInitializers::CommandBufferBeginInfo(nullptr);
-    if (vkBeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (dispatch.BeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("fiaile to begin recording command buffer!");
     }
 
     // 启动Pass
-    static std::array<VkClearValue, 2> clearValues = {
-        consts::CLEAR_COLOR_WHITE_FLT,
-        consts::CLEAR_DEPTH_ONE_STENCIL_ZERO,
-    };
-    VkRenderPassBeginInfo renderPassInfo = vulkanInitializers::RenderPassBeginInfo(input.presentRenderPass, input.swapchanFb);
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = input.swapchainExtent;
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-    vkCmdBeginRenderPass(mCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    CmdBeginPresentPass(mCommandBuffer, input, consts::CLEAR_COLOR_WHITE_FLT);
 
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.pipeline);
+    dispatch.CmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline.pipeline);
 
     VkViewport viewport = {
         .x = 0.0f, .y = 0.0f,
@@ -69,30 +62,30 @@ std::vector<VkCommandBuffer>& DrawTextureMsaa::RecordCommand(const RenderInputIn
         .height = static_cast<float>(input.swapchainExtent.height),
         .minDepth = 0.0, .maxDepth = 1.0f,
     };
-    vkCmdSetViewport(mCommandBuffer, 0, 1, &viewport);
+    dispatch.CmdSetViewport(mCommandBuffer, 0, 1, &viewport);
     VkRect2D scissor = { .offset = { 0, 0 }, .extent = input.swapchainExtent };
-    vkCmdSetScissor(mCommandBuffer, 0, 1, &scissor);
+    dispatch.CmdSetScissor(mCommandBuffer, 0, 1, &scissor);
 
     // 绑定顶点缓冲
-    std::vector<VkBuffer> vertexBuffers = { mVertexBuffer };
-    std::vector<VkDeviceSize> offsets = { 0 };
-    vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffers.data(), offsets.data());
+    std::array<VkBuffer, 1> vertexBuffers = { mVertexBuffer };
+    std::array<VkDeviceSize, 1> offsets = { 0 };
+    dispatch.CmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffers.data(), offsets.data());
 
     // 绑定索引缓冲
-    vkCmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    dispatch.CmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
     // 绑定DescriptorSet
-    vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    dispatch.CmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
         mPipeline.layout,
         0, 1, &mDescriptorSet,
         0, nullptr);
 
     //画图
-    vkCmdDrawIndexed(mCommandBuffer, mQuadIndices.size(), 1, 0, 0, 0);
+    dispatch.CmdDrawIndexed(mCommandBuffer, mQuadIndices.size(), 1, 0, 0, 0);
 
-    vkCmdEndRenderPass(mCommandBuffer);
+    CmdEndPresentPass(mCommandBuffer, input);
 
-    if (vkEndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
+    if (dispatch.EndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer!");
     }
 
@@ -126,7 +119,7 @@ void DrawTextureMsaa::CreatePipelines()
 
     // pipeline
     GraphicsPipelineConfigInfo configInfo{};
-    configInfo.SetRenderPass(mPresentRenderPass);
+    SetPresentPassTarget(configInfo);
     configInfo.SetVertexInputBindings({ Vertex2DColorTexture::GetBindingDescription() });
     configInfo.SetVertexInputAttributes(Vertex2DColorTexture::getAttributeDescriptions());
     configInfo.mMultisampleState.rasterizationSamples = GetConfig().presentFb.msaaSampleCount;
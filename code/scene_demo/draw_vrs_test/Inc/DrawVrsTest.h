@@ -8,8 +8,10 @@
 #include "TestMesh.h"
 #include "Camera.h"
 #include "VmaUsage.h"
+#include "DynamicResolution.h"
 
 #include "VrsPipeline.h"
+#include "VrsEvaluator.h"
 
 namespace framework {
 class DrawVrsTest : public SceneRenderBase {
@@ -20,9 +22,11 @@ public:
     void Init(const RenderInitInfo& initInfo) override;
     void CleanUp() override;
     std::vector<VkCommandBuffer>& RecordCommand(const RenderInputInfo& input) override;
+    bool GetAsyncCompute(AsyncComputeInfo& asyncCompute) override;
     void OnResize(VkExtent2D newExtent) override;
     void ProcessInputEvent(const InputEventInfo& inputEventInfo) override;
     void RequestPhysicalDeviceFeatures(PhysicalDevice* physicalDevice) override;
+    Camera* GetCamera() override { return mCamera; }
 
 private:
     void CreateRenderPasses();
@@ -61,7 +65,11 @@ private:
     void UpdateDescriptorSets();
 
     // tool functions
+    // fullRate时忽略shading rate附件，用于渲染评估VRS的参考画面
+    void RecordMainPass(VkCommandBuffer cmdBuf, VkFramebuffer framebuffer, VkExtent2D renderExtent, bool fullRate);
     void RecordPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input);
+    // 异步计算时呈现pass和VRS分析同时读取颜色和shading rate，不做layout转换
+    VkImageLayout GetPresentSampleLayout();
 
 private:
     std::vector<VkCommandBuffer> mPrimaryCommandBuffers = {};
@@ -73,6 +81,9 @@ private:
     PipelineObjecs mPipelineBlendVrsImage = {};
 
     VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+    // 异步计算时主pass之后的命令单独提交，VRS分析录制到计算队列的命令缓冲
+    VkCommandBuffer mPresentCommandBuffer = VK_NULL_HANDLE;
+    VkCommandBuffer mComputeCommandBuffer = VK_NULL_HANDLE;
 
     // vertex buffer
     VkBuffer mVertexBuffer = VK_NULL_HANDLE;
@@ -121,17 +132,21 @@ private:
     VkImageView mMainFbColorImageView = VK_NULL_HANDLE;
     VkImage mMainFbDepthImage = VK_NULL_HANDLE;
     VkImageView mMainFbDepthImageView = VK_NULL_HANDLE;
+    VkImageView mMainFbDepthSampleView = VK_NULL_HANDLE;     // 只含深度，VRS重投影时采样
     VkDeviceMemory mMainFbMemory = VK_NULL_HANDLE;
     VkFramebuffer mMainFrameBuffer = VK_NULL_HANDLE;
     VkRenderPass mMainPass = VK_NULL_HANDLE;
 
-    const float mResolutionFactor = 0.8;
-    VkExtent2D mMainFbExtent = {};
+    DynamicResolution mDynamicResolution = {};
+    VkExtent2D mMainFbExtent = {};      // 分配的大小，实际渲染区域由mDynamicResolution决定
     const VkFormat mMainFbColorFormat = VK_FORMAT_B10G11R11_UFLOAT_PACK32;  //VK_FORMAT_R8G8B8A8_UNORM;
     const VkFormat mMainFbDepthFormat = VK_FORMAT_D24_UNORM_S8_UINT;
 
     VrsPipeline* mVrsPipeline = nullptr;
+    VrsEvaluator* mVrsEvaluator = nullptr;
     bool mBlendKeyPress = false;
+    glm::mat4 mPrevViewProj = glm::mat4(1.0f);
+    bool mPrevViewProjValid = false;
 
     // data
     struct UboMvpMatrix {
@@ -157,6 +172,11 @@ private:
     struct InstanceMatrixM {
         glm::mat4 model;
     };
+
+    struct PresentPushConstants {
+        glm::vec2 uvScale;
+        glm::vec2 uvClamp;
+    };
     size_t mInstanceMatrixMAlignment = 0;
     static constexpr uint32_t INSTANCE_NUM = 5;
     uint32_t mInstanceMatrixMOffsets[INSTANCE_NUM] = {};
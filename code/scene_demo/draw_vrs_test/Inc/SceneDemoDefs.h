@@ -16,6 +16,7 @@ static void FillConfig()
 
     // physical device
     g_SceneDemoConfig.phisicalDevice = {};
+    g_SceneDemoConfig.phisicalDevice.enableAsyncCompute = true;
     
     // layers
     g_SceneDemoConfig.layer.instanceLayers = {};
@@ -38,13 +39,33 @@ static void FillConfig()
         VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
     };
 
+    // device features
+    g_SceneDemoConfig.deviceFeatures.pipelineStatisticsQuery = VK_TRUE;     // GPU profiler统计各pass的调用次数
+
     // swapchain
     g_SceneDemoConfig.swapchain.surfaceFormat = {
         VK_FORMAT_B8G8R8A8_SRGB,
         VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT
     };
     g_SceneDemoConfig.swapchain.imageCount = 2;
-    g_SceneDemoConfig.swapchain.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+    // frame pacing
+    g_SceneDemoConfig.pacing.mode = framework::FramePacingMode::VSYNC;
+
+    // dynamic resolution
+    g_SceneDemoConfig.dynamicResolution.enable = true;
+    g_SceneDemoConfig.dynamicResolution.targetGpuTimeMs = 12.0f;
+    g_SceneDemoConfig.dynamicResolution.minScale = 0.5f;
+    g_SceneDemoConfig.dynamicResolution.maxScale = 1.0f;
+    g_SceneDemoConfig.dynamicResolution.initialScale = 0.8f;
+
+    // vrs
+    g_SceneDemoConfig.vrs.reprojection = true;
+    g_SceneDemoConfig.vrs.analysisInterval = 2;
+    g_SceneDemoConfig.vrs.asyncCompute = true;
+    g_SceneDemoConfig.vrs.tileSize = 16;
+    g_SceneDemoConfig.vrs.perceptual = true;
+    g_SceneDemoConfig.vrs.evaluationInterval = 0;      // 评估时改为非0，用跑分程序按相机路径运行
     
     // present fb
     g_SceneDemoConfig.presentFb.depthFormatCandidates = { VK_FORMAT_D24_UNORM_S8_UINT };
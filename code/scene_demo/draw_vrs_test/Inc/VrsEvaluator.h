@@ -0,0 +1,95 @@
+#ifndef __VRS_EVALUATOR_H__
+#define __VRS_EVALUATOR_H__
+
+#include "FrameworkHeaders.h"
+#include "VmaUsage.h"
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace framework {
+
+/*
+ * @brief 离线评估VRS的效果：按间隔用同一个主pass额外渲染一帧全速率的参考画面，
+ *        和使用VRS的画面逐像素比较，统计着色次数的减少和误差，退出时写出报告。
+ *        配合跑分程序的相机路径使用，每次运行的画面一致，可以比较不同参数的结果。
+ */
+class VrsEvaluator {
+public:
+    VrsEvaluator() {}
+    ~VrsEvaluator() {}
+
+    // vrs.evaluationInterval为0时不创建任何资源
+    void Init(Device* device);
+    void CleanUp();
+    bool IsEnabled() { return mEnabled; }
+
+    // 参考画面和主framebuffer共用深度和shading rate附件，随主framebuffer重建
+    void CreateResources(VkRenderPass mainPass, VkImageView mainFbColorImageView, VkImageView mainFbDepthImageView,
+        VkImageView shadingRateImageView, VkFormat colorFormat, uint32_t width, uint32_t height, uint32_t tileSize);
+    void CleanUpResources();
+
+    /*
+     * @brief 每帧录制之前调用，读取上一次评估的结果
+     * @return 本帧是否需要渲染参考画面
+     */
+    bool BeginFrame();
+    VkFramebuffer GetReferenceFramebuffer() { return mReferenceFramebuffer; }
+
+    // 参考画面渲染完成、CmdPrepareAnalysis之后调用，此时颜色和shading rate都是GENERAL
+    void CmdEvaluate(VkCommandBuffer commandBuffer, VkExtent2D renderExtent, bool perceptual);
+
+private:
+    void CreatePipeline();
+    void CreateDescriptorSet();
+    void CollectResult();
+    void WriteReport();
+
+private:
+    struct EvaluateParams {
+        glm::ivec2 renderSize;
+        uint32_t tileSize;
+        uint32_t groupCountX;
+    };
+
+    struct EvaluationResult {
+        uint32_t frameIndex = 0;
+        bool perceptual = false;
+        float shadedReduction = 0.0f;   // 相对全速率少着色的比例
+        float psnr = 0.0f;
+        float mse = 0.0f;
+        float maxLumaError = 0.0f;
+    };
+
+    static constexpr uint32_t GROUP_SIZE = 8;
+    static constexpr uint32_t LOG_INTERVAL = 10;       // 每评估多少帧输出一次平均值
+    static constexpr float MAX_PSNR = 99.0f;           // 和参考画面完全一致时记为这个值
+
+    Device* mDevice = nullptr;
+    bool mEnabled = false;
+    uint32_t mInterval = 0;
+    uint32_t mFrameIndex = 0;
+    uint32_t mTileSize = 16;
+
+    PipelineObjecs mPipelineEvaluate = {};
+    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
+
+    VmaAllocation mReferenceImageAllocation = VK_NULL_HANDLE;
+    VkImage mReferenceImage = VK_NULL_HANDLE;
+    VkImageView mReferenceImageView = VK_NULL_HANDLE;
+    VkFramebuffer mReferenceFramebuffer = VK_NULL_HANDLE;
+
+    // 每个工作组一个vec4：平方误差和、着色次数、像素数、最大亮度误差，CPU上求和
+    VkBuffer mResultBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mResultBufferMemory = VK_NULL_HANDLE;
+    glm::vec4* mResultMapped = nullptr;
+    uint32_t mPendingGroupCount = 0;
+    EvaluationResult mPendingResult = {};
+
+    std::vector<EvaluationResult> mResults = {};
+};
+
+}
+
+#endif // !__VRS_EVALUATOR_H__
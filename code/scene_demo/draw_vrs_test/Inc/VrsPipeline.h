@@ -5,6 +5,9 @@
 #include "VmaUsage.h"
 #include "DescriptorSetManager.h"
 #include <memory>
+#include <array>
+#include <algorithm>
+#include <glm/glm.hpp>
 
 namespace framework {
 
@@ -16,11 +19,38 @@ public:
     void Init(Device* device);
     void CleanUp();
 
-    void CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbColorImageView, uint32_t mainFbWidth, uint32_t mainFbHeight);
+    // 深度用于重投影和内容分析，分析之后保持只读layout，下一帧重投影读取的是上一帧主pass写入的结果
+    void CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbColorImageView,
+        VkImage mainFbDepthImage, VkImageView mainFbDepthSampleView, uint32_t mainFbWidth, uint32_t mainFbHeight);
     void CleanUpVrsImage();
 
+    /*
+     * @brief 主pass之前调用，把上一帧的shading rate按深度重投影到本帧
+     * @param reprojection 上一帧的VP矩阵的逆乘以本帧的VP矩阵，都不带抖动
+     */
+    void CmdReprojectShadingRate(VkCommandBuffer commandBuffer, VkExtent2D renderExtent, const glm::mat4& reprojection);
     void CmdPrepareShadingRate(VkCommandBuffer commandBuffer);
-    void CmdAnalysisContent(VkCommandBuffer commandBUffer);
+    // 主pass之后在图形队列上调用，把颜色、深度和shading rate转到分析使用的layout
+    void CmdPrepareAnalysis(VkCommandBuffer commandBuffer);
+    /*
+     * @brief 异步计算时录制到计算队列的命令缓冲中，否则紧接着CmdPrepareAnalysis录制
+     * @param renderExtent 主framebuffer中实际渲染的区域，只分析这一部分；按analysisInterval跳过的帧不做分析
+     */
+    void CmdAnalysisContent(VkCommandBuffer commandBUffer, VkExtent2D renderExtent);
+
+    void SetReprojectionEnabled(bool enable) { mReprojectionEnabled = enable; }
+    bool IsReprojectionEnabled() { return mReprojectionEnabled; }
+    void SetAnalysisInterval(uint32_t interval) { mAnalysisInterval = std::max(interval, 1u); }
+    uint32_t GetAnalysisInterval() { return mAnalysisInterval; }
+    // 关闭时只按亮度梯度选择速率，不考虑运动、深度和亮度掩蔽
+    void SetPerceptualEnabled(bool enable) { mPerceptualEnabled = enable; }
+    bool IsPerceptualEnabled() { return mPerceptualEnabled; }
+    // 本帧不带抖动的投影矩阵，分析时把深度还原为距离
+    void SetProjection(const glm::mat4& projection) { mDepthUnproject = glm::vec2(projection[2][2], projection[3][2]); }
+    // 配置打开并且设备有独立的计算队列
+    bool IsAsyncCompute() { return mAsyncCompute; }
+    // shading rate附件的texel大小，创建主pass时使用
+    uint32_t GetTileSize() { return mTileSize; }
 
     PipelineObjecs& GetPipeline() {
         return mPipelineDrawVrsRegion;
@@ -47,6 +77,8 @@ public:
     }
 
 private:
+    void SelectTileSize();
+    static uint32_t GetAnalysisGroupCells(uint32_t tileSize);
     void CreatePipeline();
     void CleanUpPipeline();
 
@@ -57,19 +89,61 @@ private:
     void CreateSampler();
     void CleanUpSampler();
 
+    void CreateStatisticsBuffer();
+    void CleanUpStatisticsBuffer();
+    void ReportStatistics();
+
 private:
+    struct ReprojectParams {
+        glm::mat4 reprojection;
+        glm::vec2 prevRenderSize;
+        glm::vec2 currRenderSize;
+        uint32_t tileSize;
+        uint32_t historyValid;
+        uint32_t depthValid;
+    };
+
+    // 和draw_vrs_region.comp中的push constant一致，平滑只使用renderSize
+    struct AnalysisParams {
+        glm::ivec2 renderSize;
+        glm::vec2 depthUnproject;
+        float sensitivity;
+        float quarterCoef;
+        float motionScale;
+        float depthEdgeThreshold;
+        float maskingStrength;
+        float adaptationLuma;
+        alignas(16) glm::mat4 currToPrev;
+    };
+
+    struct ReuseStatistics {
+        uint32_t tileCount;
+        uint32_t changedCount;
+        uint32_t coarserCount;
+    };
+
+    static constexpr uint32_t ANALYSIS_CELL_SIZE = 8;       // 分析的最小单元，tile大小是它的1、2、4倍
+    static constexpr uint32_t MAX_TILE_SIZE = 32;
+    static constexpr uint32_t STATISTICS_REPORT_INTERVAL = 120;    // 每分析多少帧输出一次统计
+
     Device* mDevice = nullptr;
     VkImage mMainFbColorImage = VK_NULL_HANDLE;
     VkImageView mMainFbColorImageView = VK_NULL_HANDLE;
     uint32_t mMainFbWidth = 0;
     uint32_t mMainFbHeight = 0;
+    uint32_t mTileSize = 16;
+    VkImage mMainFbDepthImage = VK_NULL_HANDLE;
+    VkImageView mMainFbDepthSampleView = VK_NULL_HANDLE;
 
     PipelineObjecs mPipelineDrawVrsRegion = {};
     PipelineObjecs mPipelineSmoothVrs = {};
+    PipelineObjecs mPipelineReprojectVrs = {};
 
     VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
     VkDescriptorSet mDescriptorSetVrsComp = VK_NULL_HANDLE;
-    VkDescriptorSet mDescriptorSetSmoothVrs = VK_NULL_HANDLE;
+    // 两张history交替读写，按写入的下标区分
+    std::array<VkDescriptorSet, 2> mDescriptorSetsSmoothVrs = {};
+    std::array<VkDescriptorSet, 2> mDescriptorSetsReprojectVrs = {};
 
     // vrs image
     VmaAllocation mVrsImageAllocation = VK_NULL_HANDLE;
@@ -80,8 +154,36 @@ private:
     VkImage mSmoothVrsImage = VK_NULL_HANDLE;
     VkImageView mSmoothVrsImageView = VK_NULL_HANDLE;
 
+    // 每帧最终的shading rate，下一帧重投影的输入
+    std::array<VmaAllocation, 2> mHistoryVrsImageAllocations = {};
+    std::array<VkImage, 2> mHistoryVrsImages = {};
+    std::array<VkImageView, 2> mHistoryVrsImageViews = {};
+    uint32_t mHistoryIndex = 0;         // 本帧重投影读取的history
+    bool mHistoryValid = false;
+    bool mDepthValid = false;           // 重建后第一帧深度还没有内容
+    VkExtent2D mPrevRenderExtent = {};
+
+    bool mReprojectionEnabled = true;
+    uint32_t mAnalysisInterval = 1;
+    bool mPerceptualEnabled = true;
+    glm::vec2 mDepthUnproject = glm::vec2(-1.0f, -0.2f);
+    glm::mat4 mCurrToPrev = glm::mat4(1.0f);
+    uint32_t mFrameIndex = 0;
+    bool mAsyncCompute = false;
+
+    // 复用的质量统计
+    VkBuffer mStatisticsBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory mStatisticsBufferMemory = VK_NULL_HANDLE;
+    ReuseStatistics* mStatisticsMapped = nullptr;
+    bool mStatisticsPending = false;
+    uint32_t mAnalysisCount = 0;
+    ReuseStatistics mStatisticsSum = {};
+
+    // 分析结果按单元存储，平滑之后的结果和history按tile存储
     uint32_t mVrsImageWidth = 0;
     uint32_t mVrsImageHeight = 0;
+    uint32_t mTileImageWidth = 0;
+    uint32_t mTileImageHeight = 0;
 
     VkSampler mNearestSampler = VK_NULL_HANDLE;
 
@@ -14,7 +14,9 @@
 
 #include "SceneDemoDefs.h"
 #include "BufferCreator.h"
+#include "DeletionQueue.h"
 #include "AppDispatchTable.h"
+#include "GpuProfiler.h"
 #include "Log.h"
 #undef LOG_TAG
 #define LOG_TAG "DrawVrsTest"
@@ -25,10 +27,12 @@ DrawVrsTest::DrawVrsTest()
     mMesh = new TestMesh;
     mCamera = new Camera;
     mVrsPipeline = new VrsPipeline;
+    mVrsEvaluator = new VrsEvaluator;
 }
 
 DrawVrsTest::~DrawVrsTest()
 {
+    delete mVrsEvaluator;
     delete mVrsPipeline;
     delete mCamera;
     delete mMesh;
@@ -40,9 +44,8 @@ void DrawVrsTest::Init(const RenderInitInfo& initInfo)
         return;
     }
 
-    mMainFbExtent = initInfo.swapchainExtent;
-    mMainFbExtent.width *= mResolutionFactor;
-    mMainFbExtent.height *= mResolutionFactor;
+    mDynamicResolution.Init(GetConfig().dynamicResolution);
+    mMainFbExtent = mDynamicResolution.Resize(initInfo.swapchainExtent);
 
     mCamera->mTargetDistance = 20.0f;
     mCamera->mTargetPoint = glm::vec3(0.0, 0.0, 0.0);
@@ -53,12 +56,17 @@ void DrawVrsTest::Init(const RenderInitInfo& initInfo)
     mMesh->GenerateSphere(1.0f, glm::vec3(0.0), glm::uvec2(64, 64));
 
     mVrsPipeline->Init(mDevice);
+    mVrsEvaluator->Init(mDevice);
 
     CreateRenderPasses();
     CreateMainFbAttachment();
     CreateMainFramebuffer();
     CreatePipelines();
     mCommandBuffer = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    if (mVrsPipeline->IsAsyncCompute()) {
+        mPresentCommandBuffer = mDevice->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        mComputeCommandBuffer = mDevice->CreateComputeCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    }
     CreateVertexBuffer();
     CreateIndexBuffer();
     CreateUniformBuffer();
@@ -76,62 +84,161 @@ void DrawVrsTest::CleanUp()
     CleanUpUniformBuffer();
     CleanUpIndexBuffer();
     CleanUpVertexBuffer();
+    if (mComputeCommandBuffer != VK_NULL_HANDLE) {
+        mDevice->FreeComputeCommandBuffer(mComputeCommandBuffer);
+        mDevice->FreeCommandBuffer(mPresentCommandBuffer);
+    }
     mDevice->FreeCommandBuffer(mCommandBuffer);
     CleanUpPipelines();
     CleanUpMainFramebuffer();
     CleanUpMainFbAttachment();
     CleanUpRenderPasses();
 
+    mVrsEvaluator->CleanUp();
     mVrsPipeline->CleanUp();
 }
 
 std::vector<VkCommandBuffer>& DrawVrsTest::RecordCommand(const RenderInputInfo& input)
 {
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
     // 更新uniform buffer
     float aspectRatio = (float)input.swapchainExtent.width / (float)input.swapchainExtent.height;
     UpdataUniformBuffer(aspectRatio);
 
-    vkResetCommandBuffer(mCommandBuffer, 0);
+    // 按上一帧的GPU耗时调整渲染区域，只改viewport和scissor
+    mDynamicResolution.Update(input.frameTiming.gpuFrameTimeMs);
+    VkExtent2D renderExtent = mDynamicResolution.GetRenderExtent();
+    bool evaluateFrame = mVrsEvaluator->BeginFrame();
+
+    dispatch.ResetCommandBuffer(mCommandBuffer, 0);
     // 开始写入
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0;
     beginInfo.pInheritanceInfo = nullptr;
-    if (vkBeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
+    if (dispatch.BeginCommandBuffer(mCommandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("fiaile to begin recording command buffer!");
     }
 
+    // 上一帧的shading rate重投影到本帧的相机
+    glm::mat4 proj = mCamera->GetProjection();
+    proj[1][1] *= -1;
+    glm::mat4 currViewProj = proj * mCamera->GetView();
+    if (!mPrevViewProjValid) {
+        mPrevViewProj = currViewProj;
+        mPrevViewProjValid = true;
+    }
+    mVrsPipeline->CmdReprojectShadingRate(mCommandBuffer, renderExtent, currViewProj * glm::inverse(mPrevViewProj));
+    mVrsPipeline->SetProjection(proj);
+    mPrevViewProj = currViewProj;
+
     mVrsPipeline->CmdPrepareShadingRate(mCommandBuffer);
 
-    std::vector<VkClearValue> clearValuesMain = { { 0.1f, 0.1f, 0.1f, 1.0f }, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO };
-    VkRect2D renderArea = { {0, 0}, {mMainFbExtent.width, mMainFbExtent.height} };
+    {
+        GpuProfileScope mainPassScope(mCommandBuffer, "MainPass", true);
+        RecordMainPass(mCommandBuffer, mMainFrameBuffer, renderExtent, false);
+    }
+    // 评估VRS的帧再用全速率渲染一次参考画面，深度和主pass的结果相同
+    if (evaluateFrame) {
+        GpuProfileScope referencePassScope(mCommandBuffer, "VrsReferencePass");
+        RecordMainPass(mCommandBuffer, mVrsEvaluator->GetReferenceFramebuffer(), renderExtent, true);
+    }
+
+    mVrsPipeline->CmdPrepareAnalysis(mCommandBuffer);
+    if (evaluateFrame) {
+        mVrsEvaluator->CmdEvaluate(mCommandBuffer, renderExtent, mVrsPipeline->IsPerceptualEnabled());
+    }
+
+    // =============================================================================
+
+    // 异步计算时分析录制到计算队列，呈现pass单独提交，和分析并行
+    VkCommandBuffer presentCommandBuffer = mCommandBuffer;
+    if (mVrsPipeline->IsAsyncCompute()) {
+        if (dispatch.EndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+
+        dispatch.ResetCommandBuffer(mComputeCommandBuffer, 0);
+        if (dispatch.BeginCommandBuffer(mComputeCommandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("fiaile to begin recording compute command buffer!");
+        }
+        mVrsPipeline->CmdAnalysisContent(mComputeCommandBuffer, renderExtent);
+        if (dispatch.EndCommandBuffer(mComputeCommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record compute command buffer!");
+        }
+
+        dispatch.ResetCommandBuffer(mPresentCommandBuffer, 0);
+        if (dispatch.BeginCommandBuffer(mPresentCommandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("fiaile to begin recording command buffer!");
+        }
+        presentCommandBuffer = mPresentCommandBuffer;
+    }
+    else {
+        mVrsPipeline->CmdAnalysisContent(mCommandBuffer, renderExtent);
+
+        ImageMemoryBarrierInfo imageBarrierInfo{};
+        imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbColorImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    }
+
+    // =============================================================================
+
+    {
+        GpuProfileScope presentPassScope(presentCommandBuffer, "PresentPass", true);
+        RecordPresentPass(presentCommandBuffer, input);
+    }
+
+    // 写入完成
+    if (dispatch.EndCommandBuffer(presentCommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+
+    mPrimaryCommandBuffers.clear();
+    mPrimaryCommandBuffers.emplace_back(mCommandBuffer);
+    if (presentCommandBuffer != mCommandBuffer) {
+        mPrimaryCommandBuffers.emplace_back(presentCommandBuffer);
+    }
+    return mPrimaryCommandBuffers;
+}
+
+void DrawVrsTest::RecordMainPass(VkCommandBuffer cmdBuf, VkFramebuffer framebuffer, VkExtent2D renderExtent, bool fullRate)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    std::array<VkClearValue, 2> clearValuesMain = { VkClearValue{ 0.1f, 0.1f, 0.1f, 1.0f }, consts::CLEAR_DEPTH_ONE_STENCIL_ZERO };
+    VkRect2D renderArea = { {0, 0}, renderExtent };
     VkRenderPassBeginInfo renderPassInfoMain = vulkanInitializers::RenderPassBeginInfo(
-        mMainPass, mMainFrameBuffer, renderArea, clearValuesMain);
-    vkCmdBeginRenderPass(mCommandBuffer, &renderPassInfoMain, VK_SUBPASS_CONTENTS_INLINE);
+        mMainPass, framebuffer, renderArea, clearValuesMain);
+    dispatch.CmdBeginRenderPass(cmdBuf, &renderPassInfoMain, VK_SUBPASS_CONTENTS_INLINE);
 
     // 绑定Pipeline
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineDrawPbr.pipeline);
-    VkViewport viewportMain = { 0.0f, 0.0f, mMainFbExtent.width, mMainFbExtent.height, 0.0f, 1.0f };
-    vkCmdSetViewport(mCommandBuffer, 0, 1, &viewportMain);
-    vkCmdSetScissor(mCommandBuffer, 0, 1, &renderArea);
-
-    std::vector<VkExtent2D> shadingRates = { { 1, 1 }, {2, 2}, {4, 4}, {2, 4} };
-    std::vector<VkFragmentShadingRateCombinerOpKHR> combinerOps = {
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineDrawPbr.pipeline);
+    VkViewport viewportMain = { 0.0f, 0.0f, (float)renderExtent.width, (float)renderExtent.height, 0.0f, 1.0f };
+    dispatch.CmdSetViewport(cmdBuf, 0, 1, &viewportMain);
+    dispatch.CmdSetScissor(cmdBuf, 0, 1, &renderArea);
+
+    std::array<VkExtent2D, 4> shadingRates = { VkExtent2D{ 1, 1 }, {2, 2}, {4, 4}, {2, 4} };
+    // 参考画面忽略shading rate附件，全部使用管线的1x1
+    std::array<VkFragmentShadingRateCombinerOpKHR, 2> combinerOps = {
         VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR,
-        VK_FRAGMENT_SHADING_RATE_COMBINER_OP_MAX_KHR,
+        fullRate ? VK_FRAGMENT_SHADING_RATE_COMBINER_OP_KEEP_KHR : VK_FRAGMENT_SHADING_RATE_COMBINER_OP_MAX_KHR,
     };
-    AppDeviceDispatchTable::GetInstance().CmdSetFragmentShadingRateKHR(mCommandBuffer, &shadingRates[0], combinerOps.data());
+    dispatch.CmdSetFragmentShadingRateKHR(cmdBuf, &shadingRates[0], combinerOps.data());
 
     // 绑定顶点缓冲
-    std::vector<VkBuffer> vertexBuffersMain = { mVertexBuffer };
-    std::vector<VkDeviceSize> offsetsMain = { 0 };
-    vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, vertexBuffersMain.data(), offsetsMain.data());
+    std::array<VkBuffer, 1> vertexBuffersMain = { mVertexBuffer };
+    std::array<VkDeviceSize, 1> offsetsMain = { 0 };
+    dispatch.CmdBindVertexBuffers(cmdBuf, 0, 1, vertexBuffersMain.data(), offsetsMain.data());
 
     // 绑定索引缓冲
-    vkCmdBindIndexBuffer(mCommandBuffer, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+    dispatch.CmdBindIndexBuffer(cmdBuf, mIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
     // 绑定DescriptorSet
-    vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
         mPipelineDrawPbr.layout,
         0, 1, &mDescriptorSetPbr,
         0, nullptr);
@@ -147,51 +254,38 @@ std::vector<VkCommandBuffer>& DrawVrsTest::RecordCommand(const RenderInputInfo&
             uboMaterial.roughness = 0.2f + static_cast<float>(z) / zSegMent;
             uboMaterial.metallic = 0.2f + static_cast<float>(y) / ySegMent;
             uboMaterial.modelOffset = glm::vec3(0.0, SphereDistance * y - 5.0f, SphereDistance * z - 5.0f);
-            vkCmdPushConstants(mCommandBuffer, mPipelineDrawPbr.layout, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformMaterial), &uboMaterial);
-            vkCmdDrawIndexed(mCommandBuffer, mMesh->GetIndexData().size(), 1, 0, 0, 0);
+            dispatch.CmdPushConstants(cmdBuf, mPipelineDrawPbr.layout, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformMaterial), &uboMaterial);
+            dispatch.CmdDrawIndexed(cmdBuf, mMesh->GetIndexData().size(), 1, 0, 0, 0);
         }
     }
 
     // pbr with texture
-    vkCmdBindPipeline(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePbrTexture.pipeline);
-    AppDeviceDispatchTable::GetInstance().CmdSetFragmentShadingRateKHR(mCommandBuffer, &shadingRates[0], combinerOps.data());
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePbrTexture.pipeline);
+    dispatch.CmdSetFragmentShadingRateKHR(cmdBuf, &shadingRates[0], combinerOps.data());
 
 
     for (int i = 0; i < INSTANCE_NUM; i++) {
-        vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
             mPipelinePbrTexture.layout,
             0, 1, &mDescriptorSetPbrTexture,
             1, &mInstanceMatrixMOffsets[i]);
-        vkCmdDrawIndexed(mCommandBuffer, mMesh->GetIndexData().size(), 1, 0, 0, 0);
+        dispatch.CmdDrawIndexed(cmdBuf, mMesh->GetIndexData().size(), 1, 0, 0, 0);
     }
 
-    vkCmdEndRenderPass(mCommandBuffer);
-
-    mVrsPipeline->CmdAnalysisContent(mCommandBuffer);
-
-    // =============================================================================
-
-    ImageMemoryBarrierInfo imageBarrierInfo{};
-    imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-    imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-    imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    mDevice->AddCmdPipelineBarrier(mCommandBuffer, mMainFbColorImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
-
-    // =============================================================================
-
-    RecordPresentPass(mCommandBuffer, input);
+    dispatch.CmdEndRenderPass(cmdBuf);
+}
 
-    // 写入完成
-    if (vkEndCommandBuffer(mCommandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+bool DrawVrsTest::GetAsyncCompute(AsyncComputeInfo& asyncCompute)
+{
+    if (!mVrsPipeline->IsAsyncCompute()) {
+        return false;
     }
-
-    mPrimaryCommandBuffers.clear();
-    mPrimaryCommandBuffers.emplace_back(mCommandBuffer);
-    return mPrimaryCommandBuffers;
+    // 分析只依赖主pass，下一帧的重投影读写history，主pass覆盖颜色和深度
+    asyncCompute.commandBuffer = mComputeCommandBuffer;
+    asyncCompute.dependencyCount = 1;
+    asyncCompute.nextFrameWaitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    return true;
 }
 
 void DrawVrsTest::OnResize(VkExtent2D newExtent)
@@ -199,9 +293,7 @@ void DrawVrsTest::OnResize(VkExtent2D newExtent)
     if (newExtent.width == 0 || newExtent.height == 0) {
         return;
     }
-    mMainFbExtent = newExtent;
-    mMainFbExtent.width *= mResolutionFactor;
-    mMainFbExtent.height *= mResolutionFactor;
+    mMainFbExtent = mDynamicResolution.Resize(newExtent);
 
     CleanUpMainFramebuffer();
     CleanUpMainFbAttachment();
@@ -222,20 +314,40 @@ void DrawVrsTest::ProcessInputEvent(const InputEventInfo& inputEventInfo)
     mLastLeftPress = inputEventInfo.leftPressFlag;
     mLastCursorPose = curCursorPose;
 
-    // blend vrs image
-    if (inputEventInfo.keyAction == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_P == inputEventInfo.key) {
-        mBlendKeyPress = true;
-    }
+    // key input，依次处理本帧的所有按键事件
+    for (const InputEvent& event : inputEventInfo.events) {
+        if (event.type != InputEventType::KEY) {
+            continue;
+        }
 
-    if (inputEventInfo.keyAction == FRAMEWORK_KEY_RELEASE && FRAMEWORK_KEY_P == inputEventInfo.key) {
-        mBlendKeyPress = false;
-    }
+        // blend vrs image
+        if (event.action == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_P == event.code) {
+            mBlendKeyPress = true;
+        }
+        if (event.action == FRAMEWORK_KEY_RELEASE && FRAMEWORK_KEY_P == event.code) {
+            mBlendKeyPress = false;
+        }
 
+        // R开关重投影，I在1/2/4/8帧之间切换分析间隔
+        if (event.action == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_R == event.code) {
+            mVrsPipeline->SetReprojectionEnabled(!mVrsPipeline->IsReprojectionEnabled());
+            LOGI("vrs reprojection %s", mVrsPipeline->IsReprojectionEnabled() ? "on" : "off");
+        }
+        if (event.action == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_I == event.code) {
+            uint32_t interval = mVrsPipeline->GetAnalysisInterval();
+            mVrsPipeline->SetAnalysisInterval(interval >= 8 ? 1 : interval * 2);
+            LOGI("vrs analysis interval %d", mVrsPipeline->GetAnalysisInterval());
+        }
+        // M在感知模型和只按亮度梯度选择速率之间切换
+        if (event.action == FRAMEWORK_KEY_PRESS && FRAMEWORK_KEY_M == event.code) {
+            mVrsPipeline->SetPerceptualEnabled(!mVrsPipeline->IsPerceptualEnabled());
+            LOGI("vrs perceptual rate %s", mVrsPipeline->IsPerceptualEnabled() ? "on" : "off");
+        }
 
-    // key input
-    if (inputEventInfo.keyAction == FRAMEWORK_KEY_PRESS || inputEventInfo.keyAction == FRAMEWORK_KEY_RELEASE) {
-        if (mKeyPressStatus.find(inputEventInfo.key) != mKeyPressStatus.end()) {
-            mKeyPressStatus[inputEventInfo.key] = static_cast<uint16_t>(inputEventInfo.keyAction);
+        if (event.action == FRAMEWORK_KEY_PRESS || event.action == FRAMEWORK_KEY_RELEASE) {
+            if (mKeyPressStatus.find(event.code) != mKeyPressStatus.end()) {
+                mKeyPressStatus[event.code] = static_cast<uint16_t>(event.action);
+            }
         }
     }
     bool directionKeyPress = false;
@@ -328,7 +440,7 @@ void DrawVrsTest::CreateRenderPasses()
     VkAttachmentReference2 shadingRateAttachment =
         vulkanInitializers::AttachmentReference2(2, VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR);
     VkFragmentShadingRateAttachmentInfoKHR shadingRateAttachmentInfo =
-        vulkanInitializers::FragmentShadingRateAttachmentInfoKHR(&shadingRateAttachment, { 16, 16 });
+        vulkanInitializers::FragmentShadingRateAttachmentInfoKHR(&shadingRateAttachment, { mVrsPipeline->GetTileSize(), mVrsPipeline->GetTileSize() });
 
     std::vector<VkSubpassDescription2> subpasses = {
         vulkanInitializers::SubpassDescription2(VK_PIPELINE_BIND_POINT_GRAPHICS, &colorAttachmentRef, &depthAttachmentRef),
@@ -336,8 +448,10 @@ void DrawVrsTest::CreateRenderPasses()
     subpasses[0].pNext = &shadingRateAttachmentInfo;
 
     std::vector<VkSubpassDependency2> dependencys = { vulkanInitializers::SubpassDependency2(VK_SUBPASS_EXTERNAL, 0) };
-    dependencys[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependencys[0].srcAccessMask = 0;
+    // 深度在上一次使用后被计算着色器读取，评估VRS时参考画面紧接着主pass写入
+    dependencys[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    dependencys[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     dependencys[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     dependencys[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
@@ -350,8 +464,9 @@ void DrawVrsTest::CreateRenderPasses()
         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
     // 深度附件
     mAttachments2[1] = vulkanInitializers::AttachmentDescription2(mMainFbDepthFormat);
+    // 内容分析和下一帧重投影shading rate时需要读取
     vulkanInitializers::AttachmentDescription2SetOp(mAttachments2[1],
-        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+        VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE);
     vulkanInitializers::AttachmentDescription2SetLayout(mAttachments2[1],
         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
     // shading rate附件
@@ -380,6 +495,9 @@ void DrawVrsTest::CreateMainFbAttachment()
         VK_IMAGE_TYPE_2D, mMainFbColorFormat,
         { mMainFbExtent.width, mMainFbExtent.height, 1 },
         VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+    if (mVrsPipeline->IsAsyncCompute()) {
+        mDevice->SetAsyncComputeSharing(colorImageInfo);
+    }
     if (vkCreateImage(mDevice->Get(), &colorImageInfo, nullptr, &mMainFbColorImage) != VK_SUCCESS) {    // 创建VkImage
         throw std::runtime_error("failed to mMainFbColorImage!");
     }
@@ -387,7 +505,11 @@ void DrawVrsTest::CreateMainFbAttachment()
     VkImageCreateInfo depthImageInfo = vulkanInitializers::ImageCreateInfo(
         VK_IMAGE_TYPE_2D, mMainFbDepthFormat,
         { mMainFbExtent.width, mMainFbExtent.height, 1 },
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    // 内容分析在计算队列上采样深度
+    if (mVrsPipeline->IsAsyncCompute()) {
+        mDevice->SetAsyncComputeSharing(depthImageInfo);
+    }
     if (vkCreateImage(mDevice->Get(), &depthImageInfo, nullptr, &mMainFbDepthImage) != VK_SUCCESS) {    // 创建VkImage
         throw std::runtime_error("failed to mMainFbDepthImage!");
     }
@@ -426,19 +548,27 @@ void DrawVrsTest::CreateMainFbAttachment()
     if (vkCreateImageView(mDevice->Get(), &depthImageViewInfo, nullptr, &mMainFbDepthImageView) != VK_SUCCESS) {
         throw std::runtime_error("failed to create mMainFbDepthImageView!");
     }
+    depthImageViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (vkCreateImageView(mDevice->Get(), &depthImageViewInfo, nullptr, &mMainFbDepthSampleView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mMainFbDepthSampleView!");
+    }
 
-    mVrsPipeline->CreateVrsImage(mMainFbColorImage, mMainFbColorImageView, mMainFbExtent.width, mMainFbExtent.height);
+    mVrsPipeline->CreateVrsImage(mMainFbColorImage, mMainFbColorImageView, mMainFbDepthImage, mMainFbDepthSampleView,
+        mMainFbExtent.width, mMainFbExtent.height);
 }
 
 void DrawVrsTest::CleanUpMainFbAttachment()
 {
     mVrsPipeline->CleanUpVrsImage();
 
-    vkDestroyImageView(mDevice->Get(), mMainFbDepthImageView, nullptr);
-    vkDestroyImageView(mDevice->Get(), mMainFbColorImageView, nullptr);
-    vkDestroyImage(mDevice->Get(), mMainFbDepthImage, nullptr);
-    vkDestroyImage(mDevice->Get(), mMainFbColorImage, nullptr);
-    vkFreeMemory(mDevice->Get(), mMainFbMemory, nullptr);
+    // 重建时上一帧可能还在使用，交给延迟销毁
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    deletionQueue.DestroyImageView(mMainFbDepthSampleView);
+    deletionQueue.DestroyImageView(mMainFbDepthImageView);
+    deletionQueue.DestroyImageView(mMainFbColorImageView);
+    deletionQueue.DestroyImage(mMainFbDepthImage);
+    deletionQueue.DestroyImage(mMainFbColorImage);
+    deletionQueue.FreeMemory(mMainFbMemory);
 }
 
 void DrawVrsTest::CreateMainFramebuffer()
@@ -452,12 +582,17 @@ void DrawVrsTest::CreateMainFramebuffer()
     }
 
     LOGI("create main fb success %d", mMainFrameBuffer);
+
+    mVrsEvaluator->CreateResources(mMainPass, mMainFbColorImageView, mMainFbDepthImageView,
+        mVrsPipeline->GetSmoothVrsImageView(), mMainFbColorFormat, mMainFbExtent.width, mMainFbExtent.height,
+        mVrsPipeline->GetTileSize());
 }
 
 void DrawVrsTest::CleanUpMainFramebuffer()
 {
+    mVrsEvaluator->CleanUpResources();
     LOGI("clean up main fb %d", mMainFrameBuffer);
-    vkDestroyFramebuffer(mDevice->Get(), mMainFrameBuffer, nullptr);
+    DeletionQueue::GetInstance().DestroyFramebuffer(mMainFrameBuffer);
 }
 
 void DrawVrsTest::CreateVertexBuffer() {
@@ -572,7 +707,7 @@ void DrawVrsTest::CreateDescriptorSets() {
 
     // 向descriptor set写入信息
     VkDescriptorImageInfo sampleMainFbColorImageInfo = {
-        mTexureSampler, mMainFbColorImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        mTexureSampler, mMainFbColorImageView, GetPresentSampleLayout()
     };
     std::vector<VkWriteDescriptorSet> presentDescriptorWrites(1);
     presentDescriptorWrites[0] = vulkanInitializers::WriteDescriptorSet(mDescriptorSetPresent,
@@ -641,7 +776,7 @@ void DrawVrsTest::CreateDescriptorSets() {
 
     // 向descriptor set写入信息
     VkDescriptorImageInfo sampleVrsBlendImageInfo = {
-        mTexureSamplerNearst, mVrsPipeline->GetSmoothVrsImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        mTexureSamplerNearst, mVrsPipeline->GetSmoothVrsImageView(), GetPresentSampleLayout()
     };
     std::vector<VkWriteDescriptorSet> vrsBlendDescriptorWrites = {
         vulkanInitializers::WriteDescriptorSet(mDescriptorSetBlendVrs,
@@ -667,11 +802,16 @@ void DrawVrsTest::CreatePipelines()
 
     std::vector<VkPushConstantRange> nullPushConstantRanges = {};
 
+    // 渲染区域只占主framebuffer的一部分，纹理坐标需要缩放，并在片元着色器中限制在区域内
+    std::vector<VkPushConstantRange> presentPushConstantRanges = {
+        { VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PresentPushConstants) },
+    };
+
     GraphicsPipelineConfigInfo presentConfigInfo{};
-    presentConfigInfo.SetRenderPass(mPresentRenderPass);
+    SetPresentPassTarget(presentConfigInfo);
     presentConfigInfo.SetInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
 
-    mPipelinePresent = pipelineFactory.CreateGraphicsPipeline(presentConfigInfo, presentShaderFilePaths, presentLayoutBindings, nullPushConstantRanges);
+    mPipelinePresent = pipelineFactory.CreateGraphicsPipeline(presentConfigInfo, presentShaderFilePaths, presentLayoutBindings, presentPushConstantRanges);
 
     // blend vrsImage
     std::vector<ShaderFileInfo> blendVrsShaderFilePaths = {
@@ -694,10 +834,10 @@ void DrawVrsTest::CreatePipelines()
     vrsBlendAttachmentStates[0].alphaBlendOp = VK_BLEND_OP_ADD;
 
     GraphicsPipelineConfigInfo blendVrsConfigInfo{};
-    blendVrsConfigInfo.SetRenderPass(mPresentRenderPass);
+    SetPresentPassTarget(blendVrsConfigInfo);
     blendVrsConfigInfo.SetInputAssemblyState(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
     blendVrsConfigInfo.SetBlendStates(vrsBlendAttachmentStates);
-    mPipelineBlendVrsImage = pipelineFactory.CreateGraphicsPipeline(blendVrsConfigInfo, blendVrsShaderFilePaths, blendVrsLayoutBindings, nullPushConstantRanges);
+    mPipelineBlendVrsImage = pipelineFactory.CreateGraphicsPipeline(blendVrsConfigInfo, blendVrsShaderFilePaths, blendVrsLayoutBindings, presentPushConstantRanges);
 
     // draw glosy material
     std::vector<ShaderFileInfo> pbrShaderFilePaths = {
@@ -949,7 +1089,7 @@ void DrawVrsTest::UpdateDescriptorSets()
 {
     // present pass
     VkDescriptorImageInfo sampleMainFbColorImageInfo = {
-        mTexureSampler, mMainFbColorImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        mTexureSampler, mMainFbColorImageView, GetPresentSampleLayout()
     };
     std::vector<VkWriteDescriptorSet> presentDescriptorWrites(1);
     presentDescriptorWrites[0] = vulkanInitializers::WriteDescriptorSet(mDescriptorSetPresent,
@@ -958,7 +1098,7 @@ void DrawVrsTest::UpdateDescriptorSets()
 
     // blend vrs pass
     VkDescriptorImageInfo sampleVrsBlendImageInfo = {
-        mTexureSamplerNearst, mVrsPipeline->GetSmoothVrsImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        mTexureSamplerNearst, mVrsPipeline->GetSmoothVrsImageView(), GetPresentSampleLayout()
     };
     std::vector<VkWriteDescriptorSet> vrsBlendDescriptorWrites = {
         vulkanInitializers::WriteDescriptorSet(mDescriptorSetBlendVrs,
@@ -969,7 +1109,9 @@ void DrawVrsTest::UpdateDescriptorSets()
 
 void DrawVrsTest::RecordPresentPass(VkCommandBuffer cmdBuf, const RenderInputInfo& input)
 {
-    if (mBlendKeyPress) {
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    bool transferBlendImage = mBlendKeyPress && !mVrsPipeline->IsAsyncCompute();
+    if (transferBlendImage) {
         ImageMemoryBarrierInfo imageBarrierInfo{};
         imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
         imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -977,54 +1119,47 @@ void DrawVrsTest::RecordPresentPass(VkCommandBuffer cmdBuf, const RenderInputInf
         imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
         imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        mDevice->AddCmdPipelineBarrier(mCommandBuffer, mVrsPipeline->GetSmoothVrsImage(), VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+        mDevice->AddCmdPipelineBarrier(cmdBuf, mVrsPipeline->GetSmoothVrsImage(), VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
     }
 
     // 启动Pass
-    std::array<VkClearValue, 2> clearValues = {
-        consts::CLEAR_COLOR_NAVY_FLT,
-        consts::CLEAR_DEPTH_ONE_STENCIL_ZERO
-    };
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = input.presentRenderPass;
-    renderPassInfo.framebuffer = input.swapchanFb;
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = input.swapchainExtent;
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-    vkCmdBeginRenderPass(cmdBuf, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    CmdBeginPresentPass(cmdBuf, input, consts::CLEAR_COLOR_NAVY_FLT);
 
     // 绑定Pipeline
-    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePresent.pipeline);
+    dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelinePresent.pipeline);
     VkViewport viewport = { 0.0f, 0.0f, input.swapchainExtent.width, input.swapchainExtent.height, 0.0f, 1.0f };
-    vkCmdSetViewport(cmdBuf, 0, 1, &viewport);
+    dispatch.CmdSetViewport(cmdBuf, 0, 1, &viewport);
     VkRect2D scissor = { { 0, 0 }, input.swapchainExtent };
-    vkCmdSetScissor(cmdBuf, 0, 1, &scissor);
+    dispatch.CmdSetScissor(cmdBuf, 0, 1, &scissor);
 
     // 绑定DescriptorSet
-    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
         mPipelinePresent.layout,
         0, 1, &mDescriptorSetPresent,
         0, nullptr);
+    PresentPushConstants presentPushConstants = { mDynamicResolution.GetUvScale(), mDynamicResolution.GetUvClamp() };
+    dispatch.CmdPushConstants(cmdBuf, mPipelinePresent.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0, sizeof(presentPushConstants), &presentPushConstants);
 
     //画图
-    vkCmdDraw(cmdBuf, 4, 1, 0, 0);
+    dispatch.CmdDraw(cmdBuf, 4, 1, 0, 0);
 
     if (mBlendKeyPress) {
         // blend vrs image
-        vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineBlendVrsImage.pipeline);
-        vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+        dispatch.CmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineBlendVrsImage.pipeline);
+        dispatch.CmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
             mPipelineBlendVrsImage.layout,
             0, 1, &mDescriptorSetBlendVrs,
             0, nullptr);
-        vkCmdDraw(cmdBuf, 4, 1, 0, 0);
+        dispatch.CmdPushConstants(cmdBuf, mPipelineBlendVrsImage.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            0, sizeof(presentPushConstants), &presentPushConstants);
+        dispatch.CmdDraw(cmdBuf, 4, 1, 0, 0);
     }
 
     // 结束Pass
-    vkCmdEndRenderPass(cmdBuf);
+    CmdEndPresentPass(cmdBuf, input);
 
-    if (mBlendKeyPress) {
+    if (transferBlendImage) {
         ImageMemoryBarrierInfo imageBarrierInfo{};
         imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
@@ -1032,7 +1167,12 @@ void DrawVrsTest::RecordPresentPass(VkCommandBuffer cmdBuf, const RenderInputInf
         imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
         imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
         imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        mDevice->AddCmdPipelineBarrier(mCommandBuffer, mVrsPipeline->GetSmoothVrsImage(), VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+        mDevice->AddCmdPipelineBarrier(cmdBuf, mVrsPipeline->GetSmoothVrsImage(), VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
     }
 }
+
+VkImageLayout DrawVrsTest::GetPresentSampleLayout()
+{
+    return mVrsPipeline->IsAsyncCompute() ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
 }   // namespace render
@@ -0,0 +1,286 @@
+#include "VrsEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "SceneDemoDefs.h"
+#include "BufferCreator.h"
+#include "DeletionQueue.h"
+#include "GpuProfiler.h"
+
+#include "Log.h"
+#include "AppDispatchTable.h"
+#undef LOG_TAG
+#define LOG_TAG "VrsEvaluator"
+
+namespace framework {
+
+void VrsEvaluator::Init(Device* device)
+{
+    mDevice = device;
+    mInterval = GetConfig().vrs.evaluationInterval;
+    mEnabled = mInterval > 0;
+    if (!mEnabled) {
+        return;
+    }
+    mFrameIndex = 0;
+    mResults.clear();
+    CreatePipeline();
+    CreateDescriptorSet();
+    LOGI("vrs evaluation every %d frames, report to %s", mInterval, GetConfig().vrs.evaluationReportPath.c_str());
+}
+
+void VrsEvaluator::CleanUp()
+{
+    if (!mEnabled) {
+        return;
+    }
+    WriteReport();
+
+    vkDestroyDescriptorPool(mDevice->Get(), mDescriptorPool, nullptr);
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+    pipelineFactory.DestroyPipelineObjecst(mPipelineEvaluate);
+}
+
+void VrsEvaluator::CreateResources(VkRenderPass mainPass, VkImageView mainFbColorImageView, VkImageView mainFbDepthImageView,
+    VkImageView shadingRateImageView, VkFormat colorFormat, uint32_t width, uint32_t height, uint32_t tileSize)
+{
+    if (!mEnabled) {
+        return;
+    }
+    mTileSize = tileSize;
+
+    // 参考画面
+    VkImageCreateInfo imageInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, colorFormat);
+    imageInfo.extent = { width, height, 1 };
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    VmaAllocationCreateInfo imageAllocInfo = {};
+    imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    if (vmaCreateImage(BufferCreator::GetInstance().GetAllocator(),
+        &imageInfo, &imageAllocInfo, &mReferenceImage, &mReferenceImageAllocation, nullptr) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create reference image!");
+    }
+    VkImageViewCreateInfo viewInfo = vulkanInitializers::ImageViewCreateInfo(mReferenceImage,
+        VK_IMAGE_VIEW_TYPE_2D, colorFormat, { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 });
+    if (vkCreateImageView(mDevice->Get(), &viewInfo, nullptr, &mReferenceImageView) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create reference image view!");
+    }
+
+    // 和主framebuffer只有颜色附件不同，参考画面渲染时忽略shading rate附件
+    std::vector<VkImageView> attachments = { mReferenceImageView, mainFbDepthImageView, shadingRateImageView };
+    VkFramebufferCreateInfo framebufferInfo = vulkanInitializers::FramebufferCreateInfo(mainPass, attachments, width, height);
+    if (vkCreateFramebuffer(mDevice->Get(), &framebufferInfo, nullptr, &mReferenceFramebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create reference framebuffer!");
+    }
+
+    // 按最大渲染区域分配每个工作组的结果
+    uint32_t groupCount = ((width + GROUP_SIZE - 1) / GROUP_SIZE) * ((height + GROUP_SIZE - 1) / GROUP_SIZE);
+    VkDeviceSize bufferSize = sizeof(glm::vec4) * groupCount;
+    BufferCreator::GetInstance().CreateBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        mResultBuffer, mResultBufferMemory);
+    vkMapMemory(mDevice->Get(), mResultBufferMemory, 0, bufferSize, 0, reinterpret_cast<void**>(&mResultMapped));
+
+    VkDescriptorImageInfo vrsImageInfo = { VK_NULL_HANDLE, mainFbColorImageView, VK_IMAGE_LAYOUT_GENERAL };
+    VkDescriptorImageInfo referenceImageInfo = { VK_NULL_HANDLE, mReferenceImageView, VK_IMAGE_LAYOUT_GENERAL };
+    VkDescriptorImageInfo shadingRateImageInfo = { VK_NULL_HANDLE, shadingRateImageView, VK_IMAGE_LAYOUT_GENERAL };
+    VkDescriptorBufferInfo resultInfo = { mResultBuffer, 0, bufferSize };
+    std::vector<VkWriteDescriptorSet> descriptorSetWrites = {
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSet,
+            0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &vrsImageInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSet,
+            1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &referenceImageInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSet,
+            2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &shadingRateImageInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSet,
+            3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &resultInfo),
+    };
+    vkUpdateDescriptorSets(mDevice->Get(), descriptorSetWrites.size(), descriptorSetWrites.data(), 0, nullptr);
+}
+
+void VrsEvaluator::CleanUpResources()
+{
+    if (!mEnabled) {
+        return;
+    }
+    // 重建或退出前在飞行的帧已经结束，读出最后一次评估的结果
+    CollectResult();
+    vkUnmapMemory(mDevice->Get(), mResultBufferMemory);
+    mResultMapped = nullptr;
+
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    deletionQueue.DestroyBuffer(mResultBuffer);
+    deletionQueue.FreeMemory(mResultBufferMemory);
+    deletionQueue.DestroyFramebuffer(mReferenceFramebuffer);
+    deletionQueue.DestroyImageView(mReferenceImageView);
+    deletionQueue.DestroyVmaImage(mReferenceImage, mReferenceImageAllocation);
+}
+
+bool VrsEvaluator::BeginFrame()
+{
+    if (!mEnabled) {
+        return false;
+    }
+    // 上一帧已经执行完，读取评估结果
+    CollectResult();
+    return mFrameIndex++ % mInterval == 0;
+}
+
+void VrsEvaluator::CmdEvaluate(VkCommandBuffer commandBuffer, VkExtent2D renderExtent, bool perceptual)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    GpuProfileScope evaluateScope(commandBuffer, "VrsEvaluate");
+
+    ImageMemoryBarrierInfo imageBarrierInfo{};
+    imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    imageBarrierInfo.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mReferenceImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+
+    EvaluateParams params{};
+    params.renderSize = glm::ivec2(renderExtent.width, renderExtent.height);
+    params.tileSize = mTileSize;
+    params.groupCountX = (renderExtent.width + GROUP_SIZE - 1) / GROUP_SIZE;
+    uint32_t groupCountY = (renderExtent.height + GROUP_SIZE - 1) / GROUP_SIZE;
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineEvaluate.pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+        mPipelineEvaluate.layout,
+        0, 1, &mDescriptorSet,
+        0, nullptr);
+    dispatch.CmdPushConstants(commandBuffer, mPipelineEvaluate.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    dispatch.CmdDispatch(commandBuffer, params.groupCountX, groupCountY, 1);
+
+    mPendingGroupCount = params.groupCountX * groupCountY;
+    mPendingResult = {};
+    mPendingResult.frameIndex = mFrameIndex - 1;
+    mPendingResult.perceptual = perceptual;
+}
+
+void VrsEvaluator::CreatePipeline()
+{
+    PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
+    pipelineFactory.SetDevice(mDevice->Get());
+
+    ShaderFileInfo evaluateShaderFile{};
+    evaluateShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("evaluate_vrs_quality.comp.spv");
+    evaluateShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+    std::vector<VkPushConstantRange> pushConstantRanges = {
+        { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(EvaluateParams) },
+    };
+    mPipelineEvaluate = pipelineFactory.CreateComputePipeline(evaluateShaderFile, layoutBindings, pushConstantRanges);
+}
+
+void VrsEvaluator::CreateDescriptorSet()
+{
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = mPipelineEvaluate.descriptorSizes.size();
+    poolInfo.pPoolSizes = mPipelineEvaluate.descriptorSizes.data();
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocInfo.descriptorPool = mDescriptorPool;
+    allocInfo.descriptorSetCount = mPipelineEvaluate.descriptorSetLayouts.size();
+    allocInfo.pSetLayouts = mPipelineEvaluate.descriptorSetLayouts.data();
+    if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+}
+
+void VrsEvaluator::CollectResult()
+{
+    if (mPendingGroupCount == 0 || mResultMapped == nullptr) {
+        return;
+    }
+
+    double errorSum = 0.0;
+    double fragmentSum = 0.0;
+    double pixelCount = 0.0;
+    float maxLumaError = 0.0f;
+    for (uint32_t i = 0; i < mPendingGroupCount; i++) {
+        errorSum += mResultMapped[i].x;
+        fragmentSum += mResultMapped[i].y;
+        pixelCount += mResultMapped[i].z;
+        maxLumaError = std::max(maxLumaError, mResultMapped[i].w);
+    }
+    mPendingGroupCount = 0;
+    if (pixelCount <= 0.0) {
+        return;
+    }
+
+    EvaluationResult& result = mPendingResult;
+    result.mse = static_cast<float>(errorSum / pixelCount);
+    result.psnr = result.mse > 0.0f ? std::min(10.0f * std::log10(1.0f / result.mse), MAX_PSNR) : MAX_PSNR;
+    result.shadedReduction = static_cast<float>(1.0 - fragmentSum / pixelCount);
+    result.maxLumaError = maxLumaError;
+    mResults.emplace_back(result);
+
+    if (mResults.size() % LOG_INTERVAL != 0) {
+        return;
+    }
+    float reductionSum = 0.0f;
+    float psnrSum = 0.0f;
+    for (size_t i = mResults.size() - LOG_INTERVAL; i < mResults.size(); i++) {
+        reductionSum += mResults[i].shadedReduction;
+        psnrSum += mResults[i].psnr;
+    }
+    LOGI("vrs evaluation: %.2f%% fewer fragments shaded, psnr %.2fdB (last %d evaluations)",
+        100.0f * reductionSum / LOG_INTERVAL, psnrSum / LOG_INTERVAL, LOG_INTERVAL);
+}
+
+void VrsEvaluator::WriteReport()
+{
+    if (mResults.empty()) {
+        return;
+    }
+    const std::string& path = GetConfig().vrs.evaluationReportPath;
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOGE("failed to open %s", path.c_str());
+        return;
+    }
+
+    // 按速率选择模型分别求平均，同一次运行中切换过模型时可以直接对比
+    double reductionSum[2] = {};
+    double psnrSum[2] = {};
+    uint32_t count[2] = {};
+    file << "# vrs evaluation, tile size " << mTileSize << ", every " << mInterval << " frames\n";
+    file << "# frame perceptual shadedReduction(%) psnr(dB) mse maxLumaError\n";
+    for (const EvaluationResult& result : mResults) {
+        file << result.frameIndex << " " << (result.perceptual ? 1 : 0) << " " << 100.0f * result.shadedReduction
+            << " " << result.psnr << " " << result.mse << " " << result.maxLumaError << "\n";
+        uint32_t model = result.perceptual ? 1 : 0;
+        reductionSum[model] += result.shadedReduction;
+        psnrSum[model] += result.psnr;
+        count[model]++;
+    }
+    const char* modelNames[2] = { "gradient", "perceptual" };
+    for (uint32_t model = 0; model < 2; model++) {
+        if (count[model] == 0) {
+            continue;
+        }
+        file << "# average " << modelNames[model] << ": " << 100.0 * reductionSum[model] / count[model] << "% fewer fragments, "
+            << psnrSum[model] / count[model] << "dB psnr over " << count[model] << " frames\n";
+        LOGI("vrs evaluation %s: %.2f%% fewer fragments shaded, psnr %.2fdB over %d frames", modelNames[model],
+            100.0 * reductionSum[model] / count[model], psnrSum[model] / count[model], count[model]);
+    }
+    LOGI("save vrs evaluation to %s", path.c_str());
+}
+
+} // namespace framework
@@ -1,9 +1,17 @@
 #include "VrsPipeline.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+
 #include "SceneDemoDefs.h"
 #include "BufferCreator.h"
+#include "DeletionQueue.h"
+#include "GpuProfiler.h"
 
 #include "Log.h"
+#include "AppDispatchTable.h"
 #undef LOG_TAG
 #define LOG_TAG "VrsPipeline"
 
@@ -36,8 +44,17 @@ VrsPipeline::~VrsPipeline()
 void VrsPipeline::Init(Device* device)
 {
     mDevice = device;
+    mReprojectionEnabled = GetConfig().vrs.reprojection;
+    SetAnalysisInterval(GetConfig().vrs.analysisInterval);
+    mPerceptualEnabled = GetConfig().vrs.perceptual;
+    mAsyncCompute = GetConfig().vrs.asyncCompute && mDevice->HasAsyncCompute();
+    if (GetConfig().vrs.asyncCompute && !mAsyncCompute) {
+        LOGW("async compute not available, analysis runs on graphics queue");
+    }
+    SelectTileSize();
     CreatePipeline();
     CreateSampler();
+    CreateStatisticsBuffer();
     CreateDescriptorPool();
     CreateDesciptorSets();
 
@@ -52,17 +69,25 @@ void VrsPipeline::Init(Device* device)
 void VrsPipeline::CleanUp()
 {
     vkDestroyDescriptorPool(mDevice->Get(), mDescriptorPool, nullptr);
+    CleanUpStatisticsBuffer();
     CleanUpSampler();
     CleanUpPipeline();
 }
 
-void VrsPipeline::CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbColorImageView, uint32_t mainFbWidth, uint32_t mainFbHeight)
+void VrsPipeline::CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbColorImageView,
+    VkImage mainFbDepthImage, VkImageView mainFbDepthSampleView, uint32_t mainFbWidth, uint32_t mainFbHeight)
 {
-    // create image
-    uint32_t vrsImageWidth = mainFbWidth / 8, vrsImageHeight = mainFbHeight / 8;
+    // create image，不能整除时向上取整，边缘的tile也要覆盖
+    uint32_t vrsImageWidth = (mainFbWidth + ANALYSIS_CELL_SIZE - 1) / ANALYSIS_CELL_SIZE;
+    uint32_t vrsImageHeight = (mainFbHeight + ANALYSIS_CELL_SIZE - 1) / ANALYSIS_CELL_SIZE;
+    uint32_t tileImageWidth = (mainFbWidth + mTileSize - 1) / mTileSize;
+    uint32_t tileImageHeight = (mainFbHeight + mTileSize - 1) / mTileSize;
     VkImageCreateInfo vrsImageInfo = vulkanInitializers::ImageCreateInfo(VK_IMAGE_TYPE_2D, VK_FORMAT_R8_UINT);
     vrsImageInfo.extent = { vrsImageWidth, vrsImageHeight, 1 };
     vrsImageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (mAsyncCompute) {
+        mDevice->SetAsyncComputeSharing(vrsImageInfo);
+    }
 
     VmaAllocationCreateInfo imageAllocInfo = {};
     imageAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -70,6 +95,7 @@ void VrsPipeline::CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbCol
         &vrsImageInfo, &imageAllocInfo, &mVrsImage, &mVrsImageAllocation, nullptr) != VK_SUCCESS) {
         LOGE("failed to create texture image!");
     }
+    vrsImageInfo.extent = { tileImageWidth, tileImageHeight, 1 };
     if (vmaCreateImage(BufferCreator::GetInstance().GetAllocator(),
         &vrsImageInfo, &imageAllocInfo, &mSmoothVrsImage, &mSmoothVrsImageAllocation, nullptr) != VK_SUCCESS) {
         LOGE("failed to create texture image!");
@@ -86,6 +112,19 @@ void VrsPipeline::CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbCol
         LOGE("failed to create texture image view!");
     }
 
+    // history只作为计算着色器的输入输出
+    vrsImageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT;
+    for (uint32_t i = 0; i < mHistoryVrsImages.size(); i++) {
+        if (vmaCreateImage(BufferCreator::GetInstance().GetAllocator(),
+            &vrsImageInfo, &imageAllocInfo, &mHistoryVrsImages[i], &mHistoryVrsImageAllocations[i], nullptr) != VK_SUCCESS) {
+            LOGE("failed to create history image!");
+        }
+        viewInfo.image = mHistoryVrsImages[i];
+        if (vkCreateImageView(mDevice->Get(), &viewInfo, nullptr, &mHistoryVrsImageViews[i]) != VK_SUCCESS) {
+            LOGE("failed to create history image view!");
+        }
+    }
+
     // transfer layout
     ImageMemoryBarrierInfo imageBarrierInfo{};
     imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -96,24 +135,103 @@ void VrsPipeline::CreateVrsImage(VkImage mainFbColorImage, VkImageView mainFbCol
     imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
     BufferCreator::GetInstance().TransitionImageLayout(mVrsImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
     BufferCreator::GetInstance().TransitionImageLayout(mSmoothVrsImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    for (VkImage historyImage : mHistoryVrsImages) {
+        BufferCreator::GetInstance().TransitionImageLayout(historyImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    }
+    mHistoryIndex = 0;
+    mHistoryValid = false;
+    mDepthValid = false;
+    mFrameIndex = 0;
 
     mVrsImageWidth = vrsImageWidth;
     mVrsImageHeight = vrsImageHeight;
+    mTileImageWidth = tileImageWidth;
+    mTileImageHeight = tileImageHeight;
 
     // process main fb color attachment
     mMainFbColorImageView = mainFbColorImageView;
     mMainFbColorImage = mainFbColorImage;
     mMainFbWidth = mainFbWidth;
     mMainFbHeight = mainFbHeight;
+    mMainFbDepthImage = mainFbDepthImage;
+    mMainFbDepthSampleView = mainFbDepthSampleView;
     UpdateDescriptorSets(mMainFbColorImageView, mVrsImageView, mSmoothVrsImageView);
 }
 
 void VrsPipeline::CleanUpVrsImage()
 {
-    vkDestroyImageView(mDevice->Get(), mSmoothVrsImageView, nullptr);
-    vkDestroyImageView(mDevice->Get(), mVrsImageView, nullptr);
-    vmaDestroyImage(BufferCreator::GetInstance().GetAllocator(), mSmoothVrsImage, mSmoothVrsImageAllocation);
-    vmaDestroyImage(BufferCreator::GetInstance().GetAllocator(), mVrsImage, mVrsImageAllocation);
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    for (uint32_t i = 0; i < mHistoryVrsImages.size(); i++) {
+        deletionQueue.DestroyImageView(mHistoryVrsImageViews[i]);
+        deletionQueue.DestroyVmaImage(mHistoryVrsImages[i], mHistoryVrsImageAllocations[i]);
+    }
+    deletionQueue.DestroyImageView(mSmoothVrsImageView);
+    deletionQueue.DestroyImageView(mVrsImageView);
+    deletionQueue.DestroyVmaImage(mSmoothVrsImage, mSmoothVrsImageAllocation);
+    deletionQueue.DestroyVmaImage(mVrsImage, mVrsImageAllocation);
+}
+
+void VrsPipeline::CmdReprojectShadingRate(VkCommandBuffer commandBuffer, VkExtent2D renderExtent, const glm::mat4& reprojection)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // 上一帧已经执行完，读取统计结果
+    ReportStatistics();
+
+    GpuProfileScope reprojectScope(commandBuffer, "VrsReproject");
+
+    renderExtent.width = std::min(renderExtent.width, mMainFbWidth);
+    renderExtent.height = std::min(renderExtent.height, mMainFbHeight);
+    if (mPrevRenderExtent.width == 0 || mPrevRenderExtent.height == 0) {
+        mPrevRenderExtent = renderExtent;
+    }
+
+    // 上一帧的深度，分析之前已经转为只读，重建后第一帧还没有内容
+    ImageMemoryBarrierInfo imageBarrierInfo{};
+    imageBarrierInfo.oldLayout = mDepthValid ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.srcAccessMask = 0;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mMainFbDepthImage,
+        VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, imageBarrierInfo);
+
+    // 上一帧分析写入的history，以及上一帧主pass和呈现pass读完的shading rate
+    imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mHistoryVrsImages[0], VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mHistoryVrsImages[1], VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mSmoothVrsImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+
+    ReprojectParams params{};
+    params.reprojection = reprojection;
+    params.prevRenderSize = glm::vec2(mPrevRenderExtent.width, mPrevRenderExtent.height);
+    params.currRenderSize = glm::vec2(renderExtent.width, renderExtent.height);
+    params.tileSize = mTileSize;
+    params.historyValid = mHistoryValid ? 1 : 0;
+    params.depthValid = mDepthValid && mReprojectionEnabled ? 1 : 0;
+    // 分析本帧时估计相机运动
+    mCurrToPrev = glm::inverse(reprojection);
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineReprojectVrs.pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+        mPipelineReprojectVrs.layout,
+        0, 1, &mDescriptorSetsReprojectVrs[mHistoryIndex],
+        0, nullptr);
+    dispatch.CmdPushConstants(commandBuffer, mPipelineReprojectVrs.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    uint32_t tileCountX = (renderExtent.width + mTileSize - 1) / mTileSize;
+    uint32_t tileCountY = (renderExtent.height + mTileSize - 1) / mTileSize;
+    dispatch.CmdDispatch(commandBuffer, (tileCountX + 7) / 8, (tileCountY + 7) / 8, 1);
+
+    // 本帧之后读写另一张history
+    mHistoryIndex = 1 - mHistoryIndex;
+    mHistoryValid = true;
+    mDepthValid = true;
+    mPrevRenderExtent = renderExtent;
 }
 
 void VrsPipeline::CmdPrepareShadingRate(VkCommandBuffer commandBuffer)
@@ -128,39 +246,139 @@ void VrsPipeline::CmdPrepareShadingRate(VkCommandBuffer commandBuffer)
     mDevice->AddCmdPipelineBarrier(commandBuffer, mSmoothVrsImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
 }
 
-void VrsPipeline::CmdAnalysisContent(VkCommandBuffer commandBuffer)
+void VrsPipeline::CmdPrepareAnalysis(VkCommandBuffer commandBuffer)
 {
-    // compute pass
+    // 异步计算时呈现pass和分析同时读取，都使用GENERAL
     ImageMemoryBarrierInfo imageBarrierInfo{};
     imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
     imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     imageBarrierInfo.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
     mDevice->AddCmdPipelineBarrier(commandBuffer, mMainFbColorImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
 
+    // 深度之后一直保持只读，直到下一帧主pass重新写入
+    imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    imageBarrierInfo.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mMainFbDepthImage,
+        VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, imageBarrierInfo);
+
     imageBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_FRAGMENT_SHADING_RATE_ATTACHMENT_OPTIMAL_KHR;
     imageBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
     imageBarrierInfo.srcStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     imageBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    imageBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
     mDevice->AddCmdPipelineBarrier(commandBuffer, mSmoothVrsImage, VK_IMAGE_ASPECT_COLOR_BIT, imageBarrierInfo);
+}
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineDrawVrsRegion.pipeline);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+void VrsPipeline::CmdAnalysisContent(VkCommandBuffer commandBuffer, VkExtent2D renderExtent)
+{
+    AppDeviceDispatchTable& dispatch = AppDeviceDispatchTable::GetInstance();
+    // 跳过的帧也记录这个scope，跑分报告中的平均耗时就是分摊后的耗时
+    // 计算队列不支持图形管线的统计查询，异步时只记录耗时
+    GpuProfileScope analysisScope(commandBuffer, mAsyncCompute ? "VrsAnalysisAsync" : "VrsAnalysis", !mAsyncCompute);
+    bool analysisFrame = mFrameIndex % mAnalysisInterval == 0;
+    mFrameIndex++;
+
+    // 不分析的帧，下一帧沿用重投影写入history的结果
+    if (!analysisFrame) {
+        return;
+    }
+
+    const VrsConfig& vrsConfig = GetConfig().vrs;
+    AnalysisParams params{};
+    params.renderSize = glm::ivec2(std::min(renderExtent.width, mMainFbWidth), std::min(renderExtent.height, mMainFbHeight));
+    params.depthUnproject = mDepthUnproject;
+    params.sensitivity = vrsConfig.sensitivity;
+    params.quarterCoef = vrsConfig.quarterCoef;
+    params.motionScale = mPerceptualEnabled ? vrsConfig.motionScale : 0.0f;
+    params.depthEdgeThreshold = mPerceptualEnabled ? vrsConfig.depthEdgeThreshold : 0.0f;
+    params.maskingStrength = mPerceptualEnabled ? vrsConfig.maskingStrength : 0.0f;
+    params.adaptationLuma = vrsConfig.adaptationLuma;
+    params.currToPrev = mCurrToPrev;
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineDrawVrsRegion.pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
         mPipelineDrawVrsRegion.layout,
         0, 1, &mDescriptorSetVrsComp,
         0, nullptr);
-    vkCmdDispatch(commandBuffer, mMainFbWidth / 16, mMainFbHeight / 16, 1);
-
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineSmoothVrs.pipeline);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+    dispatch.CmdPushConstants(commandBuffer, mPipelineDrawVrsRegion.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    // 每个工作组输出groupCells x groupCells个8x8的单元
+    uint32_t groupSize = GetAnalysisGroupCells(mTileSize) * ANALYSIS_CELL_SIZE;
+    dispatch.CmdDispatch(commandBuffer, (params.renderSize.x + groupSize - 1) / groupSize, (params.renderSize.y + groupSize - 1) / groupSize, 1);
+
+    // 覆盖重投影写入的history，同时和本帧使用的速率比较
+    ImageMemoryBarrierInfo computeBarrierInfo{};
+    computeBarrierInfo.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    computeBarrierInfo.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    computeBarrierInfo.srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    computeBarrierInfo.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    computeBarrierInfo.dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    computeBarrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mVrsImage, VK_IMAGE_ASPECT_COLOR_BIT, computeBarrierInfo);
+    mDevice->AddCmdPipelineBarrier(commandBuffer, mHistoryVrsImages[mHistoryIndex], VK_IMAGE_ASPECT_COLOR_BIT, computeBarrierInfo);
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineSmoothVrs.pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
         mPipelineSmoothVrs.layout,
-        0, 1, &mDescriptorSetSmoothVrs,
+        0, 1, &mDescriptorSetsSmoothVrs[mHistoryIndex],
         0, nullptr);
-    vkCmdDispatch(commandBuffer, mVrsImageWidth / 16, mVrsImageHeight / 16, 1);
+    dispatch.CmdPushConstants(commandBuffer, mPipelineSmoothVrs.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    // 每个线程输出一个tile
+    uint32_t tileCountX = (params.renderSize.x + mTileSize - 1) / mTileSize;
+    uint32_t tileCountY = (params.renderSize.y + mTileSize - 1) / mTileSize;
+    dispatch.CmdDispatch(commandBuffer, (tileCountX + 7) / 8, (tileCountY + 7) / 8, 1);
+    mStatisticsPending = true;
+}
+
+void VrsPipeline::SelectTileSize()
+{
+    VkPhysicalDeviceFragmentShadingRatePropertiesKHR vrsProperties{
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_SHADING_RATE_PROPERTIES_KHR
+    };
+    VkPhysicalDeviceProperties2 properties2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+    properties2.pNext = &vrsProperties;
+    vkGetPhysicalDeviceProperties2(mDevice->GetPhysicalDevice()->Get(), &properties2);
+
+    // 只使用正方形的tile，并且是分析单元的1、2、4倍
+    VkExtent2D minTexelSize = vrsProperties.minFragmentShadingRateAttachmentTexelSize;
+    VkExtent2D maxTexelSize = vrsProperties.maxFragmentShadingRateAttachmentTexelSize;
+    std::vector<uint32_t> supportedTileSizes = {};
+    for (uint32_t tileSize = ANALYSIS_CELL_SIZE; tileSize <= MAX_TILE_SIZE; tileSize *= 2) {
+        if (tileSize >= std::max(minTexelSize.width, minTexelSize.height) &&
+            tileSize <= std::min(maxTexelSize.width, maxTexelSize.height)) {
+            supportedTileSizes.emplace_back(tileSize);
+        }
+    }
+    if (supportedTileSizes.empty()) {
+        LOGE("no supported shading rate texel size in (%d, %d) - (%d, %d), use %d",
+            minTexelSize.width, minTexelSize.height, maxTexelSize.width, maxTexelSize.height, mTileSize);
+        return;
+    }
+
+    // 配置的大小不支持时取最接近的
+    uint32_t requestedTileSize = GetConfig().vrs.tileSize;
+    mTileSize = supportedTileSizes.front();
+    for (uint32_t tileSize : supportedTileSizes) {
+        if (std::abs(static_cast<int>(tileSize) - static_cast<int>(requestedTileSize)) <
+            std::abs(static_cast<int>(mTileSize) - static_cast<int>(requestedTileSize))) {
+            mTileSize = tileSize;
+        }
+    }
+    LOGI("shading rate tile size %d, requested %d, device supports (%d, %d) - (%d, %d)", mTileSize, requestedTileSize,
+        minTexelSize.width, minTexelSize.height, maxTexelSize.width, maxTexelSize.height);
+}
+
+uint32_t VrsPipeline::GetAnalysisGroupCells(uint32_t tileSize)
+{
+    // 工作组至少覆盖16x16像素，32的tile时一个工作组正好对应一个tile
+    return std::max(tileSize / ANALYSIS_CELL_SIZE, 2u);
 }
 
 void VrsPipeline::CreatePipeline()
@@ -168,23 +386,73 @@ void VrsPipeline::CreatePipeline()
     PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
     pipelineFactory.SetDevice(mDevice->Get());
 
+    // 按tile大小特化两个计算着色器：分析的工作组形状和平滑时每个tile包含的单元数
+    uint32_t groupCells = GetAnalysisGroupCells(mTileSize);
+    std::array<uint32_t, 3> analysisConstants = { groupCells, groupCells * 4, groupCells * 2 };
+    std::array<VkSpecializationMapEntry, 3> analysisEntries = {};
+    for (uint32_t i = 0; i < analysisEntries.size(); i++) {
+        analysisEntries[i] = { i, static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t) };
+    }
+    VkSpecializationInfo analysisSpecialization{};
+    analysisSpecialization.mapEntryCount = static_cast<uint32_t>(analysisEntries.size());
+    analysisSpecialization.pMapEntries = analysisEntries.data();
+    analysisSpecialization.dataSize = sizeof(analysisConstants);
+    analysisSpecialization.pData = analysisConstants.data();
+
+    uint32_t tileCells = mTileSize / ANALYSIS_CELL_SIZE;
+    VkSpecializationMapEntry smoothEntry = { 0, 0, sizeof(uint32_t) };
+    VkSpecializationInfo smoothSpecialization{};
+    smoothSpecialization.mapEntryCount = 1;
+    smoothSpecialization.pMapEntries = &smoothEntry;
+    smoothSpecialization.dataSize = sizeof(tileCells);
+    smoothSpecialization.pData = &tileCells;
+
     ShaderFileInfo computeVrsRegionShaderFile{};
     computeVrsRegionShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("draw_vrs_region.comp.spv");
     computeVrsRegionShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeVrsRegionShaderFile.specializationInfo = &analysisSpecialization;
 
     std::vector<VkDescriptorSetLayoutBinding> layoutBindings = {
         vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
         vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+
+    std::vector<VkDescriptorSetLayoutBinding> smoothLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
     };
 
-    std::vector<VkPushConstantRange> nullPushConstantRanges = {};
+    std::vector<VkPushConstantRange> analysisPushConstantRanges = {
+        { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(AnalysisParams) },
+    };
 
-    mPipelineDrawVrsRegion = pipelineFactory.CreateComputePipeline(computeVrsRegionShaderFile, layoutBindings, nullPushConstantRanges);
+    mPipelineDrawVrsRegion = pipelineFactory.CreateComputePipeline(computeVrsRegionShaderFile, layoutBindings, analysisPushConstantRanges);
 
     ShaderFileInfo smoothVrsShaderFile{};
     smoothVrsShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("smooth_shading_rate.comp.spv");
     smoothVrsShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    mPipelineSmoothVrs = pipelineFactory.CreateComputePipeline(smoothVrsShaderFile, layoutBindings, nullPushConstantRanges);
+    smoothVrsShaderFile.specializationInfo = &smoothSpecialization;
+    mPipelineSmoothVrs = pipelineFactory.CreateComputePipeline(smoothVrsShaderFile, smoothLayoutBindings, analysisPushConstantRanges);
+
+    ShaderFileInfo reprojectVrsShaderFile{};
+    reprojectVrsShaderFile.filePath = GetConfig().directory.dirSpvFiles + std::string("reproject_shading_rate.comp.spv");
+    reprojectVrsShaderFile.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> reprojectLayoutBindings = {
+        vulkanInitializers::DescriptorSetLayoutBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+        vulkanInitializers::DescriptorSetLayoutBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT),
+    };
+
+    std::vector<VkPushConstantRange> reprojectPushConstantRanges = {
+        { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ReprojectParams) },
+    };
+
+    mPipelineReprojectVrs = pipelineFactory.CreateComputePipeline(reprojectVrsShaderFile, reprojectLayoutBindings, reprojectPushConstantRanges);
 }
 
 void VrsPipeline::CleanUpPipeline()
@@ -192,6 +460,7 @@ void VrsPipeline::CleanUpPipeline()
     PipelineFactory& pipelineFactory = PipelineFactory::GetInstance();
     pipelineFactory.SetDevice(mDevice->Get());
 
+    pipelineFactory.DestroyPipelineObjecst(mPipelineReprojectVrs);
     pipelineFactory.DestroyPipelineObjecst(mPipelineSmoothVrs);
     pipelineFactory.DestroyPipelineObjecst(mPipelineDrawVrsRegion);
 }
@@ -200,13 +469,16 @@ void VrsPipeline::CreateDescriptorPool()
 {
     std::vector<VkDescriptorPoolSize> poolSizes = {};   // 池中各种类型的Descriptor个数
     poolSizes.insert(poolSizes.end(), mPipelineDrawVrsRegion.descriptorSizes.begin(), mPipelineDrawVrsRegion.descriptorSizes.end());
-    poolSizes.insert(poolSizes.end(), mPipelineSmoothVrs.descriptorSizes.begin(), mPipelineSmoothVrs.descriptorSizes.end());
+    for (uint32_t i = 0; i < mHistoryVrsImages.size(); i++) {
+        poolSizes.insert(poolSizes.end(), mPipelineSmoothVrs.descriptorSizes.begin(), mPipelineSmoothVrs.descriptorSizes.end());
+        poolSizes.insert(poolSizes.end(), mPipelineReprojectVrs.descriptorSizes.begin(), mPipelineReprojectVrs.descriptorSizes.end());
+    }
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     poolInfo.poolSizeCount = poolSizes.size();
     poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 2;   // 池中最大能申请descriptorSet的个数
+    poolInfo.maxSets = 5;   // 池中最大能申请descriptorSet的个数
     poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
     if (vkCreateDescriptorPool(mDevice->Get(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create descriptor pool!");
@@ -225,11 +497,20 @@ void VrsPipeline::CreateDesciptorSets()
         throw std::runtime_error("failed to allocate descriptor sets!");
     }
 
-    // smooth vrs pass
-    allocInfo.descriptorSetCount = mPipelineSmoothVrs.descriptorSetLayouts.size();
-    allocInfo.pSetLayouts = mPipelineSmoothVrs.descriptorSetLayouts.data();
-    if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetSmoothVrs) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate descriptor sets!");
+    for (uint32_t i = 0; i < mHistoryVrsImages.size(); i++) {
+        // smooth vrs pass
+        allocInfo.descriptorSetCount = mPipelineSmoothVrs.descriptorSetLayouts.size();
+        allocInfo.pSetLayouts = mPipelineSmoothVrs.descriptorSetLayouts.data();
+        if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetsSmoothVrs[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor sets!");
+        }
+
+        // reproject vrs pass
+        allocInfo.descriptorSetCount = mPipelineReprojectVrs.descriptorSetLayouts.size();
+        allocInfo.pSetLayouts = mPipelineReprojectVrs.descriptorSetLayouts.data();
+        if (vkAllocateDescriptorSets(mDevice->Get(), &allocInfo, &mDescriptorSetsReprojectVrs[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor sets!");
+        }
     }
 }
 
@@ -237,27 +518,53 @@ void VrsPipeline::UpdateDescriptorSets(VkImageView mainFbColorAttachment, VkImag
 {
     VkDescriptorImageInfo texInputImageInfo = { mNearestSampler, mainFbColorAttachment, VK_IMAGE_LAYOUT_GENERAL };
     VkDescriptorImageInfo texVrsImageInfo = { mNearestSampler, vrsImageView, VK_IMAGE_LAYOUT_GENERAL };
+    VkDescriptorImageInfo depthImageInfo = { mNearestSampler, mMainFbDepthSampleView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
 
     std::vector<VkWriteDescriptorSet> vrsDescriptorSetWrites = {
         vulkanInitializers::WriteDescriptorSet(mDescriptorSetVrsComp,
             0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &texInputImageInfo),
         vulkanInitializers::WriteDescriptorSet(mDescriptorSetVrsComp,
             1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &texVrsImageInfo),
+        vulkanInitializers::WriteDescriptorSet(mDescriptorSetVrsComp,
+            2, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &depthImageInfo),
     };
 
     vkUpdateDescriptorSets(mDevice->Get(), vrsDescriptorSetWrites.size(), vrsDescriptorSetWrites.data(), 0, nullptr);
 
     VkDescriptorImageInfo originVrsImageInfo = { mNearestSampler, vrsImageView, VK_IMAGE_LAYOUT_GENERAL };
     VkDescriptorImageInfo smoothVrsImageInfo = { mNearestSampler, smoothVrsImageView, VK_IMAGE_LAYOUT_GENERAL };
-
-    std::vector<VkWriteDescriptorSet> smoothVrsDescriptorSetWrites = {
-        vulkanInitializers::WriteDescriptorSet(mDescriptorSetSmoothVrs,
-            0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &originVrsImageInfo),
-        vulkanInitializers::WriteDescriptorSet(mDescriptorSetSmoothVrs,
-            1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &smoothVrsImageInfo),
-    };
-
-    vkUpdateDescriptorSets(mDevice->Get(), smoothVrsDescriptorSetWrites.size(), smoothVrsDescriptorSetWrites.data(), 0, nullptr);
+    VkDescriptorBufferInfo statisticsInfo = { mStatisticsBuffer, 0, sizeof(ReuseStatistics) };
+
+    for (uint32_t i = 0; i < mHistoryVrsImages.size(); i++) {
+        // 重投影的第i组读取history[i]、写入history[1-i]，之后分析用第1-i组覆盖history[1-i]
+        VkDescriptorImageInfo readHistoryInfo = { mNearestSampler, mHistoryVrsImageViews[i], VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorImageInfo writeHistoryInfo = { mNearestSampler, mHistoryVrsImageViews[1 - i], VK_IMAGE_LAYOUT_GENERAL };
+        VkDescriptorImageInfo smoothOutputInfo = { mNearestSampler, mHistoryVrsImageViews[i], VK_IMAGE_LAYOUT_GENERAL };
+
+        std::vector<VkWriteDescriptorSet> smoothVrsDescriptorSetWrites = {
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsSmoothVrs[i],
+                0, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &originVrsImageInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsSmoothVrs[i],
+                1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &smoothOutputInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsSmoothVrs[i],
+                2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &smoothVrsImageInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsSmoothVrs[i],
+                3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &statisticsInfo),
+        };
+        vkUpdateDescriptorSets(mDevice->Get(), smoothVrsDescriptorSetWrites.size(), smoothVrsDescriptorSetWrites.data(), 0, nullptr);
+
+        std::vector<VkWriteDescriptorSet> reprojectVrsDescriptorSetWrites = {
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsReprojectVrs[i],
+                0, 0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &depthImageInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsReprojectVrs[i],
+                1, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &readHistoryInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsReprojectVrs[i],
+                2, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &smoothVrsImageInfo),
+            vulkanInitializers::WriteDescriptorSet(mDescriptorSetsReprojectVrs[i],
+                3, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &writeHistoryInfo),
+        };
+        vkUpdateDescriptorSets(mDevice->Get(), reprojectVrsDescriptorSetWrites.size(), reprojectVrsDescriptorSetWrites.data(), 0, nullptr);
+    }
 }
 
 void VrsPipeline::CreateSampler()
@@ -300,4 +607,46 @@ void VrsPipeline::CleanUpSampler()
     vkDestroySampler(mDevice->Get(), mNearestSampler, nullptr);
 }
 
+void VrsPipeline::CreateStatisticsBuffer()
+{
+    BufferCreator::GetInstance().CreateBuffer(sizeof(ReuseStatistics), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        mStatisticsBuffer, mStatisticsBufferMemory);
+    vkMapMemory(mDevice->Get(), mStatisticsBufferMemory, 0, sizeof(ReuseStatistics), 0, reinterpret_cast<void**>(&mStatisticsMapped));
+    memset(mStatisticsMapped, 0, sizeof(ReuseStatistics));
+}
+
+void VrsPipeline::CleanUpStatisticsBuffer()
+{
+    vkUnmapMemory(mDevice->Get(), mStatisticsBufferMemory);
+    vkDestroyBuffer(mDevice->Get(), mStatisticsBuffer, nullptr);
+    vkFreeMemory(mDevice->Get(), mStatisticsBufferMemory, nullptr);
+    mStatisticsMapped = nullptr;
+}
+
+void VrsPipeline::ReportStatistics()
+{
+    if (!mStatisticsPending) {
+        return;
+    }
+    mStatisticsPending = false;
+
+    mStatisticsSum.tileCount += mStatisticsMapped->tileCount;
+    mStatisticsSum.changedCount += mStatisticsMapped->changedCount;
+    mStatisticsSum.coarserCount += mStatisticsMapped->coarserCount;
+    memset(mStatisticsMapped, 0, sizeof(ReuseStatistics));
+
+    mAnalysisCount++;
+    if (mAnalysisCount < STATISTICS_REPORT_INTERVAL || mStatisticsSum.tileCount == 0) {
+        return;
+    }
+    // 重投影的结果和完整分析的差异，间隔越大差异越大
+    LOGI("vrs reuse: reprojection %s, analysis every %d frames, %.2f%% tiles differ, %.2f%% coarser than analysis",
+        mReprojectionEnabled ? "on" : "off", mAnalysisInterval,
+        100.0f * mStatisticsSum.changedCount / mStatisticsSum.tileCount,
+        100.0f * mStatisticsSum.coarserCount / mStatisticsSum.tileCount);
+    mStatisticsSum = {};
+    mAnalysisCount = 0;
+}
+
 } // namespace framework
\ No newline at end of file